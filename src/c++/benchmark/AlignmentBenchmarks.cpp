@@ -0,0 +1,305 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file AlignmentBenchmarks.cpp
+ **
+ ** Seed lookup, ungapped and gapped alignment and shadow rescue benchmarks.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <boost/foreach.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread.hpp>
+
+#include "alignment/BandedSmithWaterman.hh"
+#include "alignment/BclClusters.hh"
+#include "alignment/Cluster.hh"
+#include "alignment/Mismatch.hh"
+#include "alignment/templateBuilder/ShadowAligner.hh"
+#include "flowcell/Layout.hh"
+#include "oligo/KmerGenerator.hpp"
+#include "reference/ReferenceHasher.hh"
+
+#include "Benchmarks.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+static const unsigned READ_LENGTH = 150;
+static const std::size_t PAIRS_COUNT = 4096;
+// shadow rescue is considerably more expensive than the rest
+static const std::size_t SHADOW_PAIRS_COUNT = 256;
+static const unsigned TEMPLATE_LENGTH_MIN = 320;
+static const unsigned TEMPLATE_LENGTH_MAX = 480;
+static const double ERROR_RATE = 0.01;
+
+static const unsigned SEED_LENGTH = 16;
+typedef oligo::BasicKmerType<SEED_LENGTH> SeedKmer;
+typedef reference::ReferenceHash<SeedKmer, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > SeedHash;
+// much smaller than the 4^SEED_LENGTH isaac-align defaults to but still well outside of the caches
+static const uint64_t HASH_BUCKET_COUNT = 1UL << 24;
+
+static void benchmarkFindMatches(
+    Suite &suite, const Reference &reference, const std::vector<SimulatedPair> &pairs)
+{
+    const std::string name = "findMatches/" + reference.name_;
+    if (!suite.enabled(name))
+    {
+        return;
+    }
+
+    common::ThreadVector threads(boost::thread::hardware_concurrency());
+    reference::ReferenceHasher<SeedHash> hasher(reference.contigList_, threads, threads.size());
+    const SeedHash hash = hasher.generate(HASH_BUCKET_COUNT);
+
+    // non-overlapping seeds, same as isaac-align uses by default
+    std::vector<SeedKmer> seeds;
+    BOOST_FOREACH(const SimulatedPair &pair, pairs)
+    {
+        BOOST_FOREACH(const std::string &read, pair.reads_)
+        {
+            oligo::KmerGenerator<SEED_LENGTH, SeedKmer, std::string::const_iterator> kmerGenerator(read.begin(), read.end());
+            SeedKmer kmer(0);
+            std::string::const_iterator position;
+            while (kmerGenerator.next(kmer, position))
+            {
+                if (!(std::distance(read.begin(), position) % SEED_LENGTH))
+                {
+                    seeds.push_back(kmer);
+                }
+            }
+        }
+    }
+
+    suite.run(name, seeds.size(), 0,
+              [&hash, &seeds](const uint64_t iterations)
+              {
+                  uint64_t matches = 0;
+                  for (uint64_t i = 0; iterations != i; ++i)
+                  {
+                      BOOST_FOREACH(const SeedKmer &seed, seeds)
+                      {
+                          const SeedHash::MatchRange range = hash.findMatches(seed);
+                          matches += std::distance(range.first, range.second);
+                      }
+                  }
+                  return matches / iterations;
+              });
+}
+
+static void benchmarkCountMismatchesFast(
+    Suite &suite, const Reference &reference, const std::vector<SimulatedPair> &pairs)
+{
+    std::vector<const char *> referenceBegins;
+    BOOST_FOREACH(const SimulatedPair &pair, pairs)
+    {
+        referenceBegins.push_back(&*(reference.contigList_.at(pair.contigId_).begin() + pair.position_));
+    }
+
+    suite.run("countMismatchesFast/" + reference.name_, pairs.size(), pairs.size() * READ_LENGTH,
+              [&pairs, &referenceBegins](const uint64_t iterations)
+              {
+                  uint64_t mismatches = 0;
+                  for (uint64_t i = 0; iterations != i; ++i)
+                  {
+                      for (std::size_t pair = 0; pairs.size() != pair; ++pair)
+                      {
+                          const std::string &read = pairs[pair].reads_[0];
+                          mismatches += alignment::countMismatchesFast(
+                              read.data(), read.data() + read.size(), referenceBegins[pair]);
+                      }
+                  }
+                  return mismatches / iterations;
+              });
+}
+
+template <unsigned widestGapSize>
+static void benchmarkBandedSmithWaterman(
+    Suite &suite, const Reference &reference, const std::vector<SimulatedPair> &pairs, const unsigned seed)
+{
+    Random random(seed);
+    typedef alignment::BandedSmithWaterman<widestGapSize> Bsw;
+    // positions inside the contigs that fit the whole band
+    const int64_t leftFlank = (Bsw::WIDEST_GAP_SIZE - 1) / 2;
+
+    // each query has a short deletion or insertion in the middle on top of the substitutions
+    std::vector<std::vector<char> > queries;
+    std::vector<reference::Contig::const_iterator> databaseBegins;
+    std::uniform_int_distribution<unsigned> gapLength(1, std::min(4U, widestGapSize / 4));
+    std::bernoulli_distribution deletion(0.5);
+    BOOST_FOREACH(const SimulatedPair &pair, pairs)
+    {
+        const reference::Contig &contig = reference.contigList_.at(pair.contigId_);
+        if (pair.position_ < leftFlank ||
+            std::size_t(pair.position_ + READ_LENGTH + Bsw::WIDEST_GAP_SIZE) > contig.size())
+        {
+            continue;
+        }
+        std::string read = pair.reads_[0];
+        const unsigned length = gapLength(random);
+        if (deletion(random))
+        {
+            read.erase(READ_LENGTH / 2, length);
+            read.append(contig.begin() + pair.position_ + READ_LENGTH, contig.begin() + pair.position_ + READ_LENGTH + length);
+        }
+        else
+        {
+            read.insert(READ_LENGTH / 2, length, 'A');
+            read.resize(READ_LENGTH);
+        }
+        queries.push_back(std::vector<char>(read.begin(), read.end()));
+        databaseBegins.push_back(contig.begin() + pair.position_ - leftFlank);
+    }
+
+    suite.run("bandedSmithWaterman" + std::to_string(widestGapSize) + "/" + reference.name_,
+              queries.size(), queries.size() * READ_LENGTH,
+              [&queries, &databaseBegins](const uint64_t iterations)
+              {
+                  const Bsw bsw(2, -1, 15, 3, READ_LENGTH);
+                  alignment::Cigar cigar;
+                  cigar.reserve(1024);
+                  uint64_t ret = 0;
+                  for (uint64_t i = 0; iterations != i; ++i)
+                  {
+                      for (std::size_t query = 0; queries.size() != query; ++query)
+                      {
+                          cigar.clear();
+                          ret += bsw.align(
+                              queries[query].begin(), queries[query].end(),
+                              databaseBegins[query], databaseBegins[query] + READ_LENGTH + Bsw::WIDEST_GAP_SIZE - 1,
+                              cigar);
+                          ret += cigar.size();
+                      }
+                  }
+                  return ret / iterations;
+              });
+}
+
+static std::vector<char> getBcl(const SimulatedPair &pair)
+{
+    std::vector<char> ret;
+    BOOST_FOREACH(const std::string &read, pair.reads_)
+    {
+        BOOST_FOREACH(const char base, read)
+        {
+            ret.push_back((30 << 2) | oligo::getValue(base));
+        }
+    }
+    return ret;
+}
+
+static flowcell::ReadMetadataList getReadMetadataList()
+{
+    flowcell::ReadMetadataList ret;
+    std::vector<unsigned> cycles;
+    for (unsigned readIndex = 0; 2 != readIndex; ++readIndex)
+    {
+        cycles.clear();
+        for (unsigned cycle = readIndex * READ_LENGTH + 1; (readIndex + 1) * READ_LENGTH >= cycle; ++cycle)
+        {
+            cycles.push_back(cycle);
+        }
+        ret.push_back(flowcell::ReadMetadata(readIndex + 1, cycles, readIndex, readIndex * READ_LENGTH, cycles.front()));
+    }
+    return ret;
+}
+
+template <unsigned shadowKmerLength>
+static void benchmarkRescueShadows(
+    Suite &suite, const Reference &reference, const std::vector<SimulatedPair> &pairs)
+{
+    const std::string name = "rescueShadows" + std::to_string(shadowKmerLength) + "/" + reference.name_;
+    if (!suite.enabled(name))
+    {
+        return;
+    }
+
+    const flowcell::ReadMetadataList readMetadataList = getReadMetadataList();
+    const flowcell::FlowcellLayoutList flowcells(
+        1, flowcell::Layout("", flowcell::Layout::Fastq, flowcell::FastqFlowcellData(false, '!', false), 8, 0,
+                            std::vector<unsigned>(), readMetadataList, "benchmark"));
+
+    const std::size_t pairsCount = std::min(pairs.size(), SHADOW_PAIRS_COUNT);
+    alignment::BclClusters bcl(flowcell::getTotalReadLength(readMetadataList));
+    bcl.reserveClusters(pairsCount, false);
+    boost::ptr_vector<alignment::Cluster> clusters;
+    std::vector<alignment::FragmentMetadata> orphans;
+    for (std::size_t pair = 0; pairsCount != pair; ++pair)
+    {
+        const std::vector<char> pairBcl = getBcl(pairs[pair]);
+        std::copy(pairBcl.begin(), pairBcl.end(), bcl.addMoreClusters(1));
+    }
+    for (std::size_t pair = 0; pairsCount != pair; ++pair)
+    {
+        clusters.push_back(new alignment::Cluster(READ_LENGTH));
+        clusters.back().init(readMetadataList, bcl.cluster(pair), 1101, pair, alignment::ClusterXy(0, 0), true, 0, 0);
+        alignment::FragmentMetadata orphan;
+        orphan.cluster = &clusters.back();
+        orphan.readIndex = 0;
+        orphan.contigId = pairs[pair].contigId_;
+        orphan.position = pairs[pair].position_;
+        orphan.reverse = false;
+        orphans.push_back(orphan);
+    }
+
+    const alignment::TemplateLengthStatistics tls(
+        TEMPLATE_LENGTH_MIN - 20, TEMPLATE_LENGTH_MAX + 20, (TEMPLATE_LENGTH_MIN + TEMPLATE_LENGTH_MAX) / 2, 30, 30,
+        alignment::TemplateLengthStatistics::FRp, alignment::TemplateLengthStatistics::RFm, -1);
+    const alignment::AlignmentCfg alignmentCfg(2, -1, -15, -3, 25, -1U);
+    const alignment::SequencingAdapterList noAdapters;
+
+    suite.run(name, orphans.size(), 0,
+              [&](const uint64_t iterations)
+              {
+                  alignment::Cigar cigarBuffer;
+                  cigarBuffer.reserve(10000);
+                  alignment::templateBuilder::ShadowAligner<shadowKmerLength> shadowAligner(
+                      true, flowcells, 8, 2, false, false, false, alignmentCfg, cigarBuffer);
+                  alignment::templateBuilder::FragmentSequencingAdapterClipper adapterClipper(noAdapters);
+                  alignment::FragmentMetadataList shadowList;
+                  shadowList.reserve(100);
+                  uint64_t ret = 0;
+                  for (uint64_t i = 0; iterations != i; ++i)
+                  {
+                      BOOST_FOREACH(const alignment::FragmentMetadata &orphan, orphans)
+                      {
+                          cigarBuffer.clear();
+                          if (shadowAligner.rescueShadows(
+                              reference.contigList_, orphan, 100, shadowList, readMetadataList[1], adapterClipper, tls))
+                          {
+                              ret += shadowList.front().position + shadowList.front().mismatchCount;
+                          }
+                      }
+                  }
+                  return ret / iterations;
+              });
+}
+
+void runAlignmentBenchmarks(Suite &suite, const Reference &reference, const unsigned seed)
+{
+    Random random(seed);
+    const std::vector<SimulatedPair> pairs = simulatePairs(
+        reference.contigList_, PAIRS_COUNT, READ_LENGTH, TEMPLATE_LENGTH_MIN, TEMPLATE_LENGTH_MAX, ERROR_RATE, 0.0, 0.0, random);
+
+    benchmarkFindMatches(suite, reference, pairs);
+    benchmarkCountMismatchesFast(suite, reference, pairs);
+    benchmarkBandedSmithWaterman<16>(suite, reference, pairs, seed);
+    benchmarkBandedSmithWaterman<64>(suite, reference, pairs, seed);
+    benchmarkRescueShadows<7>(suite, reference, pairs);
+    benchmarkRescueShadows<8>(suite, reference, pairs);
+}
+
+} // namespace benchmark
+} // namespace isaac
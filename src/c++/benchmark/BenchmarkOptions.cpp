@@ -0,0 +1,83 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file BenchmarkOptions.cpp
+ **
+ ** Command line options for isaac-benchmark
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <boost/foreach.hpp>
+
+#include "common/Exceptions.hh"
+
+#include "BenchmarkOptions.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+namespace bpo = boost::program_options;
+namespace bfs = boost::filesystem;
+using common::InvalidOptionException;
+
+BenchmarkOptions::BenchmarkOptions():
+    seed_(1),
+    genomeLength_(1000000),
+    minSeconds_(0.2),
+    repeats_(5)
+{
+    namedOptions_.add_options()
+        ("output-file,o"       , bpo::value<bfs::path>(&outputFilePath_),
+            "Path for the json file with the results. Results go to the standard output if not specified.")
+        ("reference-fasta,r"   , bpo::value<std::vector<bfs::path> >(&referenceFastaPaths_),
+            "Fasta file to derive the reference-dependent inputs from in addition to the synthetic genome. "
+            "Multiple entries allowed, each is benchmarked separately.")
+        ("filter,f"            , bpo::value<std::string>(&filter_),
+            "Only run benchmarks which names contain the specified string.")
+        ("seed"                , bpo::value<unsigned>(&seed_)->default_value(seed_),
+            "Seed for the synthetic inputs. Results are only comparable between runs with the same seed.")
+        ("genome-length"       , bpo::value<uint64_t>(&genomeLength_)->default_value(genomeLength_),
+            "Length of the synthetic genome.")
+        ("min-time"            , bpo::value<double>(&minSeconds_)->default_value(minSeconds_),
+            "Minimum duration in seconds of each timed batch.")
+        ("repeats"             , bpo::value<unsigned>(&repeats_)->default_value(repeats_),
+            "Number of timed batches per benchmark. The median is reported.")
+        ;
+}
+
+void BenchmarkOptions::postProcess(bpo::variables_map &vm)
+{
+    if(vm.count("help") ||  vm.count("version"))
+    {
+        return;
+    }
+
+    if (!repeats_)
+    {
+        BOOST_THROW_EXCEPTION(InvalidOptionException("\n   *** --repeats must be at least 1 ***\n"));
+    }
+
+    BOOST_FOREACH(bfs::path &fastaPath, referenceFastaPaths_)
+    {
+        fastaPath = bfs::absolute(fastaPath);
+        if (!bfs::exists(fastaPath))
+        {
+            BOOST_THROW_EXCEPTION(InvalidOptionException("\n   *** Fasta file does not exist: " + fastaPath.string() + " ***\n"));
+        }
+    }
+}
+
+} // namespace benchmark
+} // namespace isaac
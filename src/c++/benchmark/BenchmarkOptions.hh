@@ -0,0 +1,57 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file BenchmarkOptions.hh
+ **
+ ** Command line options for isaac-benchmark
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BENCHMARK_BENCHMARK_OPTIONS_HH
+#define iSAAC_BENCHMARK_BENCHMARK_OPTIONS_HH
+
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "common/Program.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+class BenchmarkOptions : public common::Options
+{
+public:
+    boost::filesystem::path outputFilePath_;
+    std::vector<boost::filesystem::path> referenceFastaPaths_;
+    std::string filter_;
+    unsigned seed_;
+    uint64_t genomeLength_;
+    double minSeconds_;
+    unsigned repeats_;
+
+public:
+    BenchmarkOptions();
+
+private:
+    std::string usagePrefix() const {return "isaac-benchmark";}
+    void postProcess(boost::program_options::variables_map &vm);
+};
+
+} // namespace benchmark
+} // namespace isaac
+
+#endif // #ifndef iSAAC_BENCHMARK_BENCHMARK_OPTIONS_HH
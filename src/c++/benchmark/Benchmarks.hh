@@ -0,0 +1,53 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file Benchmarks.hh
+ **
+ ** Micro-benchmarks of the alignment and output hot paths.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BENCHMARK_BENCHMARKS_HH
+#define iSAAC_BENCHMARK_BENCHMARKS_HH
+
+#include "Inputs.hh"
+#include "Suite.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+/**
+ * \brief Seed lookup, ungapped and gapped alignment and shadow rescue against the reference.
+ *        Benchmark names are suffixed with the reference name.
+ *
+ * \param seed  each benchmark generates its inputs from it independently of which benchmarks are enabled
+ */
+void runAlignmentBenchmarks(Suite &suite, const Reference &reference, const unsigned seed);
+
+/**
+ * \brief Known indel lookup and gap realignment against a gnomAD-sized set of indels simulated over the reference.
+ *        Benchmark names are suffixed with the reference name.
+ */
+void runRealignmentBenchmarks(Suite &suite, const Reference &reference, const unsigned seed);
+
+/**
+ * \brief Barcode resolution, bam record encoding and bgzf compression
+ */
+void runOutputBenchmarks(Suite &suite, const Reference &reference, const unsigned seed);
+
+} // namespace benchmark
+} // namespace isaac
+
+#endif // #ifndef iSAAC_BENCHMARK_BENCHMARKS_HH
@@ -0,0 +1,211 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file Inputs.cpp
+ **
+ ** Fixed synthetic and fasta-derived inputs of the micro-benchmarks.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <boost/foreach.hpp>
+
+#include "common/Exceptions.hh"
+#include "io/FastaReader.hh"
+#include "oligo/Nucleotides.hh"
+
+#include "Inputs.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+static const char BASES[] = {'A', 'C', 'G', 'T'};
+
+// padding keeps the shadow rescue and gapped alignment windows inside the reference
+static const std::size_t CONTIG_SPACING = 1000;
+
+static reference::SortedReferenceMetadata makeSortedReferenceMetadata(const std::vector<std::string> &contigs)
+{
+    reference::SortedReferenceMetadata ret;
+    std::size_t genomicOffset = 0;
+    BOOST_FOREACH(const std::string &contig, contigs)
+    {
+        ret.putContig(
+            genomicOffset, "contig" + std::to_string(ret.getContigsCount()), "benchmark.fa",
+            genomicOffset, contig.size(), contig.size(), contig.size(), ret.getContigsCount(), "", "", "");
+        genomicOffset += contig.size();
+    }
+    return ret;
+}
+
+Reference::Reference(const std::string &name, const std::vector<std::string> &contigs) :
+    name_(name),
+    sortedReferenceMetadata_(makeSortedReferenceMetadata(contigs)),
+    contigList_(sortedReferenceMetadata_.getContigs(), CONTIG_SPACING)
+{
+    for (std::size_t contigId = 0; contigs.size() != contigId; ++contigId)
+    {
+        reference::ContigList::UpdateRange rwContig = contigList_.getUpdateRange(contigId);
+        std::copy(contigs[contigId].begin(), contigs[contigId].end(), rwContig.begin());
+    }
+}
+
+std::string generateGenome(const std::size_t length, Random &random)
+{
+    std::uniform_int_distribution<unsigned> base(0, 3);
+    std::string ret;
+    ret.reserve(length);
+    while (ret.size() != length)
+    {
+        ret.push_back(BASES[base(random)]);
+    }
+    return ret;
+}
+
+std::vector<std::string> loadFasta(const boost::filesystem::path &fastaPath)
+{
+    io::FastaReader fasta;
+    fasta.open(fastaPath.string().c_str());
+    if (!fasta)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open fasta file: " + fastaPath.string()));
+    }
+
+    std::vector<std::string> ret;
+    char base = 0;
+    bool newContig = false;
+    while (fasta.get(base, newContig))
+    {
+        if (newContig || ret.empty())
+        {
+            ret.push_back(std::string());
+        }
+        ret.back().push_back(std::toupper(base));
+    }
+
+    if (ret.empty())
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(EINVAL, "No sequence found in fasta file: " + fastaPath.string()));
+    }
+    return ret;
+}
+
+std::string reverseComplement(const std::string &forward)
+{
+    std::string ret;
+    ret.reserve(forward.size());
+    for (std::string::const_reverse_iterator it = forward.rbegin(); forward.rend() != it; ++it)
+    {
+        ret.push_back(oligo::getReverseBase(oligo::getValue(*it)));
+    }
+    return ret;
+}
+
+void addErrors(std::string &read, const double errorRate, Random &random)
+{
+    std::bernoulli_distribution error(errorRate);
+    std::uniform_int_distribution<unsigned> shift(1, 3);
+    BOOST_FOREACH(char &base, read)
+    {
+        if (error(random))
+        {
+            base = BASES[(oligo::getValue(base) + shift(random)) % 4];
+        }
+    }
+}
+
+/**
+ * \brief Takes the read off the beginning of sequence. Deletions are only simulated if the sequence is long enough
+ *        to fill the read after them.
+ */
+static std::string sequenceRead(const std::string &sequence, const unsigned readLength, const bool indel, Random &random)
+{
+    std::string ret(sequence, 0, readLength + INDEL_LENGTH_MAX);
+    if (indel)
+    {
+        const unsigned length = std::uniform_int_distribution<unsigned>(1, INDEL_LENGTH_MAX)(random);
+        const std::size_t offset = std::uniform_int_distribution<std::size_t>(readLength / 3, readLength * 2 / 3)(random);
+        if (std::bernoulli_distribution(0.5)(random))
+        {
+            ret.insert(offset, generateGenome(length, random));
+        }
+        else if (ret.size() >= readLength + length)
+        {
+            ret.erase(offset, length);
+        }
+    }
+    ret.resize(readLength);
+    return ret;
+}
+
+std::vector<SimulatedPair> simulatePairs(
+    const reference::ContigList &contigList,
+    const std::size_t count,
+    const unsigned readLength,
+    const unsigned templateLengthMin,
+    const unsigned templateLengthMax,
+    const double errorRate,
+    const double indelRate,
+    const double duplicateRate,
+    Random &random)
+{
+    std::vector<std::size_t> usableContigs;
+    BOOST_FOREACH(const reference::Contig &contig, contigList)
+    {
+        if (contig.size() > templateLengthMax)
+        {
+            usableContigs.push_back(contig.getIndex());
+        }
+    }
+    if (usableContigs.empty())
+    {
+        BOOST_THROW_EXCEPTION(common::InvalidParameterException(
+            "Reference must have at least one contig longer than " + std::to_string(templateLengthMax)));
+    }
+
+    std::uniform_int_distribution<std::size_t> contigIndex(0, usableContigs.size() - 1);
+    std::uniform_int_distribution<unsigned> templateLength(templateLengthMin, templateLengthMax);
+    std::vector<SimulatedPair> ret(count);
+    for (std::size_t i = 0; count != i; ++i)
+    {
+        SimulatedPair &pair = ret[i];
+        // zero rates don't consume random numbers so that the inputs stay the same for the same seed
+        if (duplicateRate && i && std::bernoulli_distribution(duplicateRate)(random))
+        {
+            const SimulatedPair &original = ret[std::uniform_int_distribution<std::size_t>(0, i - 1)(random)];
+            pair.contigId_ = original.contigId_;
+            pair.templateLength_ = original.templateLength_;
+            pair.position_ = original.position_;
+        }
+        else
+        {
+            const reference::Contig &contig = contigList.at(usableContigs.at(contigIndex(random)));
+            pair.contigId_ = contig.getIndex();
+            pair.templateLength_ = templateLength(random);
+            pair.position_ = std::uniform_int_distribution<int64_t>(0, contig.size() - pair.templateLength_)(random);
+        }
+
+        const reference::Contig::const_iterator templateBegin = contigList.at(pair.contigId_).begin() + pair.position_;
+        const std::string fragment(templateBegin, templateBegin + pair.templateLength_);
+        pair.reads_[0] = sequenceRead(fragment, readLength, indelRate && std::bernoulli_distribution(indelRate)(random), random);
+        pair.reads_[1] = sequenceRead(
+            reverseComplement(fragment), readLength, indelRate && std::bernoulli_distribution(indelRate)(random), random);
+        addErrors(pair.reads_[0], errorRate, random);
+        addErrors(pair.reads_[1], errorRate, random);
+    }
+    return ret;
+}
+
+} // namespace benchmark
+} // namespace isaac
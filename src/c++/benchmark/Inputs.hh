@@ -0,0 +1,107 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file Inputs.hh
+ **
+ ** Fixed synthetic and fasta-derived inputs of the micro-benchmarks.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BENCHMARK_INPUTS_HH
+#define iSAAC_BENCHMARK_INPUTS_HH
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "reference/Contig.hh"
+#include "reference/SortedReferenceMetadata.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+/**
+ * \brief All randomness of the suite comes from here so that same seed produces the same inputs everywhere
+ */
+typedef std::mt19937 Random;
+
+struct Reference
+{
+    Reference(const std::string &name, const std::vector<std::string> &contigs);
+    Reference(Reference &&that) :
+        name_(that.name_), sortedReferenceMetadata_(that.sortedReferenceMetadata_), contigList_(std::move(that.contigList_)){}
+
+    // used as benchmark name suffix
+    std::string name_;
+    reference::SortedReferenceMetadata sortedReferenceMetadata_;
+    reference::ContigList contigList_;
+};
+
+// longest insertion or deletion simulated in a read
+static const unsigned INDEL_LENGTH_MAX = 3;
+
+/**
+ * \brief FR pair sampled from the reference
+ */
+struct SimulatedPair
+{
+    unsigned contigId_;
+    // f-strand position of the first read
+    int64_t position_;
+    unsigned templateLength_;
+    // as sequenced. The second read is reverse-complemented
+    std::string reads_[2];
+};
+
+std::string generateGenome(const std::size_t length, Random &random);
+
+/**
+ * \brief Upper-cased contig sequences of the fasta file
+ */
+std::vector<std::string> loadFasta(const boost::filesystem::path &fastaPath);
+
+/**
+ * \param templateLengthMin     pairs with templates of uniformly distributed lengths from
+ *                              [templateLengthMin, templateLengthMax] are produced
+ * \param errorRate             probability of each base to be substituted
+ * \param indelRate             probability of each read to have an insertion or deletion of up to
+ *                              INDEL_LENGTH_MAX bases in its middle third
+ * \param duplicateRate         probability of each pair to come from the same template as one of the pairs
+ *                              produced before it
+ */
+std::vector<SimulatedPair> simulatePairs(
+    const reference::ContigList &contigList,
+    const std::size_t count,
+    const unsigned readLength,
+    const unsigned templateLengthMin,
+    const unsigned templateLengthMax,
+    const double errorRate,
+    const double indelRate,
+    const double duplicateRate,
+    Random &random);
+
+std::string reverseComplement(const std::string &forward);
+
+/**
+ * \param errorRate   probability of each base to be substituted
+ */
+void addErrors(std::string &read, const double errorRate, Random &random);
+
+} // namespace benchmark
+} // namespace isaac
+
+#endif // #ifndef iSAAC_BENCHMARK_INPUTS_HH
@@ -0,0 +1,300 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file OutputBenchmarks.cpp
+ **
+ ** Barcode resolution, bam record encoding and bgzf compression benchmarks.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <cstring>
+
+#include <boost/foreach.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include "bam/Bam.hh"
+#include "bgzf/BgzfCompressor.hh"
+#include "build/FragmentAccessorBamAdapter.hh"
+#include "demultiplexing/BarcodeResolver.hh"
+#include "oligo/Nucleotides.hh"
+
+#include "Benchmarks.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+static const unsigned READ_LENGTH = 150;
+static const std::size_t PAIRS_COUNT = 4096;
+static const unsigned TEMPLATE_LENGTH_MIN = 320;
+static const unsigned TEMPLATE_LENGTH_MAX = 480;
+static const double ERROR_RATE = 0.01;
+
+static const unsigned BARCODE_LENGTH = 8;
+static const unsigned SAMPLES_COUNT = 24;
+static const std::size_t BARCODES_COUNT = 65536;
+
+static unsigned hammingDistance(const std::string &left, const std::string &right)
+{
+    unsigned ret = 0;
+    for (std::size_t i = 0; left.size() != i; ++i)
+    {
+        ret += left[i] != right[i];
+    }
+    return ret;
+}
+
+static demultiplexing::Kmer getBarcodeKmer(const std::string &sequence)
+{
+    demultiplexing::Kmer ret = 0;
+    BOOST_FOREACH(const char base, sequence)
+    {
+        ret = (ret << demultiplexing::BITS_PER_BASE) | oligo::getValue(base);
+    }
+    return ret;
+}
+
+static void benchmarkBarcodeResolver(Suite &suite, const unsigned seed)
+{
+    const std::string name = "barcodeResolve";
+    if (!suite.enabled(name))
+    {
+        return;
+    }
+
+    Random random(seed);
+    // sample barcodes at least 3 mismatches apart so that 1-mismatch variants don't collide
+    std::vector<std::string> sampleBarcodes;
+    while (SAMPLES_COUNT != sampleBarcodes.size())
+    {
+        const std::string candidate = generateGenome(BARCODE_LENGTH, random);
+        if (sampleBarcodes.end() == std::find_if(
+            sampleBarcodes.begin(), sampleBarcodes.end(),
+            [&candidate](const std::string &barcode){return 3 > hammingDistance(barcode, candidate);}))
+        {
+            sampleBarcodes.push_back(candidate);
+        }
+    }
+
+    flowcell::BarcodeMetadataList barcodeMetadataList(SAMPLES_COUNT + 1);
+    const std::vector<unsigned> componentMismatches(1, 1);
+    barcodeMetadataList.at(0).setUnknown();
+    barcodeMetadataList.at(0).setIndex(0);
+    barcodeMetadataList.at(0).setComponentMismatches(componentMismatches);
+    for (unsigned sample = 0; SAMPLES_COUNT != sample; ++sample)
+    {
+        barcodeMetadataList.at(sample + 1).setSequence(sampleBarcodes.at(sample));
+        barcodeMetadataList.at(sample + 1).setIndex(sample + 1);
+        barcodeMetadataList.at(sample + 1).setComponentMismatches(componentMismatches);
+    }
+
+    // mostly perfect barcodes with some 1-mismatch ones and some that don't belong to any sample
+    std::uniform_int_distribution<unsigned> sample(0, SAMPLES_COUNT - 1);
+    std::uniform_int_distribution<unsigned> kind(0, 9);
+    std::uniform_int_distribution<unsigned> mismatchPosition(0, BARCODE_LENGTH - 1);
+    demultiplexing::Barcodes barcodes;
+    for (std::size_t cluster = 0; BARCODES_COUNT != cluster; ++cluster)
+    {
+        std::string sequence = sampleBarcodes.at(sample(random));
+        const unsigned k = kind(random);
+        if (8 == k)
+        {
+            char &base = sequence.at(mismatchPosition(random));
+            base = 'A' == base ? 'C' : 'A';
+        }
+        else if (9 == k)
+        {
+            sequence = generateGenome(BARCODE_LENGTH, random);
+        }
+        barcodes.push_back(demultiplexing::Barcode(getBarcodeKmer(sequence), demultiplexing::BarcodeId(0, 0, cluster, 0)));
+    }
+
+    common::ThreadVector threads(1);
+    demultiplexing::BarcodeResolver resolver(barcodeMetadataList, barcodeMetadataList, threads, threads.size());
+    demultiplexing::DemultiplexingStats stats(flowcell::FlowcellLayoutList(), barcodeMetadataList);
+
+    suite.run(name, barcodes.size(), 0,
+              [&](const uint64_t iterations)
+              {
+                  uint64_t unknown = 0;
+                  for (uint64_t i = 0; iterations != i; ++i)
+                  {
+                      resolver.resolve(barcodes, stats);
+                      BOOST_FOREACH(const demultiplexing::Barcode &barcode, barcodes)
+                      {
+                          unknown += !barcode.getBarcode();
+                      }
+                  }
+                  return unknown / iterations;
+              });
+}
+
+/**
+ * \brief Packs the simulated pairs into fragment records the way the alignment stage stores them in bin files
+ */
+static void packFragments(
+    const Reference &reference,
+    const std::vector<SimulatedPair> &pairs,
+    std::vector<char> &data,
+    std::vector<build::PackedFragmentBuffer::Index> &index)
+{
+    alignment::Cigar cigar(1);
+    cigar.addOperation(READ_LENGTH, alignment::Cigar::ALIGN);
+    std::vector<uint64_t> offsets;
+    BOOST_FOREACH(const SimulatedPair &pair, pairs)
+    {
+        const reference::Contig &contig = reference.contigList_.at(pair.contigId_);
+        for (unsigned readIndex = 0; 2 != readIndex; ++readIndex)
+        {
+            const bool reverse = readIndex;
+            const int64_t position = reverse ? pair.position_ + pair.templateLength_ - READ_LENGTH : pair.position_;
+            const int64_t matePosition = reverse ? pair.position_ : pair.position_ + pair.templateLength_ - READ_LENGTH;
+            // stored in the orientation of the forward strand
+            const std::string bases = reverse ? reverseComplement(pair.reads_[readIndex]) : pair.reads_[readIndex];
+            const std::string name = "benchmark:1:1101:" + std::to_string(&pair - &pairs.front());
+
+            io::FragmentHeader header;
+            header.flags_ = io::FragmentHeader::Flags(
+                true, false, false, reverse, !reverse, readIndex, false, true, false, false, false);
+            header.fStrandPosition_ = reference::ReferencePosition(pair.contigId_, position);
+            header.fStrandOriginalPosition_ = header.fStrandPosition_;
+            header.rStrandPosition_ = header.fStrandPosition_ + READ_LENGTH;
+            header.mateFStrandPosition_ = reference::ReferencePosition(pair.contigId_, matePosition);
+            header.bamTlen_ = reverse ? -int(pair.templateLength_) : pair.templateLength_;
+            header.readLength_ = READ_LENGTH;
+            header.cigarLength_ = cigar.size();
+            header.nameLength_ = name.size();
+            header.alignmentScore_ = 60;
+            header.templateAlignmentScore_ = 120;
+            header.mapQ_ = 60;
+            header.tile_ = 0;
+            header.barcode_ = 0;
+            header.clusterId_ = &pair - &pairs.front();
+            header.editDistance_ = std::inner_product(
+                bases.begin(), bases.end(), contig.begin() + position, 0, std::plus<unsigned>(), std::not_equal_to<char>());
+
+            offsets.push_back(data.size());
+            data.insert(data.end(), header.bytesBegin(), header.bytesEnd());
+            BOOST_FOREACH(const char base, bases)
+            {
+                data.push_back((30 << 2) | oligo::getValue(base));
+            }
+            data.insert(data.end(),
+                        reinterpret_cast<const char *>(&cigar.front()), reinterpret_cast<const char *>(&cigar.back() + 1));
+            data.insert(data.end(), name.c_str(), name.c_str() + name.size() + 1);
+        }
+    }
+
+    // the buffer does not move from here on
+    BOOST_FOREACH(const uint64_t offset, offsets)
+    {
+        const io::FragmentAccessor &fragment = *reinterpret_cast<const io::FragmentAccessor *>(&data.at(offset));
+        const uint64_t mateOffset = (&offset - &offsets.front()) % 2 ? *(&offset - 1) : *(&offset + 1);
+        index.push_back(build::PackedFragmentBuffer::Index(
+            fragment.fStrandPosition_, offset, mateOffset, fragment.cigarBegin(), fragment.cigarEnd(), fragment.isReverse()));
+    }
+}
+
+/**
+ * \brief Encodes the records the same way BamSerializer::storeAligned does minus the bam index update
+ */
+static void benchmarkBamEncode(
+    Suite &suite, const Reference &reference, const std::vector<SimulatedPair> &pairs, std::vector<char> &encoded)
+{
+    std::vector<char> data;
+    std::vector<build::PackedFragmentBuffer::Index> index;
+    packFragments(reference, pairs, data, index);
+
+    flowcell::BarcodeMetadataList barcodeMetadataList(1);
+    barcodeMetadataList.at(0).setIndex(0);
+    barcodeMetadataList.at(0).setReferenceIndex(0);
+    const reference::SortedReferenceMetadataList sortedReferenceMetadataList(1, reference.sortedReferenceMetadata_);
+    const build::BuildContigMap contigMap(
+        barcodeMetadataList, alignment::BinMetadataCRefList(), sortedReferenceMetadataList, false);
+    const flowcell::TileMetadataList tileMetadataList;
+    const reference::ContigLists contigLists;
+    const flowcell::FlowcellLayoutList flowcellLayoutList;
+    const build::SplitInfoList splitInfoList;
+
+    build::FragmentAccessorBamAdapter adapter(
+        READ_LENGTH, tileMetadataList, barcodeMetadataList, contigMap, contigLists, 0, flowcellLayoutList,
+        build::IncludeTags(true, false, true, true, true, true, false, false), false, 0, splitInfoList);
+
+    const auto encode =
+        [&](std::vector<char> &output)
+        {
+            boost::iostreams::filtering_ostream bamStream;
+            bamStream.push(boost::iostreams::back_inserter(output));
+            BOOST_FOREACH(const build::PackedFragmentBuffer::Index &idx, index)
+            {
+                const io::FragmentAccessor &fragment =
+                    *reinterpret_cast<const io::FragmentAccessor *>(&data.at(idx.dataOffset_));
+                bam::serializeAlignment(bamStream, adapter(idx, fragment));
+            }
+            bamStream.strict_sync();
+        };
+
+    encode(encoded);
+
+    std::vector<char> output;
+    output.reserve(encoded.size());
+    suite.run("bamEncode", index.size(), data.size(),
+              [&](const uint64_t iterations)
+              {
+                  for (uint64_t i = 0; iterations != i; ++i)
+                  {
+                      output.clear();
+                      encode(output);
+                  }
+                  return output.size();
+              });
+}
+
+static void benchmarkBgzfCompress(Suite &suite, const std::vector<char> &uncompressed)
+{
+    const int level = boost::iostreams::gzip::best_speed;
+    std::vector<char> compressed;
+    compressed.reserve(uncompressed.size());
+    suite.run("bgzfCompress" + std::to_string(level), 1, uncompressed.size(),
+              [&](const uint64_t iterations)
+              {
+                  for (uint64_t i = 0; iterations != i; ++i)
+                  {
+                      compressed.clear();
+                      boost::iostreams::filtering_ostream bgzfStream;
+                      bgzfStream.push(bgzf::BgzfCompressor(level), 65535, 0);
+                      bgzfStream.push(boost::iostreams::back_inserter(compressed));
+                      bgzfStream.write(&uncompressed.front(), uncompressed.size());
+                      bgzfStream.reset();
+                  }
+                  return compressed.size();
+              });
+}
+
+void runOutputBenchmarks(Suite &suite, const Reference &reference, const unsigned seed)
+{
+    benchmarkBarcodeResolver(suite, seed);
+
+    Random random(seed);
+    const std::vector<SimulatedPair> pairs = simulatePairs(
+        reference.contigList_, PAIRS_COUNT, READ_LENGTH, TEMPLATE_LENGTH_MIN, TEMPLATE_LENGTH_MAX, ERROR_RATE, 0.0, 0.0, random);
+    // compression input is the encoder output so that the compression ratio is representative
+    std::vector<char> encoded;
+    benchmarkBamEncode(suite, reference, pairs, encoded);
+    benchmarkBgzfCompress(suite, encoded);
+}
+
+} // namespace benchmark
+} // namespace isaac
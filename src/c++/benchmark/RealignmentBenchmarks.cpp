@@ -0,0 +1,277 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file RealignmentBenchmarks.cpp
+ **
+ ** Known indel lookup and gap realignment benchmarks.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <numeric>
+
+#include <boost/foreach.hpp>
+
+#include "build/GapRealigner.hh"
+#include "oligo/Nucleotides.hh"
+
+#include "Benchmarks.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+static const unsigned READ_LENGTH = 150;
+static const std::size_t FRAGMENTS_COUNT = 4096;
+static const double ERROR_RATE = 0.01;
+
+// gnomAD genomes list tens of millions of indels over the 3.1 gigabases of the human reference
+static const unsigned KNOWN_INDEL_SPACING = 50;
+static const unsigned KNOWN_INDEL_LENGTH_MAX = 10;
+// the rest of the reads match the reference up to the sequencing errors
+static const double INDEL_CARRIER_RATE = 0.1;
+
+// isaac-align defaults
+static const unsigned GAPS_PER_FRAGMENT_MAX = 4;
+static const unsigned MISMATCH_COST = 3;
+static const unsigned GAP_OPEN_COST = 4;
+// same limits GapRealigner applies to its own lookups
+static const unsigned FOUND_GAPS_MAX = 64 * 10;
+static const unsigned GAPS_PER_LOCUS_MAX = 8;
+
+/**
+ * \brief Known indels spread over the whole reference at the density of gnomAD
+ */
+static build::gapRealigner::Gaps generateKnownIndels(const reference::ContigList &contigList, Random &random)
+{
+    std::uniform_int_distribution<unsigned> spacing(1, KNOWN_INDEL_SPACING * 2 - 1);
+    std::uniform_int_distribution<int> length(1, KNOWN_INDEL_LENGTH_MAX);
+    build::gapRealigner::Gaps ret;
+    BOOST_FOREACH(const reference::Contig &contig, contigList)
+    {
+        for (uint64_t position = spacing(random); contig.size() > position + KNOWN_INDEL_LENGTH_MAX; position += spacing(random))
+        {
+            ret.push_back(build::gapRealigner::Gap(
+                reference::ReferencePosition(contig.getIndex(), position),
+                std::bernoulli_distribution(0.5)(random) ? length(random) : -length(random)));
+        }
+    }
+    return ret;
+}
+
+/**
+ * \brief Forward-strand single-ended reads placed without gaps, the way the aligner leaves the reads which
+ *        indels it did not discover. Some of them carry a known indel in their middle third.
+ */
+static void packFragments(
+    const Reference &reference,
+    const build::gapRealigner::Gaps &knownIndels,
+    Random &random,
+    build::PackedFragmentBuffer &dataBuffer,
+    std::vector<build::PackedFragmentBuffer::Index> &index)
+{
+    std::vector<unsigned> usableContigs;
+    BOOST_FOREACH(const reference::Contig &contig, reference.contigList_)
+    {
+        if (contig.size() > READ_LENGTH * 2)
+        {
+            usableContigs.push_back(contig.getIndex());
+        }
+    }
+    if (usableContigs.empty())
+    {
+        BOOST_THROW_EXCEPTION(common::InvalidParameterException(
+            "Reference must have at least one contig longer than " + std::to_string(READ_LENGTH * 2)));
+    }
+
+    alignment::Cigar cigar(1);
+    cigar.addOperation(READ_LENGTH, alignment::Cigar::ALIGN);
+    std::uniform_int_distribution<std::size_t> contigIndex(0, usableContigs.size() - 1);
+    std::vector<char> data;
+    std::vector<uint64_t> offsets;
+    for (std::size_t cluster = 0; FRAGMENTS_COUNT != cluster; ++cluster)
+    {
+        const reference::Contig &contig = reference.contigList_.at(usableContigs.at(contigIndex(random)));
+        const int64_t position = std::uniform_int_distribution<int64_t>(0, contig.size() - READ_LENGTH * 2)(random);
+        std::string bases(contig.begin() + position, contig.begin() + position + READ_LENGTH * 2);
+
+        if (std::bernoulli_distribution(INDEL_CARRIER_RATE)(random))
+        {
+            const reference::ReferencePosition middle(contig.getIndex(), position + READ_LENGTH / 3);
+            const build::gapRealigner::Gaps::const_iterator indel = std::lower_bound(
+                knownIndels.begin(), knownIndels.end(), build::gapRealigner::Gap(middle, 0),
+                [](const build::gapRealigner::Gap &left, const build::gapRealigner::Gap &right){return left.pos_ < right.pos_;});
+            if (knownIndels.end() != indel && middle + READ_LENGTH / 3 > indel->pos_)
+            {
+                const std::size_t offset = indel->pos_.getPosition() - position;
+                if (indel->isInsertion())
+                {
+                    bases.insert(offset, generateGenome(-indel->length_, random));
+                }
+                else
+                {
+                    bases.erase(offset, indel->length_);
+                }
+            }
+        }
+        bases.resize(READ_LENGTH);
+        addErrors(bases, ERROR_RATE, random);
+
+        io::FragmentHeader header;
+        header.flags_ = io::FragmentHeader::Flags(
+            false, false, false, false, false, false, false, false, false, false, false);
+        header.fStrandPosition_ = reference::ReferencePosition(contig.getIndex(), position);
+        header.fStrandOriginalPosition_ = header.fStrandPosition_;
+        header.rStrandPosition_ = header.fStrandPosition_ + READ_LENGTH;
+        header.mateFStrandPosition_ = header.fStrandPosition_;
+        header.readLength_ = READ_LENGTH;
+        header.cigarLength_ = cigar.size();
+        header.alignmentScore_ = 60;
+        header.templateAlignmentScore_ = 60;
+        header.mapQ_ = 60;
+        header.tile_ = 0;
+        header.barcode_ = 0;
+        header.clusterId_ = cluster;
+        header.editDistance_ = std::inner_product(
+            bases.begin(), bases.end(), contig.begin() + position, 0, std::plus<unsigned>(), std::not_equal_to<char>());
+
+        offsets.push_back(data.size());
+        data.insert(data.end(), header.bytesBegin(), header.bytesEnd());
+        BOOST_FOREACH(const char base, bases)
+        {
+            data.push_back((30 << 2) | oligo::getValue(base));
+        }
+        data.insert(data.end(),
+                    reinterpret_cast<const char *>(&cigar.front()), reinterpret_cast<const char *>(&cigar.back() + 1));
+        data.push_back(0);
+    }
+
+    dataBuffer.resize(data.size());
+    std::copy(data.begin(), data.end(), dataBuffer.begin());
+    BOOST_FOREACH(const uint64_t offset, offsets)
+    {
+        const io::FragmentAccessor &fragment = dataBuffer.getFragment(offset);
+        index.push_back(build::PackedFragmentBuffer::Index(
+            fragment.fStrandPosition_, offset, offset, fragment.cigarBegin(), fragment.cigarEnd(), fragment.isReverse()));
+    }
+}
+
+static reference::ReferencePosition getContigEndPos(const Reference &reference, const reference::ReferencePosition pos)
+{
+    return reference::ReferencePosition(pos.getContigId(), reference.contigList_.at(pos.getContigId()).size());
+}
+
+static void benchmarkFindGaps(
+    Suite &suite,
+    const Reference &reference,
+    const build::gapRealigner::RealignerGaps &realignerGaps,
+    const std::vector<build::PackedFragmentBuffer::Index> &index)
+{
+    build::gapRealigner::Gaps foundGaps;
+    foundGaps.reserve(FOUND_GAPS_MAX);
+    suite.run("findGaps/" + reference.name_, index.size(), 0,
+              [&](const uint64_t iterations)
+              {
+                  uint64_t found = 0;
+                  for (uint64_t i = 0; iterations != i; ++i)
+                  {
+                      BOOST_FOREACH(const build::PackedFragmentBuffer::Index &idx, index)
+                      {
+                          const reference::ReferencePosition binStartPos(idx.pos_.getContigId(), 0);
+                          const build::gapRealigner::GapsRange gaps = realignerGaps.findGaps(
+                              0, binStartPos, idx.pos_, idx.pos_ + READ_LENGTH, GAPS_PER_LOCUS_MAX, foundGaps);
+                          found += gaps.size();
+                      }
+                  }
+                  return found / iterations;
+              });
+}
+
+/**
+ * \brief Single thread equivalent of ParallelGapRealigner::realign minus the pair updates
+ */
+static void benchmarkRealignGaps(
+    Suite &suite,
+    const Reference &reference,
+    const build::gapRealigner::RealignerGaps &realignerGaps,
+    build::PackedFragmentBuffer &dataBuffer,
+    const std::vector<build::PackedFragmentBuffer::Index> &index)
+{
+    const std::string name = "realignGaps/" + reference.name_;
+    if (!suite.enabled(name))
+    {
+        return;
+    }
+
+    flowcell::BarcodeMetadataList barcodeMetadataList(1);
+    barcodeMetadataList.at(0).setIndex(0);
+    barcodeMetadataList.at(0).setReferenceIndex(0);
+    reference::ContigLists contigLists;
+    contigLists.push_back(reference.contigList_);
+
+    build::GapRealigner realigner(
+        false, false, GAPS_PER_FRAGMENT_MAX, MISMATCH_COST, GAP_OPEN_COST, 0, barcodeMetadataList);
+    alignment::Cigar realignedCigars;
+    realignedCigars.reserve(index.size() * alignment::Cigar::getMaxLength(GAPS_PER_FRAGMENT_MAX));
+    std::vector<build::PackedFragmentBuffer::Index> realignedIndex;
+    realignedIndex.reserve(index.size());
+
+    suite.run(name, index.size(), index.size() * READ_LENGTH,
+              [&](const uint64_t iterations)
+              {
+                  uint64_t ret = 0;
+                  for (uint64_t i = 0; iterations != i; ++i)
+                  {
+                      realignedCigars.clear();
+                      realignedIndex = index;
+                      BOOST_FOREACH(build::PackedFragmentBuffer::Index &idx, realignedIndex)
+                      {
+                          const reference::ReferencePosition binStartPos(idx.pos_.getContigId(), 0);
+                          reference::ReferencePosition newRStrandPosition;
+                          unsigned short newEditDistance = 0;
+                          if (realigner.realign(
+                              realignerGaps, binStartPos, getContigEndPos(reference, idx.pos_),
+                              dataBuffer.getFragment(idx), idx, newRStrandPosition, newEditDistance,
+                              dataBuffer, realignedCigars, contigLists))
+                          {
+                              ret += idx.pos_.getPosition() + newEditDistance + std::distance(idx.cigarBegin_, idx.cigarEnd_);
+                          }
+                      }
+                  }
+                  return ret / iterations;
+              });
+}
+
+void runRealignmentBenchmarks(Suite &suite, const Reference &reference, const unsigned seed)
+{
+    Random random(seed);
+    const build::gapRealigner::Gaps knownIndels = generateKnownIndels(reference.contigList_, random);
+    build::gapRealigner::RealignerGaps realignerGaps;
+    realignerGaps.reserve(knownIndels.size());
+    BOOST_FOREACH(const build::gapRealigner::Gap &gap, knownIndels)
+    {
+        realignerGaps.addGap(gap);
+    }
+    realignerGaps.finalizeGaps();
+    ISAAC_THREAD_CERR << "Generated " << realignerGaps.getGapsCount() << " known indels for " << reference.name_ << std::endl;
+
+    build::PackedFragmentBuffer dataBuffer;
+    std::vector<build::PackedFragmentBuffer::Index> index;
+    packFragments(reference, knownIndels, random, dataBuffer, index);
+
+    benchmarkFindGaps(suite, reference, realignerGaps, index);
+    benchmarkRealignGaps(suite, reference, realignerGaps, dataBuffer, index);
+}
+
+} // namespace benchmark
+} // namespace isaac
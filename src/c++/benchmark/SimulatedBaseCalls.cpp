@@ -0,0 +1,320 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file SimulatedBaseCalls.cpp
+ **
+ ** Storage of the simulated read pairs in the base calls formats isaac-align accepts.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include "bam/Bam.hh"
+#include "bgzf/BgzfCompressor.hh"
+#include "common/Debug.hh"
+#include "common/Exceptions.hh"
+#include "oligo/Nucleotides.hh"
+
+#include "SimulatedBaseCalls.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+namespace bfs = boost::filesystem;
+
+static const unsigned char BASE_QUALITY = 30;
+static const unsigned LANE = 1;
+// surface 1, swath 1 as RunInfoXml::getTiles numbers them
+static const unsigned FIRST_TILE = 1101;
+static const unsigned TILES_MAX = 99;
+
+static std::string getReadName(const std::size_t index, const SimulatedPair &pair)
+{
+    // alignments can be checked against the origin of the pair
+    return (boost::format("sim:%d:%d:%d:%d") % index % pair.contigId_ % pair.position_ % pair.templateLength_).str();
+}
+
+static void openForWriting(const bfs::path &path, std::ofstream &os)
+{
+    os.open(path.string().c_str(), std::ios_base::binary);
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open file for writing: " + path.string()));
+    }
+}
+
+static void closeWritten(const bfs::path &path, std::ofstream &os)
+{
+    os.close();
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to write file: " + path.string()));
+    }
+}
+
+void writeFastq(const std::vector<SimulatedPair> &pairs, const bfs::path &directory)
+{
+    bfs::create_directories(directory);
+    for (unsigned read = 0; 2 != read; ++read)
+    {
+        const bfs::path fastqPath = directory / (boost::format("lane%d_read%d.fastq") % LANE % (read + 1)).str();
+        ISAAC_THREAD_CERR << "Writing " << fastqPath << std::endl;
+        std::ofstream os;
+        openForWriting(fastqPath, os);
+        for (std::size_t index = 0; pairs.size() != index; ++index)
+        {
+            const std::string &bases = pairs[index].reads_[read];
+            os << '@' << getReadName(index, pairs[index]) << '/' << (read + 1) << '\n' << bases << "\n+\n" <<
+                std::string(bases.size(), char(BASE_QUALITY + 33)) << '\n';
+        }
+        closeWritten(fastqPath, os);
+    }
+}
+
+namespace
+{
+
+/**
+ * \brief Header with no reference sequences and read groups as expected by bam::serializeHeader
+ */
+struct UnalignedBamHeader
+{
+    struct ReadGroupType
+    {
+        std::string getValue() const {return std::string();}
+    };
+    struct RefSeqType
+    {
+        std::string name() const {return std::string();}
+        unsigned length() const {return 0;}
+        std::string bamSqAs() const {return std::string();}
+        std::string bamSqUr() const {return std::string();}
+        std::string bamM5() const {return std::string();}
+    };
+    typedef std::vector<RefSeqType> RefSeqsType;
+
+    std::vector<ReadGroupType> getReadGroups(const std::string &) const {return std::vector<ReadGroupType>();}
+    RefSeqsType getRefSequences() const {return RefSeqsType();}
+};
+
+/**
+ * \brief Unaligned mate as expected by bam::serializeAlignment
+ */
+class UnalignedBamRecord
+{
+    const std::string readName_;
+    const unsigned flag_;
+    std::vector<unsigned char> seq_;
+    const std::vector<unsigned char> qual_;
+    static const unsigned noCigar_ = 0;
+
+public:
+    UnalignedBamRecord(const std::string &readName, const std::string &bases, const unsigned read) :
+        readName_(readName),
+        // paired, unmapped, mate unmapped, first or second in template
+        flag_(0x1 | 0x4 | 0x8 | (read ? 0x80 : 0x40)),
+        seq_((bases.size() + 1) / 2, 0),
+        qual_(bases.size(), BASE_QUALITY)
+    {
+        static const unsigned char BAM_BASES[] = {1, 2, 4, 8};
+        for (std::size_t i = 0; bases.size() != i; ++i)
+        {
+            const unsigned value = oligo::getValue(bases[i]);
+            const unsigned char bamBase = oligo::INVALID_OLIGO == value ? 15 : BAM_BASES[value];
+            seq_[i / 2] |= (i % 2) ? bamBase : (bamBase << 4);
+        }
+    }
+
+    typedef std::pair<const unsigned *, const unsigned *> CigarBeginEnd;
+    typedef std::pair<std::vector<unsigned char>::const_iterator, std::vector<unsigned char>::const_iterator> SeqBeginEnd;
+    typedef SeqBeginEnd QualBeginEnd;
+
+    int refId() const {return -1;}
+    int pos() const {return -1;}
+    const char *readName() const {return readName_.c_str();}
+    unsigned observedLength() const {return 0;}
+    unsigned char mapq() const {return 0;}
+    CigarBeginEnd cigar() const {return CigarBeginEnd(&noCigar_, &noCigar_);}
+    unsigned flag() const {return flag_;}
+    int seqLen() const {return qual_.size();}
+    int nextRefId() const {return -1;}
+    int nextPos() const {return -1;}
+    int tlen() const {return 0;}
+    SeqBeginEnd seq() const {return SeqBeginEnd(seq_.begin(), seq_.end());}
+    QualBeginEnd qual() const {return QualBeginEnd(qual_.begin(), qual_.end());}
+
+    bam::iTag getFragmentSM() const {return bam::iTag();}
+    bam::iTag getFragmentAS() const {return bam::iTag();}
+    bam::zTag getFragmentRG() const {return bam::zTag();}
+    bam::iTag getFragmentNM() const {return bam::iTag();}
+    bam::zTag getFragmentBC() const {return bam::zTag();}
+    bam::zTag getFragmentOC() const {return bam::zTag();}
+    bam::iTag getFragmentOP() const {return bam::iTag();}
+    bam::iTag getFragmentZX() const {return bam::iTag();}
+    bam::iTag getFragmentZY() const {return bam::iTag();}
+    bam::zTag getFragmentSA() const {return bam::zTag();}
+};
+
+const unsigned UnalignedBamRecord::noCigar_;
+
+} // namespace
+
+void writeBam(const std::vector<SimulatedPair> &pairs, const bfs::path &bamPath)
+{
+    bfs::create_directories(bamPath.parent_path());
+    ISAAC_THREAD_CERR << "Writing " << bamPath << std::endl;
+    {
+        boost::iostreams::filtering_ostream bgzfStream;
+        bgzfStream.push(bgzf::BgzfCompressor(boost::iostreams::gzip::best_speed), 65535, 0);
+        bgzfStream.push(boost::iostreams::basic_file_sink<char>(bamPath.string(), std::ios_base::binary));
+        if (!bgzfStream)
+        {
+            BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open file for writing: " + bamPath.string()));
+        }
+        bam::serializeHeader(bgzfStream, std::vector<std::string>(1, "isaac-simulate-reads"), "Simulated read pairs",
+                             std::vector<std::string>(), "", UnalignedBamHeader());
+        for (std::size_t index = 0; pairs.size() != index; ++index)
+        {
+            const std::string readName = getReadName(index, pairs[index]);
+            for (unsigned read = 0; 2 != read; ++read)
+            {
+                UnalignedBamRecord record(readName, pairs[index].reads_[read], read);
+                bam::serializeAlignment(bgzfStream, record);
+            }
+        }
+        bgzfStream.strict_sync();
+    }
+
+    // the footer is a complete bgzf block on its own
+    std::ofstream os(bamPath.string().c_str(), std::ios_base::binary | std::ios_base::app);
+    bam::serializeBgzfFooter(os);
+    closeWritten(bamPath, os);
+}
+
+static void writeRunInfo(const bfs::path &runInfoPath, const unsigned readLength, const unsigned tiles)
+{
+    std::ofstream os;
+    openForWriting(runInfoPath, os);
+    os << "<?xml version=\"1.0\"?>\n"
+        "<RunInfo Version=\"2\">\n"
+        "  <Run Id=\"Simulated\" Number=\"1\">\n"
+        "    <Flowcell>SIMULATED</Flowcell>\n"
+        "    <Instrument>isaac-simulate-reads</Instrument>\n"
+        "    <Reads>\n"
+        "      <Read Number=\"1\" NumCycles=\"" << readLength << "\" IsIndexedRead=\"N\" />\n"
+        "      <Read Number=\"2\" NumCycles=\"" << readLength << "\" IsIndexedRead=\"N\" />\n"
+        "    </Reads>\n"
+        "    <FlowcellLayout LaneCount=\"" << LANE << "\" SurfaceCount=\"1\" SwathCount=\"1\" TileCount=\"" << tiles << "\" />\n"
+        "  </Run>\n"
+        "</RunInfo>\n";
+    closeWritten(runInfoPath, os);
+}
+
+/**
+ * \brief bcl, filter and locs files share the layout: 32 bit cluster count followed by per-cluster data
+ */
+static void writeTileFile(const bfs::path &path, const std::vector<char> &header, const std::vector<char> &data)
+{
+    std::ofstream os;
+    openForWriting(path, os);
+    os.write(&header.front(), header.size());
+    os.write(&data.front(), data.size());
+    closeWritten(path, os);
+}
+
+template <typename T>
+static std::vector<char> makeHeader(const std::vector<T> &fields)
+{
+    return std::vector<char>(reinterpret_cast<const char*>(&fields.front()),
+                             reinterpret_cast<const char*>(&fields.front() + fields.size()));
+}
+
+void writeBcl(
+    const std::vector<SimulatedPair> &pairs,
+    const unsigned clustersPerTile,
+    const bfs::path &runFolder)
+{
+    ISAAC_ASSERT_MSG(!pairs.empty(), "At least one pair is required");
+    const unsigned readLength = pairs.front().reads_[0].size();
+    const unsigned tiles = (pairs.size() + clustersPerTile - 1) / clustersPerTile;
+    if (TILES_MAX < tiles)
+    {
+        BOOST_THROW_EXCEPTION(common::InvalidOptionException(
+            (boost::format("\n   *** %d pairs require %d tiles of %d clusters. At most %d tiles are supported. "
+                "Increase --clusters-per-tile. ***\n") % pairs.size() % tiles % clustersPerTile % TILES_MAX).str()));
+    }
+
+    const bfs::path intensitiesPath = runFolder / "Data" / "Intensities";
+    const bfs::path laneBaseCallsPath = intensitiesPath / "BaseCalls" / (boost::format("L%03d") % LANE).str();
+    bfs::create_directories(intensitiesPath / (boost::format("L%03d") % LANE).str());
+    writeRunInfo(runFolder / "RunInfo.xml", readLength, tiles);
+
+    for (unsigned tileIndex = 0; tiles != tileIndex; ++tileIndex)
+    {
+        const unsigned tile = FIRST_TILE + tileIndex;
+        const std::size_t begin = std::size_t(tileIndex) * clustersPerTile;
+        const std::size_t end = std::min(pairs.size(), begin + clustersPerTile);
+        const uint32_t clusters = end - begin;
+        ISAAC_THREAD_CERR << "Writing tile " << tile << " of " << runFolder << std::endl;
+
+        std::vector<char> data(clusters);
+        for (unsigned cycle = 0; readLength * 2 != cycle; ++cycle)
+        {
+            for (std::size_t cluster = begin; end != cluster; ++cluster)
+            {
+                const unsigned value = oligo::getValue(pairs[cluster].reads_[cycle / readLength][cycle % readLength]);
+                // no-calls are stored as 0
+                data[cluster - begin] = oligo::INVALID_OLIGO == value ? 0 : char(BASE_QUALITY << 2 | value);
+            }
+            const bfs::path cycleFolder = laneBaseCallsPath / (boost::format("C%d.1") % (cycle + 1)).str();
+            bfs::create_directories(cycleFolder);
+            writeTileFile(cycleFolder / (boost::format("s_%d_%d.bcl") % LANE % tile).str(),
+                          makeHeader(std::vector<uint32_t>(1, clusters)), data);
+        }
+
+        // version 3 filter: zero, version, cluster count, one byte per cluster with pass filter in bit 0
+        std::fill(data.begin(), data.end(), 1);
+        std::vector<uint32_t> filterHeader(3, 0);
+        filterHeader[1] = 3;
+        filterHeader[2] = clusters;
+        writeTileFile(laneBaseCallsPath / (boost::format("s_%d_%04d.filter") % LANE % tile).str(),
+                      makeHeader(filterHeader), data);
+
+        // version 1 locs: version, 1.0f, cluster count, x and y floats per cluster on a square grid
+        std::vector<float> xy;
+        const unsigned side = std::ceil(std::sqrt(double(clusters)));
+        for (uint32_t cluster = 0; clusters != cluster; ++cluster)
+        {
+            xy.push_back(cluster % side);
+            xy.push_back(cluster / side);
+        }
+        std::vector<uint32_t> locsHeader(3, 1);
+        const float version = 1.0;
+        std::memcpy(&locsHeader[1], &version, sizeof(version));
+        locsHeader[2] = clusters;
+        writeTileFile(intensitiesPath / (boost::format("L%03d") % LANE).str() / (boost::format("s_%d_%04d.locs") % LANE % tile).str(),
+                      makeHeader(locsHeader), makeHeader(xy));
+    }
+}
+
+} // namespace benchmark
+} // namespace isaac
@@ -0,0 +1,56 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file SimulatedBaseCalls.hh
+ **
+ ** Storage of the simulated read pairs in the base calls formats isaac-align accepts.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BENCHMARK_SIMULATED_BASE_CALLS_HH
+#define iSAAC_BENCHMARK_SIMULATED_BASE_CALLS_HH
+
+#include <boost/filesystem.hpp>
+
+#include "Inputs.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+/**
+ * \brief Produces lane1_read1.fastq and lane1_read2.fastq in the directory. Base qualities are all Q30.
+ */
+void writeFastq(const std::vector<SimulatedPair> &pairs, const boost::filesystem::path &directory);
+
+/**
+ * \brief Produces bam file with unaligned pairs, mates stored next to each other.
+ */
+void writeBam(const std::vector<SimulatedPair> &pairs, const boost::filesystem::path &bamPath);
+
+/**
+ * \brief Produces RunInfo.xml and the Data/Intensities folder with the uncompressed bcl, filter and locs files of
+ *        lane 1. All clusters pass filter.
+ *
+ * \param clustersPerTile   clusters in each tile except for the last one that gets the remainder
+ */
+void writeBcl(
+    const std::vector<SimulatedPair> &pairs,
+    const unsigned clustersPerTile,
+    const boost::filesystem::path &runFolder);
+
+} // namespace benchmark
+} // namespace isaac
+
+#endif // #ifndef iSAAC_BENCHMARK_SIMULATED_BASE_CALLS_HH
@@ -0,0 +1,129 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file SimulatorOptions.cpp
+ **
+ ** Command line options for isaac-simulate-reads
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <boost/assign.hpp>
+#include <boost/foreach.hpp>
+
+#include "common/Exceptions.hh"
+
+#include "SimulatorOptions.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+namespace bpo = boost::program_options;
+namespace bfs = boost::filesystem;
+using common::InvalidOptionException;
+
+SimulatorOptions::SimulatorOptions():
+    baseCallsFormats_(boost::assign::list_of("fastq")("bam")("bcl")),
+    pairs_(1000000),
+    readLength_(150),
+    templateLengthMin_(300),
+    templateLengthMax_(500),
+    errorRate_(0.005),
+    indelRate_(0.002),
+    duplicateRate_(0.05),
+    clustersPerTile_(100000),
+    seed_(1)
+{
+    namedOptions_.add_options()
+        ("reference-fasta,r"      , bpo::value<bfs::path>(&referenceFastaPath_),
+            "Fasta file to sample the read pairs from.")
+        ("output-directory,o"     , bpo::value<bfs::path>(&outputDirectory_),
+            "Directory for the simulated base calls. Each format goes into its own subdirectory.")
+        ("base-calls-format,f"    , bpo::value<std::vector<std::string> >(&baseCallsFormats_)->multitoken(),
+            "Formats to produce the same read pairs in. Multiple entries allowed."
+            "\n  - bam             : Unaligned/Simulated.bam"
+            "\n  - bcl             : Bcl/RunInfo.xml with uncompressed bcl, filter and locs files for lane 1"
+            "\n  - fastq           : Fastq/lane1_read1.fastq and Fastq/lane1_read2.fastq")
+        ("pairs"                  , bpo::value<uint64_t>(&pairs_)->default_value(pairs_),
+            "Number of read pairs to simulate.")
+        ("read-length"            , bpo::value<unsigned>(&readLength_)->default_value(readLength_),
+            "Length of each read.")
+        ("template-length-min"    , bpo::value<unsigned>(&templateLengthMin_)->default_value(templateLengthMin_),
+            "Shortest template. Template lengths are uniformly distributed.")
+        ("template-length-max"    , bpo::value<unsigned>(&templateLengthMax_)->default_value(templateLengthMax_),
+            "Longest template.")
+        ("error-rate"             , bpo::value<double>(&errorRate_)->default_value(errorRate_),
+            "Probability of each base to be substituted.")
+        ("indel-rate"             , bpo::value<double>(&indelRate_)->default_value(indelRate_),
+            "Probability of each read to have a short insertion or deletion.")
+        ("duplicate-rate"         , bpo::value<double>(&duplicateRate_)->default_value(duplicateRate_),
+            "Probability of each pair to be a duplicate of a pair simulated before it.")
+        ("clusters-per-tile"      , bpo::value<unsigned>(&clustersPerTile_)->default_value(clustersPerTile_),
+            "Number of clusters in each bcl tile.")
+        ("seed"                   , bpo::value<unsigned>(&seed_)->default_value(seed_),
+            "Seed for the simulation. Same seed and parameters produce the same reads.")
+        ;
+}
+
+void SimulatorOptions::postProcess(bpo::variables_map &vm)
+{
+    if(vm.count("help") ||  vm.count("version"))
+    {
+        return;
+    }
+
+    const std::vector<std::string> requiredOptions = boost::assign::list_of("reference-fasta")("output-directory");
+    BOOST_FOREACH(const std::string &required, requiredOptions)
+    {
+        if(!vm.count(required))
+        {
+            BOOST_THROW_EXCEPTION(InvalidOptionException("\n   *** The '" + required + "' option is required ***\n"));
+        }
+    }
+
+    referenceFastaPath_ = bfs::absolute(referenceFastaPath_);
+    if (!bfs::exists(referenceFastaPath_))
+    {
+        BOOST_THROW_EXCEPTION(InvalidOptionException("\n   *** Fasta file does not exist: " + referenceFastaPath_.string() + " ***\n"));
+    }
+    outputDirectory_ = bfs::absolute(outputDirectory_);
+
+    BOOST_FOREACH(const std::string &format, baseCallsFormats_)
+    {
+        if ("bam" != format && "bcl" != format && "fastq" != format)
+        {
+            BOOST_THROW_EXCEPTION(InvalidOptionException("\n   *** --base-calls-format '" + format + "' unrecognized. ***\n"));
+        }
+    }
+
+    if (!readLength_ || templateLengthMin_ < readLength_ || templateLengthMax_ < templateLengthMin_)
+    {
+        BOOST_THROW_EXCEPTION(InvalidOptionException(
+            "\n   *** --template-length-min must be at least --read-length and not exceed --template-length-max ***\n"));
+    }
+
+    if (!clustersPerTile_)
+    {
+        BOOST_THROW_EXCEPTION(InvalidOptionException("\n   *** --clusters-per-tile must be at least 1 ***\n"));
+    }
+
+    if (errorRate_ < 0.0 || errorRate_ > 1.0 || indelRate_ < 0.0 || indelRate_ > 1.0 ||
+        duplicateRate_ < 0.0 || duplicateRate_ > 1.0)
+    {
+        BOOST_THROW_EXCEPTION(InvalidOptionException("\n   *** Rates must be within [0,1] ***\n"));
+    }
+}
+
+} // namespace benchmark
+} // namespace isaac
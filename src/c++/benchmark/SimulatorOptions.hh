@@ -0,0 +1,62 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file SimulatorOptions.hh
+ **
+ ** Command line options for isaac-simulate-reads
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BENCHMARK_SIMULATOR_OPTIONS_HH
+#define iSAAC_BENCHMARK_SIMULATOR_OPTIONS_HH
+
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "common/Program.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+class SimulatorOptions : public common::Options
+{
+public:
+    boost::filesystem::path referenceFastaPath_;
+    boost::filesystem::path outputDirectory_;
+    std::vector<std::string> baseCallsFormats_;
+    uint64_t pairs_;
+    unsigned readLength_;
+    unsigned templateLengthMin_;
+    unsigned templateLengthMax_;
+    double errorRate_;
+    double indelRate_;
+    double duplicateRate_;
+    unsigned clustersPerTile_;
+    unsigned seed_;
+
+public:
+    SimulatorOptions();
+
+private:
+    std::string usagePrefix() const {return "isaac-simulate-reads";}
+    void postProcess(boost::program_options::variables_map &vm);
+};
+
+} // namespace benchmark
+} // namespace isaac
+
+#endif // #ifndef iSAAC_BENCHMARK_SIMULATOR_OPTIONS_HH
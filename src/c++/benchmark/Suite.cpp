@@ -0,0 +1,76 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file Suite.cpp
+ **
+ ** Timing and reporting of the micro-benchmarks.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <boost/foreach.hpp>
+
+#include "config.h"
+#include "Suite.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+volatile uint64_t Suite::sink_ = 0;
+
+void Suite::addResult(
+    const std::string &name,
+    const std::size_t itemsPerOp,
+    const std::size_t bytesPerOp,
+    const uint64_t iterations,
+    std::vector<double> &batches,
+    const uint64_t checksum)
+{
+    std::nth_element(batches.begin(), batches.begin() + batches.size() / 2, batches.end());
+    const double seconds = batches.at(batches.size() / 2);
+
+    Result result;
+    result.name_ = name;
+    result.iterations_ = iterations;
+    result.nsPerOp_ = seconds * 1e9 / iterations;
+    result.itemsPerSecond_ = iterations * itemsPerOp / seconds;
+    result.bytesPerSecond_ = iterations * bytesPerOp / seconds;
+    result.checksum_ = checksum;
+    results_.push_back(result);
+
+    ISAAC_THREAD_CERR << name << ": " << result.nsPerOp_ << " ns/op, " << result.itemsPerSecond_ << " items/s" << std::endl;
+}
+
+void Suite::serialize(std::ostream &os, const unsigned seed, const std::vector<std::string> &references) const
+{
+    os << "{\n  \"version\": \"" << iSAAC_VERSION_FULL << "\",\n  \"seed\": " << seed << ",\n  \"references\": [";
+    BOOST_FOREACH(const std::string &reference, references)
+    {
+        os << (&reference == &references.front() ? "" : ", ") << "\"" << reference << "\"";
+    }
+    os << "],\n  \"benchmarks\": [";
+    BOOST_FOREACH(const Result &result, results_)
+    {
+        os << (&result == &results_.front() ? "" : ",") << "\n    {\"name\": \"" << result.name_ << "\", " <<
+            "\"iterations\": " << result.iterations_ << ", " <<
+            "\"nsPerOp\": " << result.nsPerOp_ << ", " <<
+            "\"itemsPerSecond\": " << result.itemsPerSecond_ << ", " <<
+            "\"bytesPerSecond\": " << result.bytesPerSecond_ << ", " <<
+            "\"checksum\": " << result.checksum_ << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+} // namespace benchmark
+} // namespace isaac
@@ -0,0 +1,131 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file Suite.hh
+ **
+ ** Timing and reporting of the micro-benchmarks.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BENCHMARK_SUITE_HH
+#define iSAAC_BENCHMARK_SUITE_HH
+
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "common/Debug.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+struct Result
+{
+    std::string name_;
+    uint64_t iterations_;
+    double nsPerOp_;
+    double itemsPerSecond_;
+    double bytesPerSecond_;
+    // value returned by a single operation. Same inputs must produce the same checksum between commits
+    uint64_t checksum_;
+};
+
+/**
+ * \brief Runs each benchmark in batches long enough to be timed reliably and keeps the median batch.
+ */
+class Suite: boost::noncopyable
+{
+    const double minSeconds_;
+    const unsigned repeats_;
+    const std::string filter_;
+    std::vector<Result> results_;
+
+public:
+    /**
+     * \param minSeconds    minimum duration of a timed batch
+     * \param repeats       number of timed batches. The median one is reported
+     * \param filter        only the benchmarks which names contain it are run
+     */
+    Suite(const double minSeconds, const unsigned repeats, const std::string &filter) :
+        minSeconds_(minSeconds), repeats_(repeats), filter_(filter)
+    {
+    }
+
+    bool enabled(const std::string &name) const {return std::string::npos != name.find(filter_);}
+
+    /**
+     * \param itemsPerOp    number of reads, seeds or records one operation processes
+     * \param bytesPerOp    number of input bytes one operation processes. 0 if throughput in bytes is meaningless
+     * \param op            functor uint64_t(uint64_t iterations) performing the operation iterations times.
+     *                      The value it returns goes into the checksum and keeps the work from being optimized away
+     */
+    template <typename OpT>
+    void run(const std::string &name, const std::size_t itemsPerOp, const std::size_t bytesPerOp, OpT op)
+    {
+        if (!enabled(name))
+        {
+            return;
+        }
+
+        ISAAC_THREAD_CERR << "Running " << name << std::endl;
+        // also warms up the caches and the lazily allocated buffers
+        const uint64_t checksum = op(1);
+        uint64_t iterations = 1;
+        // grow the batch until it takes long enough for the clock resolution not to matter
+        for (double seconds = time(op, iterations); minSeconds_ > seconds; seconds = time(op, iterations))
+        {
+            iterations = seconds ? std::max(iterations + 1, uint64_t(iterations * minSeconds_ * 1.2 / seconds)) : iterations * 10;
+        }
+
+        std::vector<double> batches;
+        for (unsigned repeat = 0; repeats_ != repeat; ++repeat)
+        {
+            batches.push_back(time(op, iterations));
+        }
+        addResult(name, itemsPerOp, bytesPerOp, iterations, batches, checksum);
+    }
+
+    const std::vector<Result> &getResults() const {return results_;}
+
+    void serialize(std::ostream &os, const unsigned seed, const std::vector<std::string> &references) const;
+
+private:
+    template <typename OpT>
+    static double time(OpT &op, const uint64_t iterations)
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        sink_ = op(iterations);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static volatile uint64_t sink_;
+
+    void addResult(
+        const std::string &name,
+        const std::size_t itemsPerOp,
+        const std::size_t bytesPerOp,
+        const uint64_t iterations,
+        std::vector<double> &batches,
+        const uint64_t checksum);
+};
+
+} // namespace benchmark
+} // namespace isaac
+
+#endif // #ifndef iSAAC_BENCHMARK_SUITE_HH
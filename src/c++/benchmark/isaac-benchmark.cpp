@@ -0,0 +1,76 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file isaac-benchmark.cpp
+ **
+ ** \brief Micro-benchmarks of the alignment and output hot paths on fixed inputs
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <fstream>
+
+#include <boost/foreach.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include "common/Debug.hh"
+#include "common/Exceptions.hh"
+
+#include "BenchmarkOptions.hh"
+#include "Benchmarks.hh"
+
+void runBenchmarks(const isaac::benchmark::BenchmarkOptions &options)
+{
+    using namespace isaac::benchmark;
+
+    boost::ptr_vector<Reference> references;
+    {
+        Random random(options.seed_);
+        references.push_back(new Reference("synthetic", std::vector<std::string>(1, generateGenome(options.genomeLength_, random))));
+    }
+    BOOST_FOREACH(const boost::filesystem::path &fastaPath, options.referenceFastaPaths_)
+    {
+        references.push_back(new Reference(fastaPath.stem().string(), loadFasta(fastaPath)));
+    }
+
+    Suite suite(options.minSeconds_, options.repeats_, options.filter_);
+    std::vector<std::string> referenceNames;
+    BOOST_FOREACH(const Reference &reference, references)
+    {
+        referenceNames.push_back(reference.name_);
+        runAlignmentBenchmarks(suite, reference, options.seed_);
+        runRealignmentBenchmarks(suite, reference, options.seed_);
+    }
+    runOutputBenchmarks(suite, references.front(), options.seed_);
+
+    if (options.outputFilePath_.empty())
+    {
+        suite.serialize(std::cout, options.seed_, referenceNames);
+        return;
+    }
+
+    std::ofstream os(options.outputFilePath_.string().c_str());
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(isaac::common::IoException(errno, "Failed to open file for writing: " + options.outputFilePath_.string()));
+    }
+    suite.serialize(os, options.seed_, referenceNames);
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(isaac::common::IoException(errno, "Failed to write file: " + options.outputFilePath_.string()));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    isaac::common::run(runBenchmarks, argc, argv);
+}
@@ -0,0 +1,60 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file isaac-simulate-reads.cpp
+ **
+ ** \brief Paired-end base calls sampled from a fasta file, for end-to-end throughput measurements of isaac-align
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <boost/foreach.hpp>
+
+#include "common/Debug.hh"
+
+#include "Inputs.hh"
+#include "SimulatedBaseCalls.hh"
+#include "SimulatorOptions.hh"
+
+void simulateReads(const isaac::benchmark::SimulatorOptions &options)
+{
+    using namespace isaac::benchmark;
+
+    const Reference reference(options.referenceFastaPath_.stem().string(), loadFasta(options.referenceFastaPath_));
+    Random random(options.seed_);
+    ISAAC_THREAD_CERR << "Simulating " << options.pairs_ << " pairs from " << options.referenceFastaPath_ << std::endl;
+    const std::vector<SimulatedPair> pairs = simulatePairs(
+        reference.contigList_, options.pairs_, options.readLength_,
+        options.templateLengthMin_, options.templateLengthMax_,
+        options.errorRate_, options.indelRate_, options.duplicateRate_, random);
+
+    BOOST_FOREACH(const std::string &format, options.baseCallsFormats_)
+    {
+        if ("fastq" == format)
+        {
+            writeFastq(pairs, options.outputDirectory_ / "Fastq");
+        }
+        else if ("bam" == format)
+        {
+            writeBam(pairs, options.outputDirectory_ / "Unaligned" / "Simulated.bam");
+        }
+        else
+        {
+            writeBcl(pairs, options.clustersPerTile_, options.outputDirectory_ / "Bcl");
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    isaac::common::run(simulateReads, argc, argv);
+}
@@ -0,0 +1,246 @@
+#!/bin/bash
+################################################################################
+##
+## Isaac Genome Alignment Software
+## Copyright (c) 2010-2017 Illumina, Inc.
+## All rights reserved.
+##
+## This software is provided under the terms and conditions of the
+## GNU GENERAL PUBLIC LICENSE Version 3
+##
+## You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+## along with this program. If not, see
+## <https://github.com/illumina/licenses/>.
+##
+################################################################################
+##
+## file throughput.sh
+##
+## End-to-end isaac-align throughput on simulated data. Every combination of
+## base calls format, thread count, memory control and bin size is aligned and
+## the wall-clock time, per-stage time and peak RSS of each run go into
+## results.tsv. machine.tsv describes the hardware so that results from
+## different machines can be told apart.
+##
+## author Roman Petrovski
+##
+################################################################################
+
+#set -x
+set -o pipefail
+shopt -s compat31 2>/dev/null
+
+isaacBin=''
+simulator=''
+referenceFastas=()
+outputDirectory=./Throughput
+pairs=1000000
+readLength=150
+errorRate=0.005
+indelRate=0.002
+duplicateRate=0.05
+seed=1
+formats='fastq bam bcl'
+jobsList=''
+memoryControls='off'
+binSizes='0'
+alignArgs=''
+help=''
+
+# stages recorded by AlignWorkflow in Stats/WorkflowMetrics.json
+STAGES='AlignDone AlignmentReportsDone BamDone'
+
+throughput_usage()
+{
+    cat <<EOF
+**Usage**
+
+$(basename $0) [options]
+
+**Options**
+
+    --isaac-bin arg                         Directory with installed isaac-align and isaac-sort-reference
+    --simulator arg                         Path to isaac-simulate-reads
+    -r [ --reference-fasta ] arg            Fasta file to simulate the reads from. Multiple entries allowed
+    -o [ --output-directory ] arg ($outputDirectory) Location of the references, simulated data, runs and results
+    --pairs arg ($pairs)                  Number of read pairs to simulate
+    --read-length arg ($readLength)                 Length of each read
+    --error-rate arg ($errorRate)               Probability of each base to be substituted
+    --indel-rate arg ($indelRate)               Probability of each read to have a short indel
+    --duplicate-rate arg ($duplicateRate)            Probability of each pair to duplicate an earlier one
+    --seed arg ($seed)                         Seed for the simulation
+    --base-calls-format arg ($formats) Space-separated list of input formats to align
+    -j [ --jobs ] arg (1 2 4 ... $(nproc))         Space-separated list of thread counts
+    --memory-control arg ($memoryControls)              Space-separated list of isaac-align --memory-control values
+    --target-bin-size arg ($binSizes)               Space-separated list of isaac-align --target-bin-size values
+    --isaac-align-args arg                  Additional arguments for every isaac-align run
+    -h [ --help ]                           Print this message
+EOF
+}
+
+while (( ${#@} )); do
+    param=$1
+    shift
+    if [[ $param == "--isaac-bin" ]]; then
+        isaacBin=$1
+        shift
+    elif [[ $param == "--simulator" ]]; then
+        simulator=$1
+        shift
+    elif [[ $param == "--reference-fasta" || $param == "-r" ]]; then
+        referenceFastas+=("$(cd $(dirname "$1") && pwd)/$(basename "$1")")
+        shift
+    elif [[ $param == "--output-directory" || $param == "-o" ]]; then
+        outputDirectory=$1
+        shift
+    elif [[ $param == "--pairs" ]]; then
+        pairs=$1
+        shift
+    elif [[ $param == "--read-length" ]]; then
+        readLength=$1
+        shift
+    elif [[ $param == "--error-rate" ]]; then
+        errorRate=$1
+        shift
+    elif [[ $param == "--indel-rate" ]]; then
+        indelRate=$1
+        shift
+    elif [[ $param == "--duplicate-rate" ]]; then
+        duplicateRate=$1
+        shift
+    elif [[ $param == "--seed" ]]; then
+        seed=$1
+        shift
+    elif [[ $param == "--base-calls-format" ]]; then
+        formats=$1
+        shift
+    elif [[ $param == "--jobs" || $param == "-j" ]]; then
+        jobsList=$1
+        shift
+    elif [[ $param == "--memory-control" ]]; then
+        memoryControls=$1
+        shift
+    elif [[ $param == "--target-bin-size" ]]; then
+        binSizes=$1
+        shift
+    elif [[ $param == "--isaac-align-args" ]]; then
+        alignArgs=$1
+        shift
+    elif [[ $param == "--help" || $param == "-h" ]]; then
+        help=yes
+    else
+        echo "ERROR: unrecognized argument: $param" >&2
+        exit 2
+    fi
+done
+
+[[ -n "$help" ]] && throughput_usage && exit 1
+
+[[ "" == "$isaacBin" || "" == "$simulator" || 0 == ${#referenceFastas[@]} ]] && throughput_usage && \
+    echo "ERROR: --isaac-bin, --simulator and --reference-fasta arguments are mandatory" >&2 && exit 2
+
+for program in "$isaacBin/isaac-align" "$isaacBin/isaac-sort-reference" "$simulator"; do
+    [[ ! -x "$program" ]] && echo "ERROR: Executable not found: '$program'" >&2 && exit 2
+done
+
+if [[ -z "$jobsList" ]]; then
+    cores=$(nproc)
+    for (( jobs = 1; jobs < cores; jobs *= 2 )); do
+        jobsList="$jobsList $jobs"
+    done
+    jobsList="$jobsList $cores"
+fi
+
+outputDirectory=$(mkdir -p "$outputDirectory" && (cd "$outputDirectory" && pwd)) || exit 2
+
+# Everything that makes the numbers from one machine differ from another
+{
+    echo -e "host\t$(hostname)"
+    echo -e "cpu\t$(grep -m1 '^model name' /proc/cpuinfo | cut -d: -f2- | sed 's/^ *//')"
+    echo -e "cores\t$(nproc)"
+    echo -e "memoryKb\t$(grep '^MemTotal' /proc/meminfo | awk '{print $2}')"
+    echo -e "kernel\t$(uname -r)"
+    echo -e "isaac\t$("$isaacBin/isaac-align" --version 2>&1 | tail -1)"
+    echo -e "simulation\tpairs=$pairs readLength=$readLength errorRate=$errorRate indelRate=$indelRate duplicateRate=$duplicateRate seed=$seed"
+} > "$outputDirectory/machine.tsv"
+
+# prints '<stage seconds>\t<process peak rss in bytes by the end of the stage>' for each of STAGES
+stage_metrics()
+{
+    local metricsJson=$1
+    for stage in $STAGES; do
+        awk -v stage="\"$stage\"," '
+            $1 == "\"name\":" {current = $2}
+            current == stage && $1 == "\"seconds\":" {seconds = $2}
+            current == stage && $1 == "\"processPeakRssBytes\":" {rss = $2}
+            END {gsub(",", "", seconds); gsub(",", "", rss); printf "\t%s\t%s", (seconds == "" ? "NA" : seconds), (rss == "" ? "NA" : rss)}' \
+            "$metricsJson" 2>/dev/null || echo -ne "\tNA\tNA"
+    done
+}
+
+results="$outputDirectory/results.tsv"
+if [[ ! -e "$results" ]]; then
+    echo -ne "reference\tformat\tjobs\tmemoryControl\ttargetBinSize\tpairs\tstatus\twallSeconds\tpairsPerSecond" > "$results"
+    for stage in $STAGES; do
+        echo -ne "\t${stage}Seconds\t${stage}ProcessPeakRssBytes" >> "$results"
+    done
+    echo >> "$results"
+fi
+
+for fasta in "${referenceFastas[@]}"; do
+    referenceName=$(basename "${fasta%.*}")
+    referenceDirectory="$outputDirectory/References/$referenceName"
+    simulatedDirectory="$outputDirectory/Simulated/$referenceName"
+
+    if [[ ! -e "$referenceDirectory/sorted-reference.xml" ]]; then
+        "$isaacBin/isaac-sort-reference" -q -g "$fasta" -o "$referenceDirectory" || exit 2
+    fi
+
+    # simulation parameters are part of the marker so that changing them regenerates the data
+    simulatedMarker="$simulatedDirectory/.simulated-$pairs-$readLength-$errorRate-$indelRate-$duplicateRate-$seed-${formats// /-}"
+    if [[ ! -e "$simulatedMarker" ]]; then
+        rm -rf "$simulatedDirectory"
+        "$simulator" -r "$fasta" -o "$simulatedDirectory" -f $formats --pairs $pairs --read-length $readLength \
+            --template-length-min $(( readLength * 2 )) --template-length-max $(( readLength * 3 )) \
+            --error-rate $errorRate --indel-rate $indelRate --duplicate-rate $duplicateRate --seed $seed || exit 2
+        touch "$simulatedMarker"
+    fi
+
+    for format in $formats; do
+        case $format in
+            fastq) baseCalls="$simulatedDirectory/Fastq";;
+            bam) baseCalls="$simulatedDirectory/Unaligned/Simulated.bam";;
+            bcl) baseCalls="$simulatedDirectory/Bcl/RunInfo.xml";;
+            *) echo "ERROR: unsupported base calls format: $format" >&2; exit 2;;
+        esac
+
+        for jobs in $jobsList; do
+            for memoryControl in $memoryControls; do
+                for binSize in $binSizes; do
+                    run="$outputDirectory/Runs/$referenceName-$format-j$jobs-$memoryControl-b$binSize"
+                    rm -rf "$run" && mkdir -p "$run" || exit 2
+                    echo "Aligning $run" >&2
+
+                    start=$(date +%s.%N)
+                    "$isaacBin/isaac-align" -r "$referenceDirectory/sorted-reference.xml" \
+                        -b "$baseCalls" -f $format -j $jobs \
+                        --memory-control $memoryControl --target-bin-size $binSize \
+                        -o "$run/Aligned" -t "$run/Temp" $alignArgs > "$run/isaac-align.log" 2>&1
+                    status=$?
+                    end=$(date +%s.%N)
+
+                    wallSeconds=$(awk -v start=$start -v end=$end 'BEGIN {printf "%.2f", end - start}')
+                    [[ 0 == $status ]] && statusText=ok || statusText=failed
+                    echo -ne "$referenceName\t$format\t$jobs\t$memoryControl\t$binSize\t$pairs\t$statusText" >> "$results"
+                    echo -ne "\t$wallSeconds\t$(awk -v pairs=$pairs -v seconds=$wallSeconds 'BEGIN {printf "%.1f", seconds ? pairs / seconds : 0}')" >> "$results"
+                    echo "$(stage_metrics "$run/Aligned/Stats/WorkflowMetrics.json")" >> "$results"
+
+                    # keep the logs and metrics, drop the data
+                    rm -rf "$run/Temp" "$run/Aligned/Projects"
+                done
+            done
+        done
+    done
+done
+
+echo "Results stored in $results" >&2
@@ -151,7 +151,13 @@ void align(const isaac::options::AlignOptions &options)
         options.fullBclQScoreTable,
         options.optionalFeatures,
         options.pessimisticMapQ,
-        options.detectTemplateBlockSize);
+        options.detectTemplateBlockSize,
+        options.seedMatchCacheSize,
+        options.adaptiveSeeds,
+        options.minimizerWindow,
+        options.sharedReferenceHash,
+        options.traceSlowestClusters,
+        options.progressInterval);
 
     const boost::filesystem::path stateFilePath = options.tempDirectory / "AlignerState.txt";
 
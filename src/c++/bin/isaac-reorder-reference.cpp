@@ -27,7 +27,8 @@ void reoderReference(const isaac::options::ReorderReferenceOptions &options)
         options.sortedReferenceMetadata_,
         options.newXmlPath_,
         options.newDataDirectory_,
-        options.newOrder_);
+        options.newOrder_,
+        options.contigImage_);
 
     workflow.run();
 }
@@ -50,6 +50,8 @@ public:
         const ReferenceHash& referenceHash,
         const unsigned seedBaseQualityMin);
 
+    unsigned getSeedBaseQualityMin() const {return seedBaseQualityMin_;}
+
     template <bool reverse>
     std::size_t findSeedMatches(
         const Cluster& cluster,
@@ -80,6 +82,7 @@ class ClusterHashMatchFinder : SeedHashMatchFinder<ReferenceHash>
     typedef typename BaseT::KmerT KmerT;
 public:
     using BaseT::NO_CONTIG_FILTER;
+    using BaseT::getSeedBaseQualityMin;
     static const unsigned SEED_LENGTH = ReferenceHash::SEED_LENGTH;
     BOOST_STATIC_ASSERT(seedsPerMatchMax >= SHORT_READ_SEEDS_MIN);
 
@@ -87,7 +90,8 @@ public:
         const ReferenceHash& referenceHash,
         const std::size_t candidateMatchesMax,
         const unsigned seedBaseQualityMin,
-        const unsigned seedRepeatsMax);
+        const unsigned seedRepeatsMax,
+        const bool adaptiveSeeds = false);
 
     struct SeedHits
     {
@@ -138,8 +142,15 @@ public:
 
 private:
     const std::size_t candidateMatchesMax_;
+    /**
+     * \brief when set, non-overlapping seeds are queried first and the ones shifted by half seed length
+     *        are only queried when the candidate support is ambiguous. Seeds having candidateMatchesMax_
+     *        or more hits are only used to promote the existing candidates.
+     */
+    const bool adaptiveSeeds_;
 
-    typedef common::StaticVector<SeedHits, (ISAAC_READ_LENGTH_MAX / SEED_LENGTH)> SeedsHits;
+    // adaptive seeding can query the non-overlapping and the shifted seeds for the same read
+    typedef common::StaticVector<SeedHits, (2 * ISAAC_READ_LENGTH_MAX / SEED_LENGTH)> SeedsHits;
 
     template<bool filterContigs, bool detectStructuralVariant>
     void buildMatchesIteratively(
@@ -152,12 +163,54 @@ private:
         ReferenceOffsetLists& fwMergeBuffers,
         ReferenceOffsetLists& rvMergeBuffers) const;
 
+    template <bool reverse>
+    unsigned promoteSeedHits(
+        const flowcell::ReadMetadata& readMetadata,
+        const unsigned seedOffset,
+        const typename ReferenceHash::MatchRange &matchPositions,
+        ReferenceOffsetLists& mergeBuffers) const;
+
+    bool lookupSeed(
+        const Cluster& cluster,
+        const unsigned seedOffset,
+        KmerT seedKmer,
+        const std::size_t seedRepeatThreshold,
+        SeedsHits& seedsHits) const;
+
     std::size_t collectSeedHits(
         const Cluster& cluster,
         const unsigned readIndex,
         const std::size_t seedRepeatThreshold,
         const unsigned endSeedOffset,
         SeedsHits& seedsHits) const;
+
+    std::size_t collectMinimizerSeedHits(
+        const Cluster& cluster,
+        const unsigned readIndex,
+        const std::size_t seedRepeatThreshold,
+        const unsigned endSeedOffset,
+        SeedsHits& seedsHits) const;
+
+    std::size_t collectSparseSeedHits(
+        const Cluster& cluster,
+        const unsigned readIndex,
+        const std::size_t seedRepeatThreshold,
+        const unsigned firstSeedOffset,
+        const unsigned endSeedOffset,
+        SeedsHits& seedsHits) const;
+
+    bool isAmbiguous(const MatchLists& matchLists, const unsigned seedsMin) const;
+
+    std::size_t findAdaptiveReadMatches(
+        const reference::ContigList &contigList,
+        const Cluster& cluster,
+        const flowcell::ReadMetadata& readMetadata,
+        const std::size_t seedRepeatThreshold,
+        const unsigned seedsMin,
+        SeedsHits& seedsHits,
+        MatchLists& matchLists,
+        ReferenceOffsetLists& fwMergeBuffers,
+        ReferenceOffsetLists& rvMergeBuffers) const;
 };
 
 } // namespace alignment
@@ -37,6 +37,7 @@
 #include "alignment/matchFinder/TileClusterInfo.hh"
 #include "alignment/matchSelector/MatchSelectorStats.hh"
 #include "alignment/matchSelector/SemialignedEndsClipper.hh"
+#include "alignment/matchSelector/SlowestClusters.hh"
 #include "alignment/matchSelector/OverlappingEndsClipper.hh"
 #include "alignment/matchSelector/TemplateDetector.hh"
 #include "common/Threads.hpp"
@@ -92,7 +93,9 @@ public:
         const TemplateBuilder::DodgyAlignmentScore dodgyAlignmentScore,
         const unsigned anomalousPairHandicap,
         const bool reserveBuffers,
-        const unsigned detectTemplateBlockSize);
+        const unsigned detectTemplateBlockSize,
+        const unsigned seedMatchCacheSize,
+        const unsigned slowestClustersMax);
 
     /**
      * \brief frees the major memory reservations to make it safe to use dynamic memory allocations again
@@ -105,6 +108,11 @@ public:
     }
 
     void dumpStats(const boost::filesystem::path &statsXmlPath);
+    /**
+     * \brief Writes the costliest clusters of the whole run along with the cycles each alignment phase took.
+     *        Does nothing unless slowestClustersMax was set.
+     */
+    void dumpSlowestClusters(const boost::filesystem::path &tsvPath) const;
     void reserveMemory(
         const flowcell::TileMetadataList &tileMetadataList);
 
@@ -148,6 +156,8 @@ private:
     std::vector<matchSelector::MatchSelectorStats> threadStats_;
 
     std::vector<Cluster> threadCluster_;
+    const unsigned slowestClustersMax_;
+    std::vector<matchSelector::SlowestClusters> threadSlowestClusters_;
     boost::ptr_vector<TemplateBuilder> threadTemplateBuilders_;
     std::vector<matchSelector::SemialignedEndsClipper> threadSemialignedEndsClippers_;
     std::vector<matchSelector::OverlappingEndsClipper> threadOverlappingEndsClippers_;
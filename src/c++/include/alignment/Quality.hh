@@ -20,6 +20,7 @@
 #ifndef iSAAC_ALIGNMENT_QUALITY_HH
 #define iSAAC_ALIGNMENT_QUALITY_HH
 
+#include <cmath>
 #include <limits>
 #include <vector>
 
@@ -75,6 +76,29 @@ inline unsigned char pickMapQFromMate(
 }
 
 
+/**
+ ** \brief Log probability in units of 2^-FIXED_LOG_PROBABILITY_FRACTION_BITS nats.
+ **
+ ** Per-base terms are rounded once when the lookup is built, so each base is off by at most 2^-33 nats
+ ** and a fragment of L bases by at most L * 2^-33 nats, which is below the ISAAC_LP_EQUALS tolerance for
+ ** any read shorter than 800 bases. Alignment scores computed from the converted value differ from the
+ ** floating-point sum only when -10*log10 of the probability ratio is that close to an integer.
+ ** Integer sums don't depend on the order of the terms, and any value below 2^21 nats in magnitude
+ ** converts to double exactly, so further additions of converted values stay exact as well.
+ **/
+typedef int64_t FixedLogProbability;
+static const unsigned FIXED_LOG_PROBABILITY_FRACTION_BITS = 32;
+
+inline FixedLogProbability toFixedLogProbability(const double logProbability)
+{
+    return FixedLogProbability(std::floor(std::ldexp(logProbability, FIXED_LOG_PROBABILITY_FRACTION_BITS) + 0.5));
+}
+
+inline double fromFixedLogProbability(const FixedLogProbability fixedLogProbability)
+{
+    return std::ldexp(double(fixedLogProbability), -int(FIXED_LOG_PROBABILITY_FRACTION_BITS));
+}
+
 inline unsigned computeAlignmentScore(
     const double restOfGenomeCorrection,
     const double alignmentProbability,
@@ -142,6 +166,36 @@ public:
         return logMismatchLookup[quality];
     }
 
+    /**
+     * \brief Fixed-point getLogMatch if match is true, getLogMismatch otherwise. Match and mismatch terms
+     *        are interleaved so that the choice does not need a branch
+     */
+    static FixedLogProbability getFixedLogProbability(const unsigned int quality, const bool match)
+    {
+        ISAAC_ASSERT_MSG(quality < logMatchLookup.size(),
+                         (boost::format("Incorrect quality %u ") % quality).str().c_str());
+        return fixedLogProbabilityLookup[quality * 2 + match];
+    }
+
+    /**
+     * \return unchecked fixed-point lookup for callers that validate qualities in bulk. Valid qualities are below
+     *         getQualityCount()
+     */
+    static const FixedLogProbability *getFixedLogProbabilityLookup()
+    {
+        return &fixedLogProbabilityLookup.front();
+    }
+
+    static unsigned getQualityCount()
+    {
+        return logMatchLookup.size();
+    }
+
+    static FixedLogProbability getFixedLogMatch(const unsigned int quality)
+    {
+        return getFixedLogProbability(quality, true);
+    }
+
     /**
      ** \brief Return the natural log of the probability of a base that mismatches the reference to be wrong.
      ** 
@@ -174,6 +228,8 @@ private:
     static const std::vector<double> logMatchLookup;
     /// lookup for log of probability of a mismatch for a given quality
     static const std::vector<double> logMismatchLookup;
+    /// fixed-point logMismatchLookup and logMatchLookup at even and odd positions
+    static const std::vector<FixedLogProbability> fixedLogProbabilityLookup;
 };
 
 void trimLowQualityEnds(Cluster &cluster, const unsigned baseQualityCutoff);
@@ -84,9 +84,21 @@ public:
         const AlignmentCfg &alignmentCfg,
         const DodgyAlignmentScore dodgyAlignmentScore,
         const unsigned anomalousPairHandicap,
-        const bool reserveBuffers);
+        const bool reserveBuffers,
+        const unsigned seedMatchCacheSize);
 
     const FragmentMetadataLists &getFragments() const {return candidates_;}
+    const templateBuilder::SeedMatchCache &getSeedMatchCache() const {return fragmentBuilder_.getSeedMatchCache();}
+    templateBuilder::CostTracer &getCostTracer() const {return fragmentBuilder_.getCostTracer();}
+    uint64_t getTemplatesBuilt() const {return templatesBuilt_;}
+    /// templates where all reads were aligned from unique candidates and paired properly
+    uint64_t getUniqueFastPathTemplates() const {return uniqueFastPathTemplates_;}
+    void resetCounters()
+    {
+        fragmentBuilder_.resetSeedMatchCacheCounters();
+        templatesBuilt_ = 0;
+        uniqueFastPathTemplates_ = 0;
+    }
 
     template <typename MatchFinderT>
     templateBuilder::AlignmentType buildTemplate(
@@ -170,6 +182,11 @@ private:
     /// Holds the information about the pairs rescued via rescueShadow or buildDisjoinedTemplate
     mutable templateBuilder::BestPairInfo bestRescuedPair_;
 
+    /// true when the last buildFragments aligned every read via FragmentBuilder unique match shortcut
+    bool uniqueFastPath_;
+    uint64_t templatesBuilt_;
+    uint64_t uniqueFastPathTemplates_;
+
     template <typename MatchFinderT>
     templateBuilder::AlignmentType buildTemplateFromSeeds(
         const reference::ContigList &contigList,
@@ -445,6 +462,7 @@ bool TemplateBuilder::searchForStructuralVariant(
     FragmentMetadataList &shadowList,
     Cigar &cigarBuffer) const
 {
+    templateBuilder::CostTracer::Scope costScope(getCostTracer(), templateBuilder::CostTracer::Split);
     const bool bestWasGapped = shadowList.front().gapCount;
     const FragmentMetadataList::iterator firstSplit = shadowList.end();
 
@@ -927,6 +945,7 @@ bool TemplateBuilder::rescueShadows(
     FragmentMetadataList& shadowList,
     templateBuilder::BestPairInfo &bestRescuedPair) const
 {
+    templateBuilder::CostTracer::Scope costScope(getCostTracer(), templateBuilder::CostTracer::ShadowRescue);
     const unsigned orphanIndex = orphan.getReadIndex();
 
     shadowList.clear();
@@ -1040,6 +1059,7 @@ templateBuilder::AlignmentType TemplateBuilder::buildFragments(
 {
     cigarBuffer_.clear();
     templateBuilder::AlignmentType ret = templateBuilder::Nm;
+    uniqueFastPath_ = true;
     for (const flowcell::ReadMetadata &readMetadata : readMetadataList)
     {
         candidates_[readMetadata.getIndex()].clear();
@@ -1051,6 +1071,7 @@ templateBuilder::AlignmentType TemplateBuilder::buildFragments(
                         matchFinder, cluster, withGaps,
                         candidates_[readMetadata.getIndex()]);
 
+        uniqueFastPath_ &= fragmentBuilder_.isUniqueFastPath();
         ret = combineAlignmentTypes(ret, readAlignmentType);
     }
 
@@ -1130,6 +1151,12 @@ templateBuilder::AlignmentType TemplateBuilder::buildTemplate(
         withGaps, matchFinder,
         bamTemplate);
 
+    ++templatesBuilt_;
+    if (res == templateBuilder::Normal && uniqueFastPath_ && (2 != readMetadataList.size() || bamTemplate.isProperPair()))
+    {
+        ++uniqueFastPathTemplates_;
+    }
+
     if (res == templateBuilder::Normal)
     {
         if (2 == readMetadataList.size() && rescueShadows_)
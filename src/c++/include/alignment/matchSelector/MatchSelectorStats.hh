@@ -47,7 +47,11 @@ public:
         const bool collectCycleStats,
         const flowcell::BarcodeMetadataList &barcodeMetadataList) :
             collectCycleStats_(collectCycleStats),
-            barcodeMetadataList_(barcodeMetadataList)
+            barcodeMetadataList_(barcodeMetadataList),
+            seedMatchCacheLookups_(0),
+            seedMatchCacheHits_(0),
+            templatesBuilt_(0),
+            uniqueFastPathTemplates_(0)
     {
         const unsigned tileStatsCount = maxReads_ * filterStates_;
         ISAAC_THREAD_CERR << "Allocating " << tileStatsCount << " tile stats." << std::endl;
@@ -68,9 +72,30 @@ public:
                       boost::bind(&TileStats::reset, _1));
         std::for_each(tileBarcodeStats_.begin(), tileBarcodeStats_.end(),
                       boost::bind(&TileBarcodeStats::reset, _1));
+        seedMatchCacheLookups_ = 0;
+        seedMatchCacheHits_ = 0;
+        templatesBuilt_ = 0;
+        uniqueFastPathTemplates_ = 0;
+    }
+
+    void recordSeedMatchCache(const uint64_t lookups, const uint64_t hits)
+    {
+        seedMatchCacheLookups_ += lookups;
+        seedMatchCacheHits_ += hits;
+    }
+
+    uint64_t getSeedMatchCacheLookups() const {return seedMatchCacheLookups_;}
+    uint64_t getSeedMatchCacheHits() const {return seedMatchCacheHits_;}
 
+    void recordUniqueFastPath(const uint64_t templatesBuilt, const uint64_t uniqueFastPathTemplates)
+    {
+        templatesBuilt_ += templatesBuilt;
+        uniqueFastPathTemplates_ += uniqueFastPathTemplates;
     }
 
+    uint64_t getTemplatesBuilt() const {return templatesBuilt_;}
+    uint64_t getUniqueFastPathTemplates() const {return uniqueFastPathTemplates_;}
+
     void recordTemplate(
         const flowcell::ReadMetadataList &readMetadatalist,
         const TemplateLengthStatistics &templateLengthStatistics,
@@ -121,6 +146,10 @@ public:
             tileBarcodeStats += right.tileBarcodeStats_.at(i);
             ++i;
         }
+        seedMatchCacheLookups_ += right.seedMatchCacheLookups_;
+        seedMatchCacheHits_ += right.seedMatchCacheHits_;
+        templatesBuilt_ += right.templatesBuilt_;
+        uniqueFastPathTemplates_ += right.uniqueFastPathTemplates_;
         return *this;
     }
 
@@ -137,6 +166,10 @@ public:
         ISAAC_ASSERT_MSG(that.tileBarcodeStats_.size() == tileBarcodeStats_.size(), "size must match");
         tileStats_ = that.tileStats_;
         tileBarcodeStats_ = that.tileBarcodeStats_;
+        seedMatchCacheLookups_ = that.seedMatchCacheLookups_;
+        seedMatchCacheHits_ = that.seedMatchCacheHits_;
+        templatesBuilt_ = that.templatesBuilt_;
+        uniqueFastPathTemplates_ = that.uniqueFastPathTemplates_;
         return *this;
     }
 
@@ -175,6 +208,16 @@ private:
      * \brief higher-level stats that we can afford to keep per tile-barcode
      */
     std::vector<TileBarcodeStats>  tileBarcodeStats_;
+    /**
+     * \brief number of reads looked up in the seed match cache and how many of them were found there
+     */
+    uint64_t seedMatchCacheLookups_;
+    uint64_t seedMatchCacheHits_;
+    /**
+     * \brief number of templates built and how many of them had all reads aligned from unique candidates
+     */
+    uint64_t templatesBuilt_;
+    uint64_t uniqueFastPathTemplates_;
 
     unsigned tileBarcodeIndex(
         const flowcell::ReadMetadata& read,
@@ -0,0 +1,121 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file SlowestClusters.hh
+ **
+ ** \brief Keeps the most expensive clusters seen by a thread along with their alignment outcome.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_ALIGNMENT_MATCH_SELECTOR_SLOWEST_CLUSTERS_HH
+#define iSAAC_ALIGNMENT_MATCH_SELECTOR_SLOWEST_CLUSTERS_HH
+
+#include <array>
+#include <ostream>
+#include <vector>
+
+#include "alignment/BamTemplate.hh"
+#include "alignment/matchSelector/TileBarcodeStats.hh"
+#include "alignment/templateBuilder/CostTracer.hh"
+#include "flowcell/TileMetadata.hh"
+
+namespace isaac
+{
+namespace alignment
+{
+namespace matchSelector
+{
+
+struct ClusterCost
+{
+    static const unsigned READS_MAX = 2;
+    // longer names get truncated. Storage is fixed to avoid allocations while aligning
+    static const unsigned NAME_LENGTH_MAX = 63;
+
+    struct ReadOutcome
+    {
+        bool aligned_;
+        unsigned char mapq_;
+        unsigned repeatCount_;
+        unsigned mismatchCount_;
+        unsigned gapCount_;
+        bool split_;
+        bool decoy_;
+        unsigned short adapterClipped_;
+    };
+
+    uint64_t total_;
+    templateBuilder::CostTracer::Costs costs_;
+    unsigned tileIndex_;
+    uint64_t clusterId_;
+    unsigned nameLength_;
+    std::array<char, NAME_LENGTH_MAX> name_;
+    TemplateAlignmentType result_;
+    bool properPair_;
+    unsigned readCount_;
+    std::array<ReadOutcome, READS_MAX> reads_;
+
+    ClusterCost(
+        const templateBuilder::CostTracer::Costs &costs,
+        const Cluster &cluster,
+        const BamTemplate &bamTemplate,
+        const TemplateAlignmentType result);
+
+    bool operator >(const ClusterCost &that) const {return total_ > that.total_;}
+};
+
+/**
+ ** \brief Bounded min-heap of ClusterCost. Storage is reserved upfront so that adding is safe while
+ **        dynamic memory allocations are blocked.
+ **/
+class SlowestClusters
+{
+public:
+    explicit SlowestClusters(const std::size_t clustersMax) : clustersMax_(clustersMax)
+    {
+        heap_.reserve(clustersMax_);
+    }
+
+    /// copies keep the storage reserved
+    SlowestClusters(const SlowestClusters &that) : clustersMax_(that.clustersMax_)
+    {
+        heap_.reserve(clustersMax_);
+        heap_ = that.heap_;
+    }
+
+    /// \return true if the cost exceeds the cheapest of the ones kept and is worth constructing ClusterCost for
+    bool qualifies(const uint64_t total) const
+    {
+        return clustersMax_ && (heap_.size() < clustersMax_ || heap_.front().total_ < total);
+    }
+
+    void add(const ClusterCost &cost);
+    void merge(const SlowestClusters &that);
+
+    /**
+     * \brief writes the clusters in the order of decreasing total cost
+     *
+     * \param tileMetadataList  to resolve tile indexes into flowcell, lane and tile
+     */
+    void write(std::ostream &os, const flowcell::TileMetadataList &tileMetadataList) const;
+
+private:
+    const std::size_t clustersMax_;
+    std::vector<ClusterCost> heap_;
+};
+
+} // namespace matchSelector
+} // namespace alignment
+} // namespace isaac
+
+#endif // #ifndef iSAAC_ALIGNMENT_MATCH_SELECTOR_SLOWEST_CLUSTERS_HH
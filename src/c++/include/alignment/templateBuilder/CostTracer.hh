@@ -0,0 +1,163 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file CostTracer.hh
+ **
+ ** \brief Attribution of the time spent aligning a single cluster to the alignment phases.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_ALIGNMENT_TEMPLATE_BUILDER_COST_TRACER_HH
+#define iSAAC_ALIGNMENT_TEMPLATE_BUILDER_COST_TRACER_HH
+
+#include <array>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <boost/noncopyable.hpp>
+
+namespace isaac
+{
+namespace alignment
+{
+namespace templateBuilder
+{
+
+/**
+ ** \brief Per-thread accumulator of the cpu cycles spent in each alignment phase of the current cluster.
+ **
+ ** Phases nest. The time is always charged to the innermost one, so smith-waterman performed during shadow
+ ** rescue counts as Gapped, not ShadowRescue. Whatever is not covered by any phase counts as Other.
+ ** Disabled tracer costs a single branch per phase boundary.
+ **/
+class CostTracer: boost::noncopyable
+{
+public:
+    enum Phase
+    {
+        Other,
+        MatchFinding,
+        Ungapped,
+        Gapped,
+        Split,
+        ShadowRescue,
+        PHASES_COUNT
+    };
+
+    typedef std::array<uint64_t, PHASES_COUNT> Costs;
+
+    CostTracer() : enabled_(false), current_(Other), last_(0)
+    {
+        costs_.fill(0);
+    }
+
+    void enable() {enabled_ = true;}
+    bool isEnabled() const {return enabled_;}
+
+    /// Discards the costs of the previous cluster and starts charging Other
+    void start()
+    {
+        if (enabled_)
+        {
+            costs_.fill(0);
+            current_ = Other;
+            last_ = now();
+        }
+    }
+
+    /// Charges the time since the last phase boundary to the current phase
+    void stop()
+    {
+        if (enabled_)
+        {
+            charge();
+        }
+    }
+
+    const Costs &getCosts() const {return costs_;}
+
+    /**
+     * \brief Charges current phase and makes phase the current one
+     *
+     * \return phase to be restored by the matching leave
+     */
+    Phase enter(const Phase phase)
+    {
+        if (!enabled_)
+        {
+            return phase;
+        }
+        charge();
+        const Phase ret = current_;
+        current_ = phase;
+        return ret;
+    }
+
+    void leave(const Phase previous)
+    {
+        if (enabled_)
+        {
+            charge();
+            current_ = previous;
+        }
+    }
+
+    /// Keeps the phase current for the lifetime of the scope
+    class Scope: boost::noncopyable
+    {
+        CostTracer &tracer_;
+        const Phase previous_;
+    public:
+        Scope(CostTracer &tracer, const Phase phase) : tracer_(tracer), previous_(tracer.enter(phase)) {}
+        ~Scope() {tracer_.leave(previous_);}
+    };
+
+    static const char *getPhaseName(const Phase phase)
+    {
+        static const char *names[PHASES_COUNT] = {"Other", "MatchFinding", "Ungapped", "Gapped", "Split", "ShadowRescue"};
+        return names[phase];
+    }
+
+private:
+    bool enabled_;
+    Phase current_;
+    uint64_t last_;
+    Costs costs_;
+
+    void charge()
+    {
+        const uint64_t time = now();
+        costs_[current_] += time - last_;
+        last_ = time;
+    }
+
+    /// cpu cycles where the time stamp counter is available, nanoseconds elsewhere
+    static uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+};
+
+} // namespace templateBuilder
+} // namespace alignment
+} // namespace isaac
+
+#endif // #ifndef iSAAC_ALIGNMENT_TEMPLATE_BUILDER_COST_TRACER_HH
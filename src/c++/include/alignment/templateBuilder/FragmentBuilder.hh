@@ -22,6 +22,7 @@
 
 #include <atomic>
 
+#include "alignment/templateBuilder/CostTracer.hh"
 #include "alignment/templateBuilder/GappedAligner.hh"
 #include "alignment/templateBuilder/UngappedAligner.hh"
 #include "alignment/templateBuilder/SplitReadAligner.hh"
@@ -33,6 +34,7 @@
 #include "alignment/Match.hh"
 #include "alignment/RestOfGenomeCorrection.hh"
 #include "alignment/templateBuilder/FragmentSequencingAdapterClipper.hh"
+#include "alignment/templateBuilder/SeedMatchCache.hh"
 #include "reference/Contig.hh"
 #include "flowcell/ReadMetadata.hh"
 
@@ -81,7 +83,8 @@ public:
         const bool splitAlignments,
         const AlignmentCfg &alignmentCfg,
         Cigar &cigarBuffer,
-        const bool reserveBuffers);
+        const bool reserveBuffers,
+        const unsigned seedMatchCacheSize);
 
     ~FragmentBuilder()
     {
@@ -136,12 +139,24 @@ public:
         FragmentCallbackT callback) const;
 
 
+    /**
+     * \return true if the last buildBest call aligned the read directly from a single unique candidate
+     */
+    bool isUniqueFastPath() const {return uniqueFastPath_;}
+
+    const SeedMatchCache &getSeedMatchCache() const {return seedMatchCache_;}
+    void resetSeedMatchCacheCounters() const {seedMatchCache_.resetCounters();}
+
+    /// Shared with the owning TemplateBuilder so that shadow rescue and split read phases go into the same trace
+    CostTracer &getCostTracer() const {return costTracer_;}
+
     bool realignBadUngappedAlignments(
         const reference::ContigList &contigList,
         const flowcell::ReadMetadata &readMetadata,
         templateBuilder::FragmentSequencingAdapterClipper &adapterClipper,
         FragmentMetadataList &fragments) const
     {
+        CostTracer::Scope costScope(costTracer_, CostTracer::Gapped);
         return gappedAligner_.realignBadUngappedAlignments(
             gappedMismatchesMax_, smitWatermanGapsMax_, contigList, readMetadata, fragments, adapterClipper, cigarBuffer_);
     }
@@ -175,6 +190,10 @@ private:
     mutable ReferenceOffsetLists fwMergeBuffers_;
     mutable ReferenceOffsetLists rvMergeBuffers_;
     mutable MatchLists matchLists_;
+    /// candidate matches of recently seen reads. Allows duplicate reads to skip reference hash lookups
+    mutable SeedMatchCache seedMatchCache_;
+    mutable bool uniqueFastPath_;
+    mutable CostTracer costTracer_;
     struct BestMatch
     {
         BestMatch (const Match &match, const unsigned mismatches):
@@ -219,6 +238,15 @@ private:
         const unsigned uncheckedSeeds,
         FragmentMetadataList &fragments) const;
 
+    AlignmentType alignUniqueMatch(
+        const reference::ContigList &contigList,
+        const flowcell::ReadMetadata &readMetadata,
+        templateBuilder::FragmentSequencingAdapterClipper &adapterClipper,
+        const Cluster &cluster,
+        const bool withGaps,
+        const MatchLists &matchLists,
+        FragmentMetadataList &fragments) const;
+
     AlignmentType findBestMatches(
         const reference::ContigList &contigList,
         const flowcell::ReadMetadata &readMetadata,
@@ -297,12 +325,35 @@ AlignmentType FragmentBuilder::buildBest(
     ISAAC_ASSERT_MSG(cluster.getNonEmptyReadsCount() > readMetadata.getIndex(), "cluster geometry must match");
 
     fragments.clear();
+    uniqueFastPath_ = false;
     ISAAC_ASSERT_MSG(!matchLists_.empty(), "empty matches lists");
-    const std::size_t uncheckedSeeds = matchFinder.findReadMatches(
-        contigList, cluster, readMetadata, seedRepeatThreshold, matchLists_, fwMergeBuffers_, rvMergeBuffers_);
+    std::size_t uncheckedSeeds = 0;
+    {
+        CostTracer::Scope costScope(costTracer_, CostTracer::MatchFinding);
+        if (seedMatchCache_.isEnabled())
+        {
+            const SeedMatchCache::Key key = seedMatchCache_.makeKey(matchFinder, contigList, cluster, readMetadata, seedRepeatThreshold);
+            if (!seedMatchCache_.lookup(key, matchLists_, uncheckedSeeds))
+            {
+                uncheckedSeeds = matchFinder.findReadMatches(
+                    contigList, cluster, readMetadata, seedRepeatThreshold, matchLists_, fwMergeBuffers_, rvMergeBuffers_);
+                seedMatchCache_.store(key, matchLists_, uncheckedSeeds);
+            }
+        }
+        else
+        {
+            uncheckedSeeds = matchFinder.findReadMatches(
+                contigList, cluster, readMetadata, seedRepeatThreshold, matchLists_, fwMergeBuffers_, rvMergeBuffers_);
+        }
+    }
 
-    const AlignmentType ret = findBestAlignments(
-        contigList, readMetadata, adapterClipper, cluster, withGaps, matchLists_, uncheckedSeeds, fragments);
+    AlignmentType ret = Nm;
+    {
+        // only the alignment of the matches found is charged to the ungapped phase
+        CostTracer::Scope costScope(costTracer_, CostTracer::Ungapped);
+        ret = findBestAlignments(
+            contigList, readMetadata, adapterClipper, cluster, withGaps, matchLists_, uncheckedSeeds, fragments);
+    }
     if (Nm == ret && uncheckedSeeds)
     {
         return Rm;
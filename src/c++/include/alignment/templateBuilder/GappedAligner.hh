@@ -41,6 +41,11 @@ public:
         const unsigned smithWatermanGapSizeMax,
         const AlignmentCfg &alignmentCfg);
 
+    /**
+     * \brief ungapped alignments with fewer mismatches than this are never offered to smith-waterman
+     */
+    unsigned getRealignMismatchesMin() const {return bandedSmithWaterman16_.mismatchesMin_;}
+
     bool realignBadUngappedAlignments(
         const unsigned gappedMismatchesMax,
         const unsigned smitWatermanGapsMax,
@@ -0,0 +1,142 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file SeedMatchCache.hh
+ **
+ ** \brief Per-thread cache of the candidate matches produced by the match finder for a read.
+ **
+ ** Duplicate reads (PCR and optical) produce exactly the same seeds and therefore exactly the same
+ ** candidate matches. The cache is direct-mapped, fixed size and allocated upfront so that it can be
+ ** used while dynamic memory allocations are blocked.
+ **/
+
+#ifndef iSAAC_ALIGNMENT_TEMPLATE_BUILDER_SEED_MATCH_CACHE_HH
+#define iSAAC_ALIGNMENT_TEMPLATE_BUILDER_SEED_MATCH_CACHE_HH
+
+#include <boost/noncopyable.hpp>
+
+#include "alignment/Cluster.hh"
+#include "alignment/Match.hh"
+#include "flowcell/ReadMetadata.hh"
+#include "oligo/Nucleotides.hh"
+#include "reference/Contig.hh"
+
+namespace isaac
+{
+namespace alignment
+{
+namespace templateBuilder
+{
+
+class SeedMatchCache: boost::noncopyable
+{
+public:
+    /// reads producing more candidates than this are not worth caching as they are likely to be repeats
+    static const unsigned MATCHES_PER_ENTRY_MAX = 32;
+
+    /**
+     * \brief Identifies the read in terms of everything that determines the outcome of seed matching.
+     *        Bases that fail seed base quality threshold are masked the same way the match finder does it,
+     *        so duplicates with slightly different base qualities still map onto the same key.
+     */
+    struct Key
+    {
+        uint64_t hash_;
+        uint64_t check_;
+        const void *matchFinder_;
+        const reference::ContigList *contigList_;
+        uint64_t tile_;
+        unsigned readIndex_;
+        std::size_t seedRepeatThreshold_;
+
+        bool operator ==(const Key &that) const
+        {
+            return hash_ == that.hash_ && check_ == that.check_ &&
+                matchFinder_ == that.matchFinder_ && contigList_ == that.contigList_ &&
+                tile_ == that.tile_ && readIndex_ == that.readIndex_ &&
+                seedRepeatThreshold_ == that.seedRepeatThreshold_;
+        }
+    };
+
+    /**
+     * \param entriesCount   number of cache entries. 0 disables the cache
+     * \param matchListsCount number of lists in MatchLists supplied to the match finder (maxSeedsPerMatch + 1)
+     */
+    SeedMatchCache(const unsigned entriesCount, const unsigned matchListsCount);
+
+    bool isEnabled() const {return !entries_.empty();}
+
+    template <typename MatchFinderT>
+    Key makeKey(
+        const MatchFinderT &matchFinder,
+        const reference::ContigList &contigList,
+        const Cluster &cluster,
+        const flowcell::ReadMetadata &readMetadata,
+        const std::size_t seedRepeatThreshold) const
+    {
+        static const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325UL;
+        static const uint64_t FNV_PRIME = 0x100000001b3UL;
+        const unsigned char seedBaseQualityMin = matchFinder.getSeedBaseQualityMin();
+
+        Key ret = {FNV_OFFSET_BASIS, readMetadata.getLength(), &matchFinder, &contigList,
+            cluster.getTile(), readMetadata.getIndex(), seedRepeatThreshold};
+        const BclClusters::const_iterator bclBegin = cluster.getBclData(readMetadata.getIndex());
+        for (BclClusters::const_iterator it = bclBegin; bclBegin + readMetadata.getLength() != it; ++it)
+        {
+            const unsigned char base = oligo::getQuality(*it) < seedBaseQualityMin ?
+                oligo::INVALID_OLIGO : static_cast<unsigned char>(*it & oligo::BCL_BASE_MASK);
+            ret.hash_ = (ret.hash_ ^ base) * FNV_PRIME;
+            ret.check_ = (ret.check_ << 3 | ret.check_ >> 61) + base + 1;
+        }
+        return ret;
+    }
+
+    /**
+     * \brief Fills matchLists and uncheckedSeeds from the cache if key is present
+     * \return true on cache hit
+     */
+    bool lookup(const Key &key, MatchLists &matchLists, std::size_t &uncheckedSeeds) const;
+
+    /**
+     * \brief Stores the match finder results unless they don't fit the entry
+     */
+    void store(const Key &key, const MatchLists &matchLists, const std::size_t uncheckedSeeds);
+
+    uint64_t getLookups() const {return lookups_;}
+    uint64_t getHits() const {return hits_;}
+    void resetCounters() {lookups_ = 0; hits_ = 0;}
+
+private:
+    struct Entry
+    {
+        Entry() : valid_(false), uncheckedSeeds_(0) {}
+        bool valid_;
+        Key key_;
+        std::size_t uncheckedSeeds_;
+    };
+
+    const unsigned matchListsCount_;
+    std::vector<Entry> entries_;
+    // [entry][matchList]
+    std::vector<unsigned> listSizes_;
+    // [entry][MATCHES_PER_ENTRY_MAX]
+    std::vector<Match> matches_;
+
+    mutable uint64_t lookups_;
+    mutable uint64_t hits_;
+};
+
+} // namespace templateBuilder
+} // namespace alignment
+} // namespace isaac
+
+#endif // #ifndef iSAAC_ALIGNMENT_TEMPLATE_BUILDER_SEED_MATCH_CACHE_HH
@@ -30,6 +30,7 @@
 #include "alignment/SequencingAdapter.hh"
 #include "alignment/TemplateLengthStatistics.hh"
 #include "alignment/templateBuilder/GappedAligner.hh"
+#include "alignment/templateBuilder/ShadowKmerIndex.hh"
 #include "alignment/templateBuilder/UngappedAligner.hh"
 
 namespace isaac
@@ -96,8 +97,6 @@ public:
     const Cigar &getCigarBuffer() const {return cigarBuffer_;}
 private:
 
-    /// Length of the k-mers used to rescue shadows and misaligned reads
-    static const unsigned shadowKmerCount_ = (1 << (2 * SHADOW_KMER_LENGTH));
     const unsigned gappedMismatchesMax_;
     const unsigned smitWatermanGapsMax_;
     const bool noSmithWaterman_;
@@ -109,17 +108,13 @@ private:
      ** \brief Cached storage for the position of the k-mers in the shadow
      **
      ** Note that this is a really fast and cheap but imperfect to rescue
-     ** shadows or mis-aligned reads. The index used to access elements in the
-     ** vector is made from a k-mer of length shadowKmerLength_ (the vector has
-     ** 4 ^ shadowKmerLength_ positions). The values in the table at position i
-     ** is the first position in the read where the k-mer was found (-1 if not
-     ** found). Repeats are recorded only once in the table. This allows to
-     ** identify extremely quickly if a k-mer in the reference belongs to the
-     ** read. The shadowKmerLength_ should stay small enough to ensure that the
-     ** table stays in the L1 cache.
+     ** shadows or mis-aligned reads. The index maps a k-mer of length
+     ** SHADOW_KMER_LENGTH to the first position in the read where the k-mer
+     ** was found (-1 if not found). Repeats are recorded only once in the
+     ** table. This allows to identify extremely quickly if a k-mer in the
+     ** reference belongs to the read.
      **/
-//    std::vector<short> shadowKmerPositions_;
-    common::StaticVector<short, shadowKmerCount_> shadowKmerPositions_;
+    ShadowKmerIndex<SHADOW_KMER_LENGTH> shadowKmerPositions_;
     /// Hash all the k-mers of length shadowKmerLength_ into shadowKmerPositions_
     unsigned hashShadowKmers(const std::vector<char> &sequence);
     /**
@@ -0,0 +1,141 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file ShadowKmerIndex.hh
+ **
+ ** \brief Small open addressing table of the shadow k-mer positions.
+ **
+ ** Each slot is tagged with the epoch in which it was written. Starting a new shadow only increments the
+ ** epoch, so the table never needs clearing between shadows. The table is sized for the longest supported
+ ** read and stays within L1 cache, unlike the direct 4^k table.
+ **/
+
+#ifndef iSAAC_ALIGNMENT_TEMPLATE_BUILDER_SHADOW_KMER_INDEX_HH
+#define iSAAC_ALIGNMENT_TEMPLATE_BUILDER_SHADOW_KMER_INDEX_HH
+
+#include <stdint.h>
+
+#include <boost/array.hpp>
+#include <boost/static_assert.hpp>
+
+#include "common/Debug.hh"
+
+namespace isaac
+{
+namespace alignment
+{
+namespace templateBuilder
+{
+
+template <unsigned KMER_LENGTH>
+class ShadowKmerIndex
+{
+    static constexpr unsigned ceilLog2(const unsigned value, const unsigned bits = 0)
+    {
+        return (1U << bits) >= value ? bits : ceilLog2(value, bits + 1);
+    }
+
+    // keep load factor under 1/2
+    static const unsigned SLOT_BITS = ceilLog2(2 * ISAAC_READ_LENGTH_MAX);
+    static const unsigned SLOTS = 1U << SLOT_BITS;
+    BOOST_STATIC_ASSERT_MSG(16 >= KMER_LENGTH * 2, "k-mer must fit into the 16 bit slot tag");
+
+public:
+    static const short NOT_FOUND = -1;
+
+    ShadowKmerIndex() : epoch_(1), size_(0)
+    {
+    }
+
+    /**
+     * \brief Forget all stored k-mers
+     */
+    void reset()
+    {
+        if (!++epoch_)
+        {
+            // epoch wrapped. Slots tagged with the old epochs would look current, so clear once per 64K shadows.
+            slots_.fill(Slot());
+            epoch_ = 1;
+        }
+        size_ = 0;
+    }
+
+    /**
+     * \brief Stores position unless kmer is already present
+     * \return true if kmer was not present
+     */
+    bool insert(const unsigned kmer, const short position)
+    {
+        ISAAC_ASSERT_MSG(SLOTS / 2 > size_, "Too many k-mers for shadow k-mer index:" << size_);
+        for (unsigned slot = hash(kmer);; slot = (slot + 1) & (SLOTS - 1))
+        {
+            Slot &s = slots_[slot];
+            if (epoch_ != s.epoch_)
+            {
+                s.epoch_ = epoch_;
+                s.kmer_ = kmer;
+                s.position_ = position;
+                ++size_;
+                return true;
+            }
+            if (kmer == s.kmer_)
+            {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * \return position of the first occurrence of kmer or NOT_FOUND
+     */
+    short find(const unsigned kmer) const
+    {
+        for (unsigned slot = hash(kmer);; slot = (slot + 1) & (SLOTS - 1))
+        {
+            const Slot &s = slots_[slot];
+            if (epoch_ != s.epoch_)
+            {
+                return NOT_FOUND;
+            }
+            if (kmer == s.kmer_)
+            {
+                return s.position_;
+            }
+        }
+    }
+
+private:
+    struct Slot
+    {
+        Slot() : epoch_(0), kmer_(0), position_(NOT_FOUND) {}
+        uint16_t epoch_;
+        uint16_t kmer_;
+        short position_;
+    };
+
+    uint16_t epoch_;
+    unsigned size_;
+    boost::array<Slot, SLOTS> slots_;
+
+    static unsigned hash(const unsigned kmer)
+    {
+        // Fibonacci hashing spreads the neighbor k-mers produced by the rolling scan
+        return (kmer * 2654435769U) >> (32 - SLOT_BITS);
+    }
+};
+
+} // namespace templateBuilder
+} // namespace alignment
+} // namespace isaac
+
+#endif // #ifndef iSAAC_ALIGNMENT_TEMPLATE_BUILDER_SHADOW_KMER_INDEX_HH
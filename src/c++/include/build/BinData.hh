@@ -28,8 +28,10 @@
 
 #include "demultiplexing/BarcodePathMap.hh"
 #include "alignment/BinMetadata.hh"
+#include "build/DuplicateFragmentIndexFiltering.hh"
 #include "build/FragmentAccessorBamAdapter.hh"
 #include "build/FragmentIndex.hh"
+#include "build/IndelLoader.hh"
 #include "build/PackedFragmentBuffer.hh"
 #include "build/gapRealigner/RealignerGaps.hh"
 #include "io/FileBufCache.hh"
@@ -66,7 +68,7 @@ public:
         const flowcell::BarcodeMetadataList &barcodeMetadataList,
         const build::GapRealignerMode realignGaps,
         const unsigned realignMapqMin,
-        const gapRealigner::Gaps &knownIndels,
+        const KnownIndels &knownIndels,
         const alignment::BinMetadata &bin,
         const unsigned binStatsIndex,
         const flowcell::TileMetadataList &tileMetadataList,
@@ -78,7 +80,9 @@ public:
         const IncludeTags includeTags,
         const bool pessimisticMapQ,
         const unsigned splitGapLength,
-        const unsigned expectedCoverage) :
+        const unsigned expectedCoverage,
+        const bool keepDuplicates,
+        const bool markDuplicates) :
             bin_(bin),
             binStatsIndex_(binStatsIndex),
             barcodeBamMapping_(barcodeBamMapping),
@@ -103,6 +107,11 @@ public:
         seIdx_.reserve(bin_.getSeIdxElements());
         rIdx_.reserve(bin_.getRIdxElements());
         fIdx_.reserve(bin_.getFIdxElements());
+        if (DuplicateRankingBuffers::isRankingNeeded(keepDuplicates, markDuplicates))
+        {
+            rsDuplicateRanking_.reserve(bin_.getRIdxElements());
+            fDuplicateRanking_.reserve(bin_.getFIdxElements());
+        }
         if (REALIGN_NONE != realignGaps_)
         {
             reserveGaps(bin_, knownIndels_, barcodeMetadataList);
@@ -146,12 +155,18 @@ public:
 
     void finalize();
 
-    static uint64_t getMemoryRequirements(const alignment::BinMetadata& bin)
+    static uint64_t getMemoryRequirements(
+        const alignment::BinMetadata& bin,
+        const bool keepDuplicates,
+        const bool markDuplicates)
     {
         return PackedFragmentBuffer::getMemoryRequirements(bin) +
             bin.getSeIdxElements() * sizeof(SeFragmentIndex) +
             bin.getRIdxElements() * sizeof(RStrandOrShadowFragmentIndex) +
             bin.getFIdxElements() * sizeof(FStrandFragmentIndex) +
+            (DuplicateRankingBuffers::isRankingNeeded(keepDuplicates, markDuplicates) ?
+                DuplicateRankingBuffers::getMemoryRequirements(bin.getRIdxElements()) +
+                DuplicateRankingBuffers::getMemoryRequirements(bin.getFIdxElements()) : 0) +
             bin.getTotalElements() * sizeof(PackedFragmentBuffer::Index);
     }
 
@@ -160,6 +175,8 @@ public:
         SeIdx().swap(seIdx_);
         RIdx().swap(rIdx_);
         FIdx().swap(fIdx_);
+        rsDuplicateRanking_.unreserve();
+        fDuplicateRanking_.unreserve();
     }
 
     unsigned getBinIndex() const
@@ -181,10 +198,12 @@ public:
     SeIdx seIdx_;
     RIdx rIdx_;
     FIdx fIdx_;
+    DuplicateRankingBuffers rsDuplicateRanking_;
+    DuplicateRankingBuffers fDuplicateRanking_;
     PackedFragmentBuffer data_;
     const GapRealignerMode realignGaps_;
     const unsigned realignMapqMin_;
-    const gapRealigner::Gaps &knownIndels_;
+    const KnownIndels &knownIndels_;
     alignment::Cigar additionalCigars_;
 
     SplitInfoList splitInfoList_;
@@ -195,7 +214,7 @@ public:
 private:
     void reserveGaps(
         const alignment::BinMetadata& bin,
-        const gapRealigner::Gaps &knownIndels,
+        const KnownIndels &knownIndels,
         const flowcell::BarcodeMetadataList &barcodeMetadataList);
 
     unsigned getGapGroupIndex(const unsigned barcode) const;
@@ -25,6 +25,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/foreach.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread.hpp>
 
 #include "alignment/BinMetadata.hh"
 #include "build/BamSerializer.hh"
@@ -46,7 +47,40 @@ namespace build
 
 class BinSorter
 {
+    /// work that is done in phases of independent units, followed by a single-threaded completion
+    struct PhasedWork
+    {
+        virtual ~PhasedWork(){}
+        virtual std::size_t getPhaseCount() const = 0;
+        virtual std::size_t getUnitCount(const std::size_t phase) const = 0;
+        virtual void processUnit(const std::size_t phase, const std::size_t unit) = 0;
+        virtual void complete(BinData &binData, BuildStats &buildStats) = 0;
+    };
+
+    class NotAFilterWork;
+    template <bool singleLibrarySamples>
+    class PairEndDuplicateWork;
+
 public:
+    /**
+     * \brief State of duplicate resolution for one bin, shared by the threads that join it.
+     *        Protected by the lock passed to threadResolveDuplicates.
+     */
+    class DuplicateResolution : boost::noncopyable
+    {
+        friend class BinSorter;
+        // owned by the thread that started the resolution
+        PhasedWork *work_;
+        std::size_t phase_;
+        std::size_t nextUnit_;
+        std::size_t unitsInProgress_;
+        bool completing_;
+        bool complete_;
+        boost::condition_variable stateChanged_;
+    public:
+        DuplicateResolution() : work_(0), phase_(0), nextUnit_(0), unitsInProgress_(0), completing_(false), complete_(false){}
+    };
+
     BinSorter(
         const bool singleLibrarySamples,
         const bool keepDuplicates,
@@ -68,6 +102,18 @@ public:
         BinData &binData,
         BuildStats &buildStats);
 
+    /**
+     * \brief Same as resolveDuplicates, but any number of threads can call it for the same resolution.
+     *        Each returns once the duplicates of the bin are resolved.
+     *
+     * \param lock   held on entry and on return. Released while the thread does its share of work
+     */
+    void threadResolveDuplicates(
+        boost::unique_lock<boost::mutex> &lock,
+        BinData &binData,
+        DuplicateResolution &resolution,
+        BuildStats &buildStats);
+
     std::size_t serialize(
         BinData &binData,
         boost::ptr_vector<boost::iostreams::filtering_ostream> &bgzfStreams,
@@ -81,6 +127,19 @@ private:
     BamSerializer bamSerializer_;
 
     typedef boost::iterator_range<const unsigned char *> AnchorRange;
+
+    /// calls f with the duplicate resolution work for the bin. The work does not allocate dynamic memory
+    template <typename F>
+    void withDuplicateWork(BinData &binData, F f) const;
+    void shareDuplicateWork(
+        boost::unique_lock<boost::mutex> &lock,
+        BinData &binData,
+        DuplicateResolution &resolution,
+        BuildStats &buildStats);
+    /// waits for the other threads to leave the work
+    static void waitForDuplicateUnits(
+        boost::unique_lock<boost::mutex> &lock,
+        DuplicateResolution &resolution);
 };
 
 
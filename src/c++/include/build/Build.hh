@@ -31,6 +31,7 @@
 #include "build/BinSorter.hh"
 #include "build/BuildStats.hh"
 #include "build/BuildContigMap.hh"
+#include "build/IndelLoader.hh"
 #include "common/Threads.hpp"
 #include "flowcell/BarcodeMetadata.hh"
 #include "flowcell/Layout.hh"
@@ -107,7 +108,7 @@ class Build
     boost::ptr_vector<boost::ptr_vector<boost::iostreams::filtering_ostream> > threadBgzfStreams_;
     boost::ptr_vector<boost::ptr_vector<bam::BamIndexPart> > threadBamIndexParts_;
 
-    const build::gapRealigner::Gaps knownIndels_;
+    const KnownIndels knownIndels_;
     ParallelGapRealigner gapRealigner_;
     BinSorter binSorter_;
 
@@ -20,14 +20,124 @@
 #ifndef iSAAC_BUILD_FRAGMENT_INDEX_FILTERING_HH
 #define iSAAC_BUILD_FRAGMENT_INDEX_FILTERING_HH
 
+#include <limits>
+#include <vector>
+
+#include "common/Numa.hh"
 #include "demultiplexing/BarcodePathMap.hh"
 #include "build/FragmentIndex.hh"
+#include "build/PackedFragmentBuffer.hh"
 
 namespace isaac
 {
 namespace build
 {
 
+/**
+ * \brief Fixed-width copy of everything the duplicate filters look at, so that sorting and grouping
+ *        don't need to go back to the fragment buffer
+ */
+struct DuplicateKey
+{
+    uint64_t position_;
+    uint64_t mateAnchor_;
+    // mate info in the upper half, library in the lower one
+    uint64_t mateInfoLibrary_;
+    // inverted so that higher ranks come first
+    uint64_t inverseRank_;
+    uint64_t tileCluster_;
+    // offset of the fragment index in the range being filtered. Keeps the order of identical keys stable
+    uint64_t index_;
+
+    bool operator <(const DuplicateKey &that) const
+    {
+        if (position_ != that.position_) {return position_ < that.position_;}
+        if (mateAnchor_ != that.mateAnchor_) {return mateAnchor_ < that.mateAnchor_;}
+        if (mateInfoLibrary_ != that.mateInfoLibrary_) {return mateInfoLibrary_ < that.mateInfoLibrary_;}
+        if (inverseRank_ != that.inverseRank_) {return inverseRank_ < that.inverseRank_;}
+        if (tileCluster_ != that.tileCluster_) {return tileCluster_ < that.tileCluster_;}
+        return index_ < that.index_;
+    }
+
+    /// true if both fragments are from the same library and both ends of their pairs align at the same positions
+    bool sameGroup(const DuplicateKey &that) const
+    {
+        return position_ == that.position_ && mateAnchor_ == that.mateAnchor_ && mateInfoLibrary_ == that.mateInfoLibrary_;
+    }
+
+    /**
+     * \brief same as equal_to of the filters. Fragments of the same cluster are not duplicates of each other,
+     *        which happens when both ends of a pair face the same way and align at the same position
+     */
+    bool isDuplicateOf(const DuplicateKey &that) const
+    {
+        return sameGroup(that) && tileCluster_ != that.tileCluster_;
+    }
+};
+
+/**
+ * \brief Memory DuplicateRanking works in. Reserved together with the rest of the bin, as the ranking
+ *        runs while the dynamic memory allocations are blocked
+ */
+struct DuplicateRankingBuffers
+{
+    typedef std::vector<DuplicateKey, common::NumaAllocator<DuplicateKey, common::numa::defaultNodeLocal> > Keys;
+    typedef std::vector<char, common::NumaAllocator<char, common::numa::defaultNodeLocal> > Unique;
+
+    Keys keys_;
+    // merge rounds alternate between keys_ and buffer_
+    Keys buffer_;
+    Unique unique_;
+
+    /**
+     * \return false when duplicates are kept without being marked. BinSorter does not rank them then
+     *         and the buffers don't need to be reserved
+     */
+    static bool isRankingNeeded(const bool keepDuplicates, const bool markDuplicates)
+    {
+        return !keepDuplicates || markDuplicates;
+    }
+
+    void reserve(const std::size_t fragments)
+    {
+        keys_.reserve(fragments);
+        buffer_.reserve(fragments);
+        unique_.reserve(fragments);
+    }
+
+    void unreserve()
+    {
+        Keys().swap(keys_);
+        Keys().swap(buffer_);
+        Unique().swap(unique_);
+    }
+
+    static std::size_t getMemoryRequirements(const std::size_t fragments)
+    {
+        return fragments * (sizeof(DuplicateKey) * 2 + sizeof(char));
+    }
+};
+
+inline DuplicateKey makeDuplicateKey(
+    const uint64_t position,
+    const PairEndIndex &index,
+    const io::FragmentAccessor &fragment,
+    const uint64_t library,
+    const uint64_t offset)
+{
+    ISAAC_ASSERT_MSG(library <= std::numeric_limits<uint32_t>::max(), "Library index is too big: " << library);
+    const DuplicateKey ret =
+    {
+        position,
+        index.mate_.anchor_.value_,
+        uint64_t(index.mate_.info_.value_) << 32 | library,
+        ~index.duplicateClusterRank_,
+        fragment.tile_ * INSANELY_HIGH_NUMBER_OF_CLUSTERS_PER_TILE + fragment.clusterId_,
+        offset
+    };
+    return ret;
+}
+
 /**
  * \brief Order and compares reads to identify duplicates.
  *
@@ -114,6 +224,17 @@ struct FDuplicateFilter
         }
         return false;
     }
+
+    /**
+     * \return key that orders and groups the same way as less and equal_to do
+     */
+    DuplicateKey getKey(const PackedFragmentBuffer &fragments, const FStrandFragmentIndex &index, const uint64_t offset) const
+    {
+        const io::FragmentAccessor &fragment = fragments.getFragment(index);
+        return makeDuplicateKey(
+            index.fStrandPos_.getValue(), index, fragment,
+            singleLibrarySamples ? barcodeSampleIndex_.at(fragment.barcode_) : fragment.barcode_, offset);
+    }
 };
 
 template <bool singleLibrarySamples>
@@ -204,6 +325,16 @@ struct RSDuplicateFilter
         return false;
     }
 
+    /**
+     * \return key that orders and groups the same way as less and equal_to do
+     */
+    DuplicateKey getKey(const PackedFragmentBuffer &fragments, const RStrandOrShadowFragmentIndex &index, const uint64_t offset) const
+    {
+        const io::FragmentAccessor &fragment = fragments.getFragment(index);
+        return makeDuplicateKey(
+            index.anchor_.value_, index, fragment,
+            singleLibrarySamples ? barcodeSampleIndex_.at(fragment.barcode_) : fragment.barcode_, offset);
+    }
 };
 
 
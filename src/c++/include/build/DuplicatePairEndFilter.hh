@@ -20,7 +20,13 @@
 #ifndef iSAAC_BUILD_DUPLICATE_PAIR_END_FILTER_HH
 #define iSAAC_BUILD_DUPLICATE_PAIR_END_FILTER_HH
 
+#include <algorithm>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
 #include "build/BuildStats.hh"
+#include "build/DuplicateFragmentIndexFiltering.hh"
 #include "build/FragmentIndex.hh"
 #include "build/PackedFragmentBuffer.hh"
 #include "common/Debug.hh"
@@ -30,6 +36,207 @@ namespace isaac
 namespace build
 {
 
+/**
+ * \brief Orders one range of fragment indexes by the duplicate ranking and finds the best fragment of
+ *        each group of duplicates.
+ *
+ * The work is split into phases of independent units, so that any number of threads can share it.
+ * All units of a phase must be complete before the next phase starts:
+ *  0. extract the keys of a chunk and sort them
+ *  1..mergeRounds_. merge pairs of adjacent sorted runs
+ *  mergeRounds_ + 1. scan a chunk, extended to group boundaries, for the fragments that are not
+ *     duplicates of the last unique one
+ **/
+template <typename FilterT, typename IndexIteratorT>
+class DuplicateRanking : boost::noncopyable
+{
+public:
+    static const std::size_t CHUNK_SIZE = 0x10000;
+    static const std::size_t PREFETCH_DISTANCE = 8;
+
+    /**
+     * \param buffers   must have room for the whole range reserved. The ranking does not allocate memory
+     */
+    DuplicateRanking(
+        const FilterT &filter,
+        PackedFragmentBuffer &fragments,
+        IndexIteratorT begin,
+        IndexIteratorT end,
+        DuplicateRankingBuffers &buffers) :
+            filter_(filter), fragments_(fragments), begin_(begin), size_(std::distance(begin, end)),
+            chunks_((size_ + CHUNK_SIZE - 1) / CHUNK_SIZE), mergeRounds_(getMergeRounds(chunks_)),
+            keys_(buffers.keys_), buffer_(buffers.buffer_), unique_(buffers.unique_)
+    {
+        ISAAC_ASSERT_MSG(keys_.capacity() >= size_ && buffer_.capacity() >= size_ && unique_.capacity() >= size_,
+                         "Duplicate ranking buffers are not reserved for " << size_ << " fragments");
+        keys_.resize(size_);
+        buffer_.resize(mergeRounds_ ? size_ : 0);
+        unique_.assign(size_, false);
+    }
+
+    std::size_t getPhaseCount() const {return size_ ? mergeRounds_ + 2 : 0;}
+
+    std::size_t getUnitCount(const std::size_t phase) const
+    {
+        if (getPhaseCount() <= phase)
+        {
+            return 0;
+        }
+        if (!phase || mergeRounds_ + 1 == phase)
+        {
+            return chunks_;
+        }
+        const std::size_t runSize = CHUNK_SIZE << (phase - 1);
+        return (size_ + runSize * 2 - 1) / (runSize * 2);
+    }
+
+    void processUnit(const std::size_t phase, const std::size_t unit)
+    {
+        if (!phase)
+        {
+            sortChunk(unit);
+        }
+        else if (mergeRounds_ + 1 == phase)
+        {
+            scanChunk(unit);
+        }
+        else
+        {
+            mergeRuns(phase, unit);
+        }
+    }
+
+    /**
+     * \brief stores unique fragments and, if requested, the duplicates in the order of the ranking
+     *
+     * \return number of unique fragments
+     */
+    template <typename InsertIteratorT>
+    uint64_t emit(
+        const bool keepDuplicates,
+        BuildStats &buildStats,
+        const unsigned binIndex,
+        InsertIteratorT results)
+    {
+        const DuplicateKey *keys = getSorted();
+        uint64_t unique = 0;
+        for (std::size_t i = 0; size_ != i; ++i)
+        {
+            // indexes and fragments are visited in random order. Fetch them ahead
+            if (size_ > i + PREFETCH_DISTANCE * 2)
+            {
+                __builtin_prefetch(&*(begin_ + keys[i + PREFETCH_DISTANCE * 2].index_));
+            }
+            if (size_ > i + PREFETCH_DISTANCE)
+            {
+                __builtin_prefetch(&fragments_.getFragment(*(begin_ + keys[i + PREFETCH_DISTANCE].index_)), 1);
+            }
+            const typename std::iterator_traits<IndexIteratorT>::value_type &index = *(begin_ + keys[i].index_);
+            io::FragmentAccessor &fragment = fragments_.getFragment(index);
+            if (unique_[i])
+            {
+                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Selected as a duplicate best:\n" << index << ":\n" << fragment);
+                results++ = PackedFragmentBuffer::Index(index, fragment);
+                ++unique;
+                // the very first fragment has never been counted
+                if (i)
+                {
+                    buildStats.incrementUniqueFragments(binIndex, fragment.barcode_);
+                }
+            }
+            else if (keepDuplicates)
+            {
+                fragment.flags_.duplicate_ = true;
+                results++ = PackedFragmentBuffer::Index(index, fragment);
+                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Marked as a duplicate:\n" << index << ":\n" << fragment);
+            }
+            else
+            {
+                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Discarded as a duplicate:\n" << index << ":\n" << fragment);
+            }
+            if (i)
+            {
+                buildStats.incrementTotalFragments(binIndex, fragment.barcode_);
+            }
+        }
+        return unique;
+    }
+
+    std::size_t size() const {return size_;}
+
+private:
+    const FilterT &filter_;
+    PackedFragmentBuffer &fragments_;
+    const IndexIteratorT begin_;
+    const std::size_t size_;
+    const std::size_t chunks_;
+    const std::size_t mergeRounds_;
+    DuplicateRankingBuffers::Keys &keys_;
+    DuplicateRankingBuffers::Keys &buffer_;
+    DuplicateRankingBuffers::Unique &unique_;
+
+    static std::size_t getMergeRounds(const std::size_t chunks)
+    {
+        std::size_t ret = 0;
+        while ((std::size_t(1) << ret) < chunks)
+        {
+            ++ret;
+        }
+        return ret;
+    }
+
+    /// merge rounds alternate between keys_ and buffer_
+    const DuplicateKey *getSorted() const {return mergeRounds_ % 2 ? buffer_.data() : keys_.data();}
+
+    void sortChunk(const std::size_t chunk)
+    {
+        const std::size_t begin = chunk * CHUNK_SIZE;
+        const std::size_t end = std::min(begin + CHUNK_SIZE, size_);
+        for (std::size_t i = begin; end != i; ++i)
+        {
+            keys_[i] = filter_.getKey(fragments_, *(begin_ + i), i);
+        }
+        std::sort(keys_.begin() + begin, keys_.begin() + end);
+    }
+
+    void mergeRuns(const std::size_t round, const std::size_t pair)
+    {
+        const DuplicateKey *source = round % 2 ? keys_.data() : buffer_.data();
+        DuplicateKey *target = round % 2 ? buffer_.data() : keys_.data();
+        const std::size_t runSize = CHUNK_SIZE << (round - 1);
+        const std::size_t begin = pair * runSize * 2;
+        const std::size_t middle = std::min(begin + runSize, size_);
+        const std::size_t end = std::min(middle + runSize, size_);
+        std::merge(source + begin, source + middle, source + middle, source + end, target + begin);
+    }
+
+    void scanChunk(const std::size_t chunk)
+    {
+        const DuplicateKey *keys = getSorted();
+        // groups that cross the chunk boundaries belong to the chunk where they begin
+        std::size_t begin = chunk * CHUNK_SIZE;
+        while (begin && size_ != begin && keys[begin].sameGroup(keys[begin - 1]))
+        {
+            ++begin;
+        }
+        std::size_t end = std::min(chunk * CHUNK_SIZE + CHUNK_SIZE, size_);
+        while (size_ != end && keys[end].sameGroup(keys[end - 1]))
+        {
+            ++end;
+        }
+
+        std::size_t last = begin;
+        for (std::size_t i = begin; end > i; ++i)
+        {
+            if (begin == i || !keys[i].isDuplicateOf(keys[last]))
+            {
+                unique_[i] = true;
+                last = i;
+            }
+        }
+    }
+};
+
 /**
  *
  * \brief This class implements the generic duplicate filtering flow:
@@ -41,6 +248,10 @@ class DuplicatePairEndFilter
 {
 public:
     DuplicatePairEndFilter(const bool keepDuplicates) : keepDuplicates_(keepDuplicates){}
+
+    /**
+     * \brief single-threaded filtering. See DuplicateRanking for sharing the work between threads
+     */
     template <typename FilterT, typename InputIteratorT, typename InsertIteratorT>
     void filterInput(
         const FilterT& filter,
@@ -57,50 +268,23 @@ public:
             ISAAC_THREAD_CERR << "Sorting duplicates" << std::endl;
             const clock_t startSort = clock();
 
-            std::sort(duplicatesBegin, duplicatesEnd,
-                      boost::bind(&FilterT::less, &filter,
-                                  boost::ref(fragments), _1, _2));
+            DuplicateRankingBuffers buffers;
+            buffers.reserve(std::distance(duplicatesBegin, duplicatesEnd));
+            DuplicateRanking<FilterT, InputIteratorT> ranking(filter, fragments, duplicatesBegin, duplicatesEnd, buffers);
+            for (std::size_t phase = 0; ranking.getPhaseCount() != phase; ++phase)
+            {
+                for (std::size_t unit = 0; ranking.getUnitCount(phase) != unit; ++unit)
+                {
+                    ranking.processUnit(phase, unit);
+                }
+            }
 
             ISAAC_THREAD_CERR << "Sorting duplicates" << " done in " << (clock() - startSort) / 1000 << "ms" << std::endl;
 
-            // populate self with the unique fragments
             ISAAC_THREAD_CERR << "Filtering duplicates" << std::endl;
             const clock_t startFilter = clock();
 
-
-            // Range is guaranteed to be not empty
-            uint64_t unique = 1;
-            const io::FragmentAccessor &firstBestFragment = fragments.getFragment(*duplicatesBegin);
-            results++ = PackedFragmentBuffer::Index(*duplicatesBegin, firstBestFragment);
-            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(firstBestFragment.clusterId_, "Selected as the first duplicate best:\n" << *duplicatesBegin  << ":\n" << firstBestFragment);
-            for (InputIteratorT it(duplicatesBegin + 1), itLast(duplicatesBegin); duplicatesEnd != it; ++it)
-            {
-                io::FragmentAccessor &fragment = fragments.getFragment(*it);
-                ISAAC_DEV_TRACE_BLOCK(const io::FragmentAccessor &lastFragment = fragments.getFragment(*itLast);)
-
-                if (!filter.equal_to(fragments, *itLast, *it))
-                {
-                    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Selected as a duplicate best:\n" << *it << ":\n" << fragment);
-                    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Selected as a duplicate best prev:\n" << *itLast << ":\n" << fragments.getFragment(*itLast));
-                    results++ = PackedFragmentBuffer::Index(*it, fragment);
-                    unique++;
-                    itLast = it;
-                    buildStats.incrementUniqueFragments(binIndex, fragment.barcode_);
-                }
-                else if (keepDuplicates_)
-                {
-                    fragment.flags_.duplicate_ = true;
-                    results++ = PackedFragmentBuffer::Index(*it, fragment);
-                    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Marked as a duplicate of:\n" << lastFragment << ":\n" << *it << ":\n" << fragment);
-                    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(lastFragment.clusterId_, "Marked as a duplicate of:\n" << lastFragment << ":\n" << *it << ":\n" << fragment);
-                }
-                else
-                {
-                    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Discarded as a duplicate of:\n" << lastFragment << ":\n" << *it << ":\n" << fragment);
-                    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(lastFragment.clusterId_, "Discarded as a duplicate of:\n" << lastFragment << ":\n" << *it << ":\n" << fragment);
-                }
-                buildStats.incrementTotalFragments(binIndex, fragments.getFragment(*it).barcode_);
-            }
+            const uint64_t unique = ranking.emit(keepDuplicates_, buildStats, binIndex, results);
 
             ISAAC_THREAD_CERR << "Filtering duplicates"
                 << " done in " << (clock() - startFilter) / 1000 << "ms. found " << unique
@@ -24,6 +24,7 @@
 
 #include "alignment/Cigar.hh"
 #include "alignment/TemplateLengthStatistics.hh"
+#include "build/gapRealigner/HaplotypeCache.hh"
 #include "build/gapRealigner/RealignerGaps.hh"
 #include "build/PackedFragmentBuffer.hh"
 #include "flowcell/BarcodeMetadata.hh"
@@ -42,11 +43,13 @@ namespace build
 class GapRealigner
 {
 public:
-    typedef uint64_t GapChoiceBitmask;
+    typedef gapRealigner::GapChoiceBitmask GapChoiceBitmask;
 private:
     // number of bits that can represent the on/off state for each gap.
     // Currently unsigned is used to hold the choice
     static const unsigned MAX_GAPS_AT_A_TIME = 64;
+    // number of gaps found around the fragment that are considered for realignment
+    static const unsigned GAPS_PER_LOCUS_MAX = 8;
 
     const bool realignGapsVigorously_;
     const bool realignDodgyFragments_;
@@ -66,6 +69,11 @@ private:
 
     gapRealigner::RealignerGaps fragmentGaps_;
 
+    // fragments overlapping the same set of gaps share the choices enumerated for them
+    gapRealigner::HaplotypeCache haplotypeCache_;
+    // start positions already verified for the current choice and undo pivot
+    std::vector<reference::ReferencePosition> verifiedStartPositions_;
+
 public:
     typedef gapRealigner::Gap GapType;
     GapRealigner(
@@ -83,7 +91,8 @@ public:
             mismatchCost_(mismatchCost),
             gapOpenCost_(gapOpenCost),
             gapExtendCost_(gapExtendCost),
-            barcodeMetadataList_(barcodeMetadataList)
+            barcodeMetadataList_(barcodeMetadataList),
+            haplotypeCache_(GAPS_PER_LOCUS_MAX, gapsPerFragmentMax_)
     {
         reserve();
     }
@@ -93,6 +102,9 @@ public:
         currentAttemptGaps_.reserve(MAX_GAPS_AT_A_TIME * 10);
         // number of existing gaps to be expected in one fragment. No need to be particularly precise.
         fragmentGaps_.reserve(currentAttemptGaps_.capacity());
+        haplotypeCache_.reserve();
+        // each chosen gap anchors the read start on both sides of it. Cleared for each undo pivot
+        verifiedStartPositions_.reserve(GAPS_PER_LOCUS_MAX * 2);
     }
 
     bool realign(
@@ -203,7 +215,7 @@ private:
 
     GapChoice verifyGapsChoice(
         const GapChoiceBitmask &choice,
-        const gapRealigner::GapsRange &gaps,
+        const gapRealigner::GapsRange &chosenGaps,
         const reference::ReferencePosition newBeginPos,
         const io::FragmentAccessor &fragment,
         const reference::ContigList &reference);
@@ -225,6 +237,15 @@ private:
         int64_t alignmentPos,
         reference::ReferencePosition &ret);
 
+    bool findStartPos(
+        const GapChoiceBitmask &choice,
+        const gapRealigner::GapsRange &gaps,
+        const reference::ReferencePosition binStartPos,
+        const reference::ReferencePosition binEndPos,
+        const gapRealigner::HaplotypeAnchor &anchor,
+        const int64_t alignmentPos,
+        reference::ReferencePosition &ret);
+
     bool compactCigar(
         const reference::ContigList &reference,
         const reference::ReferencePosition binEndPos,
@@ -257,7 +278,8 @@ private:
                           const reference::ReferencePosition& pivotPos);
 
     bool verifyGapsChoice(
-        const GapChoiceBitmask &choice,
+        const gapRealigner::HaplotypeLocus &locus,
+        const gapRealigner::Haplotype &haplotype,
         const gapRealigner::GapsRange& gaps,
         const reference::ReferencePosition& binStartPos,
         const reference::ReferencePosition& binEndPos,
@@ -21,8 +21,10 @@
 #define iSAAC_BUILD_INDEL_LOADER_HH
 
 #include <boost/filesystem.hpp>
+#include <boost/noncopyable.hpp>
 
 #include "build/gapRealigner/RealignerGaps.hh"
+#include "io/MappedFile.hh"
 #include "reference/SortedReferenceMetadata.hh"
 
 namespace isaac
@@ -30,9 +32,95 @@ namespace isaac
 namespace build
 {
 
-build::gapRealigner::Gaps loadIndels(
-    const boost::filesystem::path &vcfFilePath,
-    const reference::SortedReferenceMetadataList &sortedReferenceMetadataList);
+namespace knownIndels
+{
+
+struct CacheHeader
+{
+    char magic_[8];
+    uint32_t formatVersion_;
+    uint32_t contigCount_;
+    /// size and modification time of the vcf the cache was produced from
+    uint64_t vcfSize_;
+    int64_t vcfMtime_;
+    /// covers the names and lengths of the reference contigs the gaps are indexed against
+    uint64_t referenceChecksum_;
+    uint64_t gapCount_;
+    /// covers the contig table. The gap table is too big to be hashed on every start, its size is checked instead
+    uint64_t contigsChecksum_;
+};
+
+/// gaps of a contig occupy [begin_, end_) in the gap table
+struct CachedContig
+{
+    uint64_t begin_;
+    uint64_t end_;
+    /// deletions starting this far before a bin can still end inside it
+    uint32_t maxDeletionLength_;
+    uint32_t reserved_;
+};
+
+/// Gap without the contig id and priority. Ordered by position within each contig.
+struct CachedGap
+{
+    uint32_t position_;
+    int32_t length_;
+
+    bool operator <(const CachedGap &that) const
+    {
+        return position_ < that.position_ || (position_ == that.position_ && length_ < that.length_);
+    }
+};
+
+} // namespace knownIndels
+
+/**
+ * \brief Known indels sorted by contig and position in the binary cache next to the vcf file.
+ *
+ * The vcf is only parsed when the cache is missing or does not match the vcf and the reference. The cache
+ * is mapped and the gaps of a bin are looked up when the bin gets processed, so only the parts of it that
+ * cover the bins touched by Build get paged in.
+ */
+class KnownIndels : boost::noncopyable
+{
+public:
+    /**
+     * \param vcfFilePath   empty path means no known indels
+     */
+    KnownIndels(
+        const boost::filesystem::path &vcfFilePath,
+        const reference::SortedReferenceMetadataList &sortedReferenceMetadataList);
+
+    std::size_t size() const {return gapCount_;}
+
+    /**
+     * \brief Appends the known indels that begin or end within [binStart, binEnd)
+     */
+    void appendBinGaps(
+        const reference::ReferencePosition binStart,
+        const reference::ReferencePosition binEnd,
+        gapRealigner::Gaps &gaps) const;
+
+    static boost::filesystem::path getCachePath(const boost::filesystem::path &vcfFilePath)
+    {
+        return vcfFilePath.string() + ".isaac-gaps";
+    }
+
+private:
+    io::MappedFile cacheFile_;
+    // used when the cache could not be stored next to the vcf
+    std::vector<knownIndels::CachedContig> contigsBuffer_;
+    std::vector<knownIndels::CachedGap> gapsBuffer_;
+
+    const knownIndels::CachedContig *contigs_;
+    std::size_t contigCount_;
+    const knownIndels::CachedGap *gaps_;
+    std::size_t gapCount_;
+
+    bool mapCache(
+        const boost::filesystem::path &cachePath,
+        const knownIndels::CacheHeader &expected);
+};
 
 } // namespace build
 } // namespace isaac
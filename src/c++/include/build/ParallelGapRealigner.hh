@@ -57,12 +57,18 @@ public:
             contigLists_(contigLists),
             barcodeTemplateLengthStatistics_(barcodeTemplateLengthStatistics),
             threadCigars_(threads),
+            threadCigarArenas_(threads),
+            threadRealignedFragments_(threads),
             threadGapRealigners_(
                 threads,
                 GapRealigner(realignGapsVigorously, realignDodgyFragments, realignedGapsPerFragment, 3, 4, 0,
                              barcodeMetadataList))
     {
         std::for_each(threadCigars_.begin(), threadCigars_.end(), boost::bind(&alignment::Cigar::reserve, _1, THREAD_CIGAR_MAX));
+        std::for_each(threadCigarArenas_.begin(), threadCigarArenas_.end(),
+                      boost::bind(&alignment::Cigar::reserve, _1, READS_AT_A_TIME * THREAD_ARENA_CIGAR_LENGTH));
+        std::for_each(threadRealignedFragments_.begin(), threadRealignedFragments_.end(),
+                      boost::bind(&std::vector<RealignedFragment>::reserve, _1, READS_AT_A_TIME));
         std::for_each(threadGapRealigners_.begin(), threadGapRealigners_.end(), boost::bind(&GapRealigner::reserve, _1));
 
         BOOST_FOREACH(const alignment::TemplateLengthStatistics &barcodeTls, barcodeTemplateLengthStatistics)
@@ -74,18 +80,46 @@ public:
     void threadRealignGaps(boost::unique_lock<boost::mutex> &lock, BinData &binData, BinData::iterator &nextUnprocessed, uint64_t threadNumber);
 private:
     static const std::size_t THREAD_CIGAR_MAX =1024;
+    static const std::size_t READS_AT_A_TIME = 1024;
+    // typical length of a realigned CIGAR. Arenas get published early if reads get more than that on average
+    static const std::size_t THREAD_ARENA_CIGAR_LENGTH = 8;
+
+    /**
+     * \brief Fragment realigned by a thread. Its CIGAR and pair details get published once the thread
+     *        finishes its batch of reads.
+     */
+    struct RealignedFragment
+    {
+        PackedFragmentBuffer::Index *index_;
+        // location of the realigned CIGAR in the thread arena
+        std::size_t cigarOffset_;
+        std::size_t cigarLength_;
+        reference::ReferencePosition newRStrandPosition_;
+        unsigned short newEditDistance_;
+    };
+
     const bool clipSemialigned_;
     const flowcell::BarcodeMetadataList &barcodeMetadataList_;
     const isaac::reference::ContigLists &contigLists_;
     const std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics_;
     std::vector<alignment::Cigar> threadCigars_;
+    // realigned CIGARs accumulated by each thread for the current batch of reads
+    std::vector<alignment::Cigar> threadCigarArenas_;
+    std::vector<std::vector<RealignedFragment> > threadRealignedFragments_;
     std::vector<GapRealigner> threadGapRealigners_;
     boost::mutex cigarBufferMutex_;
 
     void realign(
         isaac::build::GapRealigner& realigner,
         io::FragmentAccessor& fragment, PackedFragmentBuffer::Index &index,
-        BinData& binData, isaac::alignment::Cigar& cigars);
+        BinData& binData, isaac::alignment::Cigar& cigars,
+        isaac::alignment::Cigar& cigarArena,
+        std::vector<RealignedFragment> &realignedFragments);
+
+    void publishRealignedFragments(
+        BinData& binData,
+        isaac::alignment::Cigar& cigarArena,
+        std::vector<RealignedFragment> &realignedFragments);
 };
 
 
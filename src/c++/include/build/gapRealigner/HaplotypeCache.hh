@@ -0,0 +1,143 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file HaplotypeCache.hh
+ **
+ ** Gap choices precomputed once per set of gaps and shared between the fragments
+ ** that overlap the same indel locus.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BUILD_GAP_REALIGNER_HAPLOTYPE_CACHE_HH
+#define iSAAC_BUILD_GAP_REALIGNER_HAPLOTYPE_CACHE_HH
+
+#include "build/gapRealigner/Gap.hh"
+
+namespace isaac
+{
+namespace build
+{
+namespace gapRealigner
+{
+
+typedef uint64_t GapChoiceBitmask;
+
+/**
+ * \brief Read start placement that keeps the base at pivotPos_ steady once the chosen gaps preceding
+ *        the pivot are applied.
+ *
+ * Valid for any read that has more than insertedBases_ bases ahead of pivotPos_. Reads that have fewer
+ * get some of the insertions clipped and need the full walk through the gaps.
+ */
+struct HaplotypeAnchor
+{
+    HaplotypeAnchor(const unsigned pivotGapIndex, const reference::ReferencePosition pivotPos) :
+        pivotGapIndex_(pivotGapIndex), pivotPos_(pivotPos), overlapping_(false), insertedBases_(0), shift_(0){}
+
+    /// number of gaps in the locus that precede the pivot
+    unsigned pivotGapIndex_;
+    reference::ReferencePosition pivotPos_;
+    /// chosen gaps preceding the pivot overlap. Such placement is never allowed.
+    bool overlapping_;
+    /// total length of the chosen insertions preceding the pivot
+    unsigned insertedBases_;
+    /// offset to be added to the read start position
+    int64_t shift_;
+};
+
+/**
+ * \brief One gap choice with its chosen gaps and read start anchors laid out in HaplotypeLocus buffers
+ */
+struct Haplotype
+{
+    GapChoiceBitmask choice_;
+    unsigned gapsBegin_;
+    unsigned gapsEnd_;
+    unsigned anchorsBegin_;
+    unsigned anchorsEnd_;
+};
+
+/**
+ * \brief All gap choices for one set of gaps in the order ChooseKGapsFilter produces them
+ */
+class HaplotypeLocus
+{
+    friend class HaplotypeCache;
+
+    reference::ReferencePosition binStartPos_;
+    Gaps gaps_;
+    std::vector<Haplotype> haplotypes_;
+    Gaps chosenGaps_;
+    std::vector<HaplotypeAnchor> anchors_;
+
+public:
+    typedef std::vector<Haplotype>::const_iterator const_iterator;
+    typedef std::vector<HaplotypeAnchor>::const_iterator AnchorIterator;
+
+    const_iterator begin() const {return haplotypes_.begin();}
+    const_iterator end() const {return haplotypes_.end();}
+
+    GapsRange getGaps(const Haplotype &haplotype) const
+    {
+        return GapsRange(chosenGaps_.begin() + haplotype.gapsBegin_, chosenGaps_.begin() + haplotype.gapsEnd_);
+    }
+
+    std::pair<AnchorIterator, AnchorIterator> getAnchors(const Haplotype &haplotype) const
+    {
+        return std::make_pair(anchors_.begin() + haplotype.anchorsBegin_, anchors_.begin() + haplotype.anchorsEnd_);
+    }
+
+private:
+    void reserve(const unsigned gapsMax, const unsigned gapsPerFragmentMax);
+    bool matches(const reference::ReferencePosition binStartPos, const GapsRange &gaps) const;
+    void build(
+        const reference::ReferencePosition binStartPos,
+        const GapsRange &gaps,
+        const unsigned gapsPerFragmentMax);
+    void addAnchor(const GapChoiceBitmask choice, const unsigned pivotGapIndex, const reference::ReferencePosition pivotPos);
+};
+
+/**
+ * \brief Keeps the few most recently seen loci. Fragments are realigned in the order of their positions,
+ *        so the ones sharing an indel cluster come in bunches.
+ */
+class HaplotypeCache
+{
+    static const unsigned LOCI_MAX = 16;
+
+    const unsigned gapsPerLocusMax_;
+    const unsigned gapsPerFragmentMax_;
+    std::vector<HaplotypeLocus> loci_;
+    unsigned nextToEvict_;
+
+public:
+    HaplotypeCache(const unsigned gapsPerLocusMax, const unsigned gapsPerFragmentMax) :
+        gapsPerLocusMax_(gapsPerLocusMax), gapsPerFragmentMax_(gapsPerFragmentMax), nextToEvict_(0)
+    {
+    }
+
+    void reserve();
+
+    /**
+     * \brief Returns the haplotypes for gaps, building them if the locus is not in the cache
+     *
+     * \param binStartPos   gaps that begin before the bin start don't get anchored on their left side
+     */
+    const HaplotypeLocus &get(const reference::ReferencePosition binStartPos, const GapsRange &gaps);
+};
+
+} // namespace gapRealigner
+} // namespace build
+} // namespace isaac
+
+#endif // #ifndef iSAAC_BUILD_GAP_REALIGNER_HAPLOTYPE_CACHE_HH
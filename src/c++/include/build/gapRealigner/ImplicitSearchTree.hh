@@ -0,0 +1,121 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file ImplicitSearchTree.hh
+ **
+ ** Sorted keys laid out in breadth-first order for cache-friendly lower bound lookups.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BUILD_GAP_REALIGNER_IMPLICIT_SEARCH_TREE_HH
+#define iSAAC_BUILD_GAP_REALIGNER_IMPLICIT_SEARCH_TREE_HH
+
+#include <vector>
+
+#include "common/Debug.hh"
+
+namespace isaac
+{
+namespace build
+{
+namespace gapRealigner
+{
+
+/**
+ * \brief Implicit binary search tree over a sorted sequence of keys.
+ *
+ * Node k has its children at 2k and 2k+1, so the top levels of the tree share a handful of cache lines
+ * and the descent can prefetch the whole next level ahead of time. For the gap counts the known indel
+ * databases produce this is considerably faster than std::lower_bound over the gaps themselves.
+ */
+class ImplicitSearchTree
+{
+    // 64 byte cache line holds 8 keys. The 8 grand-grand-children of node k start at 8k
+    static const std::size_t PREFETCH_STRIDE = 8;
+
+    // keys in breadth-first order. Index 0 is unused
+    std::vector<uint64_t> keys_;
+    // position of the key in the original sorted sequence
+    std::vector<unsigned> ranks_;
+
+public:
+    void reserve(const std::size_t keys)
+    {
+        keys_.reserve(keys + 1);
+        ranks_.reserve(keys + 1);
+    }
+
+    void unreserve()
+    {
+        std::vector<uint64_t>().swap(keys_);
+        std::vector<unsigned>().swap(ranks_);
+    }
+
+    void clear()
+    {
+        keys_.clear();
+        ranks_.clear();
+    }
+
+    std::size_t size() const {return keys_.empty() ? 0 : keys_.size() - 1;}
+
+    /**
+     * \param getKey    functor returning uint64_t key for the element. The sequence must be ordered by it.
+     */
+    template <typename IteratorT, typename GetKeyT>
+    void build(const IteratorT begin, const IteratorT end, GetKeyT getKey)
+    {
+        ISAAC_ASSERT_MSG(std::size_t(std::distance(begin, end)) < std::size_t(unsigned(-1)), "Too many keys: " << std::distance(begin, end));
+        keys_.resize(std::distance(begin, end) + 1);
+        ranks_.resize(keys_.size());
+        IteratorT it = begin;
+        fill(it, begin, getKey, 1);
+    }
+
+    /**
+     * \return position of the first key in the sorted sequence that is not less than value or size() if there is none
+     */
+    std::size_t lowerBound(const uint64_t value) const
+    {
+        const std::size_t n = size();
+        std::size_t k = 1;
+        while (k <= n)
+        {
+            __builtin_prefetch(keys_.data() + std::min(k * PREFETCH_STRIDE, n));
+            k = 2 * k + (keys_[k] < value);
+        }
+        // strip the right turns taken after the last left one. What remains is the node we went left at.
+        k >>= __builtin_ffsll(~k);
+        return k ? ranks_[k] : n;
+    }
+
+private:
+    template <typename IteratorT, typename GetKeyT>
+    void fill(IteratorT &it, const IteratorT begin, GetKeyT &getKey, const std::size_t k)
+    {
+        if (k < keys_.size())
+        {
+            fill(it, begin, getKey, 2 * k);
+            keys_[k] = getKey(*it);
+            ranks_[k] = std::distance(begin, it);
+            ++it;
+            fill(it, begin, getKey, 2 * k + 1);
+        }
+    }
+};
+
+} // namespace gapRealigner
+} // namespace build
+} // namespace isaac
+
+#endif // #ifndef iSAAC_BUILD_GAP_REALIGNER_IMPLICIT_SEARCH_TREE_HH
@@ -21,6 +21,7 @@
 #define iSAAC_BUILD_GAP_REALIGNER_REALIGNER_GAPS_HH
 
 #include "build/gapRealigner/Gap.hh"
+#include "build/gapRealigner/ImplicitSearchTree.hh"
 
 namespace isaac
 {
@@ -35,6 +36,9 @@ class RealignerGaps
     gapRealigner::Gaps gapGroups_;
     // Deletion gaps sorted by their end position
     gapRealigner::Gaps deletionEndGroups_;
+    // lookup trees over gapGroups_ begin positions and deletionEndGroups_ end positions
+    ImplicitSearchTree gapStartsTree_;
+    ImplicitSearchTree deletionEndsTree_;
 
 public:
     typedef gapRealigner::Gap GapType;
@@ -0,0 +1,134 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file Metrics.hh
+ **
+ ** Per-thread work counters and per-stage timing of the workflow.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_COMMON_METRICS_HH
+#define iSAAC_COMMON_METRICS_HH
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/array.hpp>
+#include <boost/filesystem.hpp>
+
+#include "common/Debug.hh"
+#include "common/SystemCompatibility.hh"
+
+namespace isaac
+{
+namespace common
+{
+namespace metrics
+{
+
+enum Counter
+{
+    BytesLoaded,
+    TilesAligned,
+    ClustersAligned,
+    SeedsLookedUp,
+    SmithWatermanCalls,
+    BinsSorted,
+    BgzfBytesCompressed,
+    TempBytesWritten,
+    CountersCount
+};
+
+const char *getCounterName(const Counter counter);
+
+typedef boost::array<uint64_t, CountersCount> CounterValues;
+
+/**
+ * \brief Counters of a single thread. Only the owner thread increments them, so the increments
+ *        don't need to lock the bus.
+ */
+struct ThreadCounters
+{
+    uint64_t values_[CountersCount];
+};
+
+extern iSAAC_THREAD_LOCAL ThreadCounters *threadCounters_;
+
+/**
+ * \brief Allocates the counters of the calling thread. Threads must register before they increment
+ *        anything and before the dynamic memory allocations get blocked. The main thread is registered
+ *        during the static initialization. Registering the same thread again does nothing.
+ */
+void registerThread();
+
+inline void add(const Counter counter, const uint64_t value)
+{
+    ThreadCounters *counters = threadCounters_;
+    ISAAC_ASSERT_MSG(counters, "Thread must be registered before it increments the metrics counters");
+    // relaxed atomics compile into plain moves and keep snapshot() from seeing torn values
+    __atomic_store_n(&counters->values_[counter],
+                     __atomic_load_n(&counters->values_[counter], __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+/**
+ * \return sum of the counters of all threads that have ever incremented any
+ */
+CounterValues snapshot();
+
+/**
+ * \brief Increases the amount of work the counter is expected to reach. Progress reporting only.
+ */
+void addExpected(const Counter counter, const uint64_t value);
+
+/**
+ * \return amounts of work announced via addExpected so far
+ */
+CounterValues expected();
+
+/**
+ * \brief Wall-clock time and counter increments of each workflow stage along with the memory high-water
+ *        mark of the process by the end of it
+ */
+class StageLog
+{
+public:
+    void begin(const std::string &stageName);
+    void end();
+
+    void serialize(std::ostream &os) const;
+    void dumpJson(const boost::filesystem::path &jsonPath) const;
+
+private:
+    struct Stage
+    {
+        std::string name_;
+        double seconds_;
+        CounterValues counters_;
+        // peak resident set size of the process since its start, not of the stage alone. Never decreases
+        // from one stage to the next
+        uint64_t processPeakRssBytes_;
+    };
+
+    std::vector<Stage> stages_;
+    std::string currentName_;
+    std::chrono::steady_clock::time_point currentStart_;
+    CounterValues currentCounters_;
+};
+
+} // namespace metrics
+} // namespace common
+} // namespace isaac
+
+#endif // #ifndef iSAAC_COMMON_METRICS_HH
@@ -34,6 +34,10 @@ namespace numa
 
 void* numaAllocate(std::size_t size, const int node);
 void numaDeallocate(void * __p, std::size_t size, const int node);
+/**
+ * \brief sets interleave policy on memory that has been mapped but not touched yet. No-op when numa is unavailable
+ */
+void numaInterleave(void *p, std::size_t size);
 
 static const int defaultNodeLocal = -1;
 static const int defaultNodeInterleave = -2;
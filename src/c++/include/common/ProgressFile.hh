@@ -0,0 +1,105 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file ProgressFile.hh
+ **
+ ** Periodically rewritten json summary of the workflow progress for the job schedulers to poll.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_COMMON_PROGRESS_FILE_HH
+#define iSAAC_COMMON_PROGRESS_FILE_HH
+
+#include <chrono>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+
+#include "common/Metrics.hh"
+
+namespace isaac
+{
+namespace common
+{
+namespace metrics
+{
+
+/**
+ * \brief Background thread rewriting the progress file from the metrics counters.
+ *
+ * The file is replaced atomically, so readers never see it half-written. Writing does not allocate
+ * dynamic memory and is safe while the allocations are blocked.
+ */
+class ProgressFile: boost::noncopyable
+{
+public:
+    /**
+     * \param intervalSeconds   0 disables the progress file
+     */
+    ProgressFile(const boost::filesystem::path &path, const unsigned intervalSeconds);
+    ~ProgressFile();
+
+    /**
+     * \brief Rates used for the estimated time of completion are averaged from the beginning of the stage
+     *
+     * \param stageName must outlive the ProgressFile
+     */
+    void beginStage(const char *stageName);
+
+    /// Stops the updates and writes the final state
+    void finish();
+
+private:
+    // big enough for the whole document
+    static const std::size_t BUFFER_SIZE = 4096;
+
+    const std::string path_;
+    const std::string tempPath_;
+    const std::chrono::seconds interval_;
+
+    boost::mutex mutex_;
+    boost::condition_variable stateChangedCondition_;
+    bool finished_;
+
+    const std::chrono::steady_clock::time_point start_;
+    const char *stageName_;
+    std::chrono::steady_clock::time_point stageStart_;
+    CounterValues stageCounters_;
+    std::chrono::steady_clock::time_point lastUpdate_;
+    CounterValues lastCounters_;
+
+    boost::thread thread_;
+
+    void run();
+    /**
+     * \brief Formats the document and makes it the base for the next rates. Requires mutex_.
+     *
+     * \return length of the document in buffer
+     */
+    std::size_t update(const std::chrono::steady_clock::time_point now, char *buffer);
+    /**
+     * \brief Replaces the file with the document. Does not need mutex_.
+     *
+     * \return false if the file could not be written
+     */
+    bool write(const char *buffer, const std::size_t length) const;
+    std::size_t format(const std::chrono::steady_clock::time_point now, const CounterValues &counters, char *buffer) const;
+};
+
+} // namespace metrics
+} // namespace common
+} // namespace isaac
+
+#endif // #ifndef iSAAC_COMMON_PROGRESS_FILE_HH
@@ -103,6 +103,12 @@ unsigned int getMaxOpenFiles();
 /// File size in bytes as returned by stat
 uint64_t getFileSize(const PathCharType *filePath);
 
+/// Largest resident set size of the process so far, in bytes
+uint64_t getPeakResidentSetSize();
+
+/// Current resident set size of the process in bytes. Does not allocate dynamic memory.
+uint64_t getResidentSetSize();
+
 /// Determine the processor time
 int64_t clock();
 
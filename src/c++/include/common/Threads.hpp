@@ -25,6 +25,7 @@
 
 #include "common/Debug.hh"
 #include "common/Exceptions.hh"
+#include "common/Metrics.hh"
 #include "common/Numa.hh"
 
 namespace isaac {
@@ -322,6 +323,7 @@ private:
         runOnNode_ = common::bindCurrentThreadToNumaNode(
             common::numa::defaultNodeInterleave == targetNumaNode_ ?
                 common::getThreadInterleaveNumaNode(threadNum) : targetNumaNode_);
+        common::metrics::registerThread();
 
 //        setitimer(ITIMER_PROF, &itimer_, NULL);
 //        ISAAC_THREAD_CERR << "thread " << threadNum << " created\n";
@@ -20,6 +20,7 @@
 #ifndef iSAAC_DEMULTIPLEXING_BARCODE_RESOLVER_HH
 #define iSAAC_DEMULTIPLEXING_BARCODE_RESOLVER_HH
 
+#include "common/Threads.hpp"
 #include "demultiplexing/Barcode.hh"
 #include "demultiplexing/DemultiplexingStats.hh"
 #include "flowcell/BarcodeMetadata.hh"
@@ -35,10 +36,13 @@ class BarcodeResolver: boost::noncopyable
 public:
     BarcodeResolver(
         const flowcell::BarcodeMetadataList &allBarcodeMetadata,
-        const flowcell::BarcodeMetadataList &barcodeGroup);
+        const flowcell::BarcodeMetadataList &barcodeGroup,
+        common::ThreadVector &threads,
+        const unsigned threadsMax);
 
     /**
-     * \brief updates the tile information in 'result' with the corresponding barcodeMetadataList_ indexes
+     * \brief updates the tile information in 'result' with the corresponding barcodeMetadataList_ indexes.
+     *        The order of barcodes is preserved.
      */
     void resolve(
         Barcodes &barcodes,
@@ -61,16 +65,40 @@ public:
                                                       const unsigned componentOffset,
                                                       const unsigned iteration);
 
+    static std::vector<unsigned> buildMismatchIndex(const Barcodes &mismatchBarcodes);
+
+    /**
+     * \return position of the sequence in mismatchBarcodes or mismatchBarcodes.size() if not found
+     */
+    static std::size_t findMismatchBarcode(
+        const Barcodes &mismatchBarcodes,
+        const std::vector<unsigned> &mismatchIndex,
+        const Kmer sequence);
+
 private:
+    /**
+     * \brief Counters accumulated by one resolve thread. Merged into DemultiplexingStats at the end of resolve
+     */
+    struct ThreadState
+    {
+        std::vector<LaneBarcodeStats> barcodeStats_;
+        std::vector<Kmer> unknownSequences_;
+        UnknownBarcodeHits unknownHits_;
+    };
+
     const flowcell::BarcodeMetadataList &allBarcodeMetadata_;
     const Barcodes mismatchBarcodes_;
+    // open addressing table of mismatchBarcodes_ offsets + 1. 0 designates empty slot
+    const std::vector<unsigned> mismatchIndex_;
     const unsigned unknownBarcodeIndex_;
     std::vector<uint64_t> barcodeHits_;
+    common::ThreadVector &threads_;
+    std::vector<ThreadState> threadStates_;
 
-    Barcodes::iterator recordSameBarcodeHits(
-        const Barcodes::iterator dataBarcodeIterator,
-        const Barcodes::const_iterator dataBarcodesEnd,
-        demultiplexing::DemultiplexingStats& demultiplexingStats);
+    void resolveThread(
+        const unsigned threadNumber,
+        const unsigned threadsTotal,
+        Barcodes &dataBarcodes);
 };
 
 } // namespace demultiplexing
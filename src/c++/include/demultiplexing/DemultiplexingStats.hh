@@ -96,6 +96,14 @@ public:
         laneBarcodeStats_.at(laneBarcodeIndex(barcodeIndex)).recordUnknownBarcode();
     }
 
+    /**
+     * \brief adds counts accumulated elsewhere (for example, by a worker thread) to the barcode stats
+     */
+    void recordBarcodeStats(const unsigned barcodeIndex, const LaneBarcodeStats &stats)
+    {
+        laneBarcodeStats_.at(laneBarcodeIndex(barcodeIndex)) += stats;
+    }
+
     static bool orderBySequence(
         const std::pair<Kmer, uint64_t> &left,
         const std::pair<Kmer, uint64_t> &right)
@@ -32,12 +32,21 @@ namespace fastq
     static const unsigned READ_NUMBER_MAX = 2;
 
 
+    static const unsigned INDEX_NUMBER_MAX = 2;
+
     void getFastqFilePath(
         const boost::filesystem::path &baseCallsPath,
         const unsigned lane,
         const unsigned read,
         const bool compressed,
         boost::filesystem::path &result);
+
+    void getFastqIndexFilePath(
+        const boost::filesystem::path &baseCallsPath,
+        const unsigned lane,
+        const unsigned index,
+        const bool compressed,
+        boost::filesystem::path &result);
 }
 
 struct FastqFilePathAttributeTag
@@ -50,6 +59,39 @@ const FastqFilePathAttributeTag::value_type & Layout::getLaneReadAttribute<Layou
     const unsigned lane, const unsigned read, FastqFilePathAttributeTag::value_type &result) const;
 
 
+struct FastqIndexFilePathAttributeTag
+{
+    typedef boost::filesystem::path value_type;
+    friend std::ostream &operator << (std::ostream &os, const FastqIndexFilePathAttributeTag &tag){return os << "FastqIndexFilePathAttributeTag";}
+};
+/**
+ * \param read index read number, 1-based
+ */
+template<>
+const FastqIndexFilePathAttributeTag::value_type & Layout::getLaneReadAttribute<Layout::Fastq, FastqIndexFilePathAttributeTag>(
+    const unsigned lane, const unsigned read, FastqIndexFilePathAttributeTag::value_type &result) const;
+
+
+struct FastqIndexLengths
+{
+    typedef std::vector<unsigned> value_type;
+    friend std::ostream &operator << (std::ostream &os, const FastqIndexLengths &tag){return os << "FastqIndexLengths";}
+};
+template<>
+const FastqIndexLengths::value_type & Layout::getAttribute<Layout::Fastq, FastqIndexLengths>(
+    FastqIndexLengths::value_type &result) const;
+
+
+struct FastqIndexInReadName
+{
+    typedef bool value_type;
+    friend std::ostream &operator << (std::ostream &os, const FastqIndexInReadName &tag){return os << "FastqIndexInReadName";}
+};
+template<>
+const FastqIndexInReadName::value_type & Layout::getAttribute<Layout::Fastq, FastqIndexInReadName>(
+    FastqIndexInReadName::value_type &result) const;
+
+
 struct FastqBaseQ0
 {
     typedef char value_type;
@@ -62,11 +62,18 @@ inline std::ostream & operator << (std::ostream &os, const BclFlowcellData &fd)
 
 struct FastqFlowcellData
 {
-    FastqFlowcellData(bool compressed, char fastqQ0, bool allowVariableLength) :
-        compressed_(compressed), fastqQ0_(fastqQ0), allowVariableLength_(allowVariableLength){}
+    FastqFlowcellData(bool compressed, char fastqQ0, bool allowVariableLength,
+                      const std::vector<unsigned> &indexLengths = std::vector<unsigned>(),
+                      bool indexInReadName = false) :
+        compressed_(compressed), fastqQ0_(fastqQ0), allowVariableLength_(allowVariableLength),
+        indexLengths_(indexLengths), indexInReadName_(indexInReadName){}
     bool compressed_;
     char fastqQ0_;
     bool allowVariableLength_;
+    // length of each index read. Empty when there are no index reads
+    std::vector<unsigned> indexLengths_;
+    // true if index reads come from the read name rather than from lane<X>_index<Y>.fastq files
+    bool indexInReadName_;
 };
 
 struct BamFlowcellData
@@ -21,6 +21,7 @@
 #define iSAAC_IO_FASTQ_LOADER_HH
 
 #include "common/Threads.hpp"
+#include "flowcell/FastqLayout.hh"
 #include "io/FastqReader.hh"
 
 namespace isaac
@@ -35,30 +36,39 @@ class FastqLoader
 {
     const unsigned inputLoadersMax_;
     std::vector<boost::shared_ptr<FastqReader> >  readReaders_;
+    std::vector<boost::shared_ptr<FastqReader> >  indexReaders_;
     bool paired_;
     common::ThreadVector &threads_;
 
 public:
-    /**
-     * \brief initializes paired fastq loader.
-     */
+    static const unsigned READERS_MAX = 2 + flowcell::fastq::INDEX_NUMBER_MAX;
+
     /**
      * \brief Creates uninitialized fastq loader
+     *
+     * \param paired       When false, only one reader is created and it gets all inputLoadersMax threads to
+     *                     decompress bgzf. Otherwise each of the two readers gets half of them.
+     * \param indexFiles   Number of lane<X>_index<Y>.fastq files to read the barcodes from
      */
     FastqLoader(
         const bool allowVariableLength,
         const std::size_t maxPathLength,
         common::ThreadVector &threads,
-        const unsigned inputLoadersMax) :
+        const unsigned inputLoadersMax,
+        const bool paired = true,
+        const unsigned indexFiles = 0) :
         inputLoadersMax_(inputLoadersMax),
-        // notice that single-ended fastq will use only half the allowed threads to decompress bgzf.
-        // That is not correct way to do it, but not particularly important. We mainly care here for
-        // inputLoadersMax_=1 scenario which is important for debugging and such.
-        paired_(false),
+        paired_(paired),
         threads_(threads)
     {
+        ISAAC_ASSERT_MSG(flowcell::fastq::INDEX_NUMBER_MAX >= indexFiles, "Too many index files: " << indexFiles);
         readReaders_.resize(2);
-        threads_.execute(boost::bind(&FastqLoader::initializeReaderThread, this, _1, allowVariableLength, maxPathLength), 2);
+        threads_.execute(boost::bind(&FastqLoader::initializeReaderThread, this, _1, allowVariableLength, maxPathLength), paired_ ? 2 : 1);
+        while (indexReaders_.size() < indexFiles)
+        {
+            // index reads are short. One thread is plenty to decompress them
+            indexReaders_.push_back(boost::shared_ptr<FastqReader>(new FastqReader(allowVariableLength, 1, maxPathLength)));
+        }
     }
 
     void open(
@@ -74,67 +84,82 @@ public:
         const boost::filesystem::path &read2Path,
         const char fastqQ0)
     {
+        ISAAC_ASSERT_MSG(readReaders_[1], "FastqLoader was created for single-ended data");
         readReaders_[0]->open(read1Path, fastqQ0);
         readReaders_[1]->open(read2Path, fastqQ0);
         paired_ = true;
     }
 
     /**
-     * \param clusterCount  Maximum number of clusters to load
-     * \param clusterLength Expected cluster length. Will fail if the read cluster length does not match
-     * \param it            Insert iterator for the buffer that is sufficient to load the clusterCount
-     *                      clusters of clusterLength
+     * \param index    0-based index file number
+     */
+    void openIndex(
+        const unsigned index,
+        const boost::filesystem::path &indexPath,
+        const char fastqQ0)
+    {
+        indexReaders_.at(index)->open(indexPath, fastqQ0);
+    }
+
+    /**
+     * \brief Loads clusters as [barcode][read1][read2][name]. The barcode comes either from the index files or
+     *        from the read names of the first read.
+     *
+     * \param clusterCount      Maximum number of clusters to load
+     * \param indexMetadataList One entry per open index file, offset being the position within the barcode
+     * \param nameIndexLength   Number of barcode bases to extract from read names. 0 if the barcode comes
+     *                          from the index files
+     * \param it                Insert iterator for the buffer that is sufficient to load the clusterCount
+     *                          clusters of clusterLength
      *
      * \return Actual number of loaded clusters
      */
     template <typename InsertIt>
-    unsigned loadClusters(unsigned clusterCount, const unsigned nameLengthMax, const flowcell::ReadMetadataList &readMetadataList, InsertIt it)
+    unsigned loadClusters(
+        unsigned clusterCount, const unsigned nameLengthMax,
+        const flowcell::ReadMetadataList &readMetadataList,
+        const flowcell::ReadMetadataList &indexMetadataList,
+        const unsigned nameIndexLength,
+        InsertIt it)
     {
-        if (1 == readMetadataList.size())
-        {
-            return loadSingleRead(*readReaders_[0], clusterCount, readMetadataList.at(0), 0, nameLengthMax, it);
-        }
-        else
-        {
-            ISAAC_ASSERT_MSG(2 == readMetadataList.size(), "Only paired and single-ended data is supported");
-            unsigned readClusters[2] = {0,0};
-            InsertIt it1 = it;
-            if (2 <= inputLoadersMax_)
-            {
-                it += readMetadataList.at(0).getLength();
-                boost::reference_wrapper<InsertIt> insertIterators[] = {boost::ref(it1), boost::ref(it)};
-                threads_.execute(boost::bind(&FastqLoader::threadLoadPairedReads<InsertIt>, this,
-                                            clusterCount, boost::ref(readMetadataList), nameLengthMax,
-                                            boost::ref(readClusters), insertIterators, _1),
-                                 2);
-            }
-            else
+        ISAAC_ASSERT_MSG(1 == readMetadataList.size() || 2 == readMetadataList.size(), "Only paired and single-ended data is supported");
+        ISAAC_ASSERT_MSG(indexReaders_.size() == indexMetadataList.size(), "Expected one index read per index file");
+        ISAAC_ASSERT_MSG(!nameIndexLength || indexMetadataList.empty(), "Barcode must come either from index files or read names");
+        const unsigned readers = readMetadataList.size() + indexMetadataList.size();
+        unsigned readClusters[READERS_MAX] = {0};
+        threads_.execute(
+            [&](const unsigned threadNumber, const unsigned threadsTotal)
             {
-                ISAAC_ASSERT_MSG(1 == inputLoadersMax_, "At least one thread is expected for IO")
-                readClusters[0] = loadSingleRead(*readReaders_[0], clusterCount, readMetadataList.at(0), readMetadataList.at(1).getLength() + nameLengthMax, 0, it1);
-                it += readMetadataList.at(0).getLength();
-                readClusters[1] = loadSingleRead(*readReaders_[1], clusterCount, readMetadataList.at(1), readMetadataList.at(0).getLength(), nameLengthMax, it);
-            }
+                threadLoadReads(clusterCount, readMetadataList, indexMetadataList,
+                                nameIndexLength, nameLengthMax, readClusters, it, threadNumber, threadsTotal);
+            },
+            std::min(readers, inputLoadersMax_));
 
-            if (readClusters[0] != readClusters[1])
+        for (unsigned reader = 1; readers > reader; ++reader)
+        {
+            if (readClusters[0] != readClusters[reader])
             {
-                BOOST_THROW_EXCEPTION(common::IoException(errno, (boost::format("Mismatching number of cluster read for r1/r2 = %d/%d, files: %s/%s") %
-                    readClusters[0] % readClusters[1] % readReaders_[0]->getPath() % readReaders_[1]->getPath()).str()));
+                BOOST_THROW_EXCEPTION(common::IoException(errno, (boost::format("Mismatching number of clusters read %d/%d, files: %s/%s") %
+                    readClusters[0] % readClusters[reader] % readReaders_[0]->getPath() % getReader(readMetadataList, reader).getPath()).str()));
             }
-
-            return readClusters[0];
         }
 
+        return readClusters[0];
     }
 private:
     template <typename InsertIt>
     static unsigned loadSingleRead(FastqReader &reader, unsigned clusterCount,
                             const flowcell::ReadMetadata &readMetadata,
+                            const unsigned nameIndexLength,
                             const unsigned step, const unsigned nameLengthMax, InsertIt &it)
     {
         unsigned clustersToRead = clusterCount;
         for (;clustersToRead && reader.hasData();)
         {
+            if (nameIndexLength)
+            {
+                it = reader.extractNameIndex(nameIndexLength, it);
+            }
             it = reader.extractBcl(readMetadata, it);
             if (nameLengthMax)
             {
@@ -151,36 +176,59 @@ private:
         return clusterCount - clustersToRead;
     }
 
+    FastqReader &getReader(const flowcell::ReadMetadataList &readMetadataList, const unsigned reader)
+    {
+        return readMetadataList.size() > reader ?
+            *readReaders_.at(reader) : *indexReaders_.at(reader - readMetadataList.size());
+    }
+
+    /**
+     * \brief Each thread takes every threadsTotal'th reader. The data readers go first, then the index readers.
+     */
     template <typename InsertIt>
-    void threadLoadPairedReads(unsigned clusterCount,
-                              const flowcell::ReadMetadataList &readMetadataList,
-                              const unsigned nameLengthMax,
-                              unsigned readClusters[2],
-                              boost::reference_wrapper<InsertIt> insertIterators[2],
-                              const int threadNumber)
+    void threadLoadReads(unsigned clusterCount,
+                         const flowcell::ReadMetadataList &readMetadataList,
+                         const flowcell::ReadMetadataList &indexMetadataList,
+                         const unsigned nameIndexLength,
+                         const unsigned nameLengthMax,
+                         unsigned readClusters[READERS_MAX],
+                         const InsertIt clustersBegin,
+                         const unsigned threadNumber,
+                         const unsigned threadsTotal)
     {
-        ISAAC_ASSERT_MSG(threadNumber < 2, "Only two threads are allowed to read paired data");
-        if(!threadNumber)
+        const unsigned barcodeLength = nameIndexLength + flowcell::getTotalReadLength(indexMetadataList);
+        const unsigned clusterLength = barcodeLength + flowcell::getTotalReadLength(readMetadataList) + nameLengthMax;
+        const unsigned readers = readMetadataList.size() + indexMetadataList.size();
+        for (unsigned reader = threadNumber; readers > reader; reader += threadsTotal)
         {
-            readClusters[0] = loadSingleRead(
-                *readReaders_[0],
-                clusterCount, readMetadataList.at(0),
-                readMetadataList.at(1).getLength() + nameLengthMax, 0,
-                insertIterators[0].get());
-        }
-        else
-        {
-            readClusters[1] = loadSingleRead(
-                *readReaders_[1],
-                clusterCount, readMetadataList.at(1),
-                readMetadataList.at(0).getLength(), nameLengthMax,
-                insertIterators[1].get());
+            InsertIt it = clustersBegin;
+            unsigned clusterBytes = 0;
+            if (readMetadataList.size() > reader)
+            {
+                const flowcell::ReadMetadata &readMetadata = readMetadataList.at(reader);
+                const unsigned readNameIndexLength = reader ? 0 : nameIndexLength;
+                const unsigned readNameLength = readMetadataList.size() - 1 == reader ? nameLengthMax : 0;
+                it += readNameIndexLength ? 0 : barcodeLength + readMetadata.getOffset();
+                clusterBytes = readNameIndexLength + readMetadata.getLength() + readNameLength;
+                readClusters[reader] = loadSingleRead(
+                    *readReaders_.at(reader), clusterCount, readMetadata,
+                    readNameIndexLength, clusterLength - clusterBytes, readNameLength, it);
+            }
+            else
+            {
+                const flowcell::ReadMetadata &indexMetadata = indexMetadataList.at(reader - readMetadataList.size());
+                it += indexMetadata.getOffset();
+                clusterBytes = indexMetadata.getLength();
+                readClusters[reader] = loadSingleRead(
+                    *indexReaders_.at(reader - readMetadataList.size()), clusterCount, indexMetadata,
+                    0, clusterLength - clusterBytes, 0, it);
+            }
         }
     }
 
     void initializeReaderThread(const int threadNumber, const bool allowVariableLength, const std::size_t maxPathLength)
     {
-        readReaders_.at(threadNumber).reset(new FastqReader(allowVariableLength, std::max(1U, inputLoadersMax_/2), maxPathLength));
+        readReaders_.at(threadNumber).reset(new FastqReader(allowVariableLength, paired_ ? std::max(1U, inputLoadersMax_/2) : inputLoadersMax_, maxPathLength));
     }
 };
 
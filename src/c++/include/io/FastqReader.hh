@@ -27,6 +27,7 @@
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread.hpp>
 
 #include "../common/StaticVector.hh"
 #include "bgzf/BgzfReader.hh"
@@ -61,6 +62,10 @@ public:
     // give each thread a chance to unpack a sensible number of bgzf blocks. Otherwise thread synchronization
     // slows the whole thing down
     static const unsigned BGZF_BLOCKS_PER_THREAD = 1024;
+    // bcl quality given to the index bases taken from the read name
+    static const unsigned char NAME_INDEX_QUALITY = 30;
+    // amount of plain gzip data inflated ahead while the previous one is being parsed
+    static const std::size_t GZIP_READ_AHEAD_BYTES = 4 * 1024 * 1024;
 
 private:
     const std::size_t uncompressedBufferSize_;
@@ -89,10 +94,26 @@ private:
     BufferType::const_iterator endIt_;
     bool zeroLengthRead_;
 
+    // plain gzip data inflated by readAheadThread_ while buffer_ is being parsed. Allocated on first plain gzip input
+    BufferType readAheadBuffer_;
+    std::size_t readAheadSize_;
+    std::size_t readAheadOffset_;
+    bool readAheadEof_;
+    boost::exception_ptr readAheadException_;
+
+    // single worker for the lifetime of the reader. Started on first plain gzip input
+    boost::mutex readAheadMutex_;
+    boost::condition_variable readAheadStateChangedCondition_;
+    std::istream *readAheadStream_;
+    bool readAheadRequested_;
+    bool readAheadTerminateRequested_;
+    boost::thread readAheadThread_;
+
     static const oligo::Translator<true, INCORRECT_FASTQ_BASE> translator_;
 
 public:
     FastqReader(const bool allowVariableLength, const unsigned threadsMax, const std::size_t maxPathLength);
+    ~FastqReader();
 
     void open(const boost::filesystem::path &fastqPath, const char q0Base);
 
@@ -104,6 +125,9 @@ public:
     template <typename InsertIt>
     InsertIt extractReadName(const unsigned nameLengthMax, InsertIt it) const;
 
+    template <typename InsertIt>
+    InsertIt extractNameIndex(const unsigned indexLength, InsertIt it) const;
+
     const std::string getPath() const
     {
         return boost::filesystem::path(fastqPath_).string();
@@ -125,6 +149,9 @@ public:
         return std::make_pair(headerBegin_, headerEnd_);
     }
 
+    /// \return false and empty indexLengths if the header does not end with a well-formed index
+    static bool parseNameIndex(IteratorPair header, std::vector<unsigned> &indexLengths);
+
     unsigned getReadLength() const
     {
         return std::distance(baseCallsBegin_, baseCallsEnd_);
@@ -141,6 +168,10 @@ private:
     void findQScoresEnd();
     bool fetchMore();
 
+    void inflateAhead(std::istream &is);
+    void readAheadThreadFunc();
+    void requestReadAhead(std::istream &is);
+    void waitForReadAhead();
     std::size_t readCompressedFastq(std::istream &is, char *buffer, std::size_t amount);
     std::size_t readBgzfFastq(std::istream &is, char *buffer, std::size_t amount);
     std::size_t readFlatFastq(std::istream &is, char *buffer, std::size_t amount);
@@ -240,6 +271,32 @@ InsertIt FastqReader::extractReadName(const unsigned nameLengthMax, InsertIt it)
     return it;
 }
 
+/**
+ * \brief retrieve the index bases from a CASAVA 1.8 header such as '@name 1:N:0:ACGTACGT+TTGGCCAA' in bcl format.
+ *        Components are concatenated. Pad up to indexLength with 0 (N)
+ *
+ * \return it + indexLength
+ */
+template <typename InsertIt>
+InsertIt FastqReader::extractNameIndex(const unsigned indexLength, InsertIt it) const
+{
+    const BufferType::const_iterator indexBegin = std::find(
+        std::reverse_iterator<BufferType::const_iterator>(headerEnd_),
+        std::reverse_iterator<BufferType::const_iterator>(headerBegin_), ':').base();
+    unsigned extracted = 0;
+    for (BufferType::const_iterator baseIt = headerBegin_ == indexBegin ? headerEnd_ : indexBegin; headerEnd_ != baseIt && indexLength != extracted; ++baseIt)
+    {
+        if ('+' == *baseIt)
+        {
+            continue;
+        }
+        const unsigned char baseValue = translator_[*baseIt];
+        *it++ = (oligo::INVALID_OLIGO <= baseValue) ? 0 : (baseValue | (NAME_INDEX_QUALITY << 2));
+        ++extracted;
+    }
+    return std::fill_n(it, indexLength - extracted, 0);
+}
+
 } // namespace io
 } // namespace isaac
 
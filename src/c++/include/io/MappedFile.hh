@@ -0,0 +1,153 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file MappedFile.hh
+ **
+ ** Read-only memory mapping of a whole file.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_IO_MAPPED_FILE_HH
+#define iSAAC_IO_MAPPED_FILE_HH
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "common/Exceptions.hh"
+
+namespace isaac
+{
+namespace io
+{
+
+class MappedFile : boost::noncopyable
+{
+public:
+    MappedFile() : mapping_(0), mappingSize_(0), data_(0), size_(0)
+    {
+    }
+
+    ~MappedFile()
+    {
+        unmap();
+    }
+
+    /**
+     * \brief maps the file and asks the kernel to start reading it in the background
+     *
+     * \param willNeed if true, the pages are prefetched asynchronously so that the io overlaps
+     *                 with whatever happens before the data is accessed
+     */
+    void map(const boost::filesystem::path &filePath, const bool willNeed)
+    {
+        mapRange(filePath, 0, std::numeric_limits<std::size_t>::max(), willNeed ? MADV_WILLNEED : MADV_NORMAL);
+    }
+
+    /**
+     * \brief maps length bytes of the file starting at offset for a single forward scan.
+     *        The kernel is told to read ahead aggressively and drop the pages behind the scan.
+     *
+     * \postcondition data() points at offset, size() is length or the number of bytes to the end of the file,
+     *                whichever is smaller
+     */
+    void mapRange(const boost::filesystem::path &filePath, const std::size_t offset, const std::size_t length)
+    {
+        mapRange(filePath, offset, length, MADV_SEQUENTIAL);
+    }
+
+    void unmap()
+    {
+        if (mapping_)
+        {
+            ::munmap(mapping_, mappingSize_);
+            mapping_ = 0;
+        }
+        mappingSize_ = 0;
+        data_ = 0;
+        size_ = 0;
+    }
+
+    bool isMapped() const {return 0 != data_;}
+    const char *data() const {return data_;}
+    std::size_t size() const {return size_;}
+
+private:
+    void *mapping_;
+    std::size_t mappingSize_;
+    const char *data_;
+    std::size_t size_;
+
+    void mapRange(
+        const boost::filesystem::path &filePath, const std::size_t offset, const std::size_t length, const int advice)
+    {
+        unmap();
+        const int fd = ::open(filePath.c_str(), O_RDONLY);
+        if (-1 == fd)
+        {
+            BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open file " + filePath.string()));
+        }
+        struct stat st;
+        if (-1 == ::fstat(fd, &st))
+        {
+            const int error = errno;
+            ::close(fd);
+            BOOST_THROW_EXCEPTION(common::IoException(error, "Failed to stat file " + filePath.string()));
+        }
+        if (std::size_t(st.st_size) < offset)
+        {
+            ::close(fd);
+            BOOST_THROW_EXCEPTION(common::IoException(EINVAL, (boost::format(
+                "Offset %d is past the end of file %s") % offset % filePath.string()).str()));
+        }
+        // mmap offset must be page-aligned. Only the requested range gets mapped, so that large files don't
+        // eat into the address space limit
+        const std::size_t mappingOffset = offset - offset % ::sysconf(_SC_PAGESIZE);
+        const std::size_t rangeSize = std::min<std::size_t>(length, st.st_size - offset);
+        mappingSize_ = rangeSize ? offset + rangeSize - mappingOffset : 0;
+        if (mappingSize_)
+        {
+            void *mapping = ::mmap(0, mappingSize_, PROT_READ, MAP_SHARED, fd, mappingOffset);
+            if (MAP_FAILED == mapping)
+            {
+                const int error = errno;
+                ::close(fd);
+                mappingSize_ = 0;
+                BOOST_THROW_EXCEPTION(common::IoException(error, "Failed to map file " + filePath.string()));
+            }
+            mapping_ = mapping;
+            data_ = static_cast<const char*>(mapping) + (offset - mappingOffset);
+            size_ = rangeSize;
+            if (MADV_NORMAL != advice)
+            {
+                // advisory only, failure is not an error
+                ::madvise(mapping, mappingSize_, advice);
+            }
+        }
+        // the mapping stays valid after the descriptor is closed
+        ::close(fd);
+    }
+};
+
+} // namespace io
+} // namespace isaac
+
+#endif // #ifndef iSAAC_IO_MAPPED_FILE_HH
@@ -0,0 +1,154 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file Minimizer.hh
+ **
+ ** \brief (w,k)-minimizer selection from a stream of k-mers.
+ **
+ ** A k-mer is a minimizer if it has the lowest order among the k-mers starting within a window of
+ ** w consecutive positions. Any w consecutive k-mers shared by a read and the reference produce the same
+ ** minimizer on both, which allows sampling the reference hash without losing exact seed matches. The
+ ** order is computed on the canonical k-mer, so that reverse-complemented reads select the same
+ ** positions as the forward strand of the reference.
+ **/
+
+#ifndef iSAAC_OLIGO_MINIMIZER_HH
+#define iSAAC_OLIGO_MINIMIZER_HH
+
+#include <boost/array.hpp>
+
+#include "common/Debug.hh"
+#include "oligo/Kmer.hh"
+
+namespace isaac
+{
+namespace oligo
+{
+
+/**
+ * \brief Order of the k-mer for the purpose of minimizer selection. Scrambles the canonical k-mer bits
+ *        so that low-complexity k-mers such as poly-A don't get selected preferentially.
+ */
+template <typename KmerT>
+inline uint64_t minimizerOrder(const KmerT &kmer)
+{
+    const KmerT reverse = reverseComplement(kmer);
+    uint64_t key = (reverse < kmer) ? reverse.bits_ : kmer.bits_;
+    // Thomas Wang's 64 bit integer hash. Invertible, so distinct k-mers never get the same order.
+    key = (~key) + (key << 21);
+    key ^= key >> 24;
+    key = (key + (key << 3)) + (key << 8);
+    key ^= key >> 14;
+    key = (key + (key << 2)) + (key << 4);
+    key ^= key >> 28;
+    key += key << 31;
+    return key;
+}
+
+template <typename KmerT>
+class MinimizerWindow
+{
+public:
+    static const unsigned WINDOW_MAX = 64;
+
+    /**
+     * \param window number of consecutive k-mer positions each minimizer is selected from
+     */
+    explicit MinimizerWindow(const unsigned window) :
+        window_(window), head_(0), size_(0), firstPosition_(0), started_(false), lastPosition_(NO_POSITION)
+    {
+        ISAAC_ASSERT_MSG(window_ && WINDOW_MAX >= window_, "Minimizer window must be within 1 and " << WINDOW_MAX << " got " << window_);
+    }
+
+    void reset()
+    {
+        head_ = 0;
+        size_ = 0;
+        started_ = false;
+        lastPosition_ = NO_POSITION;
+    }
+
+    /**
+     * \brief Adds the next k-mer. Positions must be strictly increasing. Gaps in positions (due to k-mers
+     *        containing Ns or low quality bases) are allowed.
+     *
+     * \return true if the window ending at position has a minimizer that has not been reported before.
+     *         In this case minimizer and minimizerPosition are updated.
+     */
+    bool push(const KmerT &kmer, const uint64_t position, KmerT &minimizer, uint64_t &minimizerPosition)
+    {
+        if (!started_)
+        {
+            firstPosition_ = position;
+            started_ = true;
+        }
+
+        while (size_ && at(0).position_ + window_ <= position)
+        {
+            head_ = (head_ + 1) % WINDOW_MAX;
+            --size_;
+        }
+
+        const uint64_t order = minimizerOrder(kmer);
+        // keep the leftmost of equal orders
+        while (size_ && at(size_ - 1).order_ > order)
+        {
+            --size_;
+        }
+        Entry &entry = at(size_++);
+        entry.order_ = order;
+        entry.kmer_ = kmer;
+        entry.position_ = position;
+
+        if (position + 1 < firstPosition_ + window_)
+        {
+            // window is not complete yet
+            return false;
+        }
+
+        const Entry &front = at(0);
+        if (front.position_ == lastPosition_)
+        {
+            return false;
+        }
+        lastPosition_ = front.position_;
+        minimizer = front.kmer_;
+        minimizerPosition = front.position_;
+        return true;
+    }
+
+private:
+    static const uint64_t NO_POSITION = -1UL;
+
+    struct Entry
+    {
+        Entry() : order_(0), kmer_(0), position_(0) {}
+        uint64_t order_;
+        KmerT kmer_;
+        uint64_t position_;
+    };
+
+    const unsigned window_;
+    boost::array<Entry, WINDOW_MAX> entries_;
+    unsigned head_;
+    unsigned size_;
+    uint64_t firstPosition_;
+    bool started_;
+    uint64_t lastPosition_;
+
+    Entry &at(const unsigned i) {return entries_[(head_ + i) % WINDOW_MAX];}
+};
+
+} // namespace oligo
+} // namespace isaac
+
+#endif // #ifndef iSAAC_OLIGO_MINIMIZER_HH
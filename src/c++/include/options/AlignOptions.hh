@@ -193,6 +193,12 @@ public:
     workflow::AlignWorkflow::OptionalFeatures optionalFeatures;
     bool pessimisticMapQ;
     unsigned detectTemplateBlockSize;
+    unsigned seedMatchCacheSize;
+    bool adaptiveSeeds;
+    unsigned minimizerWindow;
+    bool sharedReferenceHash;
+    unsigned traceSlowestClusters;
+    unsigned progressInterval;
     bool disableResume;
 };
 
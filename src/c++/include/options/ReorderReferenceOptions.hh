@@ -38,6 +38,7 @@ public:
     std::vector<std::string> newOrder_;
     boost::filesystem::path newXmlPath_;
     boost::filesystem::path newDataDirectory_;
+    bool contigImage_;
 
 public:
     ReorderReferenceOptions();
@@ -0,0 +1,118 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file ContigImage.hh
+ **
+ ** Binary image of the translated contig bases stored next to the sorted reference fasta.
+ **
+ ** The image holds the exact bytes loadContig produces for each contig. It is a header, then
+ ** a table of entries sorted by fasta offset, then the contig bases. Each contig starts on a
+ ** page boundary. The image is mapped shared, so concurrent processes on one node read the
+ ** same page cache, and a contig is loaded with a single copy.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_REFERENCE_CONTIG_IMAGE_HH
+#define iSAAC_REFERENCE_CONTIG_IMAGE_HH
+
+#include <boost/filesystem.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/ptr_container/ptr_map.hpp>
+
+#include "io/MappedFile.hh"
+#include "reference/Contig.hh"
+#include "reference/SortedReferenceMetadata.hh"
+
+namespace isaac
+{
+namespace reference
+{
+
+namespace contigImage
+{
+
+static const char MAGIC[8] = {'i', 'S', 'A', 'A', 'C', 'C', 'I', 0};
+static const unsigned VERSION = 2;
+static const std::size_t CONTIG_ALIGNMENT = 4096;
+
+struct Header
+{
+    char magic_[sizeof(MAGIC)];
+    uint32_t version_;
+    uint32_t contigs_;
+    // size of the fasta the image was made from. Catches the fasta being replaced without its timestamp changing
+    uint64_t fastaSize_;
+};
+
+struct Entry
+{
+    uint64_t fastaOffset_;
+    uint64_t totalBases_;
+    uint64_t acgtBases_;
+    uint64_t imageOffset_;
+};
+
+} // namespace contigImage
+
+/**
+ * \return path of the contig image that belongs to the fasta file
+ */
+inline boost::filesystem::path getContigImagePath(const boost::filesystem::path &fastaPath)
+{
+    return fastaPath.string() + ".img";
+}
+
+/**
+ * \brief stores the bases of the contigs that come from one fasta file into getContigImagePath(fastaPath)
+ *
+ * \param xmlContigs    contigs of fastaPath. All of them must be loaded in contigList
+ */
+void saveContigImage(
+    const boost::filesystem::path &fastaPath,
+    const SortedReferenceMetadata::Contigs &xmlContigs,
+    const ContigList &contigList);
+
+/**
+ * \brief Maps the images of all fasta files the contigs refer to. Fasta files without an image, or
+ *        with an image older than the fasta or made from a fasta of a different size, are ignored.
+ */
+class ContigImages : boost::noncopyable
+{
+public:
+    explicit ContigImages(const SortedReferenceMetadata::Contigs &xmlContigs);
+
+    /**
+     * \return false if the contig is not in any image. In that case the contig has to be loaded from fasta.
+     */
+    bool load(
+        const SortedReferenceMetadata::Contig &xmlContig,
+        ContigList::UpdateRange &contig) const;
+
+private:
+    struct Image
+    {
+        Image() : entriesBegin_(0), entriesEnd_(0){}
+        io::MappedFile file_;
+        const contigImage::Entry *entriesBegin_;
+        const contigImage::Entry *entriesEnd_;
+    };
+
+    boost::ptr_map<boost::filesystem::path, Image> images_;
+
+    static bool open(const boost::filesystem::path &fastaPath, Image &image);
+};
+
+} // namespace reference
+} // namespace isaac
+
+#endif // #ifndef iSAAC_REFERENCE_CONTIG_IMAGE_HH
@@ -24,6 +24,7 @@
 
 #include "common/Threads.hpp"
 #include "reference/Contig.hh"
+#include "reference/ContigImage.hh"
 #include "reference/SortedReferenceMetadata.hh"
 
 namespace isaac
@@ -31,14 +32,25 @@ namespace isaac
 namespace reference
 {
 
+/**
+ * \brief Translates a run of fasta bases that contains no line breaks. acgt are upper-cased, any
+ *        other letter becomes REFERENCE_OLIGO_N.
+ *
+ * \param acgtBases incremented by the number of ACGT bases in the run
+ *
+ * \return false if the run contains anything other than letters
+ */
+bool translateBases(const char *begin, const char *end, char *out, std::size_t &acgtBases);
+
 void loadContig(
     const reference::SortedReferenceMetadata::Contig &xmlContig,
     ContigList::UpdateRange &contig);
 
 template <typename ShouldLoadF> void loadContigsParallel(
     ShouldLoadF &shouldLoad,
-    std::vector<reference::SortedReferenceMetadata::Contig>::const_iterator &nextContigToLoad,
-    const std::vector<reference::SortedReferenceMetadata::Contig>::const_iterator contigsEnd,
+    std::vector<const reference::SortedReferenceMetadata::Contig *>::const_iterator &nextContigToLoad,
+    const std::vector<const reference::SortedReferenceMetadata::Contig *>::const_iterator contigsEnd,
+    const ContigImages &contigImages,
     reference::ContigList &contigList,
     boost::mutex &mutex)
 {
@@ -46,13 +58,15 @@ template <typename ShouldLoadF> void loadContigsParallel(
     boost::lock_guard<boost::mutex> lock(mutex);
     while (contigsEnd != nextContigToLoad)
     {
-        const std::vector<reference::SortedReferenceMetadata::Contig>::const_iterator ourContig = nextContigToLoad++;
-        if (shouldLoad(*ourContig))
+        const reference::SortedReferenceMetadata::Contig &xmlContig = **nextContigToLoad++;
+        if (shouldLoad(xmlContig))
         {
             common::unlock_guard<boost::mutex> unlock(mutex);
-            const reference::SortedReferenceMetadata::Contig &xmlContig = *ourContig;
-            ContigList::UpdateRange rwContig = contigList.getUpdateRange(ourContig->index_);
-            loadContig(xmlContig, rwContig);
+            ContigList::UpdateRange rwContig = contigList.getUpdateRange(xmlContig.index_);
+            if (!contigImages.load(xmlContig, rwContig))
+            {
+                loadContig(xmlContig, rwContig);
+            }
             if (!(xmlContig.index_ % traceStep))
             {
                 ISAAC_THREAD_CERR << (boost::format("Contig(%3d:%8d) %s : %s\n") % xmlContig.index_ % xmlContig.totalBases_ % xmlContig.name_ % xmlContig.filePath_).str();
@@ -68,7 +82,8 @@ template <typename ShouldLoadF> void loadContigsParallel(
 }
 
 /**
- * \brief loads the fasta file contigs into memory on multiple threads unless shouldLoad(contig->index_) returns false
+ * \brief loads the fasta file contigs into memory on multiple threads unless shouldLoad(contig->index_) returns false.
+ *        Contigs found in the contig image of their fasta file are copied from the image.
  */
 template <typename ShouldLoadF> reference::ContigList loadContigs(
     const reference::SortedReferenceMetadata::Contigs &xmlContigs,
@@ -77,12 +92,24 @@ template <typename ShouldLoadF> reference::ContigList loadContigs(
     common::ThreadVector &loadThreads)
 {
     reference::ContigList ret(xmlContigs, spacing);
-    std::vector<reference::SortedReferenceMetadata::Contig>::const_iterator nextContigToLoad = xmlContigs.begin();
+    // largest first so that a long contig does not end up being loaded by a single thread while the others are idle
+    std::vector<const reference::SortedReferenceMetadata::Contig *> loadOrder;
+    loadOrder.reserve(xmlContigs.size());
+    for (const reference::SortedReferenceMetadata::Contig &xmlContig : xmlContigs)
+    {
+        loadOrder.push_back(&xmlContig);
+    }
+    std::stable_sort(loadOrder.begin(), loadOrder.end(),
+                     [](const reference::SortedReferenceMetadata::Contig *left, const reference::SortedReferenceMetadata::Contig *right)
+                     {return left->totalBases_ > right->totalBases_;});
+    std::vector<const reference::SortedReferenceMetadata::Contig *>::const_iterator nextContigToLoad = loadOrder.begin();
+    const ContigImages contigImages(xmlContigs);
     boost::mutex mutex;
     loadThreads.execute(boost::bind(&loadContigsParallel<ShouldLoadF>,
                                     boost::ref(shouldLoad),
                                     boost::ref(nextContigToLoad),
-                                    xmlContigs.end(),
+                                    loadOrder.cend(),
+                                    boost::cref(contigImages),
                                     boost::ref(ret),
                                     boost::ref(mutex)));
 
@@ -44,7 +44,8 @@ public:
     typedef std::vector<Offset, ReferenceOffsetAllocator> Positions;
     typedef KmerType KmerT;
     static const unsigned SEED_LENGTH = oligo::KmerTraits<KmerT>::KMER_BASES;
-    typedef typename Positions::const_iterator const_iterator;
+    // lookups go through raw pointers so that the same type can serve a hash that lives in shared memory
+    typedef const Offset *const_iterator;
     typedef std::pair<const_iterator, const_iterator> MatchRange;
     typedef void value_type;// compatibility with std containers for numa replications
 
@@ -70,7 +71,7 @@ public:
     }
 
     ReferenceHash(const uint64_t bucketCount)
-        : a_(3308323), b_(7048005), largePrime_(1699023365707), bucketCount_(bucketCount), offsets_(bucketCount_, 0)
+        : a_(3308323), b_(7048005), largePrime_(1699023365707), bucketCount_(bucketCount), minimizerWindow_(0), offsets_(bucketCount_, 0)
     {
         if (!bucketCount_)
         {
@@ -83,22 +84,39 @@ public:
                     typeid(KeyT).name() % std::numeric_limits<KeyT>::max()
             ).str()));
         }
+        updateView();
 //        ISAAC_THREAD_CERR << "ReferenceHash()" << std::endl;
     }
 
+    /**
+     * \brief read-only hash over offsets and positions stored elsewhere. The storage must outlive the hash
+     */
+    ReferenceHash(
+        const uint64_t a, const uint64_t b, const uint64_t largePrime, const uint64_t bucketCount,
+        const unsigned minimizerWindow, const Offset *offsets, const Offset *positions, const std::size_t positionsCount)
+        : a_(a), b_(b), largePrime_(largePrime), bucketCount_(bucketCount), minimizerWindow_(minimizerWindow),
+          offsetsView_(offsets), positionsView_(positions), positionsViewSize_(positionsCount)
+    {
+    }
+
     ReferenceHash(ReferenceHash &&that, const AllocatorT &allocator = AllocatorT())
-        : a_(that.a_), b_(that.b_), largePrime_(that.largePrime_), bucketCount_(that.bucketCount_)
+        : a_(that.a_), b_(that.b_), largePrime_(that.largePrime_), bucketCount_(that.bucketCount_), minimizerWindow_(that.minimizerWindow_)
     {
         offsets_.swap(that.offsets_);
         positions_.swap(that.positions_);
+        // the buffers move with the swap, so the view stays valid. This also covers hashes over external storage
+        offsetsView_ = that.offsetsView_;
+        positionsView_ = that.positionsView_;
+        positionsViewSize_ = that.positionsViewSize_;
 //        ISAAC_THREAD_CERR << "ReferenceHash(ReferenceHash &&that, allocator)" << std::endl;
     }
 
     ReferenceHash(const ReferenceHash &that, const AllocatorT &allocator)
-        : a_(that.a_), b_(that.b_), largePrime_(that.largePrime_), bucketCount_(that.bucketCount_)
-        , offsets_(that.offsets_, allocator)
-        , positions_(that.positions_, allocator)
+        : a_(that.a_), b_(that.b_), largePrime_(that.largePrime_), bucketCount_(that.bucketCount_), minimizerWindow_(that.minimizerWindow_)
+        , offsets_(that.offsetsView_, that.offsetsView_ + that.bucketCount_, allocator)
+        , positions_(that.positionsView_, that.positionsView_ + that.positionsViewSize_, allocator)
     {
+        updateView();
 //        ISAAC_THREAD_CERR << "ReferenceHash(ReferenceHash &that, allocator)" << std::endl;
     }
 //
@@ -132,12 +150,12 @@ public:
     MatchRange iSAAC_PROFILING_NOINLINE findMatches(const KmerT &kmer) const
     {
         const KeyT key = keyFromKmer(kmer);
-        Offset positionsBegin = !key ? 0 : offsets_[key - 1];
-        Offset positionsEnd = offsets_[key];
-        ISAAC_ASSERT_MSG(positionsBegin <= positions_.size(), "Positions buffer overrun by positionsBegin:" << positionsBegin << " for kmer " << kmer);
+        Offset positionsBegin = !key ? 0 : offsetsView_[key - 1];
+        Offset positionsEnd = offsetsView_[key];
+        ISAAC_ASSERT_MSG(positionsBegin <= positionsViewSize_, "Positions buffer overrun by positionsBegin:" << positionsBegin << " for kmer " << kmer);
         ISAAC_ASSERT_MSG(positionsBegin <= positionsEnd, "positionsEnd:" << positionsEnd << " overrun by positionsBegin:" << positionsBegin << " for kmer " << kmer);
 
-        const MatchRange ret = std::make_pair(positions_.begin() + positionsBegin, positions_.begin() + positionsEnd);
+        const MatchRange ret = std::make_pair(positionsView_ + positionsBegin, positionsView_ + positionsEnd);
 
     //    ISAAC_THREAD_CERR << "found " << std::distance(ret.first, ret.second) << " matches for " << oligo::Bases<oligo::BITS_PER_BASE, KmerT>(kmer, oligo::KmerTraits<KmerT>::KMER_BASES) << std::endl;
     //    BOOST_FOREACH(const ReferencePosition &pos, ret)
@@ -149,22 +167,40 @@ public:
 
     MatchRange getEmptyRange() const
     {
-        return std::make_pair(positions_.end(), positions_.end());
+        return std::make_pair(positionsView_ + positionsViewSize_, positionsView_ + positionsViewSize_);
     }
 
+    const Offset *offsetsData() const {return offsetsView_;}
+    const Offset *positionsData() const {return positionsView_;}
+    std::size_t getPositionsCount() const {return positionsViewSize_;}
+
     uint64_t getBucketCount() const {return bucketCount_;}
     uint64_t getA() const {return a_;}
     uint64_t getB() const {return b_;}
     uint64_t getLargePrime() const {return largePrime_;}
+    /// 0 if all reference k-mers are hashed, otherwise the window of the minimizer sampling
+    unsigned getMinimizerWindow() const {return minimizerWindow_;}
 private:
     uint64_t a_;
     uint64_t b_;
     uint64_t largePrime_;
     uint64_t bucketCount_;
+    unsigned minimizerWindow_;
     Offsets offsets_;
 //    std::vector<KmerT> uniqueKmers_;
     Positions positions_;
 
+    const Offset *offsetsView_;
+    const Offset *positionsView_;
+    std::size_t positionsViewSize_;
+
+    void updateView()
+    {
+        offsetsView_ = &offsets_.front();
+        positionsView_ = positions_.empty() ? 0 : &positions_.front();
+        positionsViewSize_ = positions_.size();
+    }
+
     friend class ReferenceHasher<MyT>;
 };
 
@@ -45,7 +45,12 @@ class ReferenceHasher
     static const std::size_t THREAD_BUFFER_KMERS_MAX = 8192; // arbitrary number that reduces the cost/benefit of acquiring a mutex
 public:
 
-    ReferenceHasher(const ContigList &contigList, common::ThreadVector &threads, const unsigned threadsMax);
+    /**
+     * \param minimizerWindow when not 0, only the (minimizerWindow,k)-minimizers of the reference are hashed
+     */
+    ReferenceHasher(
+        const ContigList &contigList, common::ThreadVector &threads, const unsigned threadsMax,
+        const unsigned minimizerWindow = 0);
 
     ReferenceHashT generate(const uint64_t bucketCount);
     void generate(ReferenceHashT &ret);
@@ -54,6 +59,7 @@ private:
     const ContigList &contigList_;
     common::ThreadVector &threads_;
     const unsigned threadsMax_;
+    const unsigned minimizerWindow_;
 
     boost::ptr_vector<boost::mutex> mutexes_;
     typedef std::pair<typename ReferenceHashT::KmerT, ContigList::Offset> KmerWithPosition;
@@ -95,6 +101,9 @@ private:
 
     typename ReferenceHashT::KeyT mutexIdFromKey(const typename ReferenceHashT::KeyT key) const;
     void dumpDistribution(ReferenceHashT& ret);
+
+    template <typename CallbackT>
+    void generateKmers(const unsigned threadNumber, const std::size_t threads, const CallbackT &callback) const;
 };
 
 } // namespace reference
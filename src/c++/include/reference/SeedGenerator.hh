@@ -21,6 +21,7 @@
 #define ISAAC_REFERENCE_SEED_GENERATOR_HH
 
 #include "oligo/KmerGenerator.hpp"
+#include "oligo/Minimizer.hh"
 #include "reference/Contig.hh"
 #include "reference/Seed.hh"
 
@@ -48,6 +49,16 @@ protected:
         const std::size_t threads,
         const CallbackT &callback) const;
 
+    /**
+     * \brief same as thread but only produces the (window,k)-minimizers
+     */
+    template <typename CallbackT>
+    void minimizerThread(
+        const unsigned threadNumber,
+        const std::size_t threads,
+        const unsigned window,
+        const CallbackT &callback) const;
+
 private:
     /// index-ordered list of contigs
     const reference::ContigList &contigList_;
@@ -92,6 +103,51 @@ void SeedGeneratorThread<KmerT>::thread(
     }
 }
 
+template <typename KmerT>
+template <typename CallbackT>
+void SeedGeneratorThread<KmerT>::minimizerThread(
+    const unsigned threadNumber,
+    const std::size_t threads,
+    const unsigned window,
+    const CallbackT &callback) const
+{
+    typedef Seed<KmerT> SeedT;
+    BOOST_STATIC_ASSERT_MSG(1 == SeedT::STEP, "Minimizers are only implemented for contiguous seeds");
+    for (const ContigList::Contig &contig : contigList_)
+    {
+        const std::size_t threadSectionLength = (contig.size() + threads - 1) / threads;
+
+        const std::size_t ownBeginOffset = threadSectionLength * threadNumber;
+        if (contig.size() >= ownBeginOffset + SeedT::SEED_LENGTH)
+        {
+            const std::size_t ownEndOffset = std::min(contig.size(), ownBeginOffset + threadSectionLength);
+            // windows containing the k-mers owned by this thread start and end beyond the thread section.
+            // Minimizers outside the section are reported by the neighbor threads.
+            const std::size_t beginGenomicOffset = ownBeginOffset - std::min<std::size_t>(ownBeginOffset, window - 1);
+            const std::size_t endGenomicOffset = std::min(contig.size(), ownEndOffset + window - 1 + SeedT::SEED_LENGTH - SeedT::STEP);
+
+            oligo::InterleavedKmerGenerator<SeedT::KMER_BASES, typename SeedT::KmerType, ContigList::Contig::const_iterator, SeedT::STEP> kmerGenerator(
+                contig.begin() + beginGenomicOffset,
+                contig.begin() + endGenomicOffset);
+            oligo::MinimizerWindow<typename SeedT::KmerType> minimizerWindow(window);
+
+            typename SeedT::KmerType kmer(0);
+            typename SeedT::KmerType minimizer(0);
+            uint64_t minimizerPosition = 0;
+            ContigList::Contig::const_iterator it;
+            while (kmerGenerator.next(kmer, it))
+            {
+                const uint64_t kmerPosition = std::distance(contig.begin(), it);
+                if (minimizerWindow.push(kmer, kmerPosition, minimizer, minimizerPosition) &&
+                    ownBeginOffset <= minimizerPosition && ownEndOffset > minimizerPosition)
+                {
+                    callback(threadNumber, minimizer, contig.getIndex(), minimizerPosition, false);
+                }
+            }
+        }
+    }
+}
+
 } // namespace reference
 } // namespace isaac
 
@@ -0,0 +1,188 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file SharedReferenceHash.hh
+ **
+ ** Reference hash kept in a POSIX shared memory segment so that concurrent processes aligning
+ ** against the same reference keep one copy of it.
+ **
+ ** The segment is named after a checksum of the contig layout and the hashing parameters.
+ ** The process that creates it builds the hash and holds an exclusive flock on the segment
+ ** until the data is complete. Every other process waits for a shared flock, then validates
+ ** the header. Each attached process keeps its shared lock, and that is the reference count.
+ ** A process that can take the exclusive lock on detach is the last user, and it unlinks the
+ ** segment. Locks go away with the process, so a crashed user does not keep the segment alive
+ ** and a crashed builder leaves a segment that the next process detects as stale.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_REFERENCE_SHARED_REFERENCE_HASH_HH
+#define iSAAC_REFERENCE_SHARED_REFERENCE_HASH_HH
+
+#include <cstring>
+
+#include <boost/noncopyable.hpp>
+
+#include "reference/Contig.hh"
+#include "reference/ReferenceHash.hh"
+
+namespace isaac
+{
+namespace reference
+{
+
+namespace sharedReferenceHash
+{
+
+static const char MAGIC[8] = {'i', 'S', 'A', 'A', 'C', 'R', 'H', 0};
+static const unsigned VERSION = 2;
+// keeps the hash data page-aligned
+static const std::size_t HEADER_SIZE = 4096;
+
+struct Header
+{
+    char magic_[sizeof(MAGIC)];
+    uint32_t version_;
+    uint32_t ready_;
+    uint64_t checksum_;
+    uint64_t seedLength_;
+    uint64_t offsetSize_;
+    uint64_t minimizerWindow_;
+    uint64_t a_;
+    uint64_t b_;
+    uint64_t largePrime_;
+    uint64_t bucketCount_;
+    uint64_t positionsCount_;
+
+    /// true if the two headers describe the hash of the same reference with the same parameters
+    bool sameHash(const Header &that) const
+    {
+        return !std::memcmp(magic_, that.magic_, sizeof(magic_)) && version_ == that.version_ &&
+            checksum_ == that.checksum_ && seedLength_ == that.seedLength_ && offsetSize_ == that.offsetSize_ &&
+            minimizerWindow_ == that.minimizerWindow_ && bucketCount_ == that.bucketCount_;
+    }
+};
+
+} // namespace sharedReferenceHash
+
+class SharedReferenceHashSegment : boost::noncopyable
+{
+public:
+    /**
+     * \brief opens or creates the segment for the hash of contigList.
+     *
+     * After construction, either isAttached() is true, or isCreator() is true and the caller is expected
+     * to build the hash and publish() it, or neither is true and the hash has to be built privately.
+     * The hash is never shared if any of the contigs has no M5 in the reference metadata.
+     */
+    SharedReferenceHashSegment(
+        const ContigList &contigList,
+        const SortedReferenceMetadata::Contigs &xmlContigs,
+        const unsigned seedLength,
+        const std::size_t offsetSize,
+        const uint64_t bucketCount,
+        const unsigned minimizerWindow);
+    ~SharedReferenceHashSegment();
+
+    bool isAttached() const {return attached_;}
+    bool isCreator() const {return creator_;}
+    const sharedReferenceHash::Header &header() const {return *reinterpret_cast<const sharedReferenceHash::Header*>(mapping_);}
+    const char *data() const {return static_cast<const char*>(mapping_) + sharedReferenceHash::HEADER_SIZE;}
+
+    /**
+     * \brief stores offsets and positions of the hash and makes the segment available to other processes
+     *
+     * \return false if the segment could not be sized. The segment is then abandoned
+     */
+    template <typename ReferenceHashT>
+    bool publish(const ReferenceHashT &hash)
+    {
+        typedef typename ReferenceHashT::Offset Offset;
+        const std::size_t offsetsBytes = sizeof(Offset) * hash.getBucketCount();
+        const std::size_t positionsBytes = sizeof(Offset) * hash.getPositionsCount();
+        char *data = allocate(offsetsBytes + positionsBytes);
+        if (!data)
+        {
+            return false;
+        }
+        std::copy(hash.offsetsData(), hash.offsetsData() + hash.getBucketCount(), reinterpret_cast<Offset*>(data));
+        std::copy(hash.positionsData(), hash.positionsData() + hash.getPositionsCount(), reinterpret_cast<Offset*>(data + offsetsBytes));
+        seal(hash.getA(), hash.getB(), hash.getLargePrime(), hash.getPositionsCount());
+        return true;
+    }
+
+    /**
+     * \return read-only hash over the segment data
+     */
+    template <typename ReferenceHashT>
+    ReferenceHashT getHash() const
+    {
+        typedef typename ReferenceHashT::Offset Offset;
+        ISAAC_ASSERT_MSG(attached_, "Segment is not attached: " << name_);
+        const Offset *offsets = reinterpret_cast<const Offset*>(data());
+        return ReferenceHashT(
+            header().a_, header().b_, header().largePrime_, header().bucketCount_, header().minimizerWindow_,
+            offsets, offsets + header().bucketCount_, header().positionsCount_);
+    }
+
+private:
+    const sharedReferenceHash::Header expected_;
+    const std::string name_;
+    int fd_;
+    void *mapping_;
+    std::size_t mappingSize_;
+    bool creator_;
+    bool attached_;
+
+    /// \return true if all contigs have M5, so that processes can't share a hash of different bases
+    static bool isIdentifiable(const SortedReferenceMetadata::Contigs &xmlContigs);
+    static sharedReferenceHash::Header makeHeader(
+        const ContigList &contigList,
+        const SortedReferenceMetadata::Contigs &xmlContigs,
+        const unsigned seedLength,
+        const std::size_t offsetSize,
+        const uint64_t bucketCount,
+        const unsigned minimizerWindow);
+
+    bool open();
+    char *allocate(const std::size_t dataBytes);
+    void seal(const uint64_t a, const uint64_t b, const uint64_t largePrime, const uint64_t positionsCount);
+    void unlink();
+    void unmap();
+};
+
+/**
+ * \brief attaches to the shared hash, or builds it with build() and shares it if this process is the first.
+ *        Falls back to the private hash returned by build() when sharing is not possible.
+ */
+template <typename ReferenceHashT, typename BuildF>
+ReferenceHashT getSharedReferenceHash(SharedReferenceHashSegment &segment, BuildF build)
+{
+    if (segment.isAttached())
+    {
+        return segment.getHash<ReferenceHashT>();
+    }
+
+    ReferenceHashT hash = build();
+    if (segment.isCreator() && segment.publish(hash))
+    {
+        // the private copy is released as soon as the function returns
+        return segment.getHash<ReferenceHashT>();
+    }
+    return hash;
+}
+
+} // namespace reference
+} // namespace isaac
+
+#endif // #ifndef iSAAC_REFERENCE_SHARED_REFERENCE_HASH_HH
@@ -33,6 +33,7 @@
 #include "flowcell/TileMetadata.hh"
 #include "io/InflateGzipDecompressor.hh"
 #include "io/FileBufCache.hh"
+#include "io/MappedFile.hh"
 #include "rta/CycleBciMapper.hh"
 
 namespace isaac
@@ -74,6 +75,18 @@ public:
         reserveBuffers(reservePathLength);
     }
 
+    /**
+     * \brief bgzf bcl data is always compressed, so, it is never mapped
+     */
+    bool mapTileCycle(
+        const flowcell::Layout &flowcellLayout,
+        const flowcell::TileMetadata &tile,
+        const unsigned cycle,
+        io::MappedFile &mapping) const
+    {
+        return false;
+    }
+
     unsigned readTileCycle(
         const flowcell::Layout &flowcellLayout,
         const flowcell::TileMetadata &tile,
@@ -20,6 +20,12 @@
 #ifndef iSAAC_RTA_BCL_MAPPER_HH
 #define iSAAC_RTA_BCL_MAPPER_HH
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <chrono>
+
 #include <boost/format.hpp>
 #include <boost/iostreams/device/file.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
@@ -35,6 +41,7 @@
 
 #include "io/InflateGzipDecompressor.hh"
 #include "io/FileBufCache.hh"
+#include "io/MappedFile.hh"
 
 namespace isaac
 {
@@ -48,6 +55,55 @@ namespace BclMapperDetails
         std::copy(cycleNumbers.begin(), cycleNumbers.end(), std::ostream_iterator<unsigned>(os, ","));
         return os;
     }
+
+#ifdef __SSE2__
+    /**
+     * \brief transposes 16 bytes of 16 cycles into 16 bytes of 16 clusters
+     *
+     * \param cycles    pointers to the cycle data of 16 consecutive cycles
+     * \param offset    offset of the first of 16 clusters in cycle data
+     * \param out       output for the first cluster
+     * \param outStride distance between the clusters in the output
+     */
+    inline void transpose16x16(const char *const *cycles, const std::size_t offset, char *out, const std::size_t outStride)
+    {
+        __m128i r[16];
+        for (unsigned i = 0; 16 > i; ++i)
+        {
+            r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cycles[i] + offset));
+        }
+        // after each stage s*[x][y] holds interleaved data of progressively more cycles for progressively fewer clusters
+        __m128i s1[8][2];
+        for (unsigned i = 0; 8 > i; ++i)
+        {
+            s1[i][0] = _mm_unpacklo_epi8(r[i * 2], r[i * 2 + 1]);
+            s1[i][1] = _mm_unpackhi_epi8(r[i * 2], r[i * 2 + 1]);
+        }
+        __m128i s2[4][4];
+        for (unsigned i = 0; 4 > i; ++i)
+        {
+            for (unsigned h = 0; 2 > h; ++h)
+            {
+                s2[i][h * 2] = _mm_unpacklo_epi16(s1[i * 2][h], s1[i * 2 + 1][h]);
+                s2[i][h * 2 + 1] = _mm_unpackhi_epi16(s1[i * 2][h], s1[i * 2 + 1][h]);
+            }
+        }
+        __m128i s3[2][8];
+        for (unsigned i = 0; 2 > i; ++i)
+        {
+            for (unsigned q = 0; 4 > q; ++q)
+            {
+                s3[i][q * 2] = _mm_unpacklo_epi32(s2[i * 2][q], s2[i * 2 + 1][q]);
+                s3[i][q * 2 + 1] = _mm_unpackhi_epi32(s2[i * 2][q], s2[i * 2 + 1][q]);
+            }
+        }
+        for (unsigned p = 0; 8 > p; ++p)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + outStride * p * 2), _mm_unpacklo_epi64(s3[0][p], s3[1][p]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + outStride * (p * 2 + 1)), _mm_unpackhi_epi64(s3[0][p], s3[1][p]));
+        }
+    }
+#endif // __SSE2__
 }
 
 class BclMapper
@@ -57,16 +113,15 @@ public:
     void get(unsigned clusterIndex, InsertIteratorT insertIterator) const
     {
         ISAAC_ASSERT_MSG(clusterIndex < clusterCount_, "Requested cluster number is not in the data");
-        extractCluster(clusterIndex, getTileSize(1), insertIterator);
+        extractCluster(clusterIndex, insertIterator);
     }
 
     template <typename InsertIteratorT>
     void transpose(InsertIteratorT insertIterator) const
     {
-        const unsigned increment = getTileSize(1);
         for (unsigned clusterIndex = 0; clusterCount_ > clusterIndex; ++ clusterIndex)
         {
-            insertIterator = extractCluster(clusterIndex, increment, insertIterator);
+            insertIterator = extractCluster(clusterIndex, insertIterator);
         }
     }
 
@@ -96,24 +151,77 @@ public:
     void unreserve()
     {
         TileData().swap(tileData_);
+        std::vector<const char *>().swap(cycleData_);
     }
 
     unsigned getCyclesCount() const {return cycleNumbers_;}
 
 protected:
+    // number of clusters transposed together. Large enough to amortize the tlb misses of touching every cycle,
+    // small enough for the output block to stay in L2
+    static const unsigned TRANSPOSE_BLOCK_CLUSTERS = 1024;
+
     template <typename InsertIteratorT>
-    InsertIteratorT extractCluster(unsigned clusterIndex, const unsigned increment, InsertIteratorT insertIterator) const
+    InsertIteratorT extractCluster(unsigned clusterIndex, InsertIteratorT insertIterator) const
     {
-        const char *clusterCycleEnd = getBclBufferStart(cycleNumbers_) + getClusterOffset(clusterIndex);
-        const char *clusterCyclePointer = getBclBufferStart(0) + getClusterOffset(clusterIndex);
-        while(clusterCycleEnd != clusterCyclePointer)
+        const std::size_t clusterOffset = getClusterOffset(clusterIndex);
+        for (std::vector<const char *>::const_iterator it = cycleData_.begin(); cycleData_.end() != it; ++it)
         {
-            *insertIterator++ = *clusterCyclePointer;
-            clusterCyclePointer += increment;
+            *insertIterator++ = (*it)[clusterOffset];
         }
         return insertIterator;
     }
 
+    /**
+     * \brief Cache-blocked transposition of cycle-major data into cluster-major records of getCyclesCount() bytes
+     *
+     * \param out points at the record of clusterBegin
+     */
+    void transposeClusters(const unsigned clusterBegin, const unsigned clusterEnd, char *out) const
+    {
+        transposeClusters(clusterBegin, clusterEnd, 0, cycleData_.size(), out);
+    }
+
+    /**
+     * \brief Same as above but fills only the bytes of cycles [cycleBegin, cycleEnd) in each output record
+     *
+     * \param cycleBegin must be a multiple of 16 for the cycle groups to stay aligned with transpose16x16
+     */
+    void transposeClusters(
+        const unsigned clusterBegin, const unsigned clusterEnd,
+        const std::size_t cycleBegin, const std::size_t cycleEnd, char *out) const
+    {
+        const std::size_t cycles = cycleData_.size();
+        for (unsigned blockBegin = clusterBegin; clusterEnd > blockBegin; blockBegin += TRANSPOSE_BLOCK_CLUSTERS)
+        {
+            const unsigned blockEnd = std::min(clusterEnd, blockBegin + TRANSPOSE_BLOCK_CLUSTERS);
+            for (std::size_t cycle = cycleBegin; cycleEnd > cycle; cycle += 16)
+            {
+                const std::size_t groupEnd = std::min(cycleEnd, cycle + 16);
+                unsigned cluster = blockBegin;
+#ifdef __SSE2__
+                if (cycle + 16 == groupEnd)
+                {
+                    for (; blockEnd >= cluster + 16; cluster += 16)
+                    {
+                        BclMapperDetails::transpose16x16(
+                            &cycleData_[cycle], getClusterOffset(cluster),
+                            out + (cluster - clusterBegin) * cycles + cycle, cycles);
+                    }
+                }
+#endif // __SSE2__
+                for (; blockEnd > cluster; ++cluster)
+                {
+                    char *clusterOut = out + (cluster - clusterBegin) * cycles;
+                    for (std::size_t c = cycle; groupEnd > c; ++c)
+                    {
+                        clusterOut[c] = cycleData_[c][getClusterOffset(cluster)];
+                    }
+                }
+            }
+        }
+    }
+
     uint64_t getUnpaddedBclSize() const
     {
         return sizeof(boost::uint32_t) + clusterCount_;
@@ -134,14 +242,14 @@ protected:
         return &tileData_.front() + getTileSize(cycleIndex);
     }
 
-    const char *getBclBufferStart(const unsigned cycleIndex) const
-    {
-        return &tileData_.front() + getTileSize(cycleIndex);
-    }
-
-    const char *getBclBufferEnd(const unsigned cycleIndex) const
+    /**
+     * \brief makes the cycle data come from elsewhere (such as a mapped file) instead of the tile buffer
+     *
+     * \param bcl pointer to the bcl data including the cluster count header
+     */
+    void setCycleData(const unsigned cycleIndex, const char *bcl)
     {
-        return &tileData_.front() + getTileSize(cycleIndex + 1);
+        cycleData_.at(cycleIndex) = bcl;
     }
 
     unsigned getClusterOffset(const unsigned clusterNumber) const
@@ -154,6 +262,11 @@ protected:
         clusterCount_ = clusterCount;
         cycleNumbers_ = cycles;
         tileData_.resize(getTileSize(cycleNumbers_));
+        cycleData_.clear();
+        for (unsigned cycleIndex = 0; cycleNumbers_ > cycleIndex; ++cycleIndex)
+        {
+            cycleData_.push_back(getCycleBufferStart(cycleIndex));
+        }
     }
 
     unsigned getGeometryClusterCount() const
@@ -170,6 +283,7 @@ protected:
     {
         ISAAC_TRACE_STAT("BclMapper::BclMapper before reserve")
         tileData_.reserve(getTileSize(cycleNumbers_));
+        cycleData_.reserve(cycleNumbers_);
         ISAAC_TRACE_STAT("BclMapper::BclMapper after reserve")
     }
 
@@ -192,6 +306,8 @@ private:
     unsigned cycleNumbers_;
     typedef std::vector<char, common::NumaAllocator<char, common::numa::defaultNodeInterleave> > TileData;
     TileData tileData_;
+    // bcl data of each cycle. Points either into tileData_ or into memory mapped by someone else
+    std::vector<const char *> cycleData_;
 };
 
 /**
@@ -204,7 +320,27 @@ class ParallelBclMapper : BclMapper
     const unsigned maxInputLoaders_;
     std::vector<ReaderT> &threadReaders_;
     std::vector<unsigned> cycleNumbers_;
+    // flat bcl files are mapped instead of being read into the tile buffer
+    std::vector<io::MappedFile> mappedCycles_;
     const std::size_t transposeThreadCount_;
+
+    // cycles transposed together, one transpose16x16 wide
+    static const unsigned GROUP_CYCLES = 16;
+    // clusters of a cycle group handed to a thread at a time by mapTransposeTile
+    static const unsigned TRANSPOSE_CHUNK_CLUSTERS = TRANSPOSE_BLOCK_CLUSTERS * 16;
+
+    // mapTransposeTile state shared by the threads. Guarded by loadMutex_
+    boost::mutex loadMutex_;
+    boost::condition_variable loadStateChanged_;
+    std::vector<bool> cycleClaimed_;
+    std::vector<unsigned> groupCyclesLoaded_;
+    // fully loaded cycle groups in the order they got completed
+    std::vector<unsigned> loadedGroups_;
+    // position in loadedGroups_ and the first cluster of the next chunk to transpose
+    std::size_t transposeGroup_;
+    unsigned transposeCluster_;
+    unsigned activeLoaders_;
+    bool loadFailed_;
 public:
     using BclMapper::transpose;
     using BclMapper::getCyclesCount;
@@ -218,23 +354,22 @@ public:
         maxInputLoaders_(maxInputLoaders),
         threadReaders_(threadReaders),
         cycleNumbers_(maxCycles),
-        transposeThreadCount_(std::min<std::size_t>(threads_.size(), boost::thread::hardware_concurrency()))
+        mappedCycles_(maxCycles),
+        transposeThreadCount_(std::min<std::size_t>(threads_.size(), boost::thread::hardware_concurrency())),
+        transposeGroup_(0),
+        transposeCluster_(0),
+        activeLoaders_(0),
+        loadFailed_(false)
     {
+        cycleClaimed_.reserve(maxCycles);
+        groupCyclesLoaded_.reserve((maxCycles + GROUP_CYCLES - 1) / GROUP_CYCLES);
+        loadedGroups_.reserve(groupCyclesLoaded_.capacity());
         ISAAC_TRACE_STAT("ParallelBclMapper::ParallelBclMapper for maxInputLoaders=" << maxInputLoaders)
     }
 
     void mapTile(const flowcell::Layout &flowcell, const flowcell::TileMetadata &tileMetadata)
     {
-        ISAAC_ASSERT_MSG(cycleNumbers_.capacity() >= flowcell.getDataCycles().size() + flowcell.getBarcodeCycles().size(),
-                         "Insufficient capacity in cycleNumbers_ need " << flowcell.getDataCycles().size() + flowcell.getBarcodeCycles().size() << " got " << cycleNumbers_.size());
-        cycleNumbers_.clear();
-
-        // Add barcode cycles first
-        cycleNumbers_ = flowcell.getBarcodeCycles();
-        // Add data cycles second
-        cycleNumbers_.insert(cycleNumbers_.end(), flowcell.getDataCycles().begin(), flowcell.getDataCycles().end());
-
-        setGeometry(cycleNumbers_.size(), tileMetadata.getClusterCount());
+        setTileGeometry(flowcell, tileMetadata);
 
         threads_.execute(boost::bind(
             &ParallelBclMapper::threadLoadBcls, this, _1, _2,
@@ -247,33 +382,202 @@ public:
     template <typename RandomAccessIteratorT>
     void transpose(RandomAccessIteratorT outputIterator) const
     {
+        const unsigned clusterCount = getGeometryClusterCount();
+        if (!clusterCount)
+        {
+            return;
+        }
+        char *out = &*outputIterator;
+        const std::chrono::steady_clock::time_point transposeStart = std::chrono::steady_clock::now();
         threads_.execute(
-            [this, outputIterator](const unsigned threadNumber, const unsigned threadsTotal)
+            [this, out, clusterCount](const unsigned threadNumber, const unsigned threadsTotal)
             {
-                const unsigned chunkSize = (getGeometryClusterCount() + threadsTotal - 1) / threadsTotal;
-                const unsigned clusterBegin = chunkSize * threadNumber;
-                const unsigned clusterEnd = std::min(getGeometryClusterCount(), chunkSize * (threadNumber + 1));
-                // if there are less clusters than threads, let only thread 0 do the job
-                if (clusterBegin || !threadNumber)
-                {
-                    const unsigned increment = getTileSize(1);
-                    RandomAccessIteratorT oi = outputIterator + clusterBegin * getCyclesCount();
-                    for (unsigned clusterIndex = clusterBegin; clusterEnd > clusterIndex; ++clusterIndex)
-                    {
-                        oi = extractCluster(clusterIndex, increment, oi);
-                    }
-                }
+                // keep chunks aligned to transposition blocks so that threads don't share cache lines of input
+                const unsigned blocks = (clusterCount + TRANSPOSE_BLOCK_CLUSTERS - 1) / TRANSPOSE_BLOCK_CLUSTERS;
+                const unsigned chunkSize = (blocks + threadsTotal - 1) / threadsTotal * TRANSPOSE_BLOCK_CLUSTERS;
+                const unsigned clusterBegin = std::min(clusterCount, chunkSize * threadNumber);
+                const unsigned clusterEnd = std::min(clusterCount, chunkSize * (threadNumber + 1));
+                transposeClusters(clusterBegin, clusterEnd, out + std::size_t(clusterBegin) * getCyclesCount());
             },
             transposeThreadCount_);
 
-//        const unsigned increment = getTileSize(1);
-//        for (unsigned clusterIndex = 0; clusterCount_ > clusterIndex; ++ clusterIndex)
-//        {
-//            extractCluster(clusterIndex, increment, insertIterator);
-//        }
+        // with mapped bcl files the page faults of the first access are part of this
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - transposeStart).count();
+        ISAAC_THREAD_CERR << "Transposed " << clusterCount << " clusters of " << getCyclesCount() << " cycles in " <<
+            unsigned(seconds * 1000) << "ms (" << uint64_t(seconds ? clusterCount / seconds : 0) << " clusters/s)" << std::endl;
+    }
+
+    /**
+     * \brief Loads the tile and stores it transposed into cluster-major records of getCyclesCount() bytes
+     *
+     * All pool threads take part. Up to maxInputLoaders threads at a time load cycles while the other threads
+     * transpose each group of 16 cycles as soon as its last cycle is loaded, so the transposition of the loaded
+     * groups overlaps with the loading of the remaining cycles.
+     *
+     * \param outputIterator points at the record of the first cluster of the tile
+     */
+    template <typename RandomAccessIteratorT>
+    void mapTransposeTile(
+        const flowcell::Layout &flowcell, const flowcell::TileMetadata &tileMetadata,
+        RandomAccessIteratorT outputIterator)
+    {
+        setTileGeometry(flowcell, tileMetadata);
+
+        cycleClaimed_.assign(getCyclesCount(), false);
+        groupCyclesLoaded_.assign((getCyclesCount() + GROUP_CYCLES - 1) / GROUP_CYCLES, 0);
+        loadedGroups_.clear();
+        transposeGroup_ = 0;
+        transposeCluster_ = 0;
+        activeLoaders_ = 0;
+        loadFailed_ = false;
+
+        char *out = &*outputIterator;
+        const std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+        threads_.execute(boost::bind(
+            &ParallelBclMapper::threadLoadTransposeBcls, this, _1, _2,
+            tileMetadata.getClusterCount(),
+            boost::ref(flowcell), boost::ref(tileMetadata), out));
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+        ISAAC_THREAD_CERR << "Loaded and transposed " << tileMetadata.getClusterCount() << " clusters of " << getCyclesCount() <<
+            " cycles in " << unsigned(seconds * 1000) << "ms" << std::endl;
     }
 
 private:
+    void setTileGeometry(const flowcell::Layout &flowcell, const flowcell::TileMetadata &tileMetadata)
+    {
+        ISAAC_ASSERT_MSG(cycleNumbers_.capacity() >= flowcell.getDataCycles().size() + flowcell.getBarcodeCycles().size(),
+                         "Insufficient capacity in cycleNumbers_ need " << flowcell.getDataCycles().size() + flowcell.getBarcodeCycles().size() << " got " << cycleNumbers_.size());
+        cycleNumbers_.clear();
+
+        // Add barcode cycles first
+        cycleNumbers_ = flowcell.getBarcodeCycles();
+        // Add data cycles second
+        cycleNumbers_.insert(cycleNumbers_.end(), flowcell.getDataCycles().begin(), flowcell.getDataCycles().end());
+
+        setGeometry(cycleNumbers_.size(), tileMetadata.getClusterCount());
+    }
+
+    /**
+     * \brief Loads cycleNumbers_[cycleIndex] of the tile either by mapping the file or into the tile buffer
+     */
+    void loadCycle(
+        ReaderT &reader,
+        const unsigned clusterCount,
+        const flowcell::Layout &flowcell, const flowcell::TileMetadata &tileMetadata,
+        const unsigned cycleIndex)
+    {
+        const unsigned cycle = cycleNumbers_.at(cycleIndex);
+        io::MappedFile &mappedCycle = mappedCycles_.at(cycleIndex);
+        unsigned readClusters = 0;
+        if (reader.mapTileCycle(flowcell, tileMetadata, cycle, mappedCycle))
+        {
+            setCycleData(cycleIndex, mappedCycle.data());
+            readClusters = reinterpret_cast<const boost::uint32_t&>(*mappedCycle.data());
+        }
+        else
+        {
+            mappedCycle.unmap();
+            readClusters = reader.readTileCycle(
+                flowcell, tileMetadata, cycle,
+                getCycleBufferStart(cycleIndex), getTileSize(1));
+        }
+        ISAAC_VERIFY_MSG(readClusters == clusterCount, "Expected Bcl number of clusters(" << clusterCount <<
+                         ") does not match the one read from file(readClusters:" << readClusters <<
+                         "cycle:" << cycle << "): ");
+    }
+
+    /**
+     * \return index of the cycle the thread has to load or getCyclesCount() if no cycles are left to load
+     */
+    unsigned claimCycle(const unsigned threadNumber, const unsigned threadsTotal)
+    {
+        // cycles of the static assignment first so that readers which keep files open continue on
+        // the same cycle files from tile to tile
+        for (unsigned cycleIndex = threadNumber; cycleClaimed_.size() > cycleIndex; cycleIndex += threadsTotal)
+        {
+            if (!cycleClaimed_[cycleIndex])
+            {
+                cycleClaimed_[cycleIndex] = true;
+                return cycleIndex;
+            }
+        }
+        // then help with the cycles of the threads that are busy
+        const std::vector<bool>::iterator unclaimed = std::find(cycleClaimed_.begin(), cycleClaimed_.end(), false);
+        if (cycleClaimed_.end() != unclaimed)
+        {
+            *unclaimed = true;
+        }
+        return std::distance(cycleClaimed_.begin(), unclaimed);
+    }
+
+    void threadLoadTransposeBcls(
+        const unsigned threadNumber,
+        const unsigned threadsTotal,
+        const unsigned clusterCount,
+        const flowcell::Layout &flowcell, const flowcell::TileMetadata &tileMetadata,
+        char *out)
+    {
+        const unsigned cycles = getCyclesCount();
+        boost::unique_lock<boost::mutex> lock(loadMutex_);
+        while (!loadFailed_)
+        {
+            const unsigned cycleIndex =
+                (maxInputLoaders_ > activeLoaders_ && threadReaders_.size() > threadNumber) ?
+                    claimCycle(threadNumber, threadsTotal) : cycles;
+            if (cycles != cycleIndex)
+            {
+                ++activeLoaders_;
+                try
+                {
+                    common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
+                    loadCycle(threadReaders_[threadNumber], clusterCount, flowcell, tileMetadata, cycleIndex);
+                }
+                catch (...)
+                {
+                    // don't leave the other threads waiting for the group that will never complete
+                    loadFailed_ = true;
+                    loadStateChanged_.notify_all();
+                    throw;
+                }
+                --activeLoaders_;
+                const unsigned group = cycleIndex / GROUP_CYCLES;
+                if (std::min(GROUP_CYCLES, cycles - group * GROUP_CYCLES) == ++groupCyclesLoaded_[group])
+                {
+                    loadedGroups_.push_back(group);
+                }
+                // either a group is ready or a loader slot is free
+                loadStateChanged_.notify_all();
+            }
+            else if (loadedGroups_.size() != transposeGroup_)
+            {
+                const std::size_t cycleBegin = loadedGroups_[transposeGroup_] * GROUP_CYCLES;
+                const unsigned clusterBegin = transposeCluster_;
+                const unsigned clusterEnd = std::min(clusterCount, clusterBegin + TRANSPOSE_CHUNK_CLUSTERS);
+                transposeCluster_ = clusterEnd;
+                if (clusterCount == clusterEnd)
+                {
+                    ++transposeGroup_;
+                    transposeCluster_ = 0;
+                }
+                common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
+                transposeClusters(
+                    clusterBegin, clusterEnd,
+                    cycleBegin, std::min<std::size_t>(cycles, cycleBegin + GROUP_CYCLES),
+                    out + std::size_t(clusterBegin) * cycles);
+            }
+            else if (groupCyclesLoaded_.size() == loadedGroups_.size())
+            {
+                // the remaining chunks are being transposed by other threads
+                break;
+            }
+            else
+            {
+                loadStateChanged_.wait(lock);
+            }
+        }
+    }
+
     void threadLoadBcls(
         const unsigned threadNumber,
         const unsigned threadsTotal,
@@ -282,19 +586,14 @@ private:
         std::vector<unsigned>::const_iterator threadCyclesBegin,
         std::vector<unsigned>::const_iterator threadCyclesEnd)
     {
-        // each thread starts at the threadNumber cycle
+        // each thread starts at the threadNumber cycle. Static assignment keeps the same cycles on the same reader
+        // from tile to tile so that readers which keep files open can continue without reopening
         for(unsigned thistThreadCycleOffset = threadNumber;
             std::distance(threadCyclesBegin, threadCyclesEnd) > thistThreadCycleOffset;
             // jump to the next cycle to be loaded by this thread
             thistThreadCycleOffset += threadsTotal)
         {
-            const unsigned cycle = *(threadCyclesBegin + thistThreadCycleOffset);
-            const unsigned readClusters = threadReaders_[threadNumber].readTileCycle(
-                flowcell, tileMetadata, cycle,
-                getCycleBufferStart(thistThreadCycleOffset), getTileSize(1));
-            ISAAC_VERIFY_MSG(readClusters == clusterCount, "Expected Bcl number of clusters(" << clusterCount <<
-                             ") does not match the one read from file(readClusters:" << readClusters <<
-                             "cycle:" << cycle << "): ");
+            loadCycle(threadReaders_[threadNumber], clusterCount, flowcell, tileMetadata, thistThreadCycleOffset);
 
             //ISAAC_THREAD_CERR << "Read " << clusters << " clusters from " << *threadCyclePathsBegin << std::endl;
         }
@@ -34,6 +34,7 @@
 
 #include "io/InflateGzipDecompressor.hh"
 #include "io/FileBufCache.hh"
+#include "io/MappedFile.hh"
 
 namespace isaac
 {
@@ -87,6 +88,33 @@ public:
         }
     }
 
+    /**
+     * \brief Maps flat bcl file of the tile cycle instead of reading it into a buffer. The pages are
+     *        prefetched in the background.
+     *
+     * \return false if the file is compressed or missing and has to be loaded with readTileCycle
+     */
+    bool mapTileCycle(
+        const flowcell::Layout &flowcellLayout,
+        const flowcell::TileMetadata &tile,
+        const unsigned cycle,
+        io::MappedFile &mapping)
+    {
+        flowcellLayout.getLaneTileCycleAttribute<flowcell::Layout::Bcl, flowcell::BclFilePathAttributeTag>(
+            tile.getLane(), tile.getTile(), cycle, cycleFilePath_);
+
+        if (common::isDotGzPath(cycleFilePath_) ||
+            (ignoreMissingBcls_ && !boost::filesystem::exists(cycleFilePath_)))
+        {
+            return false;
+        }
+        mapping.map(cycleFilePath_, true);
+        ISAAC_VERIFY_MSG(sizeof(boost::uint32_t) + tile.getClusterCount() <= mapping.size(),
+                         "Bcl file is too short for " << tile.getClusterCount() << " clusters: " << cycleFilePath_ <<
+                         " size:" << mapping.size());
+        return true;
+    }
+
 private:
     const bool ignoreMissingBcls_;
     boost::filesystem::path cycleFilePath_;
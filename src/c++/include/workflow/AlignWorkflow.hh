@@ -27,6 +27,7 @@
 #include <boost/format.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "demultiplexing/BarcodePathMap.hh"
 #include "alignment/BinMetadata.hh"
@@ -35,6 +36,8 @@
 #include "alignment/TemplateLengthStatistics.hh"
 #include "alignment/matchFinder/TileClusterInfo.hh"
 #include "build/BinSorter.hh"
+#include "common/Metrics.hh"
+#include "common/ProgressFile.hh"
 #include "common/Threads.hpp"
 #include "demultiplexing/BarcodeLoader.hh"
 #include "demultiplexing/BarcodeResolver.hh"
@@ -160,7 +163,13 @@ public:
         const boost::array<char, 256> &fullBclQScoreTable,
         const OptionalFeatures optionalFeatures,
         const bool pessimisticMapQ,
-        const unsigned detectTemplateBlockSize);
+        const unsigned detectTemplateBlockSize,
+        const unsigned seedMatchCacheSize,
+        const bool adaptiveSeeds,
+        const unsigned minimizerWindow,
+        const bool sharedReferenceHash,
+        const unsigned traceSlowestClusters,
+        const unsigned progressInterval);
 
     /**
      * \brief Runs end-to-end alignment from the beginning
@@ -297,11 +306,20 @@ private:
     const reference::NumaContigLists contigLists_;
 
     State state_;
+    // wall-clock time and work done by each step. Stored in the Stats directory after every step.
+    common::metrics::StageLog stageLog_;
     alignWorkflow::FoundMatchesMetadata foundMatchesMetadata_;
     SelectedMatchesMetadata selectedMatchesMetadata_;
     std::vector<alignment::TemplateLengthStatistics> barcodeTemplateLengthStatistics_;
     demultiplexing::BarcodePathMap barcodeBamMapping_;
     const unsigned detectTemplateBlockSize_;
+    const unsigned seedMatchCacheSize_;
+    const bool adaptiveSeeds_;
+    const unsigned minimizerWindow_;
+    const bool sharedReferenceHash_;
+    const unsigned traceSlowestClusters_;
+    // created once the Stats directory exists
+    boost::scoped_ptr<common::metrics::ProgressFile> progressFile_;
 
 
     static reference::SortedReferenceMetadataList loadSortedReferenceXml(
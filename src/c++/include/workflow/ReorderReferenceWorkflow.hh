@@ -38,7 +38,8 @@ public:
         const bfs::path &sortedReferenceMetadata,
         const bfs::path &newXmlPath,
         const bfs::path &newDataFileDirectory,
-        const std::vector<std::string> &newOrder
+        const std::vector<std::string> &newOrder,
+        const bool contigImage
         );
 
     void run();
@@ -47,10 +48,13 @@ private:
     const bfs::path sortedReferenceMetadata_;
     const bfs::path newXmlPath_;
     const bfs::path newDataFileDirectory_;
+    const bool contigImage_;
 
     reference::SortedReferenceMetadata xml_;
     // translation array from new karyotype indexes to the original ones
     std::vector<unsigned> originalIndexes_;
+
+    void saveContigImage(const bfs::path &targetPath) const;
 };
 } // namespace workflow
 } // namespace isaac
@@ -60,7 +60,8 @@ public:
         bamLoader_(maxPathLength, threads, coresMax),
         clusterExtractor_(tempDirectoryPath, maxBamFileLength, maxFlowcellIdLength, maxReadNameLength, minClusterLength, cleanupIntermediary,
                           // assume each uncompressed bam record is roughly sizeof(header) + (read length * 2). Double the estimate.
-                          bamLoader_.BUFFER_SIZE / (sizeof(bam::BamBlockHeader) + minReadLength * 2) * 2)
+                          bamLoader_.BUFFER_SIZE / (sizeof(bam::BamBlockHeader) + minReadLength * 2) * 2,
+                          threads, coresMax)
     {
         flowcellId_.reserve(maxFlowcellIdLength);
     }
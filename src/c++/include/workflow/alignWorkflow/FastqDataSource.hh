@@ -51,9 +51,14 @@ class FastqBaseCallsSource : public TileSource, public BarcodeSource
     unsigned loadedTile_ = 0;
     unsigned loadedLane_ = 0;
     unsigned loadingTile_ = 0;
+    // one entry per lane<X>_index<Y>.fastq. Offsets are relative to the barcode start
+    flowcell::ReadMetadataList indexMetadataList_;
+    // number of barcode bases to take from read names
+    const unsigned nameIndexLength_;
     io::FastqLoader fastqLoader_;
 
     std::vector<std::pair<boost::filesystem::path, boost::filesystem::path> > lanePaths_;
+    std::vector<std::vector<boost::filesystem::path> > laneIndexPaths_;
 
     bool terminateRequested_ = false;
     bool forceTermination_ = false;
@@ -79,10 +84,7 @@ public:
         const flowcell::Layout &flowcell,
         const unsigned unknownBarcodeIndex,
         const flowcell::TileMetadataList &tiles,
-        demultiplexing::Barcodes &barcodes)
-    {
-        ISAAC_ASSERT_MSG(false, "Barcode resolution is not implemented for Fastq data");
-    }
+        demultiplexing::Barcodes &barcodes);
 
     // prepare bclData buffers to receive new tile data
     void resetBclData(
@@ -185,7 +185,12 @@ public:
         const bool preSortBins,
         const bool preAllocateBins,
         const std::string &binRegexString,
-        const unsigned detectTemplateBlockSize);
+        const unsigned detectTemplateBlockSize,
+        const unsigned seedMatchCacheSize,
+        const bool adaptiveSeeds,
+        const unsigned minimizerWindow,
+        const bool sharedReferenceHash,
+        const unsigned traceSlowestClusters);
 
     template <typename KmerT>
     void perform(
@@ -230,6 +235,9 @@ private:
     const unsigned coresMax_;
     const std::size_t candidateMatchesMax_;
     const unsigned matchFinderMaxRepeats_;
+    const bool adaptiveSeeds_;
+    const unsigned minimizerWindow_;
+    const bool sharedReferenceHash_;
     const unsigned seedBaseQualityMin_;
     const unsigned seedLength_;
     const unsigned repeatThreshold_;
@@ -22,16 +22,13 @@
 
 #include <cmath>
 
-#include <boost/crc.hpp>
 #include <boost/filesystem.hpp>
-#include <boost/mpl/vector.hpp>
-#include <boost/mpl/front.hpp>
-#include <boost/mpl/back.hpp>
 
 #include "bam/Bam.hh"
 #include "bam/BamParser.hh"
 #include "common/FastIo.hh"
 #include "common/FileSystem.hh"
+#include "common/Threads.hpp"
 #include "flowcell/ReadMetadata.hh"
 #include "io/FileBufCache.hh"
 #include "reference/ReferencePosition.hh"
@@ -112,14 +109,56 @@ struct IndexRecord
     }
 };
 
+/**
+ * \brief 64 bit hash of a 0-terminated read name. FNV-1a followed by a finalizer so that all bits are usable
+ *        for partitioning
+ */
+inline uint64_t getReadNameHash(const char *name)
+{
+    uint64_t ret = 14695981039346656037UL;
+    for (; *name; ++name)
+    {
+        ret = (ret ^ static_cast<unsigned char>(*name)) * 1099511628211UL;
+    }
+    ret ^= ret >> 33;
+    ret *= 0xff51afd7ed558ccdUL;
+    ret ^= ret >> 33;
+    ret *= 0xc4ceb9fe1a85ec53UL;
+    ret ^= ret >> 33;
+    return ret;
+}
+
+/**
+ * \brief Pairs the reads of one temporary file with a hash join. The file records are split into a fixed
+ *        number of join partitions by the read name hash. Partitions are paired independently on the
+ *        thread pool. Memory use is bounded by the temporary file size.
+ */
 class TempFileClusterExtractor : std::vector<char>
 {
     static const bool allowUnpairedReads_ = true;
+    // Fixed, so that the order of extracted clusters does not depend on the number of threads.
+    static const unsigned JOIN_PARTITION_BITS = 6;
+    static const unsigned JOIN_PARTITIONS = 1 << JOIN_PARTITION_BITS;
+    static const unsigned NO_RECORD = -1U;
+    static const unsigned REMOVED_RECORD = -2U;
+
+    common::ThreadVector &threads_;
+    const unsigned threadsMax_;
     common::PathStringType tempFilePath_;
     io::FileBufWithReopen unpairedReadsFile_;
 
     std::vector<std::vector<char>::const_iterator> recordIndex_;
-    std::vector<std::vector<char>::const_iterator>::const_iterator firstUnextracted_;
+    std::vector<uint64_t> recordHashes_;
+    // recordIndex_ offsets grouped by join partition
+    std::vector<unsigned> partitionedRecords_;
+    std::vector<std::size_t> partitionOffsets_;
+    // recordIndex_ offsets of read 1 and read 2 of each cluster. NO_RECORD for a missing mate
+    typedef std::pair<unsigned, unsigned> RecordPair;
+    std::vector<std::vector<RecordPair> > partitionPairs_;
+    std::vector<std::vector<unsigned> > threadJoinTables_;
+
+    unsigned extractPartition_;
+    std::size_t extractPair_;
 
 public:
     typedef unsigned char FlagsType;
@@ -129,17 +168,26 @@ public:
     TempFileClusterExtractor(
         const std::size_t maxTempFilePathLength,
         const std::size_t bufferSize,
-        const std::size_t minClusterLength) :
+        const std::size_t minClusterLength,
+        common::ThreadVector &threads,
+        const unsigned threadsMax) :
+            threads_(threads),
+            threadsMax_(std::max(1U, std::min<unsigned>(threadsMax, threads.size()))),
             unpairedReadsFile_(std::ios_base::in | std::ios_base::binary),
-            firstUnextracted_(recordIndex_.end())
+            partitionPairs_(JOIN_PARTITIONS),
+            threadJoinTables_(threadsMax_),
+            extractPartition_(JOIN_PARTITIONS),
+            extractPair_(0)
     {
         reserve(bufferSize);
         // ignore the fact that each cluster will have more than just the bcl data
         recordIndex_.reserve(bufferSize / minClusterLength);
+        recordHashes_.reserve(recordIndex_.capacity());
+        partitionedRecords_.reserve(recordIndex_.capacity());
         tempFilePath_.reserve(maxTempFilePathLength);
     }
 
-    bool isEmpty() const {return recordIndex_.end() == firstUnextracted_;}
+    bool isEmpty() const {return JOIN_PARTITIONS == extractPartition_;}
 
     void open(const boost::filesystem::path &tempFilePath, std::streamsize expectedFileSize);
 
@@ -153,52 +201,51 @@ public:
         PfInsertIt &pfIt)
     {
         ISAAC_THREAD_CERR << "TempFileClusterExtractor::extractClusters: " << clusterCount << std::endl;
-        while (recordIndex_.end() != firstUnextracted_ && clusterCount)
+        while (!isEmpty() && clusterCount)
         {
-            std::vector<std::vector<char>::const_iterator>::const_iterator prev = firstUnextracted_++;
-            if (recordIndex_.end() == firstUnextracted_ || strcmp(getReadNameCString(*prev), getReadNameCString(*firstUnextracted_)))
+            const RecordPair &pair = partitionPairs_[extractPartition_][extractPair_++];
+            if (NO_RECORD == pair.first || NO_RECORD == pair.second)
             {
+                const std::vector<char>::const_iterator record =
+                    recordIndex_[NO_RECORD == pair.first ? pair.second : pair.first];
                 if (!allowUnpairedReads_)
                 {
                     BOOST_THROW_EXCEPTION(ClusterExtractorException(
-                        (boost::format("No pair for read name %s in %s") % getReadNameCString(*prev) % common::pathStringToStdString(tempFilePath_)).str()));
+                        (boost::format("No pair for read name %s in %s") % getReadNameCString(record) % common::pathStringToStdString(tempFilePath_)).str()));
                 }
                 else
                 {
-                    if (isReadOne(*prev))
+                    if (isReadOne(record))
                     {
-                        clusterIt = std::copy(getBclBegin(*prev, nameLengthMax), getBclEnd(*prev), clusterIt);
+                        clusterIt = std::copy(getBclBegin(record, nameLengthMax), getBclEnd(record), clusterIt);
                         clusterIt = std::fill_n(clusterIt, r2Length, 0);
                     }
                     else
                     {
                         clusterIt = std::fill_n(clusterIt, r1Length, 0);
-                        clusterIt = std::copy(getBclBegin(*prev, nameLengthMax), getBclEnd(*prev), clusterIt);
+                        clusterIt = std::copy(getBclBegin(record, nameLengthMax), getBclEnd(record), clusterIt);
                     }
-//                    const std::size_t nameLength = std::distance(getReadNameBegin(*prev), getReadNameEnd(*prev));
-//                    clusterIt = bam::extractReadName(getReadNameBegin(*prev), nameLength, nameLengthMax, clusterIt);
-                    const bool pf = isPf(*prev); //gcc 4.4 has trouble figuring out which assignment implementation to use
+                    const bool pf = isPf(record); //gcc 4.4 has trouble figuring out which assignment implementation to use
                     *pfIt++ = pf;
                 }
+                const std::size_t nameLength = std::distance(getReadNameBegin(record), getReadNameEnd(record));
+                clusterIt = bam::extractReadName(getReadNameBegin(record), nameLength, nameLengthMax, clusterIt);
             }
             else
             {
-                ISAAC_ASSERT_MSG(!isReadOne(*firstUnextracted_), "Out of two reads, second one was expected to be read 2 " <<
-                                 getReadNameCString(*prev) << ":" << isReadOne(*prev) <<
-                                 " " << getReadNameCString(*firstUnextracted_) << ":" << isReadOne(*firstUnextracted_));
-                ISAAC_ASSERT_MSG(isReadOne(*prev), "Out of two reads, first one was expected to be read 1 " <<
-                                 getReadNameCString(*prev) << ":" << isReadOne(*prev) <<
-                                 " " << getReadNameCString(*firstUnextracted_) << ":" << isReadOne(*firstUnextracted_));
-                clusterIt = std::copy(getBclBegin(*prev, nameLengthMax), getBclEnd(*prev), clusterIt);
-                //ISAAC_ASSERT_MSG(isPf(*prev) == isPf(*firstUnextracted_), "Pf flag must be the same for both reads of the cluster " << getReadNameCString(*prev));
-                clusterIt = std::copy(getBclBegin(*firstUnextracted_, nameLengthMax), getBclEnd(*firstUnextracted_), clusterIt);
-                const bool pf = isPf(*prev) && isPf(*firstUnextracted_); //Although it should match, some datasets have it set differently for each read.
+                const std::vector<char>::const_iterator r1 = recordIndex_[pair.first];
+                const std::vector<char>::const_iterator r2 = recordIndex_[pair.second];
+                ISAAC_ASSERT_MSG(isReadOne(r1) && !isReadOne(r2), "Expected read 1 and read 2 " <<
+                                 getReadNameCString(r1) << ":" << isReadOne(r1) <<
+                                 " " << getReadNameCString(r2) << ":" << isReadOne(r2));
+                clusterIt = std::copy(getBclBegin(r1, nameLengthMax), getBclEnd(r1), clusterIt);
+                clusterIt = std::copy(getBclBegin(r2, nameLengthMax), getBclEnd(r2), clusterIt);
+                const bool pf = isPf(r1) && isPf(r2); //Although it should match, some datasets have it set differently for each read.
                 *pfIt++ = pf;
-
-                ++firstUnextracted_;
+                const std::size_t nameLength = std::distance(getReadNameBegin(r1), getReadNameEnd(r1));
+                clusterIt = bam::extractReadName(getReadNameBegin(r1), nameLength, nameLengthMax, clusterIt);
             }
-            const std::size_t nameLength = std::distance(getReadNameBegin(*prev), getReadNameEnd(*prev));
-            clusterIt = bam::extractReadName(getReadNameBegin(*prev), nameLength, nameLengthMax, clusterIt);
+            skipExtractedPartitions();
 
             --clusterCount;
         }
@@ -252,44 +299,30 @@ private:
     static unsigned char getFlags(const std::vector<char>::const_iterator it)
         {return *reinterpret_cast<const unsigned char*>(&*it + sizeof(unsigned));}
 
-    static bool compareNameAndRead(const std::vector<char>::const_iterator left, const std::vector<char>::const_iterator right)
+    static unsigned getJoinPartition(const uint64_t nameHash)
     {
-        const int namecmp = strcmp(getReadNameCString(left), getReadNameCString(right));
-        return 0 > namecmp || (0 == namecmp && isReadOne(left) > isReadOne(right));
+        return nameHash >> (64 - JOIN_PARTITION_BITS);
     }
-};
 
-class UnpairedReadsCache
-{
-    template <unsigned requiredWidth>
-    struct CrcSelector
+    void skipExtractedPartitions()
     {
-        template <unsigned minVal, unsigned maxVal, unsigned val>
-        struct MinMax
-        {
-            BOOST_STATIC_CONSTANT(unsigned, value
-             = (val < minVal) ? minVal : (val > maxVal) ? maxVal : val);
-        };
-
-        typedef boost::mpl::vector<
-            boost::crc_optimal<5, 0x09>,
-            boost::crc_optimal<6, 0x03>,
-            boost::crc_optimal<7, 0x09> > AllowedCrcs;
-
-        typedef typename boost::mpl::front<AllowedCrcs>::type FrontCrc;
-        typedef typename boost::mpl::back<AllowedCrcs>::type BackCrc;
-
-        typedef typename boost::mpl::at_c<AllowedCrcs, (MinMax<FrontCrc::bit_count, BackCrc::bit_count, requiredWidth>::value - FrontCrc::bit_count)  >::type Selection;
-
-        static unsigned getStringCrc(const char *string, const std::size_t stringLength)
+        while (JOIN_PARTITIONS != extractPartition_ && partitionPairs_[extractPartition_].size() == extractPair_)
         {
-            Selection crc;
-            crc.process_bytes(string, stringLength);
-            return crc.checksum();
+            ++extractPartition_;
+            extractPair_ = 0;
         }
-    };
+    }
 
-    const unsigned crcWidth_;
+    void joinRecords();
+    void joinPartition(const unsigned partition, std::vector<unsigned> &joinTable);
+};
+
+class UnpairedReadsCache
+{
+    // partitions unpaired reads into temporary files by read name hash
+    static const unsigned PARTITION_BITS_MIN = 5;
+    static const unsigned PARTITION_BITS_MAX = 7;
+    const unsigned partitionBits_;
     const std::size_t maxReadNameLength_;
     const bool cleanupIntermediary_;
     const boost::filesystem::path &tempDirectoryPath_;
@@ -309,20 +342,24 @@ public:
         const std::size_t maxFlowcellIdLength,
         const std::size_t maxReadNameLength,
         const std::size_t minClusterLength,
-        const bool cleanupIntermediary) :
-            crcWidth_(log2(std::max<std::size_t>(1, maxBamFileSize / UNPAIRED_BUFFER_SIZE))),
+        const bool cleanupIntermediary,
+        common::ThreadVector &threads,
+        const unsigned threadsMax) :
+            partitionBits_(std::min<unsigned>(PARTITION_BITS_MAX, std::max<unsigned>(
+                PARTITION_BITS_MIN, log2(std::max<std::size_t>(1, maxBamFileSize / UNPAIRED_BUFFER_SIZE))))),
             maxReadNameLength_(maxReadNameLength),
             cleanupIntermediary_(cleanupIntermediary),
             tempDirectoryPath_(tempDirectoryPath),
-            tempFilePaths_(1 << getEffectiveCrcWidth<7>(crcWidth_)),
+            tempFilePaths_(1 << partitionBits_),
             tempFileSizes_(tempFilePaths_.size(), 0),
             extractorFileIterator_(tempFilePaths_.end()),
             extracting_(false),
             tempFiles_(
-                1 << getEffectiveCrcWidth<7>(crcWidth_),
+                1 << partitionBits_,
                 io::FileBufHolder<io::FileBufWithReopen>(std::ios_base::out | std::ios_base::app | std::ios_base::binary,
                                                          getMaxTempFilePathLength(maxFlowcellIdLength))),
-            extractor_(getMaxTempFilePathLength(maxFlowcellIdLength), UNPAIRED_BUFFER_SIZE, minClusterLength)
+            extractor_(getMaxTempFilePathLength(maxFlowcellIdLength), UNPAIRED_BUFFER_SIZE, minClusterLength,
+                       threads, threadsMax)
     {
         tempFilePathBuffer_.reserve(getMaxTempFilePathLength(maxFlowcellIdLength));
         BOOST_FOREACH(common::PathStringType &tempPath, tempFilePaths_)
@@ -422,18 +459,18 @@ public:
 
 
 private:
-    const common::PathCharType* makeTempFilePath(const std::string &flowcellId, unsigned crc)
+    const common::PathCharType* makeTempFilePath(const std::string &flowcellId, unsigned partition)
     {
-        return makeTempFilePath(flowcellId, crc, tempFilePathBuffer_).c_str();
+        return makeTempFilePath(flowcellId, partition, tempFilePathBuffer_).c_str();
     }
 
-    const common::PathStringType& makeTempFilePath(const std::string &flowcellId, unsigned crc, common::PathStringType& buffer)
+    const common::PathStringType& makeTempFilePath(const std::string &flowcellId, unsigned partition, common::PathStringType& buffer)
     {
         buffer = tempDirectoryPath_.c_str();
         buffer += common::getDirectorySeparatorChar();
         buffer += common::PathStringType(flowcellId.begin(), flowcellId.end());
         buffer += iSAAC_TSTRING("-unpaired-");
-        common::appendUnsignedInteger(buffer, crc);
+        common::appendUnsignedInteger(buffer, partition);
         buffer += iSAAC_TSTRING(".tmp");
         return buffer;
     }
@@ -444,44 +481,15 @@ private:
         return makeTempFilePath(std::string(maxFlowcellIdLength, 'a'), 9999, buffer).size();
     }
 
-    template <unsigned N>
-    static unsigned getNameCrc(unsigned crcWidth, const char *name, const std::size_t nameLength)
-    {
-        ISAAC_ASSERT_MSG(crcWidth <= N, "Requested crcWidth is too big: " << crcWidth << " max: " << N);
-        if (N == crcWidth)
-        {
-            return CrcSelector<N>::getStringCrc(name, nameLength);
-        }
-
-        return getNameCrc<N-1>(crcWidth, name, nameLength);
-    }
-
-    template <unsigned N>
-    static unsigned getEffectiveCrcWidth(unsigned requiredWidth)
+    /**
+     * \brief uses bits that are independent of the ones TempFileClusterExtractor uses for join partitioning
+     */
+    unsigned getPartition(const uint64_t nameHash) const
     {
-        ISAAC_ASSERT_MSG(requiredWidth <= N, "Requested crcWidth is too big: " << requiredWidth << " max: " << N);
-        if (N == requiredWidth)
-        {
-            return CrcSelector<N>::Selection::bit_count;
-        }
-
-        return getEffectiveCrcWidth<N-1>(requiredWidth);
+        return (nameHash >> 32) & ((1U << partitionBits_) - 1);
     }
-
 };
 
-template <>
-inline unsigned UnpairedReadsCache::getNameCrc<0>(unsigned crcWidth, const char *name, const std::size_t nameLength)
-{
-    return CrcSelector<0U>::getStringCrc(name, nameLength);
-}
-
-template <>
-inline unsigned UnpairedReadsCache::getEffectiveCrcWidth<0>(unsigned requiredWidth)
-{
-    return CrcSelector<0U>::Selection::bit_count;
-}
-
 
 class PairedEndClusterExtractor :
     std::vector<IndexRecord>
@@ -499,7 +507,9 @@ public:
         const std::size_t maxReadNameLength,
         const std::size_t minClusterLength,
         const bool cleanupIntermediary,
-        const std::size_t expectedClustersPerClusterBlock) :
+        const std::size_t expectedClustersPerClusterBlock,
+        common::ThreadVector &threads,
+        const unsigned threadsMax) :
             firstUnextracted_(end()),
             unpairedReadCache_(
                 tempDirectoryPath,
@@ -507,7 +517,9 @@ public:
                 maxFlowcellIdLength,
                 maxReadNameLength,
                 minClusterLength,
-                cleanupIntermediary)
+                cleanupIntermediary,
+                threads,
+                threadsMax)
     {
         ISAAC_THREAD_CERR << "Reserving IndexRecord buffer for " << expectedClustersPerClusterBlock << " records" << std::endl;
         reserve(expectedClustersPerClusterBlock);
@@ -25,6 +25,7 @@
 #include <cstdint>
 
 #include "alignment/BandedSmithWaterman.hh"
+#include "common/Metrics.hh"
 
 namespace isaac
 {
@@ -242,6 +243,7 @@ unsigned BandedSmithWaterman<widestGapSize>::align(
     Cigar &cigar) const
 {
     assert(databaseEnd > databaseBegin);
+    common::metrics::add(common::metrics::SmithWatermanCalls, 1);
     const size_t querySize = std::distance(queryBegin, queryEnd);
     ISAAC_ASSERT_MSG(querySize + WIDEST_GAP_SIZE - 1 == (uint64_t)(databaseEnd - databaseBegin), "q:" << std::string(queryBegin, queryEnd) << " db:" << std::string(databaseBegin, databaseEnd));
     assert(querySize <= size_t(maxReadLength_));
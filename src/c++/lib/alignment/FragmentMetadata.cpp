@@ -17,6 +17,10 @@
  ** \author Roman Petrovski
  **/
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "alignment/FragmentMetadata.hh"
 #include "common/Debug.hh"
 
@@ -126,28 +130,60 @@ int64_t FragmentMetadata::processBackDels(const AlignmentCfg &cfg, const Cigar &
 //    return ret;
 //}
 
+/**
+ * \brief matches are found 16 bases at a time, then each base adds its fixed-point term without branching
+ */
 double FragmentMetadata::calculateLogProbability(
     unsigned length,
     reference::Contig::const_iterator currentReference,
     std::vector<char>::const_iterator currentSequence,
     std::vector<char>::const_iterator currentQuality)
 {
-    double ret = 0.0;
-    while (length--)
+    FixedLogProbability ret = 0;
+#ifdef __SSE2__
+    const FixedLogProbability *lookup = Quality::getFixedLogProbabilityLookup();
+    for (; length >= sizeof(__m128i); length -= sizeof(__m128i))
     {
-        if (isMatch(*currentSequence, *currentReference))
-        {
-            ret += Quality::getLogMatch(*currentQuality);
-        }
-        else
+        const __m128i sequence = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&*currentSequence));
+        const __m128i reference = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&*currentReference));
+        // qualities compared as unsigned, so that negative ones are caught too
+        ISAAC_ASSERT_MSG(std::all_of(currentQuality, currentQuality + sizeof(__m128i),
+                                     [](const char q){return Quality::getQualityCount() > static_cast<unsigned char>(q);}),
+                         "Incorrect quality in " << std::string(currentQuality, currentQuality + sizeof(__m128i)));
+        // same as isMatch
+        unsigned matches = _mm_movemask_epi8(_mm_cmpeq_epi8(sequence, reference));
+        for (unsigned i = 0; i < sizeof(__m128i); ++i, matches >>= 1)
         {
-            ret += Quality::getLogMismatch(*currentQuality);
+            ret += lookup[unsigned(currentQuality[i]) * 2 + (matches & 1)];
         }
+        currentReference += sizeof(__m128i);
+        currentSequence += sizeof(__m128i);
+        currentQuality += sizeof(__m128i);
+    }
+#endif // __SSE2__
+    while (length--)
+    {
+        ret += Quality::getFixedLogProbability(*currentQuality, isMatch(*currentSequence, *currentReference));
         ++currentReference;
         ++currentSequence;
         ++currentQuality;
     }
-    return ret;
+    return fromFixedLogProbability(ret);
+}
+
+/**
+ * \brief sum of the fixed-point getLogMatch over the qualities
+ */
+static double calculateMatchLogProbability(
+    std::vector<char>::const_iterator qualityBegin,
+    std::vector<char>::const_iterator qualityEnd)
+{
+    FixedLogProbability ret = 0;
+    for (; qualityEnd != qualityBegin; ++qualityBegin)
+    {
+        ret += Quality::getFixedLogMatch(*qualityBegin);
+    }
+    return fromFixedLogProbability(ret);
 }
 
 double FragmentMetadata::calculateInsertionLogProbability(
@@ -155,8 +191,7 @@ double FragmentMetadata::calculateInsertionLogProbability(
     std::vector<char>::const_iterator currentQuality) const
 {
 //    // assume the insertion completes the reference by being introduced exactly as in this read
-    double ret  = std::accumulate(currentQuality, currentQuality + length, 0.0,
-                           bind(std::plus<double>(), _1, boost::bind(&Quality::getLogMatch, _2)));
+    double ret  = calculateMatchLogProbability(currentQuality, currentQuality + length);
 
 //    const char qualityMax = *std::max_element(currentQuality, currentQuality + length);
 //    // assume one highest-quality base mismatches
@@ -269,8 +304,7 @@ void FragmentMetadata::processSoftClip(
     // With inversions, soft clipping can occur in the middle of CIGAR
     //            ISAAC_ASSERT_MSG(0 == i || i + 1 == this->cigarLength, "Soft clippings are expected to be "
     //                "found only at the ends of cigar string");
-    this->logProbability = std::accumulate(qualityBegin + offset, qualityBegin + offset + length, this->logProbability,
-                                           boost::bind(std::plus<double>(), _1, boost::bind(Quality::getLogMatch, _2)));
+    this->logProbability += calculateMatchLogProbability(qualityBegin + offset, qualityBegin + offset + length);
     // NOTE! Not advancing the reference for soft clips
     offset += length;
 }
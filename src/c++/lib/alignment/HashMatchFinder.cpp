@@ -20,7 +20,9 @@
 #include "flowcell/Layout.hh"
 #include "alignment/HashMatchFinder.hh"
 #include "alignment/Quality.hh"
+#include "common/Metrics.hh"
 #include "oligo/KmerGenerator.hpp"
+#include "oligo/Minimizer.hh"
 #include "reference/Seed.hh"
 
 namespace isaac
@@ -122,9 +124,11 @@ ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::ClusterHashMatchFinder(
     const ReferenceHash& referenceHash,
     const std::size_t candidateMatchesMax,
     const unsigned seedBaseQualityMin,
-    const unsigned seedRepeatsMax) :
+    const unsigned seedRepeatsMax,
+    const bool adaptiveSeeds) :
     SeedHashMatchFinder<ReferenceHash>(referenceHash, seedBaseQualityMin),
-    candidateMatchesMax_(candidateMatchesMax)
+    candidateMatchesMax_(candidateMatchesMax),
+    adaptiveSeeds_(adaptiveSeeds)
 {
 }
 
@@ -303,6 +307,42 @@ void offsetsToMatches(const ReferenceOffsetList& mergeBuffer, Matches& matches)
     }
 }
 
+/**
+ * \brief Instead of expanding all the seed hits into mergeBuffers[0], look up each existing candidate
+ *        among the sorted seed hits. This keeps the merge cost proportional to the number of candidates
+ *        rather than to the number of hits of a highly repetitive seed.
+ *
+ * \return the highest count of seeds supporting a match
+ */
+template <typename ReferenceHash, unsigned seedsPerMatchMax>
+template <bool reverse>
+unsigned iSAAC_PROFILING_NOINLINE ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::promoteSeedHits(
+    const flowcell::ReadMetadata& readMetadata,
+    const unsigned seedOffset,
+    const typename ReferenceHash::MatchRange &matchPositions,
+    ReferenceOffsetLists& mergeBuffers) const
+{
+    typedef reference::Seed<KmerT> Seed;
+    ReferenceOffsetList &promoteBuffer = mergeBuffers[0];
+    for (unsigned seeds = 1; seedsPerMatchMax > seeds; ++seeds)
+    {
+        for (const ReferenceOffset candidate : mergeBuffers[seeds])
+        {
+            // inverse of getForwardAlignmentOffset and getReverseAlignmentOffset
+            const ReferenceOffset seedLocation = reverse ?
+                candidate + readMetadata.getLength() + (Seed::STEP - 1) - Seed::SEED_LENGTH - seedOffset :
+                candidate + seedOffset;
+            if (std::binary_search(matchPositions.first, matchPositions.second, seedLocation))
+            {
+                promoteBuffer.push_back(candidate);
+            }
+        }
+    }
+    // mergeSeedHits expects sorted input
+    std::sort(promoteBuffer.begin(), promoteBuffer.end());
+    return mergeSeedHits<seedsPerMatchMax>(mergeBuffers);
+}
+
 template <typename ReferenceHash, unsigned seedsPerMatchMax>
 template<bool filterContigs, bool detectStructuralVariant>
 void iSAAC_PROFILING_NOINLINE ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::buildMatchesIteratively(
@@ -321,6 +361,23 @@ void iSAAC_PROFILING_NOINLINE ClusterHashMatchFinder<ReferenceHash, seedsPerMatc
     unsigned topSeeds = 0;
     for (const SeedHits &seedHits : seedsHits)
     {
+        if (!detectStructuralVariant && adaptiveSeeds_ && candidateMatchesMax_ <= seedHits.hitCount())
+        {
+            // seedsHits are sorted by hit count. This and all the remaining seeds can only promote
+            // the candidates found so far.
+            if (!topSeeds)
+            {
+                break;
+            }
+            // candidates supported by seedsPerMatchMax seeds can't get promoted any further
+            topSeeds = std::max(topSeeds, promoteSeedHits<false>(readMetadata, seedHits.seedOffset_, seedHits.forwardMatches_, fwMergeBuffers));
+            topSeeds = std::max(topSeeds, promoteSeedHits<true>(readMetadata, seedHits.seedOffset_, seedHits.reverseMatches_, rvMergeBuffers));
+            if (topSeeds == seedsPerMatchMax)
+            {
+                break;
+            }
+            continue;
+        }
 
         this->template getSeedAlignmentPositions<false, filterContigs>(
             contigList, seedHits.seedOffset_, readMetadata, filterContigId, seedHits.forwardMatches_, fwMergeBuffers[0]);
@@ -392,6 +449,63 @@ void iSAAC_PROFILING_NOINLINE ClusterHashMatchFinder<ReferenceHash, seedsPerMatc
     // else we either have too many candidate alignments or we have not used enough seeds to trust them.
 }
 
+struct BadBaseMasker
+{
+    BadBaseMasker(const unsigned char seedBaseQualityMin = 0) : seedBaseQualityMin_(seedBaseQualityMin){}
+    unsigned char seedBaseQualityMin_;
+    unsigned char operator[](const char &base) const
+    {
+        return oligo::getQuality(base) < seedBaseQualityMin_ ?
+            oligo::INVALID_OLIGO : static_cast<unsigned char>(base & oligo::BCL_BASE_MASK);
+    }
+};
+
+/**
+ * \brief Looks up forward and reverse-complemented seedKmer. Appends the hits to seedsHits unless
+ *        the seed is a repeat or has no hits.
+ *
+ * \return true if the seed is a repeat
+ */
+template <typename ReferenceHash, unsigned seedsPerMatchMax>
+bool ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::lookupSeed(
+    const Cluster& cluster,
+    const unsigned seedOffset,
+    KmerT seedKmer,
+    const std::size_t seedRepeatThreshold,
+    SeedsHits& seedsHits) const
+{
+    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(
+        cluster.getId(), "seed at offset : " << seedOffset << " " <<
+        (oligo::Bases<oligo::BITS_PER_BASE, KmerT>(seedKmer, oligo::KmerTraits<KmerT>::KMER_BASES)) << "/" <<
+        (oligo::ReverseBases<oligo::BITS_PER_BASE, KmerT>(seedKmer, oligo::KmerTraits<KmerT>::KMER_BASES)));
+    common::metrics::add(common::metrics::SeedsLookedUp, 1);
+    const typename ReferenceHash::MatchRange fwMatchRange = BaseT::referenceHash_.findMatches(seedKmer);
+//    ISAAC_ASSERT_MSG(fwMatchRange.second == std::adjacent_find(fwMatchRange.first, fwMatchRange.second),
+//                     "Duplicate matches unexpected:" << *std::adjacent_find(fwMatchRange.first, fwMatchRange.second) << " " << oligo::bases<2>(seedKmer, Seed::KMER_BASES));
+    if (std::size_t(std::distance(fwMatchRange.first, fwMatchRange.second)) >= seedRepeatThreshold)
+    {
+        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "findReadMatches: " << seedOffset << " fwMatchRange: MatchRange(" << std::distance(fwMatchRange.first, fwMatchRange.second) << ")");
+        return true;
+    }
+
+    seedKmer = oligo::reverseComplement(seedKmer);
+
+    const typename ReferenceHash::MatchRange rvMatchRange = BaseT::referenceHash_.findMatches(seedKmer);
+//    ISAAC_ASSERT_MSG(rvMatchRange.second == std::adjacent_find(rvMatchRange.first, rvMatchRange.second),
+//                     "Duplicate matches unexpected:" << *std::adjacent_find(rvMatchRange.first, rvMatchRange.second) << " " << oligo::bases<2>(seedKmer, Seed::KMER_BASES));
+    const SeedHits hits = { seedOffset, fwMatchRange, rvMatchRange };
+    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "findReadMatches: " << seedOffset << " " << hits);
+    if (hits.hitCount() >= seedRepeatThreshold)
+    {
+        return true;
+    }
+    if (!hits.empty()) //empty hits are either due to no match (unlikely in human) or seed base quality filtering.
+    {
+        seedsHits.push_back(hits);
+    }
+    return false;
+}
+
 template <typename ReferenceHash, unsigned seedsPerMatchMax>
 std::size_t iSAAC_PROFILING_NOINLINE ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::collectSeedHits(
     const Cluster& cluster,
@@ -400,20 +514,17 @@ std::size_t iSAAC_PROFILING_NOINLINE ClusterHashMatchFinder<ReferenceHash, seeds
     const unsigned endSeedOffset,
     SeedsHits& seedsHits) const
 {
-    struct BadBaseMasker
+    if (BaseT::referenceHash_.getMinimizerWindow())
     {
-        BadBaseMasker(const unsigned char seedBaseQualityMin = 0) : seedBaseQualityMin_(seedBaseQualityMin){}
-        unsigned char seedBaseQualityMin_;
-        unsigned char operator[](const char &base) const
-        {
-            return oligo::getQuality(base) < seedBaseQualityMin_ ?
-                oligo::INVALID_OLIGO : static_cast<unsigned char>(base & oligo::BCL_BASE_MASK);
-        }
-    } translator(BaseT::seedBaseQualityMin_);
+        // only minimizers are present in the reference hash
+        return collectMinimizerSeedHits(cluster, readIndex, seedRepeatThreshold, endSeedOffset, seedsHits);
+    }
+
+    const BadBaseMasker translator(BaseT::seedBaseQualityMin_);
 
     typedef reference::Seed <KmerT> Seed;
     const BclClusters::const_iterator bclBegin = cluster.getBclData(readIndex);
-    oligo::InterleavedKmerGenerator<Seed::KMER_BASES, typename Seed::KmerType, BclClusters::const_iterator, Seed::STEP, decltype(translator)>
+    oligo::InterleavedKmerGenerator<Seed::KMER_BASES, typename Seed::KmerType, BclClusters::const_iterator, Seed::STEP, BadBaseMasker>
         kmerGenerator(bclBegin, bclBegin + endSeedOffset, translator);
 
     std::size_t repeatSeeds = 0;
@@ -422,52 +533,180 @@ std::size_t iSAAC_PROFILING_NOINLINE ClusterHashMatchFinder<ReferenceHash, seeds
     while (kmerGenerator.next(seedKmer, bclCurrent))
     {
         const unsigned seedOffset = std::distance(bclBegin, bclCurrent);
+        const std::size_t seedsBefore = seedsHits.size();
+        if (lookupSeed(cluster, seedOffset, seedKmer, seedRepeatThreshold, seedsHits))
+        {
+            ++repeatSeeds;
+        }
+        else if (seedsBefore != seedsHits.size())
+        {
+            kmerGenerator.skip(KmerT::KMER_BASES - 1);
+        }
+    }
+    return repeatSeeds;
+}
+
+/**
+ * \brief Queries the read minimizers using the same window as the one used to sample the reference hash.
+ *        Unlike non-overlapping seeds, a single mismatch only affects the minimizers overlapping it.
+ *
+ * At most one minimizer with hits is kept per SEED_LENGTH slice of the read. This spreads the seeds over
+ * the whole read and keeps their number within the one of the non-overlapping seeds the merge buffers are
+ * sized for. Minimizers without hits or with too many of them don't use up the slice, so the next one in the
+ * slice still gets a chance.
+ */
+template <typename ReferenceHash, unsigned seedsPerMatchMax>
+std::size_t iSAAC_PROFILING_NOINLINE ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::collectMinimizerSeedHits(
+    const Cluster& cluster,
+    const unsigned readIndex,
+    const std::size_t seedRepeatThreshold,
+    const unsigned endSeedOffset,
+    SeedsHits& seedsHits) const
+{
+    const BadBaseMasker translator(BaseT::seedBaseQualityMin_);
+
+    typedef reference::Seed <KmerT> Seed;
+    const BclClusters::const_iterator bclBegin = cluster.getBclData(readIndex);
+    oligo::InterleavedKmerGenerator<Seed::KMER_BASES, typename Seed::KmerType, BclClusters::const_iterator, Seed::STEP, BadBaseMasker>
+        kmerGenerator(bclBegin, bclBegin + endSeedOffset, translator);
+    oligo::MinimizerWindow<KmerT> minimizerWindow(BaseT::referenceHash_.getMinimizerWindow());
+
+    std::size_t repeatSeeds = 0;
+    KmerT seedKmer(0);
+    KmerT minimizer(0);
+    uint64_t minimizerOffset = 0;
+    BclClusters::const_iterator bclCurrent;
+    uint64_t nextSliceOffset = 0;
+    while (seedsHits.capacity() > seedsHits.size() && kmerGenerator.next(seedKmer, bclCurrent))
+    {
+        if (!minimizerWindow.push(seedKmer, std::distance(bclBegin, bclCurrent), minimizer, minimizerOffset) ||
+            nextSliceOffset > minimizerOffset)
+        {
+            continue;
+        }
 
-        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(
-            cluster.getId(), "seed at offset : " << seedOffset << " " <<
-            (oligo::Bases<oligo::BITS_PER_BASE, KmerT>(seedKmer, oligo::KmerTraits<KmerT>::KMER_BASES)) << "/" <<
-            (oligo::ReverseBases<oligo::BITS_PER_BASE, KmerT>(seedKmer, oligo::KmerTraits<KmerT>::KMER_BASES)) << " endSeedOffset:" << endSeedOffset);
-        const typename ReferenceHash::MatchRange fwMatchRange = BaseT::referenceHash_.findMatches(seedKmer);
-//        ISAAC_ASSERT_MSG(fwMatchRange.second == std::adjacent_find(fwMatchRange.first, fwMatchRange.second),
-//                         "Duplicate matches unexpected:" << *std::adjacent_find(fwMatchRange.first, fwMatchRange.second) << " " << oligo::bases<2>(seedKmer, Seed::KMER_BASES));
-//            for(auto it = fwMatchRange.first; it != fwMatchRange.second; ++it)
-//            {
-//                const reference::ContigList::Offset &referenceOffset = *it;
-//                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "fw Hit offset:" << referenceOffset);
-//            }
-        if (std::size_t(std::distance(fwMatchRange.first, fwMatchRange.second)) >= seedRepeatThreshold)
+        const std::size_t seedsBefore = seedsHits.size();
+        if (lookupSeed(cluster, minimizerOffset, minimizer, seedRepeatThreshold, seedsHits))
         {
-            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "findReadMatches: " << seedOffset << " fwMatchRange: MatchRange(" << std::distance(fwMatchRange.first, fwMatchRange.second) << ")");
             ++repeatSeeds;
         }
-        else
+        else if (seedsBefore != seedsHits.size())
         {
-            seedKmer = oligo::reverseComplement(seedKmer);
-
-            const typename ReferenceHash::MatchRange rvMatchRange = BaseT::referenceHash_.findMatches(seedKmer);
-//            ISAAC_ASSERT_MSG(rvMatchRange.second == std::adjacent_find(rvMatchRange.first, rvMatchRange.second),
-//                             "Duplicate matches unexpected:" << *std::adjacent_find(rvMatchRange.first, rvMatchRange.second) << " " << oligo::bases<2>(seedKmer, Seed::KMER_BASES));
-//            for(auto it = rvMatchRange.first; it != rvMatchRange.second; ++it)
-//            {
-//                const reference::ContigList::Offset &referenceOffset = *it;
-//                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "rv Hit offset:" << referenceOffset);
-//            }
-            const SeedHits hits = { seedOffset, fwMatchRange, rvMatchRange };
-            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "findReadMatches: " << seedOffset << " " << hits);
-            if (hits.hitCount() >= seedRepeatThreshold)
-            {
-                ++repeatSeeds;
-            }
-            else if (!hits.empty()) //empty hits are either due to no match (unlikely in human) or seed base quality filtering.
+            nextSliceOffset = (minimizerOffset / SEED_LENGTH + 1) * SEED_LENGTH;
+        }
+    }
+    return repeatSeeds;
+}
+
+/**
+ * \brief Unlike collectSeedHits, queries only the seeds at firstSeedOffset + n * SEED_LENGTH. Seeds
+ *        containing bases below seed base quality threshold are skipped rather than shifted.
+ */
+template <typename ReferenceHash, unsigned seedsPerMatchMax>
+std::size_t iSAAC_PROFILING_NOINLINE ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::collectSparseSeedHits(
+    const Cluster& cluster,
+    const unsigned readIndex,
+    const std::size_t seedRepeatThreshold,
+    const unsigned firstSeedOffset,
+    const unsigned endSeedOffset,
+    SeedsHits& seedsHits) const
+{
+    BOOST_STATIC_ASSERT_MSG(1 == reference::Seed<KmerT>::STEP, "Sparse seeds are only implemented for contiguous seeds");
+    const BadBaseMasker translator(BaseT::seedBaseQualityMin_);
+    const BclClusters::const_iterator bclBegin = cluster.getBclData(readIndex);
+
+    std::size_t repeatSeeds = 0;
+    for (unsigned seedOffset = firstSeedOffset; seedOffset + SEED_LENGTH <= endSeedOffset; seedOffset += SEED_LENGTH)
+    {
+        KmerT seedKmer(0);
+        BclClusters::const_iterator bclCurrent = bclBegin + seedOffset;
+        for (; bclBegin + seedOffset + SEED_LENGTH != bclCurrent; ++bclCurrent)
+        {
+            const unsigned baseValue = translator[*bclCurrent];
+            if (oligo::INVALID_OLIGO <= baseValue)
             {
-                seedsHits.push_back(hits);
-                kmerGenerator.skip(KmerT::KMER_BASES - 1);
+                break;
             }
+            seedKmer <<= oligo::BITS_PER_BASE;
+            seedKmer |= KmerT(baseValue);
+        }
+
+        if (bclBegin + seedOffset + SEED_LENGTH == bclCurrent &&
+            lookupSeed(cluster, seedOffset, seedKmer, seedRepeatThreshold, seedsHits))
+        {
+            ++repeatSeeds;
         }
     }
     return repeatSeeds;
 }
 
+/**
+ * \return true unless there is exactly one candidate supported by at least seedsMin seeds
+ */
+template <typename ReferenceHash, unsigned seedsPerMatchMax>
+bool ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::isAmbiguous(
+    const MatchLists& matchLists, const unsigned seedsMin) const
+{
+    for (unsigned seeds = seedsPerMatchMax; seedsMin <= seeds; --seeds)
+    {
+        if (!matchLists[seeds].empty())
+        {
+            return 1 != matchLists[seeds].size();
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Queries the non-overlapping seeds first. If these don't produce a single well-supported candidate,
+ *        adds the seeds shifted by half seed length. Falls back to collectSeedHits if the read does not have
+ *        enough good seeds at fixed offsets.
+ */
+template <typename ReferenceHash, unsigned seedsPerMatchMax>
+std::size_t ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::findAdaptiveReadMatches(
+    const reference::ContigList &contigList,
+    const Cluster& cluster,
+    const flowcell::ReadMetadata& readMetadata,
+    const std::size_t seedRepeatThreshold,
+    const unsigned seedsMin,
+    SeedsHits& seedsHits,
+    MatchLists& matchLists,
+    ReferenceOffsetLists& fwMergeBuffers,
+    ReferenceOffsetLists& rvMergeBuffers) const
+{
+    const unsigned readIndex = readMetadata.getIndex();
+    std::size_t repeatSeeds = collectSparseSeedHits(
+        cluster, readIndex, seedRepeatThreshold, 0, readMetadata.getLength(), seedsHits);
+    if (seedsMin <= seedsHits.size())
+    {
+        std::sort(seedsHits.begin(), seedsHits.end());
+        buildMatchesIteratively<false, false>(
+            contigList, readMetadata, cluster, BaseT::NO_CONTIG_FILTER, seedsHits, matchLists, fwMergeBuffers, rvMergeBuffers);
+        if (!isAmbiguous(matchLists, seedsMin))
+        {
+            return repeatSeeds;
+        }
+        for (Matches &matches : matchLists) {matches.clear();}
+    }
+
+    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "findAdaptiveReadMatches: querying shifted seeds");
+    repeatSeeds += collectSparseSeedHits(
+        cluster, readIndex, seedRepeatThreshold, SEED_LENGTH / 2, readMetadata.getLength(), seedsHits);
+    if (seedsMin > seedsHits.size())
+    {
+        seedsHits.clear();
+        repeatSeeds = collectSeedHits(cluster, readIndex, seedRepeatThreshold, readMetadata.getLength(), seedsHits);
+    }
+
+    if (seedsMin <= seedsHits.size())
+    {
+        std::sort(seedsHits.begin(), seedsHits.end());
+        buildMatchesIteratively<false, false>(
+            contigList, readMetadata, cluster, BaseT::NO_CONTIG_FILTER, seedsHits, matchLists, fwMergeBuffers, rvMergeBuffers);
+    }
+    return repeatSeeds;
+}
+
 template <typename ReferenceHash, unsigned seedsPerMatchMax>
 iSAAC_PROFILING_NOINLINE
 std::size_t ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::findReadMatches(
@@ -484,11 +723,18 @@ std::size_t ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::findReadMat
                      "Insufficient capacity in matchLists:" << matchLists.capacity() << " for:" << seedsPerMatchMax << " seedsPerMatchMax");
     for (Matches &matches : matchLists) {matches.clear();}
 
-    SeedsHits seedsHits;
-    const std::size_t repeatSeeds = collectSeedHits(cluster, readMetadata.getIndex(), seedRepeatThreshold, readMetadata.getLength(), seedsHits);
-
     // demand LONG_READ_SEEDS_MIN unless read is too short, otherwise demand SHORT_READ_SEEDS_MIN.
     const unsigned seedsMin = std::min(LONG_READ_SEEDS_MIN, std::max(SHORT_READ_SEEDS_MIN, readMetadata.getLength() / 2 / SEED_LENGTH));
+
+    SeedsHits seedsHits;
+    // fixed offset seeds don't work with minimizer-sampled reference hash
+    if (adaptiveSeeds_ && !BaseT::referenceHash_.getMinimizerWindow())
+    {
+        return findAdaptiveReadMatches(contigList, cluster, readMetadata, seedRepeatThreshold, seedsMin,
+                                       seedsHits, matchLists, fwMergeBuffers, rvMergeBuffers);
+    }
+
+    const std::size_t repeatSeeds = collectSeedHits(cluster, readMetadata.getIndex(), seedRepeatThreshold, readMetadata.getLength(), seedsHits);
     if (seedsMin <= seedsHits.size())
     {
         std::sort(seedsHits.begin(), seedsHits.end());
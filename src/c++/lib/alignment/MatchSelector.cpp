@@ -96,7 +96,9 @@ MatchSelector::MatchSelector(
         const TemplateBuilder::DodgyAlignmentScore dodgyAlignmentScore,
         const unsigned anomalousPairHandicap,
         const bool reserveBuffers,
-        const unsigned detectTemplateBlockSize
+        const unsigned detectTemplateBlockSize,
+        const unsigned seedMatchCacheSize,
+        const unsigned slowestClustersMax
     )
     : computeThreads_(maxThreadCount),
       tileMetadataList_(),//(tileMetadataList),
@@ -118,6 +120,8 @@ MatchSelector::MatchSelector(
       threadCluster_(computeThreads_.size(),
                      Cluster(flowcell::getMaxReadLength(flowcellLayoutList_) +
                              flowcell::getMaxBarcodeLength(flowcellLayoutList_))),
+      slowestClustersMax_(slowestClustersMax),
+      threadSlowestClusters_(computeThreads_.size(), matchSelector::SlowestClusters(slowestClustersMax_)),
       threadTemplateBuilders_(computeThreads_.size()),
       threadSemialignedEndsClippers_(clipSemialigned_ ? computeThreads_.size() : 0),
       threadOverlappingEndsClippers_(computeThreads_.size()),
@@ -155,7 +159,12 @@ MatchSelector::MatchSelector(
                                                               smithWatermanGapSizeMax,
                                                               splitAlignments,
                                                               alignmentCfg,
-                                                              dodgyAlignmentScore, anomalousPairHandicap, reserveBuffers));
+                                                              dodgyAlignmentScore, anomalousPairHandicap, reserveBuffers,
+                                                              seedMatchCacheSize));
+        if (slowestClustersMax_)
+        {
+            threadTemplateBuilders_.back().getCostTracer().enable();
+        }
     }
     ISAAC_TRACE_STAT("Constructed match selector");
 }
@@ -174,6 +183,29 @@ void MatchSelector::dumpStats(const boost::filesystem::path &statsXmlPath)
     statsXml.serialize(os);
 }
 
+void MatchSelector::dumpSlowestClusters(const boost::filesystem::path &tsvPath) const
+{
+    if (!slowestClustersMax_)
+    {
+        return;
+    }
+
+    matchSelector::SlowestClusters slowestClusters(slowestClustersMax_);
+    BOOST_FOREACH(const matchSelector::SlowestClusters &threadSlowestClusters, threadSlowestClusters_)
+    {
+        slowestClusters.merge(threadSlowestClusters);
+    }
+
+    std::ofstream os(tsvPath.string().c_str());
+    if (!os) {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "ERROR: Unable to open file for writing: " + tsvPath.string()));
+    }
+    slowestClusters.write(os, tileMetadataList_);
+    if (!os) {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "ERROR: Unable to write: " + tsvPath.string()));
+    }
+}
+
 /**
  * \return false if cluster is unaligned
  */
@@ -235,6 +267,8 @@ void MatchSelector::alignThread(
     Cluster &ourThreadCluster = threadCluster_[threadNumber];
     TemplateBuilder &ourThreadTemplateBuilder = threadTemplateBuilders_.at(threadNumber);
     matchSelector::MatchSelectorStats &ourThreadStats = threadStats_.at(threadNumber);
+    matchSelector::SlowestClusters &ourThreadSlowestClusters = threadSlowestClusters_.at(threadNumber);
+    templateBuilder::CostTracer &ourThreadCostTracer = ourThreadTemplateBuilder.getCostTracer();
 
     const flowcell::Layout &flowcell = flowcellLayoutList_.at(tileMetadata.getFlowcellIndex());
     const flowcell::ReadMetadataList &tileReads = flowcell.getReadMetadataList();
@@ -243,6 +277,9 @@ void MatchSelector::alignThread(
 
     const reference::ContigLists &threadContigLists = contigLists_.threadNodeContainer();
 
+    // template detection shares the template builders. Don't account for its work.
+    ourThreadTemplateBuilder.resetCounters();
+
     boost::unique_lock<boost::mutex> lock(mutex_);
 
     while (tileMetadata.getClusterCount() != threadClusterId)
@@ -286,12 +323,23 @@ void MatchSelector::alignThread(
                     // In either case report it as skipped to ensure statistics consistency
                     if (!pfOnly_ || bclData.pf(clusterId))
                     {
+                        ourThreadCostTracer.start();
                         result = alignCluster(
                             barcodeContigList, tileReads, sequencingAdapters,
                             templateLengthStatistics[barcodeMetadata.getIndex()], barcodeMetadata.getIndex(), matchFinder,
                             restOfGenomeCorrections_[barcodeMetadata.getIndex()],
                             threadNumber, ourThreadTemplateBuilder, ourThreadCluster, bamTemplate, ourThreadStats,
                             fragmentStorage);
+                        if (ourThreadCostTracer.isEnabled())
+                        {
+                            ourThreadCostTracer.stop();
+                            const templateBuilder::CostTracer::Costs &costs = ourThreadCostTracer.getCosts();
+                            if (ourThreadSlowestClusters.qualifies(std::accumulate(costs.begin(), costs.end(), uint64_t(0))))
+                            {
+                                ourThreadSlowestClusters.add(
+                                    matchSelector::ClusterCost(costs, ourThreadCluster, bamTemplate, result));
+                            }
+                        }
                     }
                 }
                 ourThreadStats.recordTemplate(
@@ -300,6 +348,11 @@ void MatchSelector::alignThread(
             }
         }
     }
+
+    ourThreadStats.recordSeedMatchCache(
+        ourThreadTemplateBuilder.getSeedMatchCache().getLookups(), ourThreadTemplateBuilder.getSeedMatchCache().getHits());
+    ourThreadStats.recordUniqueFastPath(
+        ourThreadTemplateBuilder.getTemplatesBuilt(), ourThreadTemplateBuilder.getUniqueFastPathTemplates());
 }
 
 template <typename MatchFinderT>
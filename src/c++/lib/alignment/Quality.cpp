@@ -86,9 +86,26 @@ std::vector<double> getLogMismatchLookup()
     return lookup;
 }
 
+/**
+ ** \brief Create the fixed-point lookup of mismatch (even index) and match (odd index) log probabilities
+ **/
+std::vector<FixedLogProbability> buildFixedLogProbabilityLookup()
+{
+    const std::vector<double> logMatch = getLogMatchLookup();
+    const std::vector<double> logMismatch = getLogMismatchLookup();
+    std::vector<FixedLogProbability> lookup;
+    for(unsigned quality = 0; quality < logMatch.size(); ++quality)
+    {
+        lookup.push_back(toFixedLogProbability(logMismatch.at(quality)));
+        lookup.push_back(toFixedLogProbability(logMatch.at(quality)));
+    }
+    return lookup;
+}
+
 const std::vector<double> Quality::logErrorLookup = getLogErrorLookup();
 const std::vector<double> Quality::logMatchLookup = getLogMatchLookup();
 const std::vector<double> Quality::logMismatchLookup = getLogMismatchLookup();
+const std::vector<FixedLogProbability> Quality::fixedLogProbabilityLookup = buildFixedLogProbabilityLookup();
 
 const unsigned MASK_READ_LENGTH_MIN = 35;
 void trimLowQualityEnd(Read &read, const unsigned baseQualityCutoff)
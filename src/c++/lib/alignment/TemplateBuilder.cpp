@@ -62,7 +62,8 @@ TemplateBuilder::TemplateBuilder(
     const AlignmentCfg &alignmentCfg,
     const DodgyAlignmentScore dodgyAlignmentScore,
     const unsigned anomalousPairHandicap,
-    const bool reserveBuffers)
+    const bool reserveBuffers,
+    const unsigned seedMatchCacheSize)
     : repeatThreshold_(repeatThreshold)
     , seedLength_(seedLength)
     , matchFinderTooManyRepeats_(matchFinderTooManyRepeats)
@@ -82,12 +83,15 @@ TemplateBuilder::TemplateBuilder(
         std::max(matchFinderTooManyRepeats, std::max(matchFinderWayTooManyRepeats, matchFinderShadowSplitRepeats)),
         gappedMismatchesMax, smitWatermanGapsMax_,
         smartSmithWaterman, smithWatermanGapSizeMax, !smitWatermanGapsMax_, splitAlignments,
-        alignmentCfg_, cigarBuffer_, reserveBuffers)
+        alignmentCfg_, cigarBuffer_, reserveBuffers, seedMatchCacheSize)
     , shadowAligner_(collectMismatchCycles, flowcellLayoutList,
                      gappedMismatchesMax, smitWatermanGapsMax_, smartSmithWaterman, !smitWatermanGapsMax_, splitAlignments, alignmentCfg_, cigarBuffer_)
     , splitReadAligner_(collectMismatchCycles, alignmentCfg_)
     , bestCombinationPairInfo_(0)
     , bestRescuedPair_(0)
+    , uniqueFastPath_(false)
+    , templatesBuilt_(0)
+    , uniqueFastPathTemplates_(0)
 
 {
 //    if (reserveBuffers)
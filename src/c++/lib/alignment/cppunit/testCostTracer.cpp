@@ -0,0 +1,86 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testCostTracer.cpp
+ **
+ ** Tests for the attribution of the alignment time to the alignment phases.
+ **/
+
+#include <chrono>
+
+#include "RegistryName.hh"
+#include "testCostTracer.hh"
+
+#include "alignment/templateBuilder/CostTracer.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestCostTracer, registryName("CostTracer"));
+
+using isaac::alignment::templateBuilder::CostTracer;
+
+void TestCostTracer::setUp()
+{
+}
+
+void TestCostTracer::tearDown()
+{
+}
+
+static void spin(const unsigned milliseconds)
+{
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+    while (std::chrono::steady_clock::now() < end)
+    {
+    }
+}
+
+void TestCostTracer::testDisabled()
+{
+    CostTracer tracer;
+    tracer.start();
+    {
+        CostTracer::Scope scope(tracer, CostTracer::Gapped);
+        spin(2);
+    }
+    tracer.stop();
+    for (const uint64_t cost : tracer.getCosts())
+    {
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), cost);
+    }
+}
+
+void TestCostTracer::testNesting()
+{
+    CostTracer tracer;
+    tracer.enable();
+    tracer.start();
+    {
+        CostTracer::Scope shadowScope(tracer, CostTracer::ShadowRescue);
+        spin(5);
+        {
+            CostTracer::Scope gappedScope(tracer, CostTracer::Gapped);
+            spin(20);
+        }
+    }
+    tracer.stop();
+
+    const CostTracer::Costs &costs = tracer.getCosts();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), costs[CostTracer::MatchFinding]);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), costs[CostTracer::Split]);
+    CPPUNIT_ASSERT(costs[CostTracer::ShadowRescue]);
+    // the time spent in the inner phase must not be charged to the outer one
+    CPPUNIT_ASSERT(costs[CostTracer::Gapped] > costs[CostTracer::ShadowRescue]);
+
+    // start discards the previous cluster
+    tracer.start();
+    tracer.stop();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), tracer.getCosts()[CostTracer::Gapped]);
+}
@@ -94,7 +94,7 @@ void TestFragmentBuilder::testEmptyMatchList()
     isaac::alignment::AlignmentCfg alignmentCfg(ELAND_MATCH_SCORE, ELAND_MISMATCH_SCORE, ELAND_GAP_OPEN_SCORE, ELAND_GAP_EXTEND_SCORE, ELAND_MIN_GAP_EXTEND_SCORE, 20000);
     isaac::alignment::Cigar cigarBuffer;
     isaac::alignment::FragmentMetadataList fragments;
-    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, false, alignmentCfg, cigarBuffer, false);
+    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, false, alignmentCfg, cigarBuffer, false, 0);
     CPPUNIT_ASSERT(fragments.empty());
     CPPUNIT_ASSERT(cigarBuffer.empty());
 }
@@ -121,7 +121,7 @@ void TestFragmentBuilder::auxSingleSeed(const unsigned s0, const unsigned s1)
     isaac::alignment::AlignmentCfg alignmentCfg(ELAND_MATCH_SCORE, ELAND_MISMATCH_SCORE, ELAND_GAP_OPEN_SCORE, ELAND_GAP_EXTEND_SCORE, ELAND_MIN_GAP_EXTEND_SCORE, 20000);
     isaac::alignment::Cigar cigarBuffer;
     std::vector<isaac::alignment::FragmentMetadataList> fragments(2);
-    FragmentBuilder fragmentBuilder(true, flowcells, 456, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false);
+    FragmentBuilder fragmentBuilder(true, flowcells, 456, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false, 0);
     // build the fragments
 //    fragmentBuilder.build(contigList, contigAnnotations, readMetadataList[0], seedMetadataList, testAdapters,
 //                          isaac::alignment::TemplateLengthStatistics(), matchList.begin(), matchList.begin() + 1, cluster0, true, fragments[0]);
@@ -206,7 +206,7 @@ void TestFragmentBuilder::testMultiSeed()
     isaac::alignment::AlignmentCfg alignmentCfg(ELAND_MATCH_SCORE, ELAND_MISMATCH_SCORE, ELAND_GAP_OPEN_SCORE, ELAND_GAP_EXTEND_SCORE, ELAND_MIN_GAP_EXTEND_SCORE, 20000);
     isaac::alignment::Cigar cigarBuffer;
     std::vector<isaac::alignment::FragmentMetadataList> fragments(2);
-    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false);
+    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false, 0);
     // build the fragments
 //    fragmentBuilder.build(contigList, contigAnnotations, readMetadataList[0], seedMetadataList, testAdapters,
 //                          isaac::alignment::TemplateLengthStatistics(), matchList.begin(), matchList.begin() + 3, cluster0, true, fragments[0]);
@@ -268,7 +268,7 @@ void TestFragmentBuilder::testRepeats()
     isaac::alignment::AlignmentCfg alignmentCfg(ELAND_MATCH_SCORE, ELAND_MISMATCH_SCORE, ELAND_GAP_OPEN_SCORE, ELAND_GAP_EXTEND_SCORE, ELAND_MIN_GAP_EXTEND_SCORE, 20000);
     isaac::alignment::Cigar cigarBuffer;
     std::vector<isaac::alignment::FragmentMetadataList> fragments(2);
-    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false);
+    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false, 0);
     // build the fragments
 //    fragmentBuilder.build(contigList, contigAnnotations, readMetadataList[0], seedMetadataList, testAdapters,
 //                          isaac::alignment::TemplateLengthStatistics(), matchList.begin(), matchList.begin() + 5, cluster2, true, fragments[0]);
@@ -362,7 +362,7 @@ void TestFragmentBuilder::testMismatches()
     isaac::alignment::AlignmentCfg alignmentCfg(ELAND_MATCH_SCORE, ELAND_MISMATCH_SCORE, ELAND_GAP_OPEN_SCORE, ELAND_GAP_EXTEND_SCORE, ELAND_MIN_GAP_EXTEND_SCORE, 20000);
     isaac::alignment::Cigar cigarBuffer;
     std::vector<isaac::alignment::FragmentMetadataList> fragments(2);
-    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false);
+    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false, 0);
     // build the fragments
 //    fragmentBuilder.build(contigList, contigAnnotations, readMetadataList[0], seedMetadataList, testAdapters,
 //                          isaac::alignment::TemplateLengthStatistics(), matchList.begin(), matchList.begin() + 1, cluster3, true, fragments[0]);
@@ -433,7 +433,7 @@ void TestFragmentBuilder::testLeadingSoftClips()
     isaac::alignment::AlignmentCfg alignmentCfg(ELAND_MATCH_SCORE, ELAND_MISMATCH_SCORE, ELAND_GAP_OPEN_SCORE, ELAND_GAP_EXTEND_SCORE, ELAND_MIN_GAP_EXTEND_SCORE, 20000);
     isaac::alignment::Cigar cigarBuffer;
     std::vector<isaac::alignment::FragmentMetadataList> fragments(2);
-    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false);
+    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false, 0);
     // build the fragments
 //    fragmentBuilder.build(contigList, contigAnnotations, readMetadataList[0], seedMetadataList, testAdapters,
 //                          isaac::alignment::TemplateLengthStatistics(), matchList.begin(), matchList.begin() + 1, cluster4l, true, fragments[0]);
@@ -480,7 +480,7 @@ void TestFragmentBuilder::testTrailingSoftClips()
     isaac::alignment::AlignmentCfg alignmentCfg(ELAND_MATCH_SCORE, ELAND_MISMATCH_SCORE, ELAND_GAP_OPEN_SCORE, ELAND_GAP_EXTEND_SCORE, ELAND_MIN_GAP_EXTEND_SCORE, 20000);
     isaac::alignment::Cigar cigarBuffer;
     std::vector<isaac::alignment::FragmentMetadataList> fragments(2);
-    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false);
+    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false, 0);
     // build the fragments
 //    fragmentBuilder.build(contigList, contigAnnotations, readMetadataList[0], seedMetadataList, testAdapters,
 //                          isaac::alignment::TemplateLengthStatistics(), matchList.begin(), matchList.begin() + 1, cluster4t, true, fragments[0]);
@@ -527,7 +527,7 @@ void TestFragmentBuilder::testLeadingAndTrailingSoftClips()
     isaac::alignment::AlignmentCfg alignmentCfg(ELAND_MATCH_SCORE, ELAND_MISMATCH_SCORE, ELAND_GAP_OPEN_SCORE, ELAND_GAP_EXTEND_SCORE, ELAND_MIN_GAP_EXTEND_SCORE, 20000);
     isaac::alignment::Cigar cigarBuffer;
     std::vector<isaac::alignment::FragmentMetadataList> fragments(2);
-    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false);
+    FragmentBuilder fragmentBuilder(true, flowcells, 123, 16, 1234, 3, 8, 2, false, 32, false, true, alignmentCfg, cigarBuffer, false, 0);
     // build the fragments
 //    fragmentBuilder.build(contigList, contigAnnotations, readMetadataList[0], seedMetadataList, testAdapters,
 //                          isaac::alignment::TemplateLengthStatistics(), matchList.begin(), matchList.begin() + 1, cluster4lt, true, fragments[0]);
@@ -55,13 +55,15 @@ void TestHashMatchFinder::tearDown()
 
 TestMatchStorage TestHashMatchFinder::findMatches(
     const std::string& reference, const std::string& sequence,
-    const isaac::flowcell::ReadMetadataList &readMetadataList)
+    const isaac::flowcell::ReadMetadataList &readMetadataList,
+    const bool adaptiveSeeds,
+    const unsigned minimizerWindow)
 {
     TestContigList contigList(reference);
 
     isaac::common::ThreadVector threads(1);
     isaac::reference::ReferenceHasher<isaac::reference::ReferenceHash<isaac::oligo::VeryShortKmerType> > referenceHasher(
-        contigList, threads, threads.size());
+        contigList, threads, threads.size(), minimizerWindow);
 
     const isaac::reference::ReferenceHash<isaac::oligo::VeryShortKmerType> referenceHash = referenceHasher.generate(0x10000);
 
@@ -92,7 +94,7 @@ TestMatchStorage TestHashMatchFinder::findMatches(
 //        referenceHash, flowcells, isaac::flowcell::BarcodeMetadataList(), 0, repeatThreshold, std::vector<std::size_t>(),
 //        sortedReferenceMetadataList, seedMetadataList, seedMetadataList.size());
     isaac::alignment::ClusterHashMatchFinder< isaac::reference::ReferenceHash<isaac::oligo::VeryShortKmerType>, 4> matchFinder(
-        referenceHash, 1000, 0, 1000);
+        referenceHash, 1000, 0, 1000, adaptiveSeeds);
 
     isaac::alignment::ReferenceOffsetLists fwMergeBuffers(11, isaac::alignment::ReferenceOffsetList(1000));
     isaac::alignment::ReferenceOffsetLists rvMergeBuffers(11, isaac::alignment::ReferenceOffsetList(1000));
@@ -278,3 +280,93 @@ void TestHashMatchFinder::testEverything()
 //    }
     }
 }
+
+void TestHashMatchFinder::testAdaptiveSeeds()
+{
+    {
+        std::string reference("GTGGGGGAAGCTGAGTCTCACTTTGTCGCCCAGGCTGGAGTGCAGCGGCGCCATTTCAGCTCACTGTAACCTCCACCTCTGTGATTCAAGCAATTCTCAT");
+        std::string sequence ("GTGGGGGAAGCTGAGTCTCACTTTGTCGCCCAGGCTGGAGTGCAGCGGCGCCATTTCAGCTCACTGTAACCTCCACCTCTGTGATTCAAGCAATTCTCAT");
+        isaac::flowcell::ReadMetadataList readMetadataList(1, isaac::flowcell::ReadMetadata(1, sequence.length() + 1, 0, 0));
+        TestMatchStorage matchLists = findMatches(reference, sequence, readMetadataList, true);
+
+        CPPUNIT_ASSERT_EQUAL(0UL, matchLists.at(1).size());
+        CPPUNIT_ASSERT_EQUAL(1UL, matchLists.at(4).size());
+        CPPUNIT_ASSERT_EQUAL(1000U, matchLists.at(4).at(0).contigListOffset_);
+        CPPUNIT_ASSERT_EQUAL(false, matchLists.at(4).at(0).reverse_);
+    }
+
+    {
+        std::string reference("ATGAGAATTGCTTGAATCACAGAGGTGGAGGTTACAGTGAGCTGAAATGGCGCCGCTGCACTCCAGCCTGGGCGACAAAGTGAGACTCAGCTTCCCCCAC");
+        std::string sequence ("GTGGGGGAAGCTGAGTCTCACTTTGTCGCCCAGGCTGGAGTGCAGCGGCGCCATTTCAGCTCACTGTAACCTCCACCTCTGTGATTCAAGCAATTCTCAT");
+        isaac::flowcell::ReadMetadataList readMetadataList(1, isaac::flowcell::ReadMetadata(1, 100, 0, 0));
+        TestMatchStorage matchLists = findMatches(reference, sequence, readMetadataList, true);
+
+        CPPUNIT_ASSERT_EQUAL(0UL, matchLists.at(1).size());
+        CPPUNIT_ASSERT_EQUAL(1UL, matchLists.at(4).size());
+        CPPUNIT_ASSERT_EQUAL(1000U, matchLists.at(4).at(0).contigListOffset_);
+        CPPUNIT_ASSERT_EQUAL(true, matchLists.at(4).at(0).reverse_);
+    }
+}
+
+void TestHashMatchFinder::testMinimizers()
+{
+    {
+        std::string reference("GTGGGGGAAGCTGAGTCTCACTTTGTCGCCCAGGCTGGAGTGCAGCGGCGCCATTTCAGCTCACTGTAACCTCCACCTCTGTGATTCAAGCAATTCTCAT");
+        std::string sequence ("GTGGGGGAAGCTGAGTCTCACTTTGTCGCCCAGGCTGGAGTGCAGCGGCGCCATTTCAGCTCACTGTAACCTCCACCTCTGTGATTCAAGCAATTCTCAT");
+        isaac::flowcell::ReadMetadataList readMetadataList(1, isaac::flowcell::ReadMetadata(1, sequence.length() + 1, 0, 0));
+        TestMatchStorage matchLists = findMatches(reference, sequence, readMetadataList, false, 4);
+
+        CPPUNIT_ASSERT_EQUAL(0UL, matchLists.at(1).size());
+        CPPUNIT_ASSERT_EQUAL(1UL, matchLists.at(4).size());
+        CPPUNIT_ASSERT_EQUAL(1000U, matchLists.at(4).at(0).contigListOffset_);
+        CPPUNIT_ASSERT_EQUAL(false, matchLists.at(4).at(0).reverse_);
+    }
+
+    {
+        std::string reference("ATGAGAATTGCTTGAATCACAGAGGTGGAGGTTACAGTGAGCTGAAATGGCGCCGCTGCACTCCAGCCTGGGCGACAAAGTGAGACTCAGCTTCCCCCAC");
+        std::string sequence ("GTGGGGGAAGCTGAGTCTCACTTTGTCGCCCAGGCTGGAGTGCAGCGGCGCCATTTCAGCTCACTGTAACCTCCACCTCTGTGATTCAAGCAATTCTCAT");
+        isaac::flowcell::ReadMetadataList readMetadataList(1, isaac::flowcell::ReadMetadata(1, 100, 0, 0));
+        TestMatchStorage matchLists = findMatches(reference, sequence, readMetadataList, false, 4);
+
+        CPPUNIT_ASSERT_EQUAL(0UL, matchLists.at(1).size());
+        CPPUNIT_ASSERT_EQUAL(1UL, matchLists.at(4).size());
+        CPPUNIT_ASSERT_EQUAL(1000U, matchLists.at(4).at(0).contigListOffset_);
+        CPPUNIT_ASSERT_EQUAL(true, matchLists.at(4).at(0).reverse_);
+    }
+
+    // mismatches every 12 bases leave only some of the overlapping minimizers intact
+    {
+        std::string reference("GTGGGGGAAGCTGAGTCTCACTTTGTCGCCCAGGCTGGAGTGCAGCGGCGCCATTTCAGCTCACTGTAACCTCCACCTCTGTGATTCAAGCAATTCTCAT");
+        std::string sequence (reference);
+        for (std::size_t pos = 11; sequence.length() > pos; pos += 12)
+        {
+            sequence[pos] = 'A' == sequence[pos] ? 'C' : 'A';
+        }
+        isaac::flowcell::ReadMetadataList readMetadataList(1, isaac::flowcell::ReadMetadata(1, sequence.length() + 1, 0, 0));
+        TestMatchStorage matchLists = findMatches(reference, sequence, readMetadataList, false, 2);
+
+        std::size_t bestSeeds = 4;
+        while (bestSeeds && matchLists.at(bestSeeds).empty())
+        {
+            --bestSeeds;
+        }
+        CPPUNIT_ASSERT(bestSeeds >= 2);
+        CPPUNIT_ASSERT_EQUAL(1UL, matchLists.at(bestSeeds).size());
+        CPPUNIT_ASSERT_EQUAL(1000U, matchLists.at(bestSeeds).at(0).contigListOffset_);
+    }
+
+    // pieces of the read 5' end are scattered over the reference, the read locus is only recognizable by its 3' end
+    {
+        const std::string sequence ("TTAGTTGTGCCGCAGCGAAGTAGTGCTTGAAATATGCGACCCCTAAGTAGGAGCGTATGCGCCCAGTAACCAATGCCTGTTGAGATGCCAGACGCGTAAC");
+        const std::string reference(
+            "CATAGAAACCATGCCGCAGCGACAATAGACAGGTGAAGTAGTGCCATAATCGGTCCATGCGCCCAGACCGGATCATTGAGGAGCGTATGTGCATAG"
+            "AGCCCCCTAAGTAGTGGGCGTTAACGTATGCGACCCCCCTTTATTACTTTAGTTGTGCAGCTTAATGGTAGCTTGAAATATCACATTGACAAACAC"
+            "GGCATTAAGTAGCGACGAAACGGGATTTGCCTGACCGGGGAGAAGCCGGTCGATCAGCAGTGGTAACAATGCCTGTTGAGATGCCAGACGCGTAAC");
+        isaac::flowcell::ReadMetadataList readMetadataList(1, isaac::flowcell::ReadMetadata(1, sequence.length() + 1, 0, 0));
+        TestMatchStorage matchLists = findMatches(reference, sequence, readMetadataList, false, 2);
+
+        CPPUNIT_ASSERT_EQUAL(1UL, matchLists.at(4).size());
+        CPPUNIT_ASSERT_EQUAL(1188U, matchLists.at(4).at(0).contigListOffset_);
+        CPPUNIT_ASSERT_EQUAL(false, matchLists.at(4).at(0).reverse_);
+    }
+}
@@ -38,6 +38,8 @@ class TestHashMatchFinder : public CppUnit::TestFixture
 {
     CPPUNIT_TEST_SUITE( TestHashMatchFinder );
     CPPUNIT_TEST( testEverything );
+    CPPUNIT_TEST( testAdaptiveSeeds );
+    CPPUNIT_TEST( testMinimizers );
     CPPUNIT_TEST_SUITE_END();
 private:
 
@@ -46,12 +48,16 @@ public:
     void setUp();
     void tearDown();
     void testEverything();
+    void testAdaptiveSeeds();
+    void testMinimizers();
 
 private:
     TestMatchStorage findMatches(
         const std::string& reference,
         const std::string& sequence,
-        const isaac::flowcell::ReadMetadataList &readMetadataList);
+        const isaac::flowcell::ReadMetadataList &readMetadataList,
+        const bool adaptiveSeeds = false,
+        const unsigned minimizerWindow = 0);
 };
 
 #endif // #ifndef iSAAC_ALIGNMENT_TEST_SEQUENCING_ADAPTER_HH
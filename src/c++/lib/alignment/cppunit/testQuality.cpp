@@ -0,0 +1,78 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testQuality.cpp
+ **
+ ** Tests for the fixed-point log probabilities.
+ **/
+
+#include <cstdlib>
+
+#include "RegistryName.hh"
+#include "testQuality.hh"
+
+#include "alignment/FragmentMetadata.hh"
+#include "alignment/Quality.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestQuality, registryName("Quality"));
+
+using isaac::alignment::FixedLogProbability;
+using isaac::alignment::FragmentMetadata;
+using isaac::alignment::Quality;
+
+void TestQuality::setUp()
+{
+}
+
+void TestQuality::tearDown()
+{
+}
+
+void TestQuality::testFixedLookup()
+{
+    for (unsigned quality = 0; quality < 100; ++quality)
+    {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(Quality::getLogMatch(quality),
+            isaac::alignment::fromFixedLogProbability(Quality::getFixedLogProbability(quality, true)), 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(Quality::getLogMismatch(quality),
+            isaac::alignment::fromFixedLogProbability(Quality::getFixedLogProbability(quality, false)), 1e-9);
+        CPPUNIT_ASSERT_EQUAL(Quality::getFixedLogProbability(quality, true), Quality::getFixedLogMatch(quality));
+    }
+}
+
+void TestQuality::testFixedLogProbability()
+{
+    std::srand(17);
+    for (unsigned length = 0; length < 300; length += 7)
+    {
+        std::vector<char> sequence;
+        std::vector<char> quality;
+        isaac::reference::Contig::ReferenceSequence reference;
+        double floatingPoint = 0.0;
+        for (unsigned i = 0; i < length; ++i)
+        {
+            sequence.push_back("ACGTN"[std::rand() % 5]);
+            reference.push_back(std::rand() % 8 ? sequence.back() : "ACGTN"[std::rand() % 5]);
+            quality.push_back(std::rand() % 42);
+            floatingPoint += sequence.back() == reference.back() ?
+                Quality::getLogMatch(quality.back()) : Quality::getLogMismatch(quality.back());
+        }
+        const double fixedPoint = FragmentMetadata::calculateLogProbability(length, reference.begin(), sequence.begin(), quality.begin());
+        CPPUNIT_ASSERT(isaac::alignment::ISAAC_LP_EQUALS(floatingPoint, fixedPoint));
+
+        // exact, regardless of how the bases are split
+        const unsigned split = length / 3;
+        CPPUNIT_ASSERT_EQUAL(fixedPoint,
+            FragmentMetadata::calculateLogProbability(split, reference.begin(), sequence.begin(), quality.begin()) +
+            FragmentMetadata::calculateLogProbability(length - split, reference.begin() + split, sequence.begin() + split, quality.begin() + split));
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testSeedMatchCache.cpp
+ **
+ ** Tests for the per-thread seed match cache.
+ **/
+
+#include "RegistryName.hh"
+#include "testSeedMatchCache.hh"
+
+#include "alignment/templateBuilder/SeedMatchCache.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestSeedMatchCache, registryName("SeedMatchCache"));
+
+using isaac::alignment::Match;
+using isaac::alignment::MatchLists;
+using isaac::alignment::templateBuilder::SeedMatchCache;
+
+void TestSeedMatchCache::setUp()
+{
+}
+
+void TestSeedMatchCache::tearDown()
+{
+}
+
+static MatchLists makeMatchLists()
+{
+    MatchLists ret(3);
+    for (isaac::alignment::Matches &matches : ret)
+    {
+        matches.reserve(SeedMatchCache::MATCHES_PER_ENTRY_MAX * 2);
+    }
+    return ret;
+}
+
+static SeedMatchCache::Key makeKey(const uint64_t hash, const unsigned readIndex)
+{
+    const SeedMatchCache::Key ret = {hash, 100, 0, 0, 1, readIndex, 1000};
+    return ret;
+}
+
+void TestSeedMatchCache::testHitMiss()
+{
+    SeedMatchCache cache(16, 3);
+    CPPUNIT_ASSERT(cache.isEnabled());
+
+    MatchLists matchLists = makeMatchLists();
+    std::size_t uncheckedSeeds = 0;
+    CPPUNIT_ASSERT(!cache.lookup(makeKey(5, 0), matchLists, uncheckedSeeds));
+
+    matchLists[1].push_back(Match(100, false));
+    matchLists[2].push_back(Match(200, true));
+    matchLists[2].push_back(Match(300, false));
+    cache.store(makeKey(5, 0), matchLists, 2);
+
+    MatchLists restored = makeMatchLists();
+    CPPUNIT_ASSERT(cache.lookup(makeKey(5, 0), restored, uncheckedSeeds));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), uncheckedSeeds);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), restored[0].size());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), restored[1].size());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), restored[2].size());
+    CPPUNIT_ASSERT_EQUAL(300UL, restored[2][1].contigListOffset_);
+    CPPUNIT_ASSERT(restored[2][0].reverse_);
+
+    // same slot, different read
+    CPPUNIT_ASSERT(!cache.lookup(makeKey(5, 1), restored, uncheckedSeeds));
+    // same slot, different hash
+    CPPUNIT_ASSERT(!cache.lookup(makeKey(5 + 16, 0), restored, uncheckedSeeds));
+
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4), cache.getLookups());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), cache.getHits());
+    cache.resetCounters();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), cache.getLookups());
+}
+
+void TestSeedMatchCache::testOverflow()
+{
+    SeedMatchCache cache(16, 3);
+    MatchLists matchLists = makeMatchLists();
+    for (unsigned i = 0; SeedMatchCache::MATCHES_PER_ENTRY_MAX >= i; ++i)
+    {
+        matchLists[1].push_back(Match(i, false));
+    }
+    cache.store(makeKey(7, 0), matchLists, 0);
+
+    std::size_t uncheckedSeeds = 0;
+    CPPUNIT_ASSERT(!cache.lookup(makeKey(7, 0), matchLists, uncheckedSeeds));
+}
@@ -24,6 +24,7 @@
 #include "RegistryName.hh"
 #include "testShadowAligner.hh"
 #include "alignment/TemplateLengthStatistics.hh"
+#include "alignment/templateBuilder/ShadowKmerIndex.hh"
 
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestShadowAligner, registryName("ShadowAligner"));
 
@@ -261,3 +262,75 @@ void TestShadowAligner::testRescueShadowLongest()
     }
     }
 }
+
+void TestShadowAligner::testShadowKmerIndex()
+{
+    typedef isaac::alignment::templateBuilder::ShadowKmerIndex<8> Index;
+    Index index;
+    CPPUNIT_ASSERT_EQUAL(short(Index::NOT_FOUND), index.find(5));
+    CPPUNIT_ASSERT(index.insert(5, 10));
+    CPPUNIT_ASSERT(index.insert(6, 11));
+    // first occurrence wins
+    CPPUNIT_ASSERT(!index.insert(5, 12));
+    CPPUNIT_ASSERT_EQUAL(short(10), index.find(5));
+    CPPUNIT_ASSERT_EQUAL(short(11), index.find(6));
+
+    index.reset();
+    CPPUNIT_ASSERT_EQUAL(short(Index::NOT_FOUND), index.find(5));
+    CPPUNIT_ASSERT(index.insert(5, 13));
+    CPPUNIT_ASSERT_EQUAL(short(13), index.find(5));
+
+    // k-mers stored before the epoch wraps must not resurface after it
+    for (unsigned i = 0; 0x10000 != i; ++i)
+    {
+        index.reset();
+        CPPUNIT_ASSERT_EQUAL(short(Index::NOT_FOUND), index.find(5));
+    }
+}
+
+/**
+ * \brief Alternates the rescue of each read of the pair by the other one. K-mers of the previous shadow must
+ *        not affect the next rescue.
+ */
+void TestShadowAligner::testRepeatedRescues()
+{
+    using isaac::alignment::templateBuilder::ShadowAligner;
+    using isaac::alignment::TemplateLengthStatistics;
+    using isaac::alignment::Cluster;
+    using isaac::alignment::FragmentMetadata;
+
+    isaac::alignment::Cigar cigarBuffer;
+    cigarBuffer.reserve(10000);
+    ShadowAligner<8> shadowAligner(true, flowcells, 8, 2, false, false, false, alignmentCfg, cigarBuffer);
+    const TemplateLengthStatistics tls(200, 400, 312, 38, 26, TemplateLengthStatistics::FRp, TemplateLengthStatistics::RFm, -1);
+    const isaac::alignment::BclClusters bcl0(getBcl(readMetadataList, contigList, 0, 0, 0, false, true));
+    Cluster cluster0(getMaxReadLength(readMetadataList));
+    cluster0.init(readMetadataList, bcl0.cluster(0), 1101, 999, isaac::alignment::ClusterXy(0,0), true, 0, 0);
+    FragmentMetadata orphan0;
+    isaac::alignment::FragmentMetadataList shadowList(50);
+    orphan0.cluster = &cluster0;
+    orphan0.readIndex = 0;
+    orphan0.contigId = 0;
+    orphan0.position = 0;
+    orphan0.reverse = false;
+
+    for (unsigned i = 0; 100 != i; ++i)
+    {
+        cigarBuffer.clear();
+        CPPUNIT_ASSERT(shadowAligner.rescueShadows(contigList, orphan0, 100, shadowList, readMetadataList[1], testAdapters, tls));
+        const FragmentMetadata orphan1 = shadowList[0];
+        CPPUNIT_ASSERT_EQUAL(1U, orphan1.readIndex);
+        CPPUNIT_ASSERT_EQUAL(98L, orphan1.position);
+        CPPUNIT_ASSERT_EQUAL(true, orphan1.reverse);
+        CPPUNIT_ASSERT_EQUAL(0U, orphan1.mismatchCount);
+        CPPUNIT_ASSERT_EQUAL(isaac::alignment::Cigar::toString(orphan1.cigarBegin(), orphan1.cigarEnd()), std::string("92M"));
+
+        cigarBuffer.clear();
+        CPPUNIT_ASSERT(shadowAligner.rescueShadows(contigList, orphan1, 100, shadowList, readMetadataList[0], testAdapters, tls));
+        CPPUNIT_ASSERT_EQUAL(0U, shadowList[0].readIndex);
+        CPPUNIT_ASSERT_EQUAL(0L, shadowList[0].position);
+        CPPUNIT_ASSERT_EQUAL(false, shadowList[0].reverse);
+        CPPUNIT_ASSERT_EQUAL(0U, shadowList[0].mismatchCount);
+        CPPUNIT_ASSERT_EQUAL(isaac::alignment::Cigar::toString(shadowList[0].cigarBegin(), shadowList[0].cigarEnd()), std::string("81M"));
+    }
+}
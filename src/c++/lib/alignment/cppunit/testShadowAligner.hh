@@ -27,6 +27,8 @@ class TestShadowAligner : public CppUnit::TestFixture
     CPPUNIT_TEST_SUITE( TestShadowAligner );
     CPPUNIT_TEST( testRescueShadowShortest );
     CPPUNIT_TEST( testRescueShadowLongest );
+    CPPUNIT_TEST( testShadowKmerIndex );
+    CPPUNIT_TEST( testRepeatedRescues );
     CPPUNIT_TEST_SUITE_END();
 private:
     const std::vector<isaac::flowcell::ReadMetadata> readMetadataList;
@@ -39,6 +41,8 @@ public:
     void tearDown();
     void testRescueShadowShortest();
     void testRescueShadowLongest();
+    void testShadowKmerIndex();
+    void testRepeatedRescues();
 };
 
 #endif // #ifndef iSAAC_ALIGNMENT_TEST_SHADOW_ALIGNER_HH
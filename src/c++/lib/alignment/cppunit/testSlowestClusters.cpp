@@ -0,0 +1,185 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testSlowestClusters.cpp
+ **
+ ** Tests for the bounded collection of the most expensive clusters.
+ **/
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/assign.hpp>
+#include <boost/thread.hpp>
+
+#include "RegistryName.hh"
+#include "testSlowestClusters.hh"
+
+#include "BuilderInit.hh"
+#include "alignment/matchSelector/SlowestClusters.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestSlowestClusters, registryName("SlowestClusters"));
+
+using isaac::alignment::matchSelector::ClusterCost;
+using isaac::alignment::matchSelector::SlowestClusters;
+using isaac::alignment::templateBuilder::CostTracer;
+
+static const unsigned READ_LENGTH = 20;
+
+void TestSlowestClusters::setUp()
+{
+}
+
+void TestSlowestClusters::tearDown()
+{
+}
+
+/**
+ * \brief Unaligned pair of reads named name with total cycles charged to match finding
+ */
+static ClusterCost makeCost(const uint64_t total, const uint64_t clusterId, const std::string &name = "")
+{
+    const isaac::flowcell::ReadMetadataList readMetadataList = getReadMetadataList(READ_LENGTH, READ_LENGTH);
+    // the name follows the bases of the reads
+    const std::size_t clusterLength = READ_LENGTH * 2 + name.size() + 1;
+    isaac::alignment::BclClusters bcl(clusterLength);
+    bcl.reset(clusterLength, 1);
+    std::fill(bcl.cluster(0), bcl.cluster(0) + clusterLength, 0);
+    std::copy(name.begin(), name.end(), bcl.cluster(0) + READ_LENGTH * 2);
+
+    isaac::alignment::Cluster cluster(READ_LENGTH);
+    cluster.init(readMetadataList, bcl.cluster(0), 0, clusterId, isaac::alignment::ClusterXy(0, 0), true, 0, name.size() + 1);
+    const isaac::alignment::BamTemplate bamTemplate(readMetadataList, cluster);
+
+    CostTracer::Costs costs;
+    costs.fill(0);
+    costs[CostTracer::MatchFinding] = total;
+    return ClusterCost(costs, cluster, bamTemplate, isaac::alignment::matchSelector::NmNm);
+}
+
+/**
+ * \return tab-separated fields of each line write produces, header excluded
+ */
+static std::vector<std::vector<std::string> > write(const SlowestClusters &slowestClusters)
+{
+    const isaac::flowcell::TileMetadataList tileMetadataList(std::vector<isaac::flowcell::TileMetadata>(
+        1, isaac::flowcell::TileMetadata("FC1", 0, 1101, 1, 1000, 0)));
+    std::ostringstream os;
+    slowestClusters.write(os, tileMetadataList);
+
+    std::vector<std::string> lines;
+    const std::string text = os.str();
+    boost::algorithm::split(lines, text, boost::algorithm::is_any_of("\n"));
+    CPPUNIT_ASSERT(lines.size() >= 2);
+    CPPUNIT_ASSERT_EQUAL('#', lines.front().at(0));
+    CPPUNIT_ASSERT(lines.back().empty());
+
+    std::vector<std::vector<std::string> > ret;
+    for (std::vector<std::string>::const_iterator line = lines.begin() + 1; lines.end() - 1 != line; ++line)
+    {
+        ret.push_back(std::vector<std::string>());
+        boost::algorithm::split(ret.back(), *line, boost::algorithm::is_any_of("\t"));
+    }
+    return ret;
+}
+
+static const unsigned CLUSTER_FIELD = 3;
+static const unsigned NAME_FIELD = 4;
+static const unsigned TOTAL_FIELD = 7;
+
+void TestSlowestClusters::testEviction()
+{
+    SlowestClusters slowestClusters(3);
+    const uint64_t totals[] = {5, 1, 7, 3, 9, 7, 2};
+    for (unsigned i = 0; sizeof(totals) / sizeof(totals[0]) != i; ++i)
+    {
+        slowestClusters.add(makeCost(totals[i], i));
+    }
+    // equal to the cheapest kept is not enough
+    CPPUNIT_ASSERT(!slowestClusters.qualifies(7));
+    CPPUNIT_ASSERT(slowestClusters.qualifies(8));
+
+    const std::vector<std::vector<std::string> > lines = write(slowestClusters);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), lines.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("9"), lines.at(0).at(TOTAL_FIELD));
+    CPPUNIT_ASSERT_EQUAL(std::string("4"), lines.at(0).at(CLUSTER_FIELD));
+    CPPUNIT_ASSERT_EQUAL(std::string("7"), lines.at(1).at(TOTAL_FIELD));
+    CPPUNIT_ASSERT_EQUAL(std::string("7"), lines.at(2).at(TOTAL_FIELD));
+    CPPUNIT_ASSERT_EQUAL(std::string("FC1"), lines.at(0).at(0));
+    CPPUNIT_ASSERT_EQUAL(std::string("NmNm"), lines.at(0).at(5));
+
+    // disabled collection keeps nothing
+    SlowestClusters disabled(0);
+    CPPUNIT_ASSERT(!disabled.qualifies(-1UL));
+    disabled.add(makeCost(100, 0));
+    CPPUNIT_ASSERT(write(disabled).empty());
+}
+
+static void addClusters(SlowestClusters &slowestClusters, const unsigned thread, const unsigned threadsCount)
+{
+    // threads see interleaved totals, so the slowest clusters of the run are spread across all of them
+    for (unsigned cluster = thread; 100 > cluster; cluster += threadsCount)
+    {
+        if (slowestClusters.qualifies(cluster))
+        {
+            slowestClusters.add(makeCost(cluster, cluster));
+        }
+    }
+}
+
+void TestSlowestClusters::testMerge()
+{
+    static const unsigned THREADS_COUNT = 4;
+    static const unsigned CLUSTERS_MAX = 10;
+    const SlowestClusters prototype(CLUSTERS_MAX);
+    std::vector<SlowestClusters> threadClusters(THREADS_COUNT, prototype);
+
+    boost::thread_group threads;
+    for (unsigned thread = 0; THREADS_COUNT != thread; ++thread)
+    {
+        threads.create_thread(boost::bind(&addClusters, boost::ref(threadClusters.at(thread)), thread, THREADS_COUNT));
+    }
+    threads.join_all();
+
+    SlowestClusters slowestClusters(prototype);
+    for (const SlowestClusters &clusters : threadClusters)
+    {
+        slowestClusters.merge(clusters);
+    }
+
+    const std::vector<std::vector<std::string> > lines = write(slowestClusters);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(CLUSTERS_MAX), lines.size());
+    for (unsigned i = 0; CLUSTERS_MAX != i; ++i)
+    {
+        std::ostringstream expected;
+        expected << 99 - i;
+        CPPUNIT_ASSERT_EQUAL(expected.str(), lines.at(i).at(TOTAL_FIELD));
+        CPPUNIT_ASSERT_EQUAL(expected.str(), lines.at(i).at(CLUSTER_FIELD));
+    }
+}
+
+void TestSlowestClusters::testNames()
+{
+    const std::string longName(ClusterCost::NAME_LENGTH_MAX + 10, 'n');
+    SlowestClusters slowestClusters(3);
+    slowestClusters.add(makeCost(3, 0, "read0"));
+    slowestClusters.add(makeCost(2, 1, longName));
+    slowestClusters.add(makeCost(1, 2));
+
+    const std::vector<std::vector<std::string> > lines = write(slowestClusters);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), lines.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("read0"), lines.at(0).at(NAME_FIELD));
+    CPPUNIT_ASSERT_EQUAL(longName.substr(0, ClusterCost::NAME_LENGTH_MAX), lines.at(1).at(NAME_FIELD));
+    CPPUNIT_ASSERT_EQUAL(std::string("-"), lines.at(2).at(NAME_FIELD));
+}
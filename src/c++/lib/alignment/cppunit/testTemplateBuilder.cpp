@@ -152,7 +152,7 @@ void TestTemplateBuilder::testEmptyMatchList()
     const isaac::alignment::AlignmentCfg alignmentCfg(ELAND_MATCH_SCORE, ELAND_MISMATCH_SCORE, ELAND_GAP_OPEN_SCORE, ELAND_GAP_EXTEND_SCORE, ELAND_MIN_GAP_EXTEND_SCORE, 20000);
     std::auto_ptr<TemplateBuilder> templateBuilder(new TemplateBuilder(true, flowcells, 10, 10, 16, 4, 1000, 1000, 1000, false, true, false, false, 8, 2, false, 32, false,
                                                                        alignmentCfg,
-                                                                       TemplateBuilder::DODGY_ALIGNMENT_SCORE_UNALIGNED, 4, false));
+                                                                       TemplateBuilder::DODGY_ALIGNMENT_SCORE_UNALIGNED, 4, false, 0));
     BamTemplate bamTemplate;
     CPPUNIT_ASSERT_EQUAL(0U, bamTemplate.getFragmentCount());
     isaac::alignment::TemplateBuilder::FragmentMetadataLists fragments;
@@ -182,7 +182,7 @@ void TestTemplateBuilder::testOrphan()
     const isaac::alignment::AlignmentCfg alignmentCfg(ELAND_MATCH_SCORE, ELAND_MISMATCH_SCORE, ELAND_GAP_OPEN_SCORE, ELAND_GAP_EXTEND_SCORE, ELAND_MIN_GAP_EXTEND_SCORE, 20000);
     TemplateBuilder templateBuilder(true, flowcells, 10, 10, 16, 4, 1000, 1000, 1000, false, true, false, false, 8, 2, false, 32, true,
                                     alignmentCfg,
-                                    TemplateBuilder::DODGY_ALIGNMENT_SCORE_UNALIGNED, 4, false);
+                                    TemplateBuilder::DODGY_ALIGNMENT_SCORE_UNALIGNED, 4, false, 0);
     BamTemplate bamTemplate;
     isaac::alignment::TemplateBuilder::FragmentMetadataLists fragments;
     // align on the first read only
@@ -230,7 +230,7 @@ void TestTemplateBuilder::testUnique()
     const isaac::alignment::AlignmentCfg alignmentCfg(ELAND_MATCH_SCORE, ELAND_MISMATCH_SCORE, ELAND_GAP_OPEN_SCORE, ELAND_GAP_EXTEND_SCORE, ELAND_MIN_GAP_EXTEND_SCORE, 20000);
     TemplateBuilder templateBuilder(true, flowcells, 10, 10, 16, 4, 1000, 1000, 1000, false, true, false, false, 8, 2, false, 32, true,
                                     alignmentCfg,
-                                    TemplateBuilder::DODGY_ALIGNMENT_SCORE_UNALIGNED, 4, false);
+                                    TemplateBuilder::DODGY_ALIGNMENT_SCORE_UNALIGNED, 4, false, 0);
     BamTemplate bamTemplate;
     isaac::alignment::TemplateBuilder::FragmentMetadataLists fragments;
     fragments[0].push_back(f0_0);
@@ -279,7 +279,7 @@ void TestTemplateBuilder::testPeAdapterTrim()
     {
         TemplateBuilder templateBuilder(true, flowcells, 10, 10, 16, 4, 1000, 1000, 1000, false, true, false, false, 8, 2, false, 32, true,
                                         alignmentCfg,
-                                        TemplateBuilder::DODGY_ALIGNMENT_SCORE_UNALIGNED, 4, false);
+                                        TemplateBuilder::DODGY_ALIGNMENT_SCORE_UNALIGNED, 4, false, 0);
         BamTemplate bamTemplate;
         isaac::alignment::TemplateBuilder::FragmentMetadataLists fragments;
         fragments[0].push_back(f1_0);
@@ -319,7 +319,7 @@ void TestTemplateBuilder::testPeAdapterTrim()
     {
         TemplateBuilder templateBuilder(true, flowcells, 10, 10, 16, 4, 1000, 1000, 1000, false, true, true, false, 8, 2, false, 32, true,
                                         alignmentCfg,
-                                        TemplateBuilder::DODGY_ALIGNMENT_SCORE_UNALIGNED, 4, false);
+                                        TemplateBuilder::DODGY_ALIGNMENT_SCORE_UNALIGNED, 4, false, 0);
         BamTemplate bamTemplate;
         isaac::alignment::TemplateBuilder::FragmentMetadataLists fragments;
         fragments[0].push_back(f1_0);
@@ -370,7 +370,7 @@ void TestTemplateBuilder::testMultiple()
     const isaac::alignment::AlignmentCfg alignmentCfg(ELAND_MATCH_SCORE, ELAND_MISMATCH_SCORE, ELAND_GAP_OPEN_SCORE, ELAND_GAP_EXTEND_SCORE, ELAND_MIN_GAP_EXTEND_SCORE, 20000);
     TemplateBuilder templateBuilder(true, flowcells, 10, 10, 16, 4, 1000, 1000, 1000, false, true, false, false, 8, 2, false, 32, true,
                                     alignmentCfg,
-                                    TemplateBuilder::DODGY_ALIGNMENT_SCORE_UNALIGNED, 4, false);
+                                    TemplateBuilder::DODGY_ALIGNMENT_SCORE_UNALIGNED, 4, false, 0);
     BamTemplate bamTemplate;
 
     isaac::alignment::TemplateBuilder::FragmentMetadataLists fragments;
@@ -22,6 +22,7 @@
 
 #include "common/Debug.hh"
 #include "common/Exceptions.hh"
+#include "common/Metrics.hh"
 #include "alignment/BinMetadata.hh"
 #include "alignment/matchSelector/BinningFragmentStorage.hh"
 
@@ -187,6 +188,7 @@ void FragmentBinner::flushBuffer(
 {
 //    ISAAC_THREAD_CERR << "flushBuffer fileIndex: " << fileIndex << " for " << buffer.size() << std::endl;
     boost::unique_lock<boost::mutex> lock(binMutex_[fileIndex % binMutex_.size()]);
+    uint64_t fragmentBytes = 0;
     for (const char *p = &buffer.front(); &buffer.front() + buffer.size() != p;)
     {
         const io::FragmentAccessor &fragment0 = reinterpret_cast<const io::FragmentAccessor &>(*p);
@@ -199,16 +201,22 @@ void FragmentBinner::flushBuffer(
             const BinIndexList &binIndexList = *reinterpret_cast<const BinIndexList *>(fragment1.end());
             flushSingle(fragment0, binIndexList, binMetadataList, fileIndex);
             flushSingle(fragment1, binIndexList, binMetadataList, fileIndex);
+            fragmentBytes += fragment0.getTotalLength() + fragment1.getTotalLength();
             p = reinterpret_cast<const char*>(&binIndexList.indexes_[binIndexList.indexCount_]);
         }
         else
         {
             const BinIndexList &binIndexList = *reinterpret_cast<const BinIndexList *>(fragment0.end());
             flushSingle(fragment0, binIndexList, binMetadataList, fileIndex);
+            fragmentBytes += fragment0.getTotalLength();
             p = reinterpret_cast<const char*>(&binIndexList.indexes_[binIndexList.indexCount_]);
         }
     }
     buffer.clear();
+#ifndef ISAAC_TEMP_STORE_DISABLED
+    // counted once per buffer to keep the increments out of the per-fragment loop
+    common::metrics::add(common::metrics::TempBytesWritten, fragmentBytes);
+#endif //ISAAC_TEMP_STORE_DISABLED
 //    ISAAC_THREAD_CERR << "flushBuffer fileIndex: " << fileIndex << " for " << buffer.size() << " done" << std::endl;
 }
 
@@ -254,6 +254,24 @@ void MatchSelectorStatsXml::serlializeTile(
     ISAAC_XML_WRITER_ELEMENT_BLOCK(xmlWriter, "Tile")
     {
         xmlWriter.writeAttribute("number", tile.getTile());
+        const MatchSelectorStats &tileStats = stats_.at(tile.getIndex());
+        if (tileStats.getSeedMatchCacheLookups())
+        {
+            ISAAC_XML_WRITER_ELEMENT_BLOCK(xmlWriter, "SeedMatchCache")
+            {
+                xmlWriter.writeElement("Lookups", tileStats.getSeedMatchCacheLookups());
+                xmlWriter.writeElement("Hits", tileStats.getSeedMatchCacheHits());
+            }
+        }
+        if (tileStats.getTemplatesBuilt())
+        {
+            ISAAC_XML_WRITER_ELEMENT_BLOCK(xmlWriter, "UniqueFastPath")
+            {
+                xmlWriter.writeElement("Templates", tileStats.getTemplatesBuilt());
+                xmlWriter.writeElement("FastPathTemplates", tileStats.getUniqueFastPathTemplates());
+                xmlWriter.writeElement("Fraction", double(tileStats.getUniqueFastPathTemplates()) / tileStats.getTemplatesBuilt());
+            }
+        }
         ISAAC_XML_WRITER_ELEMENT_BLOCK(xmlWriter, "Pf")
         {
             BOOST_FOREACH(const flowcell::ReadMetadata& read, flowcellLayoutList_.at(tile.getFlowcellIndex()).getReadMetadataList())
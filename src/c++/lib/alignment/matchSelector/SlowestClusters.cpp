@@ -0,0 +1,159 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file SlowestClusters.cpp
+ **
+ ** \brief Keeps the most expensive clusters seen by a thread along with their alignment outcome.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+#include "alignment/matchSelector/SlowestClusters.hh"
+#include "common/Debug.hh"
+
+namespace isaac
+{
+namespace alignment
+{
+namespace matchSelector
+{
+
+ClusterCost::ClusterCost(
+    const templateBuilder::CostTracer::Costs &costs,
+    const Cluster &cluster,
+    const BamTemplate &bamTemplate,
+    const TemplateAlignmentType result) :
+        total_(std::accumulate(costs.begin(), costs.end(), uint64_t(0))),
+        costs_(costs),
+        tileIndex_(cluster.getTile()),
+        clusterId_(cluster.getId()),
+        nameLength_(std::min<unsigned>(NAME_LENGTH_MAX, std::distance(cluster.nameBegin(), cluster.nameEnd()))),
+        result_(result),
+        properPair_(bamTemplate.isProperPair()),
+        readCount_(std::min<unsigned>(READS_MAX, bamTemplate.getFragmentCount()))
+{
+    std::copy(cluster.nameBegin(), cluster.nameBegin() + nameLength_, name_.begin());
+    for (unsigned i = 0; readCount_ != i; ++i)
+    {
+        const FragmentMetadata &fragment = bamTemplate.getFragmentMetadata(i);
+        ReadOutcome &read = reads_[i];
+        read.aligned_ = fragment.isAligned();
+        read.mapq_ = fragment.mapQ;
+        read.repeatCount_ = fragment.repeatCount;
+        read.mismatchCount_ = fragment.mismatchCount;
+        read.gapCount_ = fragment.gapCount;
+        read.split_ = fragment.isSplit();
+        read.decoy_ = fragment.decoyAlignment;
+        read.adapterClipped_ = fragment.adapterClipped_;
+    }
+}
+
+void SlowestClusters::add(const ClusterCost &cost)
+{
+    if (!qualifies(cost.total_))
+    {
+        return;
+    }
+
+    if (heap_.size() == clustersMax_)
+    {
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<ClusterCost>());
+        heap_.pop_back();
+    }
+    heap_.push_back(cost);
+    std::push_heap(heap_.begin(), heap_.end(), std::greater<ClusterCost>());
+}
+
+void SlowestClusters::merge(const SlowestClusters &that)
+{
+    for (const ClusterCost &cost : that.heap_)
+    {
+        add(cost);
+    }
+}
+
+static const char *getTemplateAlignmentTypeName(const TemplateAlignmentType type)
+{
+    switch (type)
+    {
+    case Normal: return "Normal";
+    case NmNm: return "NmNm";
+    case Qc: return "Qc";
+    case Rm: return "Rm";
+    case Filtered: return "Filtered";
+    default: ISAAC_ASSERT_MSG(false, "Unexpected template alignment type " << type); return 0;
+    }
+}
+
+void SlowestClusters::write(std::ostream &os, const flowcell::TileMetadataList &tileMetadataList) const
+{
+    os << "#flowcell\tlane\ttile\tcluster\tname\toutcome\tproperPair\ttotalCycles";
+    for (unsigned phase = 0; templateBuilder::CostTracer::PHASES_COUNT != phase; ++phase)
+    {
+        os << "\t" << templateBuilder::CostTracer::getPhaseName(templateBuilder::CostTracer::Phase(phase)) << "Cycles";
+    }
+    for (unsigned read = 1; ClusterCost::READS_MAX >= read; ++read)
+    {
+        os << "\tr" << read << "Mapq\tr" << read << "Repeats\tr" << read << "Mismatches\tr" << read << "Gaps" <<
+            "\tr" << read << "Split\tr" << read << "Decoy\tr" << read << "AdapterClipped";
+    }
+    os << "\n";
+
+    std::vector<ClusterCost> sorted(heap_);
+    std::sort(sorted.begin(), sorted.end(), std::greater<ClusterCost>());
+    for (const ClusterCost &cost : sorted)
+    {
+        const flowcell::TileMetadata &tile = tileMetadataList.at(cost.tileIndex_);
+        const bool aligned = cost.readCount_ &&
+            std::any_of(cost.reads_.begin(), cost.reads_.begin() + cost.readCount_,
+                        [](const ClusterCost::ReadOutcome &read){return read.aligned_;});
+
+        os << tile.getFlowcellId() << "\t" << tile.getLane() << "\t" << tile.getTile() << "\t" << cost.clusterId_ << "\t";
+        if (cost.nameLength_)
+        {
+            os.write(cost.name_.data(), cost.nameLength_);
+        }
+        else
+        {
+            os << "-";
+        }
+        // Template types in the stats describe the unaligned templates. Aligned ones are better described by the reads.
+        os << "\t" << (aligned && Filtered != cost.result_ ? "Aligned" : getTemplateAlignmentTypeName(cost.result_)) <<
+            "\t" << cost.properPair_ << "\t" << cost.total_;
+        for (const uint64_t phaseCost : cost.costs_)
+        {
+            os << "\t" << phaseCost;
+        }
+        for (unsigned i = 0; ClusterCost::READS_MAX != i; ++i)
+        {
+            if (cost.readCount_ > i && cost.reads_[i].aligned_)
+            {
+                const ClusterCost::ReadOutcome &read = cost.reads_[i];
+                os << "\t" << unsigned(read.mapq_) << "\t" << read.repeatCount_ << "\t" << read.mismatchCount_ <<
+                    "\t" << read.gapCount_ << "\t" << read.split_ << "\t" << read.decoy_ << "\t" << read.adapterClipped_;
+            }
+            else
+            {
+                os << "\t-\t-\t-\t-\t-\t-\t-";
+            }
+        }
+        os << "\n";
+    }
+}
+
+} // namespace matchSelector
+} // namespace alignment
+} // namespace isaac
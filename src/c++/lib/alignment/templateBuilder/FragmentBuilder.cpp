@@ -54,7 +54,8 @@ FragmentBuilder::FragmentBuilder(
     const bool splitAlignments,
     const AlignmentCfg &alignmentCfg,
     Cigar &cigarBuffer,
-    const bool reserveBuffers)
+    const bool reserveBuffers,
+    const unsigned seedMatchCacheSize)
     : repeatThreshold_(repeatThreshold)
     , gappedMismatchesMax_(gappedMismatchesMax)
     , smitWatermanGapsMax_(smitWatermanGapsMax)
@@ -66,6 +67,8 @@ FragmentBuilder::FragmentBuilder(
     , ungappedAligner_(collectMismatchCycles, alignmentCfg_)
     , gappedAligner_(collectMismatchCycles, flowcellLayoutList, smartSmithWaterman, smithWatermanGapSizeMax, alignmentCfg_)
     , matchLists_(maxSeedsPerMatch + 1)
+    , seedMatchCache_(seedMatchCacheSize, maxSeedsPerMatch + 1)
+    , uniqueFastPath_(false)
 {
 //    if (reserveBuffers)
     {
@@ -375,6 +378,7 @@ bool  iSAAC_PROFILING_NOINLINE FragmentBuilder::makeBestAlignments(
     if (!noSmithWaterman_ && withGaps && (!perfectFound || !smartSmithWaterman_))
     {
         // If there are still bad alignments, try to do expensive smith-waterman on them.
+        CostTracer::Scope costScope(costTracer_, CostTracer::Gapped);
         if (gappedAligner_.realignBadUngappedAlignments(
             gappedMismatchesMax_, smitWatermanGapsMax_, contigList, readMetadata, fragments, adapterClipper, cigarBuffer_))
         {
@@ -422,6 +426,59 @@ bool  iSAAC_PROFILING_NOINLINE FragmentBuilder::makeBestAlignments(
     return !fragments.empty();
 }
 
+/**
+ * \brief Shortcut for reads that have exactly one candidate and no repeat seeds. Avoids best matches
+ *        heap and alignment ranking when the ungapped alignment is too good to be offered to smith-waterman.
+ *        Produces the same fragment as makeBestAlignments would.
+ *
+ * \return Rm if fast path is not applicable, otherwise the result of the alignment.
+ */
+AlignmentType FragmentBuilder::alignUniqueMatch(
+    const reference::ContigList &contigList,
+    const flowcell::ReadMetadata &readMetadata,
+    templateBuilder::FragmentSequencingAdapterClipper &adapterClipper,
+    const Cluster &cluster,
+    const bool withGaps,
+    const MatchLists &matchLists,
+    FragmentMetadataList &fragments) const
+{
+    const Match *uniqueMatch = 0;
+    for (const Matches &matches : matchLists)
+    {
+        if (!matches.empty())
+        {
+            if (uniqueMatch || 1 != matches.size())
+            {
+                return Rm;
+            }
+            uniqueMatch = &matches.front();
+        }
+    }
+
+    if (!uniqueMatch)
+    {
+        return Rm;
+    }
+
+    // adapter clipping can only reduce the number of mismatches, so raw count is a safe bound
+    if (!noSmithWaterman_ && withGaps &&
+        gappedAligner_.getRealignMismatchesMin() <= countMismatches(*uniqueMatch, contigList, cluster.at(readMetadata.getIndex())))
+    {
+        return Rm;
+    }
+
+    uniqueFastPath_ = true;
+    const FragmentMetadata fragment = makeAlignment(contigList, readMetadata, cluster, adapterClipper, *uniqueMatch, 0, cigarBuffer_);
+    if (!fragment.isAligned())
+    {
+        return Nm;
+    }
+    fragments.push_back(fragment);
+    fragments.back().repeatCount = 1;
+    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "    FragmentBuilder::alignUniqueMatch " << contigList[fragments.back().contigId] << " " << *uniqueMatch << " " << fragments.back());
+    return Normal;
+}
+
 /**
  * \return true if at least one fragment was built.
  */
@@ -435,6 +492,15 @@ AlignmentType FragmentBuilder::findBestAlignments(
     const unsigned repeatSeeds,
     FragmentMetadataList &fragments) const
 {
+    if (!repeatSeeds)
+    {
+        const AlignmentType uniqueRes = alignUniqueMatch(contigList, readMetadata, adapterClipper, cluster, withGaps, matchLists, fragments);
+        if (Rm != uniqueRes)
+        {
+            return uniqueRes;
+        }
+    }
+
     const AlignmentType res = findBestMatches(contigList, readMetadata, cluster, matchLists, bestMatches_);
     if (Normal != res)
     {
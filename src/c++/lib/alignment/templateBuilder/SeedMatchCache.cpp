@@ -0,0 +1,94 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file SeedMatchCache.cpp
+ **
+ ** \brief See SeedMatchCache.hh
+ **/
+
+#include "alignment/templateBuilder/SeedMatchCache.hh"
+#include "common/Debug.hh"
+
+namespace isaac
+{
+namespace alignment
+{
+namespace templateBuilder
+{
+
+SeedMatchCache::SeedMatchCache(const unsigned entriesCount, const unsigned matchListsCount)
+    : matchListsCount_(matchListsCount)
+    , entries_(entriesCount)
+    , listSizes_(entriesCount * matchListsCount, 0)
+    , matches_(entriesCount * MATCHES_PER_ENTRY_MAX, Match(0, false))
+    , lookups_(0)
+    , hits_(0)
+{
+}
+
+bool SeedMatchCache::lookup(const Key &key, MatchLists &matchLists, std::size_t &uncheckedSeeds) const
+{
+    ISAAC_ASSERT_MSG(isEnabled(), "Lookup in disabled cache");
+    ISAAC_ASSERT_MSG(matchListsCount_ == matchLists.size(), "Unexpected number of match lists " << matchLists.size() << " expected " << matchListsCount_);
+    ++lookups_;
+    const std::size_t entryIndex = key.hash_ % entries_.size();
+    const Entry &entry = entries_[entryIndex];
+    if (!entry.valid_ || !(entry.key_ == key))
+    {
+        return false;
+    }
+
+    std::vector<Match>::const_iterator source = matches_.begin() + entryIndex * MATCHES_PER_ENTRY_MAX;
+    std::vector<unsigned>::const_iterator listSize = listSizes_.begin() + entryIndex * matchListsCount_;
+    for (Matches &matches : matchLists)
+    {
+        ISAAC_ASSERT_MSG(matches.capacity() >= *listSize, "Insufficient capacity to restore cached matches");
+        matches.assign(source, source + *listSize);
+        source += *listSize;
+        ++listSize;
+    }
+    uncheckedSeeds = entry.uncheckedSeeds_;
+    ++hits_;
+    return true;
+}
+
+void SeedMatchCache::store(const Key &key, const MatchLists &matchLists, const std::size_t uncheckedSeeds)
+{
+    ISAAC_ASSERT_MSG(matchListsCount_ == matchLists.size(), "Unexpected number of match lists " << matchLists.size() << " expected " << matchListsCount_);
+    std::size_t total = 0;
+    for (const Matches &matches : matchLists)
+    {
+        total += matches.size();
+    }
+    if (MATCHES_PER_ENTRY_MAX < total)
+    {
+        return;
+    }
+
+    const std::size_t entryIndex = key.hash_ % entries_.size();
+    std::vector<Match>::iterator destination = matches_.begin() + entryIndex * MATCHES_PER_ENTRY_MAX;
+    std::vector<unsigned>::iterator listSize = listSizes_.begin() + entryIndex * matchListsCount_;
+    for (const Matches &matches : matchLists)
+    {
+        destination = std::copy(matches.begin(), matches.end(), destination);
+        *listSize++ = matches.size();
+    }
+
+    Entry &entry = entries_[entryIndex];
+    entry.key_ = key;
+    entry.uncheckedSeeds_ = uncheckedSeeds;
+    entry.valid_ = true;
+}
+
+} // namespace templateBuilder
+} // namespace alignment
+} // namespace isaac
@@ -61,19 +61,15 @@ ShadowAligner<SHADOW_KMER_LENGTH>::ShadowAligner(
 template <unsigned SHADOW_KMER_LENGTH>
 unsigned ShadowAligner<SHADOW_KMER_LENGTH>::hashShadowKmers(const std::vector<char> &sequence)
 {
-    shadowKmerPositions_.clear();
-    // initialize all k-mers to the magic value -1 (NOT_FOUND)
-    shadowKmerPositions_.resize(shadowKmerCount_, -1);
-    // 
+    shadowKmerPositions_.reset();
     oligo::KmerGenerator<SHADOW_KMER_LENGTH, unsigned, std::vector<char>::const_iterator> kmerGenerator(sequence.begin(), sequence.end());
     unsigned positionsCount = 0;
     unsigned kmer;
     std::vector<char>::const_iterator position;
     while (kmerGenerator.next(kmer, position))
     {
-        if (-1 == shadowKmerPositions_[kmer])
+        if (shadowKmerPositions_.insert(kmer, position - sequence.begin()))
         {
-            shadowKmerPositions_[kmer] = (position - sequence.begin());
             ++positionsCount;
         }
     }
@@ -91,15 +87,31 @@ bool ShadowAligner<SHADOW_KMER_LENGTH>::findShadowCandidatePositions(
 {
     hashShadowKmers(shadowSequence);
 
-    // find matching positions in the reference by k-mer comparison
-    oligo::KmerGenerator<SHADOW_KMER_LENGTH, unsigned, reference::Contig::const_iterator> kmerGenerator(referenceBegin, referenceEnd);
-    unsigned kmer;
-    reference::Contig::const_iterator position = referenceBegin;
-    while(kmerGenerator.next(kmer, position))
+    // find matching positions in the reference by k-mer comparison. Rolling scan over the reference
+    // window, restarted after each N
+    static const unsigned KMER_MASK = (1U << (2 * SHADOW_KMER_LENGTH)) - 1;
+    static const oligo::Translator<> translator;
+    unsigned kmer = 0;
+    unsigned basesToComplete = SHADOW_KMER_LENGTH;
+    for (reference::Contig::const_iterator it = referenceBegin; referenceEnd != it; ++it)
     {
-        if (-1 != shadowKmerPositions_[kmer])
+        const unsigned baseValue = translator[*it];
+        if (oligo::INVALID_OLIGO <= baseValue)
+        {
+            basesToComplete = SHADOW_KMER_LENGTH;
+            continue;
+        }
+        kmer = ((kmer << 2) | baseValue) & KMER_MASK;
+        if (basesToComplete && --basesToComplete)
+        {
+            continue;
+        }
+
+        const short shadowKmerPosition = shadowKmerPositions_.find(kmer);
+        if (ShadowKmerIndex<SHADOW_KMER_LENGTH>::NOT_FOUND != shadowKmerPosition)
         {
-            const int64_t candidatePosition = position - referenceBegin - shadowKmerPositions_[kmer] + referenceOffset;
+            const reference::Contig::const_iterator position = it - (SHADOW_KMER_LENGTH - 1);
+            const int64_t candidatePosition = position - referenceBegin - shadowKmerPosition + referenceOffset;
 
             // avoid positions that will place mate outside the requested range. This can happen if rightmost k-mer of the mate matches the
             // first kmer of the reference like so:
@@ -77,7 +77,7 @@ const gapRealigner::RealignerGaps &BinData::getRealignerGaps(const unsigned barc
 
 void BinData::reserveGaps(
     const alignment::BinMetadata& bin,
-    const gapRealigner::Gaps &knownIndels,
+    const KnownIndels &knownIndels,
     const flowcell::BarcodeMetadataList &barcodeMetadataList)
 {
     std::vector<std::size_t> gapsByGroup(getGapGroupsCount(), 0);
@@ -87,18 +87,16 @@ void BinData::reserveGaps(
             bin.getBarcodeGapCount(barcode.getIndex());
     }
 
-    BOOST_FOREACH(const gapRealigner::Gap &gap, knownIndels)
+    gapRealigner::Gaps binKnownIndels;
+    knownIndels.appendBinGaps(bin.getBinStart(), bin.getBinEnd(), binKnownIndels);
+    BOOST_FOREACH(const gapRealigner::Gap &gap, binKnownIndels)
     {
-        if ((gap.getBeginPos() >= bin.getBinStart() && gap.getBeginPos() < bin.getBinEnd()) ||
-            (gap.getEndPos(false) >= bin.getBinStart() && gap.getEndPos(false) < bin.getBinEnd()))
-        {
-            std::for_each(
-                realignerGaps_.begin(), realignerGaps_.end(),
-                [&](gapRealigner::RealignerGaps &gapGroup)
-                {
-                    gapGroup.addGap(gapRealigner::Gap(gap.pos_, gap.length_, gap.HIGHEST_PRIORITY));
-                });
-        }
+        std::for_each(
+            realignerGaps_.begin(), realignerGaps_.end(),
+            [&](gapRealigner::RealignerGaps &gapGroup)
+            {
+                gapGroup.addGap(gapRealigner::Gap(gap.pos_, gap.length_, gap.HIGHEST_PRIORITY));
+            });
     }
 
     unsigned gapGroupId = 0;
@@ -27,6 +27,7 @@
 
 #include "build/BinSorter.hh"
 #include "common/Memory.hh"
+#include "common/Threads.hpp"
 
 namespace isaac
 {
@@ -90,49 +91,249 @@ uint64_t BinSorter::serialize(
     return binData.size();
 }
 
-void BinSorter::resolveDuplicates(
-    BinData &binData,
-    BuildStats &buildStats)
+/**
+ * \brief single-ended fragments are never duplicates
+ */
+class BinSorter::NotAFilterWork : public BinSorter::PhasedWork
 {
-    ISAAC_THREAD_CERR << "Resolving duplicates for bin " << binData.bin_ << std::endl;
+    const bool filterPairs_;
+public:
+    explicit NotAFilterWork(const bool filterPairs) : filterPairs_(filterPairs){}
+    virtual std::size_t getPhaseCount() const {return 0;}
+    virtual std::size_t getUnitCount(const std::size_t phase) const {return 0;}
+    virtual void processUnit(const std::size_t phase, const std::size_t unit) {}
+    virtual void complete(BinData &binData, BuildStats &buildStats)
+    {
+        NotAFilter().filterInput(binData.data_, binData.seIdx_.begin(), binData.seIdx_.end(), buildStats, binData.binStatsIndex_, std::back_inserter(binData));
+        if (filterPairs_)
+        {
+            NotAFilter().filterInput(binData.data_, binData.rIdx_.begin(), binData.rIdx_.end(), buildStats, binData.binStatsIndex_, std::back_inserter(binData));
+            NotAFilter().filterInput(binData.data_, binData.fIdx_.begin(), binData.fIdx_.end(), buildStats, binData.binStatsIndex_, std::back_inserter(binData));
+        }
+    }
+};
+
+/**
+ * \brief ranks r-stranded or shadow and f-stranded fragments at the same time, then stores them in the same order
+ *        as the single-threaded filtering did
+ */
+template <bool singleLibrarySamples>
+class BinSorter::PairEndDuplicateWork : public BinSorter::PhasedWork
+{
+    const bool keepDuplicates_;
+    const RSDuplicateFilter<singleLibrarySamples> rsFilter_;
+    const FDuplicateFilter<singleLibrarySamples> fFilter_;
+    DuplicateRanking<RSDuplicateFilter<singleLibrarySamples>, BinData::RIdx::iterator> rsRanking_;
+    DuplicateRanking<FDuplicateFilter<singleLibrarySamples>, BinData::FIdx::iterator> fRanking_;
 
-    NotAFilter().filterInput(binData.data_, binData.seIdx_.begin(), binData.seIdx_.end(), buildStats, binData.binStatsIndex_, std::back_inserter(binData));
-    if (keepDuplicates_ && !markDuplicates_)
+public:
+    PairEndDuplicateWork(const bool keepDuplicates, BinData &binData) :
+        keepDuplicates_(keepDuplicates),
+        rsFilter_(binData.barcodeBamMapping_.getSampleIndexMap()),
+        fFilter_(binData.barcodeBamMapping_.getSampleIndexMap()),
+        rsRanking_(rsFilter_, binData.data_, binData.rIdx_.begin(), binData.rIdx_.end(), binData.rsDuplicateRanking_),
+        fRanking_(fFilter_, binData.data_, binData.fIdx_.begin(), binData.fIdx_.end(), binData.fDuplicateRanking_)
     {
-        NotAFilter().filterInput(binData.data_, binData.rIdx_.begin(), binData.rIdx_.end(), buildStats, binData.binStatsIndex_, std::back_inserter(binData));
-        NotAFilter().filterInput(binData.data_, binData.fIdx_.begin(), binData.fIdx_.end(), buildStats, binData.binStatsIndex_, std::back_inserter(binData));
     }
-    else
+
+    virtual std::size_t getPhaseCount() const
+    {
+        return std::max(rsRanking_.getPhaseCount(), fRanking_.getPhaseCount());
+    }
+
+    virtual std::size_t getUnitCount(const std::size_t phase) const
     {
-        if (singleLibrarySamples_)
+        return rsRanking_.getUnitCount(phase) + fRanking_.getUnitCount(phase);
+    }
+
+    virtual void processUnit(const std::size_t phase, const std::size_t unit)
+    {
+        const std::size_t rsUnits = rsRanking_.getUnitCount(phase);
+        if (rsUnits > unit)
         {
-            DuplicatePairEndFilter(keepDuplicates_).filterInput(
-                RSDuplicateFilter<true>(binData.barcodeBamMapping_.getSampleIndexMap()),
-                binData.data_, binData.rIdx_.begin(), binData.rIdx_.end(),
-                buildStats, binData.binStatsIndex_, std::back_inserter(binData));
-            DuplicatePairEndFilter(keepDuplicates_).filterInput(
-                FDuplicateFilter<true>(binData.barcodeBamMapping_.getSampleIndexMap()),
-                binData.data_, binData.fIdx_.begin(), binData.fIdx_.end(),
-                buildStats, binData.binStatsIndex_, std::back_inserter(binData));
+            rsRanking_.processUnit(phase, unit);
         }
         else
         {
-            DuplicatePairEndFilter(keepDuplicates_).filterInput(
-                RSDuplicateFilter<false>(binData.barcodeBamMapping_.getSampleIndexMap()),
-                binData.data_, binData.rIdx_.begin(), binData.rIdx_.end(),
-                buildStats, binData.binStatsIndex_, std::back_inserter(binData));
-            DuplicatePairEndFilter(keepDuplicates_).filterInput(
-                FDuplicateFilter<false>(binData.barcodeBamMapping_.getSampleIndexMap()),
-                binData.data_, binData.fIdx_.begin(), binData.fIdx_.end(),
-                buildStats, binData.binStatsIndex_, std::back_inserter(binData));
+            fRanking_.processUnit(phase, unit - rsUnits);
         }
     }
 
+    virtual void complete(BinData &binData, BuildStats &buildStats)
+    {
+        NotAFilter().filterInput(binData.data_, binData.seIdx_.begin(), binData.seIdx_.end(), buildStats, binData.binStatsIndex_, std::back_inserter(binData));
+        const uint64_t unique =
+            rsRanking_.emit(keepDuplicates_, buildStats, binData.binStatsIndex_, std::back_inserter(binData)) +
+            fRanking_.emit(keepDuplicates_, buildStats, binData.binStatsIndex_, std::back_inserter(binData));
+        ISAAC_THREAD_CERR << "Filtering duplicates done. found " << unique << " unique out of " <<
+            rsRanking_.size() + fRanking_.size() << " fragments" << std::endl;
+    }
+};
+
+template <typename F>
+void BinSorter::withDuplicateWork(BinData &binData, F f) const
+{
+    // BinData reserves the ranking buffers under the same condition
+    if (!DuplicateRankingBuffers::isRankingNeeded(keepDuplicates_, markDuplicates_))
+    {
+        NotAFilterWork work(true);
+        f(work);
+    }
+    else if (singleLibrarySamples_)
+    {
+        PairEndDuplicateWork<true> work(keepDuplicates_, binData);
+        f(work);
+    }
+    else
+    {
+        PairEndDuplicateWork<false> work(keepDuplicates_, binData);
+        f(work);
+    }
+}
+
+void BinSorter::resolveDuplicates(
+    BinData &binData,
+    BuildStats &buildStats)
+{
+    ISAAC_THREAD_CERR << "Resolving duplicates for bin " << binData.bin_ << std::endl;
+
+    withDuplicateWork(binData, [&binData, &buildStats](PhasedWork &work)
+    {
+        for (std::size_t phase = 0; work.getPhaseCount() != phase; ++phase)
+        {
+            for (std::size_t unit = 0; work.getUnitCount(phase) != unit; ++unit)
+            {
+                work.processUnit(phase, unit);
+            }
+        }
+        work.complete(binData, buildStats);
+    });
+
     // we will not be needing these anymore. Free up some memory so that other bins get a chance to start earlier
     binData.unreserveIndexes();
 
     ISAAC_THREAD_CERR << "Resolving duplicates done for bin " << binData.bin_ << std::endl;
 }
 
+void BinSorter::threadResolveDuplicates(
+    boost::unique_lock<boost::mutex> &lock,
+    BinData &binData,
+    DuplicateResolution &resolution,
+    BuildStats &buildStats)
+{
+    if (resolution.work_ || resolution.complete_)
+    {
+        shareDuplicateWork(lock, binData, resolution, buildStats);
+        return;
+    }
+
+    ISAAC_THREAD_CERR << "Resolving duplicates for bin " << binData.bin_ << std::endl;
+    // The dynamic memory allocations are blocked. The work lives on the stack of the thread that started it
+    // and that thread does not leave while any other thread is still inside the work.
+    withDuplicateWork(binData, [this, &lock, &binData, &resolution, &buildStats](PhasedWork &work)
+    {
+        resolution.work_ = &work;
+        try
+        {
+            shareDuplicateWork(lock, binData, resolution, buildStats);
+        }
+        catch (...)
+        {
+            waitForDuplicateUnits(lock, resolution);
+            throw;
+        }
+        // another thread might have failed while this one was still working
+        waitForDuplicateUnits(lock, resolution);
+    });
+}
+
+void BinSorter::waitForDuplicateUnits(
+    boost::unique_lock<boost::mutex> &lock,
+    DuplicateResolution &resolution)
+{
+    while (resolution.unitsInProgress_)
+    {
+        resolution.stateChanged_.wait(lock);
+    }
+    resolution.work_ = 0;
+}
+
+void BinSorter::shareDuplicateWork(
+    boost::unique_lock<boost::mutex> &lock,
+    BinData &binData,
+    DuplicateResolution &resolution,
+    BuildStats &buildStats)
+{
+    // only valid until the resolution is complete
+    PhasedWork *work = resolution.work_;
+
+    try
+    {
+        while (!resolution.complete_)
+        {
+            // skip phases that have no units left
+            while (work->getPhaseCount() != resolution.phase_ &&
+                work->getUnitCount(resolution.phase_) == resolution.nextUnit_ && !resolution.unitsInProgress_)
+            {
+                ++resolution.phase_;
+                resolution.nextUnit_ = 0;
+                resolution.stateChanged_.notify_all();
+            }
+
+            if (work->getPhaseCount() == resolution.phase_)
+            {
+                if (resolution.completing_)
+                {
+                    resolution.stateChanged_.wait(lock);
+                    continue;
+                }
+                resolution.completing_ = true;
+                {
+                    common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
+                    work->complete(binData, buildStats);
+                    // we will not be needing these anymore. Free up some memory so that other bins get a chance to start earlier
+                    binData.unreserveIndexes();
+                    ISAAC_THREAD_CERR << "Resolving duplicates done for bin " << binData.bin_ << std::endl;
+                }
+                resolution.complete_ = true;
+                resolution.stateChanged_.notify_all();
+            }
+            else if (work->getUnitCount(resolution.phase_) == resolution.nextUnit_)
+            {
+                // the phase is being finished by other threads
+                resolution.stateChanged_.wait(lock);
+            }
+            else
+            {
+                const std::size_t phase = resolution.phase_;
+                const std::size_t unit = resolution.nextUnit_++;
+                ++resolution.unitsInProgress_;
+                try
+                {
+                    common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
+                    work->processUnit(phase, unit);
+                }
+                catch (...)
+                {
+                    --resolution.unitsInProgress_;
+                    throw;
+                }
+                if (!--resolution.unitsInProgress_ && resolution.complete_)
+                {
+                    // the thread that owns the work waits for this one after a failure elsewhere
+                    resolution.stateChanged_.notify_all();
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        // release the threads waiting for this one. The failure terminates the whole build
+        resolution.complete_ = true;
+        resolution.stateChanged_.notify_all();
+        throw;
+    }
+}
+
 } // namespace build
 } // namespace isaac
@@ -37,6 +37,7 @@
 #include "build/IndelLoader.hh"
 #include "common/Debug.hh"
 #include "common/FileSystem.hh"
+#include "common/Metrics.hh"
 #include "common/Threads.hpp"
 #include "io/Fragment.hh"
 #include "reference/ContigLoader.hh"
@@ -368,8 +369,8 @@ Build::Build(const std::vector<std::string> &argv,
      threadBgzfBuffers_(threads_.size(), BgzfBuffers(bamFileStreams_.size())),
      threadBgzfStreams_(threads_.size()),
      threadBamIndexParts_(threads_.size()),
-     knownIndels_((build::GapRealignerMode::REALIGN_NONE == realignGaps_ || knownIndelsPath.empty()) ?
-         gapRealigner::Gaps() : loadIndels(knownIndelsPath, sortedReferenceMetadataList_)),
+     knownIndels_(build::GapRealignerMode::REALIGN_NONE == realignGaps_ ? boost::filesystem::path() : knownIndelsPath,
+                  sortedReferenceMetadataList_),
      gapRealigner_(threads_.size(),
          realignGapsVigorously, realignDodgyFragments, realignedGapsPerFragment, clipSemialigned,
 //         alignmentCfg_.normalizedMismatchScore_,
@@ -417,6 +418,7 @@ void Build::run(common::ScopedMallocBlock &mallocBlock)
     alignment::BinMetadataCRefList::const_iterator nextUnallocatedBinIt(binRefs_.begin());
     alignment::BinMetadataCRefList::const_iterator nextUnloadedBinIt(binRefs_.begin());
     alignment::BinMetadataCRefList::const_iterator nextUnsavedBinIt(binRefs_.begin());
+    common::metrics::addExpected(common::metrics::BinsSorted, binRefs_.size());
 
     threads_.execute(boost::bind(&Build::sortBinParallel, this,
                                 boost::ref(nextUnprocessedBinIt),
@@ -554,7 +556,7 @@ void Build::reserveBuffers(
                         barcodeBamMapping_, barcodeMetadataList_,
                         realignGaps_, realignMapqMin_, knownIndels_, bin, binStatsIndex, tileMetadataList_, contigMap_, contigLists, maxReadLength_,
                         forcedDodgyAlignmentScore_,  flowcellLayoutList_, includeTags_, pessimisticMapQ_, alignmentCfg_.splitGapLength_,
-                        expectedCoverage_));
+                        expectedCoverage_, keepDuplicates_, markDuplicates_));
 
         unsigned outputFileIndex = 0;
         for(bam::BgzfBuffer &bgzfBuffer : bgzfBuffers)
@@ -700,7 +702,7 @@ boost::shared_ptr<BinData> Build::allocateBin(
                 totalBuffersNeeded += estimateBinCompressedDataRequirements(bin, outputFileIndex++);
             }
             warningTraced = handleBinAllocationFailure(
-                warningTraced, bin, a, BinData::getMemoryRequirements(bin) + totalBuffersNeeded);
+                warningTraced, bin, a, BinData::getMemoryRequirements(bin, keepDuplicates_, markDuplicates_) + totalBuffersNeeded);
         }
         catch (boost::iostreams::zlib_error &z)
         {
@@ -992,6 +994,8 @@ void Build::sortBinParallel(alignment::BinMetadataCRefList::iterator &nextUnproc
         // wait and allocate memory required for loading and compressing this bin
         boost::shared_ptr<BinData> binDataPtr =
             allocateBin(lock, thisThreadBinsEndIt, nextUnprocessedBinIt, nextUnallocatedBinIt, binRefs_.end(), mallocBlock, threadNumber);
+        // small bins get merged into one. Progress is reported in terms of the original ones
+        const std::size_t thisThreadBinsCount = std::distance(thisThreadBinIt, thisThreadBinsEndIt);
         waitForLoadSlot(lock, thisThreadBinIt, thisThreadBinsEndIt, nextUnloadedBinIt);
         ISAAC_BLOCK_WITH_CLENAUP(boost::bind(&Build::returnLoadSlot, this, _1))
         {
@@ -1007,16 +1011,14 @@ void Build::sortBinParallel(alignment::BinMetadataCRefList::iterator &nextUnproc
         }
 
         {
+            BinSorter::DuplicateResolution duplicateResolution;
             preemptComputeSlot(
-                lock, 1, std::distance(binRefs_.begin(), thisThreadBinIt),
-                [this, &binDataPtr](boost::unique_lock<boost::mutex> &l, const unsigned tn)
+                lock, -1, std::distance(binRefs_.begin(), thisThreadBinIt),
+                [this, &binDataPtr, &duplicateResolution](boost::unique_lock<boost::mutex> &l, const unsigned tn)
                 {
                     ++dedupingThreads;
             //        ISAAC_THREAD_CERR << "Threads:" << allocatedBins_ << "," << dedupingThreads << "," << realigningThreads << "," << serializingThreads << "," << savingThreads << "," << loadingThreads << std::endl;
-                    {
-                        common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(l);
-                        binSorter_.resolveDuplicates(*binDataPtr, stats_);
-                    }
+                    binSorter_.threadResolveDuplicates(l, *binDataPtr, duplicateResolution, stats_);
                     --dedupingThreads;
             //        ISAAC_THREAD_CERR << "Threads:" << allocatedBins_ << "," << dedupingThreads << "," << realigningThreads << "," << serializingThreads << "," << savingThreads << "," << loadingThreads << std::endl;
                 },
@@ -1052,7 +1054,7 @@ void Build::sortBinParallel(alignment::BinMetadataCRefList::iterator &nextUnproc
 
             preemptComputeSlot(
                 lock, 1, std::distance(binRefs_.begin(), thisThreadBinIt),
-                [this, &binDataPtr, &threadNumber](boost::unique_lock<boost::mutex> &l, const unsigned tn)
+                [this, &binDataPtr, &threadNumber, thisThreadBinsCount](boost::unique_lock<boost::mutex> &l, const unsigned tn)
                 {
                     ++serializingThreads;
             //        ISAAC_THREAD_CERR << "Threads:" << allocatedBins_ << "," << dedupingThreads << "," << realigningThreads << "," << serializingThreads << "," << savingThreads << "," << loadingThreads << std::endl;
@@ -1062,6 +1064,7 @@ void Build::sortBinParallel(alignment::BinMetadataCRefList::iterator &nextUnproc
                         binSorter_.serialize(
                             *binDataPtr, threadBgzfStreams_.at(threadNumber), threadBamIndexParts_.at(threadNumber));
                         threadBgzfStreams_.at(threadNumber).clear();
+                        common::metrics::add(common::metrics::BinsSorted, thisThreadBinsCount);
                     }
                     --serializingThreads;
             //        ISAAC_THREAD_CERR << "Threads:" << allocatedBins_ << "," << dedupingThreads << "," << realigningThreads << "," << serializingThreads << "," << savingThreads << "," << loadingThreads << std::endl;
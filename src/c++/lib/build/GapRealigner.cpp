@@ -21,7 +21,6 @@
 
 #include "alignment/BandedSmithWaterman.hh"
 #include "build/GapRealigner.hh"
-#include "build/gapRealigner/ChooseKGapsFilter.hh"
 
 namespace isaac
 {
@@ -399,13 +398,13 @@ inline int calculateMismatchesPercent(
 
 
 /**
- * \brief bits in choice determine whether the corresponding gaps are on or off
+ * \brief chosenGaps are the gaps that have their bits set in choice
  *
  * \return cost of the new choice or -1U if choice is inapplicable.
  */
 GapRealigner::GapChoice GapRealigner::verifyGapsChoice(
     const GapChoiceBitmask &choice,
-    const gapRealigner::GapsRange &gaps,
+    const gapRealigner::GapsRange &chosenGaps,
     const reference::ReferencePosition newBeginPos,
     const io::FragmentAccessor &fragment,
     const reference::ContigList &reference)
@@ -425,101 +424,95 @@ GapRealigner::GapChoice GapRealigner::verifyGapsChoice(
 
     reference::ReferencePosition lastGapEndPos = newBeginPos;
     reference::ReferencePosition lastGapBeginPos; // initially set to an invalid position which would not match any gap pos
-    unsigned currentGapIndex = 0;
-    BOOST_FOREACH(const gapRealigner::Gap& gap, std::make_pair(gaps.first, gaps.second))
+    BOOST_FOREACH(const gapRealigner::Gap& gap, std::make_pair(chosenGaps.first, chosenGaps.second))
     {
-        if (choice & (GapChoiceBitmask(1) << currentGapIndex))
+        ret.addPriority(gap);
+//        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "testing " << gap);
+        if (gap.getEndPos(true) <= lastGapEndPos)// || gap.getBeginPos() > lastGapEndPos + basesLeft)
         {
-            ret.addPriority(gap);
-//            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "testing " << gap);
-            if (gap.getEndPos(true) <= lastGapEndPos)// || gap.getBeginPos() > lastGapEndPos + basesLeft)
-            {
-                // the choice requires a gap that cannot be applied.
-                // just bail out. there will be another choice just like
-                // this one but without the useless gap
-                ret.cost_ = -1U;
-                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, ret << " does not fit in range [" << lastGapEndPos << ";" << lastGapEndPos + basesLeft << ")");
-                return ret;
-            }
-//            ISAAC_THREAD_CERR << " lastGapEndPos=" << lastGapEndPos << std::endl;
-
-            if (gap.getBeginPos() < lastGapEndPos)
-            {
-                ret.cost_ = -1U;
-                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, ret << " contains overlapping deletions ");
-                return ret;
-                // Allowing overlapping deletions is tricky because it is hard to track back the
-                // newBeginPos from the pivot see findStartPos.
-            }
-
-            if (gap.getBeginPos() == lastGapBeginPos)
-            {
-                // The only case where it makes sense to allow two or more gaps starting at the same
-                // position is when we want to combine multiple insertions into a larger
-                // one. Unfortunately, with enough gaps, it consumes the read into one single insertion...
-                // Other cases:
-                // deletion/deletion - is disallowed above
-                // insertion/deletion - does not make sense (and cause trouble SAAC-253)
-                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, ret << " contains overlapping gaps ");
-                ret.cost_ = -1U;
-                return ret;
-            }
-
-//            ISAAC_THREAD_CERR << " lastGapEndPos=" << lastGapEndPos << " lastGapBeginPos=" << lastGapBeginPos <<
-//                " gap.isInsertion()=" << gap.isInsertion() << std::endl;
-
-            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "basesLeft - fragment.rightClipped(): " << basesLeft - fragment.rightClipped());
-            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "gap.getBeginPos() - lastGapEndPos: " << gap.getBeginPos() - lastGapEndPos);
-            const int mappedBases = std::min<int>(basesLeft - fragment.rightClipped(), gap.getBeginPos() - lastGapEndPos);
-//            ISAAC_THREAD_CERR << " mappedBases=" << mappedBases << " basesLeft=" << basesLeft << std::endl;
-
-            const unsigned length = mappedBases - std::min(mappedBases, leftClippedLeft);
-            const unsigned mm = alignment::countEditDistanceMismatches(reference,
-                                                fragment.basesBegin() + (fragment.readLength_ - basesLeft) + leftClippedLeft,
-                                                lastGapEndPos + leftClippedLeft, length);
+            // the choice requires a gap that cannot be applied.
+            // just bail out. there will be another choice just like
+            // this one but without the useless gap
+            ret.cost_ = -1U;
+            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, ret << " does not fit in range [" << lastGapEndPos << ";" << lastGapEndPos + basesLeft << ")");
+            return ret;
+        }
+//        ISAAC_THREAD_CERR << " lastGapEndPos=" << lastGapEndPos << std::endl;
 
-            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "length: " << length);
-//            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "countMismatches: " << mm);
-//            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "leftClippedLeft: " << leftClippedLeft);
+        if (gap.getBeginPos() < lastGapEndPos)
+        {
+            ret.cost_ = -1U;
+            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, ret << " contains overlapping deletions ");
+            return ret;
+            // Allowing overlapping deletions is tricky because it is hard to track back the
+            // newBeginPos from the pivot see findStartPos.
+        }
 
-            ret.mappedLength_ += length;
-            ret.editDistance_ += mm;
-            ret.mismatches_ += mm;
-            ret.cost_ += mm * mismatchCost_;
-            basesLeft -= mappedBases;
-            leftClippedLeft -= std::min(leftClippedLeft, mappedBases);
-//            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "leftClippedLeft: " << leftClippedLeft);
-            if (!basesLeft)
-            {
-                // gap begins after the read ends.
-                ret.cost_ = -1U;
-                return ret;
-            }
-            unsigned clippedGapLength = 0;
-            if (gap.isInsertion())
-            {
-                clippedGapLength = std::min<int>(basesLeft - fragment.rightClipped(), gap.getLength());
-                // insertions reduce read length
-                basesLeft -= clippedGapLength;
-                leftClippedLeft -= std::min<int>(leftClippedLeft, gap.getLength());
-            }
-            else
-            {
-                clippedGapLength = leftClippedLeft ? 0 : gap.getLength();
-            }
-            ret.editDistance_ += clippedGapLength;
-            ret.cost_ += clippedGapLength ? (gapOpenCost_ + (clippedGapLength - 1) * gapExtendCost_) : 0;
-            lastGapEndPos = gap.getEndPos(false);
-            lastGapBeginPos = gap.getBeginPos();
+        if (gap.getBeginPos() == lastGapBeginPos)
+        {
+            // The only case where it makes sense to allow two or more gaps starting at the same
+            // position is when we want to combine multiple insertions into a larger
+            // one. Unfortunately, with enough gaps, it consumes the read into one single insertion...
+            // Other cases:
+            // deletion/deletion - is disallowed above
+            // insertion/deletion - does not make sense (and cause trouble SAAC-253)
+            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, ret << " contains overlapping gaps ");
+            ret.cost_ = -1U;
+            return ret;
+        }
 
-            if (basesLeft == leftClippedLeft + fragment.rightClipped())
-            {
-                break;
-            }
-            ISAAC_ASSERT_MSG(basesLeft > leftClippedLeft + fragment.rightClipped(), "Was not supposed to run into the clipping");
+//        ISAAC_THREAD_CERR << " lastGapEndPos=" << lastGapEndPos << " lastGapBeginPos=" << lastGapBeginPos <<
+//            " gap.isInsertion()=" << gap.isInsertion() << std::endl;
+
+        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "basesLeft - fragment.rightClipped(): " << basesLeft - fragment.rightClipped());
+        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "gap.getBeginPos() - lastGapEndPos: " << gap.getBeginPos() - lastGapEndPos);
+        const int mappedBases = std::min<int>(basesLeft - fragment.rightClipped(), gap.getBeginPos() - lastGapEndPos);
+//        ISAAC_THREAD_CERR << " mappedBases=" << mappedBases << " basesLeft=" << basesLeft << std::endl;
+
+        const unsigned length = mappedBases - std::min(mappedBases, leftClippedLeft);
+        const unsigned mm = alignment::countEditDistanceMismatches(reference,
+                                            fragment.basesBegin() + (fragment.readLength_ - basesLeft) + leftClippedLeft,
+                                            lastGapEndPos + leftClippedLeft, length);
+
+        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "length: " << length);
+//        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "countMismatches: " << mm);
+//        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "leftClippedLeft: " << leftClippedLeft);
+
+        ret.mappedLength_ += length;
+        ret.editDistance_ += mm;
+        ret.mismatches_ += mm;
+        ret.cost_ += mm * mismatchCost_;
+        basesLeft -= mappedBases;
+        leftClippedLeft -= std::min(leftClippedLeft, mappedBases);
+//        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "leftClippedLeft: " << leftClippedLeft);
+        if (!basesLeft)
+        {
+            // gap begins after the read ends.
+            ret.cost_ = -1U;
+            return ret;
+        }
+        unsigned clippedGapLength = 0;
+        if (gap.isInsertion())
+        {
+            clippedGapLength = std::min<int>(basesLeft - fragment.rightClipped(), gap.getLength());
+            // insertions reduce read length
+            basesLeft -= clippedGapLength;
+            leftClippedLeft -= std::min<int>(leftClippedLeft, gap.getLength());
+        }
+        else
+        {
+            clippedGapLength = leftClippedLeft ? 0 : gap.getLength();
+        }
+        ret.editDistance_ += clippedGapLength;
+        ret.cost_ += clippedGapLength ? (gapOpenCost_ + (clippedGapLength - 1) * gapExtendCost_) : 0;
+        lastGapEndPos = gap.getEndPos(false);
+        lastGapBeginPos = gap.getBeginPos();
 
+        if (basesLeft == leftClippedLeft + fragment.rightClipped())
+        {
+            break;
         }
-        ++currentGapIndex;
+        ISAAC_ASSERT_MSG(basesLeft > leftClippedLeft + fragment.rightClipped(), "Was not supposed to run into the clipping");
     }
 
     if(basesLeft > leftClippedLeft + fragment.rightClipped())
@@ -554,7 +547,7 @@ GapRealigner::GapChoice GapRealigner::verifyGapsChoice(
             ", newBeginPos " << newBeginPos <<
             " lastGapEndPos " << lastGapEndPos <<
             " leftClippedLeft " << leftClippedLeft <<
-            " gaps: " << gaps);
+            " gaps: " << chosenGaps);
     }
 
     ret.mismatchesPercent_ = calculateMismatchesPercent(ret.mismatches_, ret.mappedLength_);
@@ -825,6 +818,38 @@ int64_t GapRealigner::undoExistingGaps(
     return position;
 }
 
+/**
+ * \return false if alignmentPos places the read outside the bin
+ */
+static bool placeStartPos(
+    const reference::ReferencePosition binStartPos,
+    const reference::ReferencePosition binEndPos,
+    const reference::ReferencePosition pivotPos,
+    const int64_t alignmentPos,
+    reference::ReferencePosition &ret)
+{
+    if (int64_t(binStartPos.getPosition()) > alignmentPos)
+    {
+//        ISAAC_THREAD_CERR << " gap places read before bin start" << std::endl;
+        // this combination of gaps will have the read start alignmentPos moved before the binStartPos.
+        // Don't realign this way.
+        return false;
+    }
+
+    if (int64_t(binEndPos.getPosition()) < alignmentPos)
+    {
+//         ISAAC_THREAD_CERR << " gap places read after bin end" << std::endl;
+         // this combination of gaps will have the read start position moved at or after the binEndPos.
+         // Don't realign this way.
+         return false;
+    }
+
+    ret = reference::ReferencePosition(pivotPos.getContigId(), alignmentPos);
+//    ISAAC_THREAD_CERR << " new startPos offset=" << offset << " startPos=" << ret << " from pivot=" << pivotPos << "and original=" << index.pos_ << std::endl;
+
+    return true;
+}
+
 /**
  * \brief Find the start position such that the base that would be the read base
  *        at pivotPos if read originally had no gaps, would still be at pivotPos
@@ -879,26 +904,36 @@ bool GapRealigner::findStartPos(
         --gapIndex;
     }
 
-    if (int64_t(binStartPos.getPosition()) > alignmentPos)
+    return placeStartPos(binStartPos, binEndPos, pivotPos, alignmentPos, ret);
+}
+
+/**
+ * \brief Same as above but uses the shift precomputed for the haplotype unless the read start
+ *        is close enough to the pivot to have some of the insertions clipped.
+ */
+bool GapRealigner::findStartPos(
+    const GapChoiceBitmask &choice,
+    const gapRealigner::GapsRange &gaps,
+    const reference::ReferencePosition binStartPos,
+    const reference::ReferencePosition binEndPos,
+    const gapRealigner::HaplotypeAnchor &anchor,
+    const int64_t alignmentPos,
+    reference::ReferencePosition &ret)
+{
+    const unsigned basesLeft = anchor.pivotPos_.getPosition() - alignmentPos;
+    if (anchor.insertedBases_ >= basesLeft)
     {
-//        ISAAC_THREAD_CERR << " gap places read before bin start" << std::endl;
-        // this combination of gaps will have the read start alignmentPos moved before the binStartPos.
-        // Don't realign this way.
-        return false;
+        return findStartPos(choice, gaps, binStartPos, binEndPos,
+                            anchor.pivotGapIndex_, anchor.pivotPos_, alignmentPos, ret);
     }
 
-    if (int64_t(binEndPos.getPosition()) < alignmentPos)
+    if (anchor.overlapping_)
     {
-//         ISAAC_THREAD_CERR << " gap places read after bin end" << std::endl;
-         // this combination of gaps will have the read start position moved at or after the binEndPos.
-         // Don't realign this way.
-         return false;
+        // overlapping gaps are not allowed
+        return false;
     }
 
-    ret = reference::ReferencePosition(pivotPos.getContigId(), alignmentPos);
-//    ISAAC_THREAD_CERR << " new startPos offset=" << offset << " startPos=" << ret << " from pivot=" << pivotPos << "and original=" << index.pos_ << std::endl;
-
-    return true;
+    return placeStartPos(binStartPos, binEndPos, anchor.pivotPos_, alignmentPos + anchor.shift_, ret);
 }
 
 static unsigned short getTotalGapsLength(
@@ -1000,8 +1035,12 @@ public:
     }
 };
 
+/**
+ * \brief Verify the haplotype for all read start positions anchored on its gaps
+ */
 bool GapRealigner::verifyGapsChoice(
-    const GapChoiceBitmask &choice,
+    const gapRealigner::HaplotypeLocus &locus,
+    const gapRealigner::Haplotype &haplotype,
     const gapRealigner::GapsRange& gaps,
     const reference::ReferencePosition& binStartPos,
     const reference::ReferencePosition& binEndPos,
@@ -1012,56 +1051,38 @@ bool GapRealigner::verifyGapsChoice(
     GapChoice& bestChoice)
 {
     bool ret = false;
-    unsigned pivotGapIndex = 0;
-    BOOST_FOREACH(const gapRealigner::Gap& pivotGap, std::make_pair(gaps.first, gaps.second))
-    //                for (unsigned pivotGapIndex = 0; gaps.size() != pivotGapIndex; ++pivotGapIndex)
+    // the undo pivot changes the start positions the anchors produce. Keeping the ones from the previous pivots
+    // would make the list grow with the number of existing gaps in the fragment
+    verifiedStartPositions_.clear();
+    BOOST_FOREACH(const gapRealigner::HaplotypeAnchor& anchor, locus.getAnchors(haplotype))
     {
-        if (choice & (GapChoiceBitmask(1) << pivotGapIndex))
-        {
-            //TODO: check binBorder overrun
-            reference::ReferencePosition newStarPos;
+        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Testing pivot " << anchor.pivotPos_);
 
-            // verify case when anchoring occurs before pivot gap
-            if (pivotGap.getBeginPos() >= binStartPos)
+        reference::ReferencePosition newStarPos;
+        if (findStartPos(haplotype.choice_, gaps, binStartPos, binEndPos, anchor, undoneAlignmentPos, newStarPos))
+        {
+            // Different pivots often anchor the read at the same position. Verifying it again cannot produce
+            // a better choice than the one we already have.
+            if (verifiedStartPositions_.end() != std::find(verifiedStartPositions_.begin(), verifiedStartPositions_.end(), newStarPos))
             {
-                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Testing pivot before " << pivotGap);
-                if (findStartPos(choice, gaps, binStartPos, binEndPos,
-                                 pivotGapIndex, pivotGap.getBeginPos(), undoneAlignmentPos, newStarPos))
-                {
-                    const GapChoice thisChoice = verifyGapsChoice(choice, gaps, newStarPos, fragment, reference);
-                    if (isBetterChoice(thisChoice, originalMismatchesPercent, bestChoice))
-                    {
-                        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, thisChoice << "better than " << bestChoice);
-                        bestChoice = thisChoice;
-                        ret = true;
-                    }
-                    else
-                    {
-                        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, thisChoice << "no better than " << bestChoice);
-                    }
-                }
+                continue;
             }
+            ISAAC_ASSERT_MSG(verifiedStartPositions_.capacity() > verifiedStartPositions_.size(),
+                             "More anchors than reserved for: " << haplotype.choice_);
+            verifiedStartPositions_.push_back(newStarPos);
 
-            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Testing pivot after " << pivotGap);
-
-            // verify case when anchoring occurs after pivot gap
-            if (findStartPos(choice, gaps, binStartPos, binEndPos,
-                             pivotGapIndex + 1, pivotGap.getEndPos(false), undoneAlignmentPos, newStarPos))
+            const GapChoice thisChoice = verifyGapsChoice(haplotype.choice_, locus.getGaps(haplotype), newStarPos, fragment, reference);
+            if (isBetterChoice(thisChoice, originalMismatchesPercent, bestChoice))
             {
-                const GapChoice thisChoice = verifyGapsChoice(choice, gaps, newStarPos, fragment, reference);
-                if (isBetterChoice(thisChoice, originalMismatchesPercent, bestChoice))
-                {
-                    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, thisChoice << "better than " << bestChoice);
-                    bestChoice = thisChoice;
-                    ret = true;
-                }
-                else
-                {
-                    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, thisChoice << "no better than " << bestChoice);
-                }
+                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, thisChoice << "better than " << bestChoice);
+                bestChoice = thisChoice;
+                ret = true;
+            }
+            else
+            {
+                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, thisChoice << "no better than " << bestChoice);
             }
         }
-        ++pivotGapIndex;
     }
 
     return ret;
@@ -1083,7 +1104,7 @@ bool GapRealigner::findBetterGapsChoice(
 //        exit(1);
 //    }
 //            const gapRealigner::OverlappingGapsFilter overlappingGapsFilter(gaps);
-    gapRealigner::ChooseKGapsFilter<GapChoiceBitmask> gapsFilter(gaps, gapsPerFragmentMax_);
+    const gapRealigner::HaplotypeLocus &locus = haplotypeCache_.get(binStartPos, gaps);
 
     const int originalMismatchesPercent = bestChoice.mismatchesPercent_;
     ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Initial bestChoice " << bestChoice);
@@ -1093,8 +1114,7 @@ bool GapRealigner::findBetterGapsChoice(
     const gapRealigner::GapsRange fragmentGapsRange = fragmentGaps_.allGaps();
 
     bool ret = false;
-    // 0 means none of the gaps apply. It also means the original alignment should be kept.
-    for (GapChoiceBitmask choice = 0; (choice = gapsFilter.next(choice));)
+    BOOST_FOREACH(const gapRealigner::Haplotype& haplotype, locus)
     {
         if (!--leftToEvaluate)
         {
@@ -1111,11 +1131,11 @@ bool GapRealigner::findBetterGapsChoice(
         //AGATCAG
         //   ^pp
         ISAAC_ASSERT_MSG(undoneAlignmentPos <= int64_t(index.pos_.getPosition()), "undoPivotPos pos " << index.pos_ << " overlapped by an existing deletion " << index);
-        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Testing choice " << int(choice) << ":" << TraceGapsChoice(choice, gaps) << " undoneAlignmentPos:" << undoneAlignmentPos);
+        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Testing choice " << int(haplotype.choice_) << ":" << TraceGapsChoice(haplotype.choice_, gaps) << " undoneAlignmentPos:" << undoneAlignmentPos);
 
 
         ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID( fragment.clusterId_, "undo pivot: " << index.pos_);
-        ret |= verifyGapsChoice(choice, gaps, binStartPos, binEndPos, fragment, reference, originalMismatchesPercent, undoneAlignmentPos, bestChoice);
+        ret |= verifyGapsChoice(locus, haplotype, gaps, binStartPos, binEndPos, fragment, reference, originalMismatchesPercent, undoneAlignmentPos, bestChoice);
 
         int64_t lastUndoneAlignmentPos = undoneAlignmentPos;
         BOOST_FOREACH(const gapRealigner::Gap& undoPivotGap, std::make_pair(fragmentGapsRange.first, fragmentGapsRange.second))
@@ -1128,10 +1148,10 @@ bool GapRealigner::findBetterGapsChoice(
                 //AGATCAG
                 //   ^pp
                 ISAAC_ASSERT_MSG(undoneAlignmentPos <= int64_t(undoPivotGap.getEndPos(false).getPosition()), "undoPivotPos pos " << undoneAlignmentPos << " overlapped by an existing gap at " << undoPivotGap << " " << index << " " << fragment);
-                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Testing choice " << int(choice) << ":" << TraceGapsChoice(choice, gaps) << " undoneAlignmentPos:" << undoneAlignmentPos);
+                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(fragment.clusterId_, "Testing choice " << int(haplotype.choice_) << ":" << TraceGapsChoice(haplotype.choice_, gaps) << " undoneAlignmentPos:" << undoneAlignmentPos);
 
                 ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID( fragment.clusterId_, "undo pivot: " << undoPivotGap.getEndPos(false));
-                ret |= verifyGapsChoice(choice, gaps, binStartPos, binEndPos, fragment, reference, originalMismatchesPercent, undoneAlignmentPos, bestChoice);
+                ret |= verifyGapsChoice(locus, haplotype, gaps, binStartPos, binEndPos, fragment, reference, originalMismatchesPercent, undoneAlignmentPos, bestChoice);
                 lastUndoneAlignmentPos = undoneAlignmentPos;
             }
         }
@@ -1236,7 +1256,7 @@ bool GapRealigner::realign(
         }
 
         RealignmentBounds bounds = extractRealignmentBounds(index);
-        const gapRealigner::GapsRange gaps = realignerGaps.findGaps(fragment.clusterId_, binStartPos, bounds.beginPos_, bounds.endPos_, 8, currentAttemptGaps_);
+        const gapRealigner::GapsRange gaps = realignerGaps.findGaps(fragment.clusterId_, binStartPos, bounds.beginPos_, bounds.endPos_, GAPS_PER_LOCUS_MAX, currentAttemptGaps_);
 
 //            if (!firstAttempt && lastAttemptGaps_.size() == currentAttemptGaps_.size() &&
 //                std::equal(lastAttemptGaps_.begin(), lastAttemptGaps_.end(), currentAttemptGaps_.begin()))
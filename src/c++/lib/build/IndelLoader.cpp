@@ -18,8 +18,15 @@
  **/
 
 #include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unistd.h>
 #include <unordered_map>
 
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+
 #include "build/IndelLoader.hh"
 #include "common/Debug.hh"
 #include "vcf/VcfUtils.hh"
@@ -30,11 +37,66 @@ namespace isaac
 namespace build
 {
 
-build::gapRealigner::Gaps loadIndels(
+namespace knownIndels
+{
+
+static const char CACHE_MAGIC[sizeof(CacheHeader::magic_)] = {'i', 'S', 'A', 'A', 'C', 'K', 'I', 'G'};
+static const unsigned CACHE_FORMAT_VERSION = 2;
+
+static uint64_t fnv1a(uint64_t hash, const void *data, const std::size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 0x100000001b3UL;
+    }
+    return hash;
+}
+
+template <typename T>
+static uint64_t fnv1a(const uint64_t hash, const T &value)
+{
+    return fnv1a(hash, &value, sizeof(value));
+}
+
+static const uint64_t FNV1A_OFFSET_BASIS = 0xcbf29ce484222325UL;
+
+static uint64_t checksumContigs(const CachedContig *contigs, const std::size_t contigCount)
+{
+    return fnv1a(FNV1A_OFFSET_BASIS, contigs, contigCount * sizeof(CachedContig));
+}
+
+static CacheHeader makeHeader(
     const boost::filesystem::path& vcfFilePath,
     const reference::SortedReferenceMetadata& sortedReferenceMetadata)
 {
-    build::gapRealigner::Gaps ret;
+    CacheHeader ret;
+    memset(&ret, 0, sizeof(ret));
+    std::copy(CACHE_MAGIC, CACHE_MAGIC + sizeof(CACHE_MAGIC), ret.magic_);
+    ret.formatVersion_ = CACHE_FORMAT_VERSION;
+    ret.contigCount_ = sortedReferenceMetadata.getContigsCount();
+    ret.vcfSize_ = boost::filesystem::file_size(vcfFilePath);
+    ret.vcfMtime_ = boost::filesystem::last_write_time(vcfFilePath);
+
+    uint64_t checksum = FNV1A_OFFSET_BASIS;
+    BOOST_FOREACH(const reference::SortedReferenceMetadata::Contig &contig, sortedReferenceMetadata.getContigs())
+    {
+        checksum = fnv1a(checksum, contig.index_);
+        checksum = fnv1a(checksum, contig.name_.data(), contig.name_.size());
+        checksum = fnv1a(checksum, contig.totalBases_);
+    }
+    ret.referenceChecksum_ = checksum;
+    return ret;
+}
+
+/**
+ * \brief Parses the vcf into per-contig lists of gaps
+ */
+static void loadIndels(
+    const boost::filesystem::path& vcfFilePath,
+    const reference::SortedReferenceMetadata& sortedReferenceMetadata,
+    std::vector<std::vector<CachedGap> > &contigGaps)
+{
     typedef std::unordered_map<std::string, unsigned> ContigLookup;
     ContigLookup contigLookup;
 
@@ -43,9 +105,11 @@ build::gapRealigner::Gaps loadIndels(
         contigs.begin(), contigs.end(),
         [&](const reference::SortedReferenceMetadata::Contig& contig)
         {
+            ISAAC_ASSERT_MSG(contig.index_ < contigs.size(), "Contig indexes are expected to be sequential " << contig);
             contigLookup.insert(ContigLookup::value_type(contig.name_, contig.index_));
         }
     );
+    contigGaps.resize(contigs.size());
 
     std::ifstream ifs(vcfFilePath.c_str());
     if (!ifs)
@@ -77,6 +141,12 @@ build::gapRealigner::Gaps loadIndels(
             ContigLookup::const_iterator contigIndex = contigLookup.find(parsedLine.getChromosome());
             if (contigLookup.end() != contigIndex)
             {
+                if (parsedLine.getPosition() > std::numeric_limits<uint32_t>::max())
+                {
+                    BOOST_THROW_EXCEPTION(vcf::VcfError(
+                        (boost::format("ERROR: %s:%d. Position is too large: %s") %
+                            vcfFilePath.c_str() % lineNumber % line).str()));
+                }
                 for (ParsedLine::AlternativesConstIterator it = parsedLine.alternativesBegin();
                     parsedLine.alternativesEnd() != it; ++it)
                 {
@@ -88,12 +158,11 @@ build::gapRealigner::Gaps loadIndels(
                     }
                     else if (alternative.refLength() != alternative.altLength())
                     {
-                        ret.push_back(
-                            build::gapRealigner::Gap(
-                                reference::ReferencePosition(contigIndex->second, parsedLine.getPosition()),
-                                alternative.refLength() - alternative.altLength()));
-                        insertions += ret.back().isInsertion();
-                        deletions += ret.back().isDeletion();
+                        const CachedGap gap = {uint32_t(parsedLine.getPosition()),
+                                               int32_t(alternative.refLength()) - int32_t(alternative.altLength())};
+                        contigGaps.at(contigIndex->second).push_back(gap);
+                        insertions += 0 > gap.length_;
+                        deletions += 0 < gap.length_;
                     }
                 }
             }
@@ -111,17 +180,234 @@ build::gapRealigner::Gaps loadIndels(
     }
 
     ISAAC_THREAD_CERR << "Read " << insertions << " known insertions and " << deletions << " deletions from " << vcfFilePath.c_str() << std::endl;
+}
 
-    return ret;
+/**
+ * \brief Writes the cache under a temporary name and renames it into place so that concurrent runs
+ *        never see a partially written cache.
+ *
+ * \return false if the cache could not be stored.
+ */
+static bool storeCache(
+    const boost::filesystem::path &cachePath,
+    const CacheHeader &header,
+    const std::vector<CachedContig> &contigs,
+    const std::vector<CachedGap> &gaps)
+{
+    const boost::filesystem::path tmpPath =
+        cachePath.string() + (boost::format(".tmp%d") % ::getpid()).str();
+    {
+        std::ofstream os(tmpPath.c_str(), std::ios_base::binary);
+        if (os)
+        {
+            os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            if (!contigs.empty())
+            {
+                os.write(reinterpret_cast<const char*>(&contigs.front()), contigs.size() * sizeof(CachedContig));
+            }
+            if (!gaps.empty())
+            {
+                os.write(reinterpret_cast<const char*>(&gaps.front()), gaps.size() * sizeof(CachedGap));
+            }
+            os.close();
+        }
+        if (!os)
+        {
+            ISAAC_THREAD_CERR << "WARNING: Unable to store known indels cache " << tmpPath.c_str() <<
+                ": " << strerror(errno) << std::endl;
+            boost::system::error_code ignore;
+            boost::filesystem::remove(tmpPath, ignore);
+            return false;
+        }
+    }
+
+    if (-1 == ::rename(tmpPath.c_str(), cachePath.c_str()))
+    {
+        ISAAC_THREAD_CERR << "WARNING: Unable to rename known indels cache " << tmpPath.c_str() << " to " <<
+            cachePath.c_str() << ": " << strerror(errno) << std::endl;
+        boost::system::error_code ignore;
+        boost::filesystem::remove(tmpPath, ignore);
+        return false;
+    }
+    return true;
 }
 
-build::gapRealigner::Gaps loadIndels(
+} // namespace knownIndels
+
+KnownIndels::KnownIndels(
     const boost::filesystem::path &vcfFilePath,
-    const reference::SortedReferenceMetadataList &sortedReferenceMetadataList)
+    const reference::SortedReferenceMetadataList &sortedReferenceMetadataList) :
+    contigs_(0), contigCount_(0), gaps_(0), gapCount_(0)
 {
+    using namespace knownIndels;
+    if (vcfFilePath.empty())
+    {
+        return;
+    }
+
     ISAAC_ASSERT_MSG(1 == sortedReferenceMetadataList.size(), "Multiple references are not supported");
     const reference::SortedReferenceMetadata &sortedReferenceMetadata  = sortedReferenceMetadataList.front();
-    return loadIndels(vcfFilePath, sortedReferenceMetadata);
+    if (!boost::filesystem::exists(vcfFilePath))
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(ENOENT,
+            (boost::format("ERROR: Unable to open known indels file: %s") % vcfFilePath.c_str()).str()));
+    }
+
+    const CacheHeader expected = makeHeader(vcfFilePath, sortedReferenceMetadata);
+    const boost::filesystem::path cachePath = getCachePath(vcfFilePath);
+    if (mapCache(cachePath, expected))
+    {
+        ISAAC_THREAD_CERR << "Mapped " << gapCount_ << " known indels from " << cachePath.c_str() << std::endl;
+        return;
+    }
+
+    std::vector<std::vector<CachedGap> > contigGaps;
+    loadIndels(vcfFilePath, sortedReferenceMetadata, contigGaps);
+
+    std::size_t totalGaps = 0;
+    BOOST_FOREACH(const std::vector<CachedGap> &gaps, contigGaps)
+    {
+        totalGaps += gaps.size();
+    }
+    gapsBuffer_.reserve(totalGaps);
+    contigsBuffer_.reserve(contigGaps.size());
+    BOOST_FOREACH(std::vector<CachedGap> &gaps, contigGaps)
+    {
+        std::sort(gaps.begin(), gaps.end());
+        CachedContig contig = {gapsBuffer_.size(), gapsBuffer_.size() + gaps.size(), 0, 0};
+        BOOST_FOREACH(const CachedGap &gap, gaps)
+        {
+            contig.maxDeletionLength_ = std::max<uint32_t>(contig.maxDeletionLength_, std::max(gap.length_, 0));
+        }
+        gapsBuffer_.insert(gapsBuffer_.end(), gaps.begin(), gaps.end());
+        contigsBuffer_.push_back(contig);
+        std::vector<CachedGap>().swap(gaps);
+    }
+
+    CacheHeader header = expected;
+    header.gapCount_ = gapsBuffer_.size();
+    header.contigsChecksum_ = checksumContigs(contigsBuffer_.empty() ? 0 : &contigsBuffer_.front(), contigsBuffer_.size());
+    if (storeCache(cachePath, header, contigsBuffer_, gapsBuffer_) && mapCache(cachePath, header))
+    {
+        ISAAC_THREAD_CERR << "Stored " << gapCount_ << " known indels in " << cachePath.c_str() << std::endl;
+        std::vector<CachedContig>().swap(contigsBuffer_);
+        std::vector<CachedGap>().swap(gapsBuffer_);
+        return;
+    }
+
+    contigs_ = contigsBuffer_.empty() ? 0 : &contigsBuffer_.front();
+    contigCount_ = contigsBuffer_.size();
+    gaps_ = gapsBuffer_.empty() ? 0 : &gapsBuffer_.front();
+    gapCount_ = gapsBuffer_.size();
+}
+
+/**
+ * \return false if the cache does not exist, is damaged or was produced from a different vcf or reference
+ */
+bool KnownIndels::mapCache(
+    const boost::filesystem::path &cachePath,
+    const knownIndels::CacheHeader &expected)
+{
+    using namespace knownIndels;
+    if (!boost::filesystem::exists(cachePath))
+    {
+        return false;
+    }
+    cacheFile_.map(cachePath, false);
+
+    CacheHeader header;
+    if (cacheFile_.size() < sizeof(header))
+    {
+        ISAAC_THREAD_CERR << "WARNING: Ignoring truncated known indels cache " << cachePath.c_str() << std::endl;
+        cacheFile_.unmap();
+        return false;
+    }
+    // the mapping is page-aligned, so the tables that follow the header are properly aligned too
+    memcpy(&header, cacheFile_.data(), sizeof(header));
+    if (!std::equal(CACHE_MAGIC, CACHE_MAGIC + sizeof(CACHE_MAGIC), header.magic_) ||
+        expected.formatVersion_ != header.formatVersion_ ||
+        expected.contigCount_ != header.contigCount_ ||
+        expected.vcfSize_ != header.vcfSize_ ||
+        expected.vcfMtime_ != header.vcfMtime_ ||
+        expected.referenceChecksum_ != header.referenceChecksum_ ||
+        cacheFile_.size() != sizeof(header) + header.contigCount_ * sizeof(CachedContig) + header.gapCount_ * sizeof(CachedGap))
+    {
+        ISAAC_THREAD_CERR << "Known indels cache " << cachePath.c_str() << " is out of date" << std::endl;
+        cacheFile_.unmap();
+        return false;
+    }
+
+    // Only the contig table is hashed. Hashing the gap table would page in the whole cache on every start,
+    // while Build only touches the gaps of the bins it processes.
+    const CachedContig *contigs = reinterpret_cast<const CachedContig *>(cacheFile_.data() + sizeof(header));
+    const CachedGap *gaps = reinterpret_cast<const CachedGap *>(contigs + header.contigCount_);
+    uint64_t contigsEnd = 0;
+    if (header.contigsChecksum_ != checksumContigs(contigs, header.contigCount_) ||
+        contigs + header.contigCount_ != std::find_if(
+            contigs, contigs + header.contigCount_,
+            [&](const CachedContig &contig)
+            {
+                const bool damaged = contigsEnd != contig.begin_ || contig.begin_ > contig.end_;
+                contigsEnd = contig.end_;
+                return damaged;
+            }) ||
+        header.gapCount_ != contigsEnd)
+    {
+        ISAAC_THREAD_CERR << "WARNING: Ignoring damaged known indels cache " << cachePath.c_str() << std::endl;
+        cacheFile_.unmap();
+        return false;
+    }
+
+    contigs_ = contigs;
+    contigCount_ = header.contigCount_;
+    gaps_ = gaps;
+    gapCount_ = header.gapCount_;
+    return true;
+}
+
+void KnownIndels::appendBinGaps(
+    const reference::ReferencePosition binStart,
+    const reference::ReferencePosition binEnd,
+    gapRealigner::Gaps &gaps) const
+{
+    using namespace knownIndels;
+    if (!contigCount_ || binStart.isNoMatch() || binEnd.isTooManyMatch())
+    {
+        return;
+    }
+
+    const uint64_t firstContig = binStart.isTooManyMatch() ? 0 : binStart.getContigId();
+    const uint64_t lastContig = binEnd.isNoMatch() ?
+        contigCount_ - 1 : std::min<uint64_t>(binEnd.getContigId(), contigCount_ - 1);
+    for (uint64_t contigId = firstContig; contigId <= lastContig; ++contigId)
+    {
+        const CachedContig &contig = contigs_[contigId];
+        const CachedGap *begin = gaps_ + contig.begin_;
+        const CachedGap *end = gaps_ + contig.end_;
+        if (!binStart.isTooManyMatch() && binStart.getContigId() == contigId)
+        {
+            const uint64_t lowest = binStart.getPosition() - std::min<uint64_t>(binStart.getPosition(), contig.maxDeletionLength_);
+            const CachedGap key = {uint32_t(std::min<uint64_t>(lowest, std::numeric_limits<uint32_t>::max())),
+                                   std::numeric_limits<int32_t>::min()};
+            begin = std::lower_bound(begin, end, key);
+        }
+        if (!binEnd.isNoMatch() && binEnd.getContigId() == contigId)
+        {
+            const CachedGap key = {uint32_t(std::min<uint64_t>(binEnd.getPosition(), std::numeric_limits<uint32_t>::max())),
+                                   std::numeric_limits<int32_t>::min()};
+            end = std::lower_bound(begin, end, key);
+        }
+
+        for (; end != begin; ++begin)
+        {
+            const gapRealigner::Gap gap(reference::ReferencePosition(contigId, begin->position_), begin->length_);
+            if ((gap.getBeginPos() >= binStart && gap.getBeginPos() < binEnd) ||
+                (gap.getEndPos(false) >= binStart && gap.getEndPos(false) < binEnd))
+            {
+                gaps.push_back(gap);
+            }
+        }
+    }
 }
 
 } // namespace build
@@ -31,7 +31,9 @@ namespace build
 void ParallelGapRealigner::realign(
     isaac::build::GapRealigner& realigner,
     io::FragmentAccessor& fragment, PackedFragmentBuffer::Index &index,
-    BinData& binData, isaac::alignment::Cigar& cigars)
+    BinData& binData, isaac::alignment::Cigar& cigars,
+    isaac::alignment::Cigar& cigarArena,
+    std::vector<RealignedFragment> &realignedFragments)
 {
     reference::ReferencePosition newRStrandPosition;
     unsigned short newEditDistance = 0;
@@ -56,18 +58,52 @@ void ParallelGapRealigner::realign(
             clipper.clip(ref, binEndPos, fragment, index, newRStrandPosition, newEditDistance);
         }
 
+        const std::size_t cigarLength = index.cigarEnd_ - index.cigarBegin_;
+        // the arena must not grow as this runs while the dynamic memory allocations are blocked
+        if (cigarArena.size() + cigarLength > cigarArena.capacity() ||
+            realignedFragments.size() == realignedFragments.capacity())
+        {
+            publishRealignedFragments(binData, cigarArena, realignedFragments);
+        }
+        ISAAC_ASSERT_MSG(cigarArena.capacity() >= cigarLength, "Realigned CIGAR does not fit the empty arena: " << cigarLength);
+
+        // index keeps pointing at cigars until publishRealignedFragments. Nothing looks at it in the meantime.
+        const RealignedFragment realigned =
+            {&index, cigarArena.size(), cigarLength, newRStrandPosition, newEditDistance};
+        cigarArena.insert(cigarArena.end(), index.cigarBegin_, index.cigarEnd_);
+        realignedFragments.push_back(realigned);
+    }
+}
+
+/**
+ * \brief Moves the thread arena CIGARs into the bin and updates the pairs of the realigned fragments.
+ *
+ * Realignment of a fragment does not look at anything updatePairDetails changes on its mate, so the updates
+ * can wait until the batch is done. Publishing batches one at a time keeps the updates from threads that
+ * have realigned the two mates of the same pair from colliding.
+ */
+void ParallelGapRealigner::publishRealignedFragments(
+    BinData& binData,
+    isaac::alignment::Cigar& cigarArena,
+    std::vector<RealignedFragment> &realignedFragments)
+{
+    if (!realignedFragments.empty())
+    {
         boost::unique_lock<boost::mutex> lock(cigarBufferMutex_);
+        const std::size_t before = binData.additionalCigars_.size();
+        binData.additionalCigars_.addOperations(cigarArena.begin(), cigarArena.end());
+        BOOST_FOREACH(const RealignedFragment &realigned, realignedFragments)
         {
-            const std::size_t before = binData.additionalCigars_.size();
-            binData.additionalCigars_.addOperations(index.cigarBegin_, index.cigarEnd_);
-            index.cigarBegin_ = &binData.additionalCigars_.at(before);
-            index.cigarEnd_ = &binData.additionalCigars_.back() + 1;
-            // realignment affects both reads. We must make sure realignment updates on one read don't
-            // collide with post-realignment pair updates from another read.
-            realigner.updatePairDetails(
-                barcodeTemplateLengthStatistics_, index, newRStrandPosition, newEditDistance, fragment, binData.data_);
+            PackedFragmentBuffer::Index &index = *realigned.index_;
+            index.cigarBegin_ = &binData.additionalCigars_.at(before + realigned.cigarOffset_);
+            index.cigarEnd_ = index.cigarBegin_ + realigned.cigarLength_;
+            GapRealigner::updatePairDetails(
+                barcodeTemplateLengthStatistics_, index, realigned.newRStrandPosition_, realigned.newEditDistance_,
+                binData.data_.getFragment(index), binData.data_);
         }
     }
+    cigarArena.clear();
+    realignedFragments.clear();
 }
 
 void ParallelGapRealigner::threadRealignGaps(boost::unique_lock<boost::mutex> &lock, BinData &binData, BinData::iterator &nextUnprocessed, uint64_t threadNumber)
@@ -76,7 +112,8 @@ void ParallelGapRealigner::threadRealignGaps(boost::unique_lock<boost::mutex> &l
 
     isaac::build::GapRealigner &realigner = threadGapRealigners_.at(threadNumber);
     isaac::alignment::Cigar &cigars = threadCigars_.at(threadNumber);
-    static const std::size_t READS_AT_A_TIME = 1024;
+    isaac::alignment::Cigar &cigarArena = threadCigarArenas_.at(threadNumber);
+    std::vector<RealignedFragment> &realignedFragments = threadRealignedFragments_.at(threadNumber);
 
 //    int blockCount = 0;
     while (binData.indexEnd() != nextUnprocessed)
@@ -93,9 +130,10 @@ void ParallelGapRealigner::threadRealignGaps(boost::unique_lock<boost::mutex> &l
                 if (binData.bin_.hasPosition(fragment.fStrandPosition_))
                 {
                     cigars.clear();
-                    realign(realigner, fragment, index, binData, cigars);
+                    realign(realigner, fragment, index, binData, cigars, cigarArena, realignedFragments);
                 }
             }
+            publishRealignedFragments(binData, cigarArena, realignedFragments);
         }
 //        ++blockCount;
     }
@@ -111,6 +111,72 @@ void testNoDifferences(std::vector<IndexT> bin, std::vector<IndexT>  expectedUni
     CPPUNIT_ASSERT_EQUAL(size_t(0), diff.size());
 
 }
+/**
+ * \brief std::sort with the filter comparator, then equal_to against the last unique fragment. This is how the
+ *        duplicates were filtered before DuplicateRanking.
+ */
+template <typename IndexT>
+std::vector<uint64_t> filterWithComparator(
+    const TestDuplicateFilter<IndexT> &filter,
+    const PackedFragmentBuffer &fragments,
+    std::vector<IndexT> bin)
+{
+    std::sort(bin.begin(), bin.end(), boost::bind(&TestDuplicateFilter<IndexT>::less, &filter, boost::ref(fragments), _1, _2));
+    std::vector<uint64_t> ret;
+    typename std::vector<IndexT>::const_iterator last = bin.begin();
+    for (typename std::vector<IndexT>::const_iterator it = bin.begin(); bin.end() != it; ++it)
+    {
+        if (bin.begin() == it || !filter.equal_to(fragments, *last, *it))
+        {
+            ret.push_back(it->dataOffset_);
+            last = it;
+        }
+    }
+    return ret;
+}
+
+/**
+ * \brief Unique fragments and their order must be the same as with the comparator sort. Ranking units
+ *        are processed in reverse order to make sure they don't depend on each other within a phase.
+ */
+template <typename IndexT>
+void testSameAsComparator(const std::vector<IndexT> &bin, const std::size_t fragmentsCount)
+{
+    isaac::alignment::BinMetadataList binMetadataList(1);
+    isaac::alignment::BinMetadataCRefList binMetadataCRefList(1, boost::ref(binMetadataList.front()));
+    binMetadataList[0] = isaac::alignment::BinMetadata(0, 0, isaac::reference::ReferencePosition(0,0), 1000, "");
+    binMetadataList.at(0).incrementDataSize(isaac::reference::ReferencePosition(0,0), fragmentsCount * sizeof(isaac::io::FragmentHeader));
+    FakePackedFragmentBuffer fragments;
+    fragments.resize(binMetadataList.at(0));
+    fragments.fillWithUniqueClusterIdPattern();
+
+    const TestDuplicateFilter<IndexT> filter;
+    const std::vector<uint64_t> expected = filterWithComparator(filter, fragments, bin);
+
+    std::vector<IndexT> input(bin);
+    DuplicateRankingBuffers buffers;
+    buffers.reserve(input.size());
+    DuplicateRanking<TestDuplicateFilter<IndexT>, typename std::vector<IndexT>::iterator> ranking(
+        filter, fragments, input.begin(), input.end(), buffers);
+    CPPUNIT_ASSERT(3 < ranking.getPhaseCount());
+    for (std::size_t phase = 0; ranking.getPhaseCount() != phase; ++phase)
+    {
+        for (std::size_t unit = ranking.getUnitCount(phase); unit; --unit)
+        {
+            ranking.processUnit(phase, unit - 1);
+        }
+    }
+
+    isaac::flowcell::BarcodeMetadataList barcodeMetadataList(1);
+    BuildStats buildStats(binMetadataCRefList, barcodeMetadataList);
+    std::vector<PackedFragmentBuffer::Index> results;
+    CPPUNIT_ASSERT_EQUAL(uint64_t(expected.size()), ranking.emit(false, buildStats, 0, std::back_inserter(results)));
+    std::vector<uint64_t> unique;
+    std::transform(results.begin(), results.end(), std::back_inserter(unique),
+                   boost::bind(&PackedFragmentBuffer::Index::dataOffset_, _1));
+    CPPUNIT_ASSERT(expected == unique);
+}
+
 /**
  * \brief Set up the fragment pairs. Naming convention:
  * <strand><relative location><pair number><pair orientation>
@@ -422,3 +488,25 @@ void TestDuplicateFiltering::testAllTogether()
     }
 
 }
+
+void TestDuplicateFiltering::testRankingSameAsComparator()
+{
+    // enough fragments for a few merge rounds, few enough positions for big groups of duplicates
+    static const std::size_t INDEXES = DuplicateRanking<RSDuplicateFilter<false>, std::vector<RStrandOrShadowFragmentIndex>::iterator>::CHUNK_SIZE * 5 + 123;
+    // some indexes point at the same fragment. These are not duplicates of each other
+    static const std::size_t FRAGMENTS = INDEXES / 3;
+    std::srand(0);
+    std::vector<FStrandFragmentIndex> fInput;
+    std::vector<RStrandOrShadowFragmentIndex> rsInput;
+    for (std::size_t i = 0; INDEXES != i; ++i)
+    {
+        const FragmentIndexMate mate(std::rand() % 8 == 0, std::rand() % 2, std::rand() % 2, FragmentIndexAnchor(std::rand() % 4));
+        fInput.push_back(FStrandFragmentIndex(ReferencePosition(0, std::rand() % 300), mate, std::rand() % 4));
+        fInput.back().dataOffset_ = (std::rand() % FRAGMENTS) * sizeof(isaac::io::FragmentHeader);
+        rsInput.push_back(RStrandOrShadowFragmentIndex(
+            ReferencePosition(0, std::rand() % 300), FragmentIndexAnchor(std::rand() % 4), mate, std::rand() % 4));
+        rsInput.back().dataOffset_ = (std::rand() % FRAGMENTS) * sizeof(isaac::io::FragmentHeader);
+    }
+    testSameAsComparator(fInput, FRAGMENTS);
+    testSameAsComparator(rsInput, FRAGMENTS);
+}
@@ -31,6 +31,7 @@ class TestDuplicateFiltering : public CppUnit::TestFixture
     CPPUNIT_TEST( testFrpReverseMatesInDifferentBins );
     CPPUNIT_TEST( testFsh );
     CPPUNIT_TEST( testAllTogether );
+    CPPUNIT_TEST( testRankingSameAsComparator );
     CPPUNIT_TEST_SUITE_END();
 private:
     isaac::build::FStrandFragmentIndex fLeft1Frp_;
@@ -86,6 +87,7 @@ public:
     void testFrpReverseMatesInDifferentBins();
     void testFsh();
     void testAllTogether();
+    void testRankingSameAsComparator();
 };
 
 #endif // #ifndef iSAAC_ALIGNMENT_TEST_DUPLICATE_FILTERING_HH
@@ -348,15 +348,23 @@ void addGaps(const std::string &ref, const std::string &gaps, RealignerGapsT &re
     }
 }
 
+const flowcell::BarcodeMetadataList &getBarcodeMetadataList()
+{
+    static isaac::flowcell::BarcodeMetadataList barcodeMetadataList(1);
+    barcodeMetadataList.at(0).setUnknown();
+    barcodeMetadataList.at(0).setIndex(0);
+    barcodeMetadataList.at(0).setReferenceIndex(0);
+    return barcodeMetadataList;
+}
+
 RealignResult realign(
-    const unsigned mismatchCost,
-    const unsigned gapOpenCost,
+    build::GapRealigner &realigner,
     const std::string &read,
     const std::string &ref,
     const build::gapRealigner::RealignerGaps &realignerGaps,
     const io::FragmentHeader &init,
-    const reference::ReferencePosition binStartPos = reference::ReferencePosition(0, 0),
-    reference::ReferencePosition binEndPos = reference::ReferencePosition(reference::ReferencePosition::NoMatch))
+    const reference::ReferencePosition binStartPos,
+    reference::ReferencePosition binEndPos)
 {
 
 //    ISAAC_THREAD_CERR << "Initialized " <<
@@ -376,13 +384,7 @@ RealignResult realign(
         ISAAC_THREAD_CERR << "binEndPos:" << binEndPos << std::endl;
     }
 
-
-    isaac::flowcell::BarcodeMetadataList barcodeMetadataList(1);
-    barcodeMetadataList.at(0).setUnknown();
-    barcodeMetadataList.at(0).setIndex(0);
-    barcodeMetadataList.at(0).setReferenceIndex(0);
-
-    alignment::BinMetadata bin(barcodeMetadataList.size(), 0, reference::ReferencePosition(0,0), 1000000, "tada");
+    alignment::BinMetadata bin(getBarcodeMetadataList().size(), 0, reference::ReferencePosition(0,0), 1000000, "tada");
 
     static build::gapRealigner::Gaps foundGaps;
     foundGaps.reserve(100000);
@@ -394,7 +396,7 @@ RealignResult realign(
     build::PackedFragmentBuffer dataBuffer;
     alignment::BinMetadata realBin(bin);
     realBin.incrementDataSize(isaac::reference::ReferencePosition(0,0), sizeof(fragment));
-    realBin.incrementCigarLength(isaac::reference::ReferencePosition(0,0), 1024, 0);
+    realBin.incrementCigarLength(isaac::reference::ReferencePosition(0,0), 1024, 0, 0);
     dataBuffer.resize(realBin);
     std::copy(fragment.begin(), fragment.end(), dataBuffer.begin());
 
@@ -404,20 +406,34 @@ RealignResult realign(
     const unsigned realignedGapsPerFragment = 8;
     alignment::Cigar realignedCigars; realignedCigars.reserve(1024);
     realignedCigars.reserve(realBin.getTotalCigarLength() + realBin.getTotalElements() * (1 + realignedGapsPerFragment * 2));
-    build::GapRealigner realigner(false, false, 4, mismatchCost, gapOpenCost, 0, false, barcodeMetadataList);
-    realigner.realign(realignerGaps, binStartPos, binEndPos, index, dataBuffer.getFragment(index), dataBuffer, realignedCigars, contigLists);
+    reference::ReferencePosition newRStrandPosition;
+    unsigned short newEditDistance = fragment.editDistance_;
+    realigner.realign(
+        realignerGaps, binStartPos, binEndPos, dataBuffer.getFragment(index), index,
+        newRStrandPosition, newEditDistance, dataBuffer, realignedCigars, contigLists);
 
     ret.realignedPos_ = index.pos_;
     ret.realignedCigar_ = alignment::Cigar::toString(index.cigarBegin_, index.cigarEnd_);
-    const io::FragmentAccessor &updatedFragment = dataBuffer.getFragment(index);
-// this is broken until updatePairDetails is called.
-//    CPPUNIT_ASSERT_EQUAL(updatedFragment.fStrandPosition_, index.pos_);
-
-    ret.realignedEditDistance_ = updatedFragment.editDistance_;
+// the fragment itself is not updated until updatePairDetails is called.
+    ret.realignedEditDistance_ = newEditDistance;
 
     return ret;
 }
 
+RealignResult realign(
+    const unsigned mismatchCost,
+    const unsigned gapOpenCost,
+    const std::string &read,
+    const std::string &ref,
+    const build::gapRealigner::RealignerGaps &realignerGaps,
+    const io::FragmentHeader &init,
+    const reference::ReferencePosition binStartPos = reference::ReferencePosition(0, 0),
+    reference::ReferencePosition binEndPos = reference::ReferencePosition(reference::ReferencePosition::NoMatch))
+{
+    build::GapRealigner realigner(false, false, 4, mismatchCost, gapOpenCost, 0, getBarcodeMetadataList());
+    return realign(realigner, read, ref, realignerGaps, init, binStartPos, binEndPos);
+}
+
 RealignResult realign(
     const std::string &read,
     const std::string &ref,
@@ -1804,3 +1820,40 @@ void TestGapRealigner::testFull11()
 
 }
 
+void TestGapRealigner::testHaplotypeCache()
+{
+    ISAAC_SCOPE_BLOCK_CERR
+    {
+    const std::string ref =
+        "GACTCAATCAGGCAATATGAAGTTGCAGGAACTGGAAGAGGAGAGATAGTCAGGCTTATCTTGGCATACCATTCTCAAGAACCACTACTTCCTTAAAAAA";
+    const std::string gaps =
+        "  *                                              *              *      ***";
+    // reads overlapping the same gaps hit the haplotypes cached by the ones realigned before them
+    const std::string reads[] = {
+        "GACCTCAATCAGGCAATATGAAGTTGCAGGAACTGGAAGAGGAGAGATAGTTCAGGCTTATCTTGGCCATACCATTCTTCTCAAGAACCACTACTTCCTT",
+        "GACCTCAATCAGGCAATATGAAGTTGCAGGAACTGGAAGAGGAGAGATAGTTCAGGCTTATCTTGGCCATACCATTCTTCTCAAGAACCACTACTTCCTT",
+        "GACCTCAATCAGGCAATATGAAGTTGCAGGAACTGGAAGAGGAGAGATAGTTCAGGCTTATCTTGGCCATACCATTCTTCTCAAGAACCACTAC",
+        "   CTCAATCAGGCAATATGAAGTTGCAGGAACTGGAAGAGGAGAGATAGTTCAGGCTTATCTTGGCCATACCATTCTTCTCAAGAACCACTACTTCCTT",
+        "GACCTCAATCAGGCAATATGAAGTTGCAGGAACTGGAAGAGGATAGATAGTTCAGGCTTATCTTGGCCATACCATTCTTCTCAAGAACCACTACTTCCTT",
+        "          CAGGCAATATGAAGTTGCAGGAACTGGAAGAGGAGAGATAGTTCAGGCTTATCTTGGCCATACCATTCTTCTCAAGAACCACTACTTCCTT",
+    };
+
+    build::gapRealigner::RealignerGaps realignerGaps;
+    addGaps(ref, gaps, realignerGaps);
+    realignerGaps.finalizeGaps();
+
+    build::GapRealigner warmRealigner(false, false, 4, 1, 0, 0, getBarcodeMetadataList());
+    BOOST_FOREACH(const std::string &read, reads)
+    {
+        const RealignResult cold = realign(1, 0, read, ref, realignerGaps, io::FragmentHeader());
+        const RealignResult warm = realign(
+            warmRealigner, read, ref, realignerGaps, io::FragmentHeader(),
+            reference::ReferencePosition(0, 0), reference::ReferencePosition(reference::ReferencePosition::NoMatch));
+
+        CPPUNIT_ASSERT(cold.originalCigar_ != cold.realignedCigar_);
+        CPPUNIT_ASSERT_EQUAL(cold.realignedPos_, warm.realignedPos_);
+        CPPUNIT_ASSERT_EQUAL(cold.realignedCigar_, warm.realignedCigar_);
+        CPPUNIT_ASSERT_EQUAL(int(cold.realignedEditDistance_), int(warm.realignedEditDistance_));
+    }
+    }
+}
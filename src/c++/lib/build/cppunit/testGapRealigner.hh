@@ -30,6 +30,7 @@ class TestGapRealigner : public CppUnit::TestFixture
     CPPUNIT_TEST( testFull9 );
     CPPUNIT_TEST( testFull10 );
     CPPUNIT_TEST( testFull11 );
+    CPPUNIT_TEST( testHaplotypeCache );
     CPPUNIT_TEST_SUITE_END();
 private:
 
@@ -49,6 +50,7 @@ public:
     void testFull9();
     void testFull10();
     void testFull11();
+    void testHaplotypeCache();
 };
 
 #endif // #ifndef iSAAC_ALIGNMENT_TEST_GAP_REALIGNER_HH
@@ -0,0 +1,119 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "build/gapRealigner/ImplicitSearchTree.hh"
+
+using namespace std;
+using namespace isaac;
+using isaac::build::gapRealigner::ImplicitSearchTree;
+
+#include "RegistryName.hh"
+#include "testImplicitSearchTree.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestImplicitSearchTree, registryName("TestImplicitSearchTree"));
+
+void TestImplicitSearchTree::setUp()
+{
+}
+
+void TestImplicitSearchTree::tearDown()
+{
+}
+
+static uint64_t getKey(const uint64_t key)
+{
+    return key;
+}
+
+static ImplicitSearchTree buildTree(const std::vector<uint64_t> &keys)
+{
+    ImplicitSearchTree ret;
+    ret.reserve(keys.size());
+    ret.build(keys.begin(), keys.end(), &getKey);
+    return ret;
+}
+
+void TestImplicitSearchTree::testEmpty()
+{
+    const ImplicitSearchTree tree = buildTree(std::vector<uint64_t>());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), tree.size());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), tree.lowerBound(0));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), tree.lowerBound(100));
+
+    // never built
+    const ImplicitSearchTree unbuilt;
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), unbuilt.lowerBound(100));
+}
+
+void TestImplicitSearchTree::testDuplicates()
+{
+    const uint64_t keyArray[] = {10, 20, 20, 20, 30, 30, 40};
+    const std::vector<uint64_t> keys(keyArray, keyArray + sizeof(keyArray) / sizeof(keyArray[0]));
+    const ImplicitSearchTree tree = buildTree(keys);
+    CPPUNIT_ASSERT_EQUAL(keys.size(), tree.size());
+    // always the first of the equal keys
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), tree.lowerBound(20));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), tree.lowerBound(30));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), tree.lowerBound(11));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), tree.lowerBound(21));
+
+    const std::vector<uint64_t> same(9, 7);
+    const ImplicitSearchTree sameTree = buildTree(same);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), sameTree.lowerBound(7));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(9), sameTree.lowerBound(8));
+}
+
+void TestImplicitSearchTree::testOutOfRange()
+{
+    for (std::size_t size = 1; 20 != size; ++size)
+    {
+        std::vector<uint64_t> keys;
+        for (std::size_t i = 0; size != i; ++i)
+        {
+            keys.push_back(100 + i * 2);
+        }
+        const ImplicitSearchTree tree = buildTree(keys);
+        CPPUNIT_ASSERT_EQUAL(std::size_t(0), tree.lowerBound(0));
+        CPPUNIT_ASSERT_EQUAL(std::size_t(0), tree.lowerBound(99));
+        CPPUNIT_ASSERT_EQUAL(std::size_t(0), tree.lowerBound(100));
+        CPPUNIT_ASSERT_EQUAL(size - 1, tree.lowerBound(keys.back()));
+        CPPUNIT_ASSERT_EQUAL(size, tree.lowerBound(keys.back() + 1));
+        CPPUNIT_ASSERT_EQUAL(size, tree.lowerBound(uint64_t(0) - 1));
+    }
+}
+
+void TestImplicitSearchTree::testSameAsLowerBound()
+{
+    std::srand(1);
+    // sizes around the powers of two make the last tree level full, nearly full and nearly empty
+    for (std::size_t size = 0; 300 != size; ++size)
+    {
+        std::vector<uint64_t> keys;
+        for (std::size_t i = 0; size != i; ++i)
+        {
+            keys.push_back(std::rand() % (size + 1) * 3);
+        }
+        std::sort(keys.begin(), keys.end());
+        const ImplicitSearchTree tree = buildTree(keys);
+        for (uint64_t value = 0; (size + 2) * 3 != value; ++value)
+        {
+            CPPUNIT_ASSERT_EQUAL(
+                std::size_t(std::distance(keys.begin(), std::lower_bound(keys.begin(), keys.end(), value))),
+                tree.lowerBound(value));
+        }
+    }
+}
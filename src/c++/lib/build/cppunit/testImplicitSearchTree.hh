@@ -0,0 +1,37 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_BUILD_TEST_IMPLICIT_SEARCH_TREE_HH
+#define iSAAC_BUILD_TEST_IMPLICIT_SEARCH_TREE_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class TestImplicitSearchTree : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestImplicitSearchTree );
+    CPPUNIT_TEST( testEmpty );
+    CPPUNIT_TEST( testDuplicates );
+    CPPUNIT_TEST( testOutOfRange );
+    CPPUNIT_TEST( testSameAsLowerBound );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+    void testEmpty();
+    void testDuplicates();
+    void testOutOfRange();
+    void testSameAsLowerBound();
+};
+
+#endif // #ifndef iSAAC_BUILD_TEST_IMPLICIT_SEARCH_TREE_HH
@@ -0,0 +1,136 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <boost/foreach.hpp>
+
+#include "build/IndelLoader.hh"
+
+using namespace std;
+using namespace isaac;
+using namespace isaac::build;
+using isaac::reference::ReferencePosition;
+
+#include "RegistryName.hh"
+#include "testIndelLoader.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestIndelLoader, registryName("TestIndelLoader"));
+
+void TestIndelLoader::setUp()
+{
+    tempDirectory_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(tempDirectory_);
+    vcfPath_ = tempDirectory_ / "known.vcf";
+
+    std::ofstream vcf(vcfPath_.c_str());
+    vcf << "##fileformat=VCFv4.1\n"
+        "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\n"
+        "chr2\t500\t.\tA\tAC\t.\tPASS\t.\n"
+        "chr1\t300\t.\tACGTACGTAC\tA\t.\tPASS\t.\n"
+        "chr1\t100\t.\tAC\tA\t.\tPASS\t.\n"
+        "chr1\t200\t.\tA\tAGG,AT\t.\tPASS\t.\n"
+        "chrX\t100\t.\tAC\tA\t.\tPASS\t.\n";
+
+    reference::SortedReferenceMetadata sortedReferenceMetadata;
+    sortedReferenceMetadata.putContig(0, "chr1", "chr1.fa", 0, 1000, 1000, 1000, 0, "", "", "");
+    sortedReferenceMetadata.putContig(1000, "chr2", "chr2.fa", 0, 1000, 1000, 1000, 1, "", "", "");
+    sortedReferenceMetadataList_.assign(1, sortedReferenceMetadata);
+}
+
+void TestIndelLoader::tearDown()
+{
+    boost::filesystem::remove_all(tempDirectory_);
+}
+
+static std::string binGaps(const KnownIndels &knownIndels, const ReferencePosition binStart, const ReferencePosition binEnd)
+{
+    gapRealigner::Gaps gaps;
+    knownIndels.appendBinGaps(binStart, binEnd, gaps);
+    std::ostringstream os;
+    BOOST_FOREACH(const gapRealigner::Gap &gap, gaps)
+    {
+        os << gap.getBeginPos().getContigId() << ":" << gap.getBeginPos().getPosition() << "," << gap.length_ << " ";
+    }
+    return os.str();
+}
+
+static void checkGaps(const KnownIndels &knownIndels)
+{
+    CPPUNIT_ASSERT_EQUAL(5UL, knownIndels.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("0:100,1 0:200,-2 0:200,-1 0:300,9 1:500,-1 "),
+                         binGaps(knownIndels, ReferencePosition(0, 0), ReferencePosition(ReferencePosition::NoMatch)));
+    // deletion that begins before the bin but ends inside it
+    CPPUNIT_ASSERT_EQUAL(std::string("0:300,9 "),
+                         binGaps(knownIndels, ReferencePosition(0, 305), ReferencePosition(0, 400)));
+    CPPUNIT_ASSERT_EQUAL(std::string("0:200,-2 0:200,-1 "),
+                         binGaps(knownIndels, ReferencePosition(0, 150), ReferencePosition(0, 250)));
+    CPPUNIT_ASSERT_EQUAL(std::string("0:300,9 1:500,-1 "),
+                         binGaps(knownIndels, ReferencePosition(0, 250), ReferencePosition(1, 600)));
+    CPPUNIT_ASSERT_EQUAL(std::string(""),
+                         binGaps(knownIndels, ReferencePosition(1, 501), ReferencePosition(1, 1000)));
+    CPPUNIT_ASSERT_EQUAL(std::string(""),
+                         binGaps(knownIndels, ReferencePosition(ReferencePosition::NoMatch),
+                                 ReferencePosition(ReferencePosition::NoMatch)));
+}
+
+void TestIndelLoader::testBinGaps()
+{
+    KnownIndels knownIndels(vcfPath_, sortedReferenceMetadataList_);
+    checkGaps(knownIndels);
+
+    KnownIndels noIndels("", sortedReferenceMetadataList_);
+    CPPUNIT_ASSERT_EQUAL(0UL, noIndels.size());
+    CPPUNIT_ASSERT_EQUAL(std::string(""),
+                         binGaps(noIndels, ReferencePosition(0, 0), ReferencePosition(ReferencePosition::NoMatch)));
+}
+
+void TestIndelLoader::testCacheReuse()
+{
+    const boost::filesystem::path cachePath = KnownIndels::getCachePath(vcfPath_);
+    {
+        KnownIndels knownIndels(vcfPath_, sortedReferenceMetadataList_);
+    }
+    CPPUNIT_ASSERT(boost::filesystem::exists(cachePath));
+
+    // the vcf must not be parsed again
+    const std::time_t cacheTime = boost::filesystem::last_write_time(cachePath);
+    const std::time_t vcfTime = boost::filesystem::last_write_time(vcfPath_);
+    boost::filesystem::rename(vcfPath_, tempDirectory_ / "moved.vcf");
+    {
+        std::ofstream vcf(vcfPath_.c_str());
+        vcf << std::string(boost::filesystem::file_size(tempDirectory_ / "moved.vcf"), '#');
+    }
+    boost::filesystem::last_write_time(vcfPath_, vcfTime);
+    KnownIndels knownIndels(vcfPath_, sortedReferenceMetadataList_);
+    checkGaps(knownIndels);
+    CPPUNIT_ASSERT_EQUAL(cacheTime, boost::filesystem::last_write_time(cachePath));
+}
+
+void TestIndelLoader::testDamagedCache()
+{
+    const boost::filesystem::path cachePath = KnownIndels::getCachePath(vcfPath_);
+    {
+        KnownIndels knownIndels(vcfPath_, sortedReferenceMetadataList_);
+    }
+    {
+        std::fstream cache(cachePath.c_str(), std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+        // the contig table follows the header
+        cache.seekp(sizeof(knownIndels::CacheHeader) + offsetof(knownIndels::CachedContig, end_));
+        cache.put(0x7f);
+    }
+    KnownIndels knownIndels(vcfPath_, sortedReferenceMetadataList_);
+    checkGaps(knownIndels);
+}
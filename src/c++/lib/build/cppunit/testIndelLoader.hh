@@ -0,0 +1,43 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_BUILD_TEST_INDEL_LOADER_HH
+#define iSAAC_BUILD_TEST_INDEL_LOADER_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <boost/filesystem.hpp>
+
+#include "reference/SortedReferenceMetadata.hh"
+
+class TestIndelLoader : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestIndelLoader );
+    CPPUNIT_TEST( testBinGaps );
+    CPPUNIT_TEST( testCacheReuse );
+    CPPUNIT_TEST( testDamagedCache );
+    CPPUNIT_TEST_SUITE_END();
+private:
+    boost::filesystem::path tempDirectory_;
+    boost::filesystem::path vcfPath_;
+    isaac::reference::SortedReferenceMetadataList sortedReferenceMetadataList_;
+
+public:
+    void setUp();
+    void tearDown();
+    void testBinGaps();
+    void testCacheReuse();
+    void testDamagedCache();
+};
+
+#endif // #ifndef iSAAC_BUILD_TEST_INDEL_LOADER_HH
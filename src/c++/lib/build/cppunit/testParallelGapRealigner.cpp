@@ -0,0 +1,261 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <fstream>
+#include <string>
+#include <boost/foreach.hpp>
+#include <boost/thread.hpp>
+
+#include "build/ParallelGapRealigner.hh"
+
+using namespace std;
+using namespace isaac;
+using isaac::reference::ReferencePosition;
+
+#include "BuilderInit.hh"
+#include "RegistryName.hh"
+#include "testParallelGapRealigner.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestParallelGapRealigner, registryName("TestParallelGapRealigner"));
+
+static const unsigned READ_LENGTH = 100;
+// enough for each thread to get several batches of reads
+static const unsigned PAIRS_COUNT = 3000;
+static const unsigned CONTIG_LENGTH = 1000;
+static const unsigned GAPS_PER_READ = 4;
+static const unsigned GAP_SPACING = 15;
+// first reads start in [READ1_POS, READ1_POS + POS_RANGE), second ones in [READ2_POS, READ2_POS + POS_RANGE)
+static const unsigned READ1_POS = 100;
+static const unsigned READ2_POS = 500;
+static const unsigned POS_RANGE = 10;
+static const unsigned THREADS_COUNT = 4;
+
+void TestParallelGapRealigner::setUp()
+{
+    tempDirectory_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(tempDirectory_);
+    binPath_ = tempDirectory_ / "bin.dat";
+    std::ofstream bin(binPath_.c_str());
+}
+
+void TestParallelGapRealigner::tearDown()
+{
+    boost::filesystem::remove_all(tempDirectory_);
+}
+
+/**
+ * \brief Single-base deletions GAP_SPACING apart, far enough from the ends of all reads for them to be
+ *        worth introducing
+ */
+static std::vector<unsigned> getDeletions(const unsigned readsPos)
+{
+    std::vector<unsigned> ret;
+    for (unsigned gap = 0; GAPS_PER_READ != gap; ++gap)
+    {
+        ret.push_back(readsPos + POS_RANGE * 2 + GAP_SPACING * gap);
+    }
+    return ret;
+}
+
+static std::string getRead(const std::string &contig, const unsigned pos, const std::vector<unsigned> &deletions)
+{
+    std::string ret;
+    for (unsigned refPos = pos; READ_LENGTH != ret.size(); ++refPos)
+    {
+        if (deletions.end() == std::find(deletions.begin(), deletions.end(), refPos))
+        {
+            ret.push_back(contig.at(refPos));
+        }
+    }
+    return ret;
+}
+
+static void appendFragment(
+    const std::string &contig, const std::string &read, const unsigned pos, const unsigned matePos,
+    const bool secondRead, const uint64_t clusterId, std::vector<char> &data)
+{
+    alignment::Cigar cigar(1);
+    cigar.addOperation(READ_LENGTH, alignment::Cigar::ALIGN);
+
+    io::FragmentHeader header;
+    header.flags_ = io::FragmentHeader::Flags(
+        true, false, false, secondRead, !secondRead, secondRead, false, true, false, false, false);
+    header.fStrandPosition_ = ReferencePosition(0, pos);
+    header.fStrandOriginalPosition_ = header.fStrandPosition_;
+    header.rStrandPosition_ = header.fStrandPosition_ + READ_LENGTH - 1;
+    header.mateFStrandPosition_ = ReferencePosition(0, matePos);
+    const int tlen = std::max(pos, matePos) + READ_LENGTH - std::min(pos, matePos);
+    header.bamTlen_ = secondRead ? -tlen : tlen;
+    header.readLength_ = READ_LENGTH;
+    header.cigarLength_ = cigar.size();
+    header.alignmentScore_ = 60;
+    header.templateAlignmentScore_ = 120;
+    header.mapQ_ = 60;
+    header.barcode_ = 0;
+    header.clusterId_ = clusterId;
+    header.editDistance_ = std::inner_product(
+        read.begin(), read.end(), contig.begin() + pos, 0, std::plus<unsigned>(), std::not_equal_to<char>());
+
+    data.insert(data.end(), header.bytesBegin(), header.bytesEnd());
+    BOOST_FOREACH(const char base, read)
+    {
+        data.push_back((30 << 2) | oligo::getValue(base));
+    }
+    data.insert(data.end(),
+                reinterpret_cast<const char *>(&cigar.front()), reinterpret_cast<const char *>(&cigar.back() + 1));
+    data.push_back(0);
+}
+
+/**
+ * \brief All the first reads come before all the second ones in the index so that the two mates of a pair
+ *        are realigned by different threads
+ */
+static void realign(
+    const std::string &contig, const std::vector<char> &data,
+    const unsigned threadsCount, build::BinData &binData)
+{
+    binData.data_.resize(data.size());
+    std::copy(data.begin(), data.end(), binData.data_.begin());
+    std::vector<uint64_t> offsets;
+    for (uint64_t offset = 0; data.size() != offset; offset += binData.data_.getFragment(offset).getTotalLength())
+    {
+        offsets.push_back(offset);
+    }
+    for (unsigned readIndex = 0; 2 != readIndex; ++readIndex)
+    {
+        for (unsigned pair = 0; PAIRS_COUNT != pair; ++pair)
+        {
+            const uint64_t offset = offsets.at(pair * 2 + readIndex);
+            const io::FragmentAccessor &fragment = binData.data_.getFragment(offset);
+            binData.push_back(build::PackedFragmentBuffer::Index(
+                fragment.fStrandPosition_, offset, offsets.at(pair * 2 + !readIndex),
+                fragment.cigarBegin(), fragment.cigarEnd(), fragment.isReverse()));
+        }
+    }
+
+    BOOST_FOREACH(const unsigned readsPos, std::vector<unsigned>({READ1_POS, READ2_POS}))
+    {
+        BOOST_FOREACH(const unsigned deletion, getDeletions(readsPos))
+        {
+            binData.realignerGaps_.at(0).addGap(build::gapRealigner::Gap(ReferencePosition(0, deletion), 1));
+        }
+    }
+    binData.realignerGaps_.at(0).finalizeGaps();
+
+    flowcell::BarcodeMetadataList barcodeMetadataList(1);
+    barcodeMetadataList.at(0).setIndex(0);
+    barcodeMetadataList.at(0).setReferenceIndex(0);
+    const std::vector<alignment::TemplateLengthStatistics> barcodeTemplateLengthStatistics(
+        1, alignment::TemplateLengthStatistics(
+            300, 600, 500, 50, 50, alignment::TemplateLengthStatistics::FRp, alignment::TemplateLengthStatistics::RFm, -1));
+    reference::ContigLists contigLists;
+    contigLists.push_back(TestContigList(contig));
+
+    build::ParallelGapRealigner realigner(
+        threadsCount, false, false, GAPS_PER_READ, false, barcodeMetadataList, barcodeTemplateLengthStatistics, contigLists);
+    boost::mutex mutex;
+    boost::unique_lock<boost::mutex> lock(mutex);
+    boost::barrier started(threadsCount + 1);
+    build::BinData::iterator nextUnprocessed = binData.indexBegin();
+    boost::thread_group threads;
+    for (unsigned threadNumber = 0; threadsCount != threadNumber; ++threadNumber)
+    {
+        threads.create_thread(
+            [&, threadNumber]()
+            {
+                started.wait();
+                boost::unique_lock<boost::mutex> lock(mutex);
+                realigner.threadRealignGaps(lock, binData, nextUnprocessed, threadNumber);
+            });
+    }
+    started.wait();
+
+    // same as in Build, realignment must not allocate
+    common::ScopedMallocBlock block(common::ScopedMallocBlock::Strict);
+    lock.unlock();
+    threads.join_all();
+}
+
+void TestParallelGapRealigner::testConcurrentMates()
+{
+    srand(1);
+    const std::string contig = getContig("c1", CONTIG_LENGTH);
+
+    std::vector<char> data;
+    for (unsigned pair = 0; PAIRS_COUNT != pair; ++pair)
+    {
+        const unsigned pos1 = READ1_POS + pair % POS_RANGE;
+        const unsigned pos2 = READ2_POS + pair % POS_RANGE;
+        appendFragment(contig, getRead(contig, pos1, getDeletions(READ1_POS)), pos1, pos2, false, pair, data);
+        appendFragment(contig, getRead(contig, pos2, getDeletions(READ2_POS)), pos2, pos1, true, pair, data);
+    }
+
+    flowcell::BarcodeMetadataList barcodeMetadataList(1);
+    barcodeMetadataList.at(0).setIndex(0);
+    barcodeMetadataList.at(0).setReferenceIndex(0);
+    alignment::BinMetadata bin(barcodeMetadataList.size(), 0, ReferencePosition(0, 0), CONTIG_LENGTH, binPath_);
+    bin.incrementDataSize(ReferencePosition(0, 0), data.size());
+    bin.incrementFIdxElements(ReferencePosition(0, 0), PAIRS_COUNT, 0);
+    bin.incrementRIdxElements(ReferencePosition(0, 0), PAIRS_COUNT, 0);
+    bin.incrementCigarLength(ReferencePosition(0, 0), PAIRS_COUNT * 2, PAIRS_COUNT * 2 * READ_LENGTH, 0);
+
+    const demultiplexing::BarcodePathMap barcodeBamMapping;
+    const reference::SortedReferenceMetadataList sortedReferenceMetadataList;
+    const build::KnownIndels knownIndels((boost::filesystem::path()), sortedReferenceMetadataList);
+    const flowcell::TileMetadataList tileMetadataList;
+    const build::BuildContigMap contigMap(
+        barcodeMetadataList, alignment::BinMetadataCRefList(), sortedReferenceMetadataList, false);
+    const reference::ContigLists noContigLists;
+    const flowcell::FlowcellLayoutList flowcellLayoutList;
+    const build::IncludeTags includeTags(false, false, false, false, false, false, false, false);
+
+    // realigned by a single thread
+    build::BinData expected(
+        GAPS_PER_READ, barcodeBamMapping, barcodeMetadataList, build::REALIGN_ALL, 0, knownIndels, bin, 0,
+        tileMetadataList, contigMap, noContigLists, READ_LENGTH, 0, flowcellLayoutList, includeTags, false, 0, 0);
+    realign(contig, data, 1, expected);
+
+    build::BinData actual(
+        GAPS_PER_READ, barcodeBamMapping, barcodeMetadataList, build::REALIGN_ALL, 0, knownIndels, bin, 0,
+        tileMetadataList, contigMap, noContigLists, READ_LENGTH, 0, flowcellLayoutList, includeTags, false, 0, 0);
+    const alignment::Cigar::value_type *additionalCigarsBegin = actual.additionalCigars_.data();
+    realign(contig, data, THREADS_COUNT, actual);
+
+    // every read gets all of its gaps. The realigned CIGARs don't fit the thread arenas in one go
+    CPPUNIT_ASSERT_EQUAL(std::size_t(PAIRS_COUNT * 2 * (GAPS_PER_READ * 2 + 1)), actual.additionalCigars_.size());
+    CPPUNIT_ASSERT(additionalCigarsBegin == actual.additionalCigars_.data());
+    CPPUNIT_ASSERT_EQUAL(expected.additionalCigars_.size(), actual.additionalCigars_.size());
+
+    for (std::size_t i = 0; expected.size() != i; ++i)
+    {
+        const build::PackedFragmentBuffer::Index &index = actual.at(i);
+        CPPUNIT_ASSERT(&actual.additionalCigars_.front() <= index.cigarBegin_);
+        CPPUNIT_ASSERT(&actual.additionalCigars_.back() + 1 >= index.cigarEnd_);
+        CPPUNIT_ASSERT_EQUAL(expected.at(i).pos_, index.pos_);
+        CPPUNIT_ASSERT_EQUAL(alignment::Cigar::toString(expected.at(i).cigarBegin_, expected.at(i).cigarEnd_),
+                             alignment::Cigar::toString(index.cigarBegin_, index.cigarEnd_));
+
+        const io::FragmentAccessor &expectedFragment = expected.data_.getFragment(expected.at(i));
+        const io::FragmentAccessor &fragment = actual.data_.getFragment(index);
+        const io::FragmentAccessor &mate = actual.data_.getMate(index);
+        CPPUNIT_ASSERT(fragment.flags_.realigned_);
+        CPPUNIT_ASSERT_EQUAL(GAPS_PER_READ, unsigned(fragment.editDistance_));
+        CPPUNIT_ASSERT_EQUAL(index.pos_, fragment.fStrandPosition_);
+        CPPUNIT_ASSERT_EQUAL(index.pos_ + READ_LENGTH + GAPS_PER_READ - 1, fragment.rStrandPosition_);
+        CPPUNIT_ASSERT_EQUAL(fragment.fStrandPosition_, mate.mateFStrandPosition_);
+        CPPUNIT_ASSERT_EQUAL(mate.fStrandPosition_, fragment.mateFStrandPosition_);
+        CPPUNIT_ASSERT_EQUAL(-fragment.bamTlen_, mate.bamTlen_);
+        CPPUNIT_ASSERT_EQUAL(expectedFragment.bamTlen_, fragment.bamTlen_);
+        CPPUNIT_ASSERT_EQUAL(expectedFragment.flags_.properPair_, fragment.flags_.properPair_);
+    }
+}
@@ -0,0 +1,166 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file HaplotypeCache.cpp
+ **
+ ** Gap choices precomputed once per set of gaps and shared between the fragments
+ ** that overlap the same indel locus.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <boost/bind.hpp>
+
+#include "build/gapRealigner/ChooseKGapsFilter.hh"
+#include "build/gapRealigner/HaplotypeCache.hh"
+
+namespace isaac
+{
+namespace build
+{
+namespace gapRealigner
+{
+
+void HaplotypeLocus::reserve(const unsigned gapsMax, const unsigned gapsPerFragmentMax)
+{
+    // sum of C(gapsMax, k) and k * C(gapsMax, k) for all k the ChooseKGapsFilter enumerates
+    std::size_t combinations = 0;
+    std::size_t chosenGaps = 0;
+    std::size_t binomial = 1;
+    for (unsigned k = 1; k <= std::min(gapsMax, gapsPerFragmentMax); ++k)
+    {
+        binomial = binomial * (gapsMax - k + 1) / k;
+        combinations += binomial;
+        chosenGaps += binomial * k;
+    }
+
+    gaps_.reserve(gapsMax);
+    haplotypes_.reserve(combinations);
+    chosenGaps_.reserve(chosenGaps);
+    // at most two anchors per chosen gap
+    anchors_.reserve(chosenGaps * 2);
+}
+
+inline bool sameGap(const Gap &left, const Gap &right)
+{
+    return Gap::comparePositionAndLength(left, right) && left.priority_ == right.priority_;
+}
+
+bool HaplotypeLocus::matches(const reference::ReferencePosition binStartPos, const GapsRange &gaps) const
+{
+    return binStartPos_ == binStartPos && gaps_.size() == gaps.size() &&
+        std::equal(gaps.first, gaps.second, gaps_.begin(), &sameGap);
+}
+
+/**
+ * \brief Same walk as GapRealigner::findStartPos does, except that none of the insertions get clipped by
+ *        the read start.
+ */
+void HaplotypeLocus::addAnchor(
+    const GapChoiceBitmask choice,
+    const unsigned pivotGapIndex,
+    const reference::ReferencePosition pivotPos)
+{
+    HaplotypeAnchor anchor(pivotGapIndex, pivotPos);
+    reference::ReferencePosition overlapPos = pivotPos;
+    for (unsigned gapIndex = pivotGapIndex; gapIndex--;)
+    {
+        if (choice & (GapChoiceBitmask(1) << gapIndex))
+        {
+            const Gap &gap = gaps_.at(gapIndex);
+            if (gap.getEndPos(false) > overlapPos)
+            {
+                anchor.overlapping_ = true;
+                break;
+            }
+            if (gap.isInsertion())
+            {
+                anchor.insertedBases_ += gap.getLength();
+                anchor.shift_ += gap.getLength();
+            }
+            else
+            {
+                anchor.shift_ -= gap.getLength();
+                overlapPos = gap.getBeginPos();
+            }
+        }
+    }
+    anchors_.push_back(anchor);
+}
+
+void HaplotypeLocus::build(
+    const reference::ReferencePosition binStartPos,
+    const GapsRange &gaps,
+    const unsigned gapsPerFragmentMax)
+{
+    binStartPos_ = binStartPos;
+    gaps_.assign(gaps.first, gaps.second);
+    haplotypes_.clear();
+    chosenGaps_.clear();
+    anchors_.clear();
+
+    ChooseKGapsFilter<GapChoiceBitmask> gapsFilter(gaps, gapsPerFragmentMax);
+    // 0 means none of the gaps apply. It is not a haplotype.
+    for (GapChoiceBitmask choice = 0; (choice = gapsFilter.next(choice));)
+    {
+        Haplotype haplotype;
+        haplotype.choice_ = choice;
+        haplotype.gapsBegin_ = chosenGaps_.size();
+        haplotype.anchorsBegin_ = anchors_.size();
+        for (unsigned pivotGapIndex = 0; gaps_.size() != pivotGapIndex; ++pivotGapIndex)
+        {
+            if (choice & (GapChoiceBitmask(1) << pivotGapIndex))
+            {
+                const Gap &pivotGap = gaps_[pivotGapIndex];
+                chosenGaps_.push_back(pivotGap);
+                // anchoring occurs before pivot gap
+                if (pivotGap.getBeginPos() >= binStartPos)
+                {
+                    addAnchor(choice, pivotGapIndex, pivotGap.getBeginPos());
+                }
+                // anchoring occurs after pivot gap
+                addAnchor(choice, pivotGapIndex + 1, pivotGap.getEndPos(false));
+            }
+        }
+        haplotype.gapsEnd_ = chosenGaps_.size();
+        haplotype.anchorsEnd_ = anchors_.size();
+        haplotypes_.push_back(haplotype);
+    }
+}
+
+void HaplotypeCache::reserve()
+{
+    loci_.resize(LOCI_MAX);
+    std::for_each(loci_.begin(), loci_.end(),
+                  boost::bind(&HaplotypeLocus::reserve, _1, gapsPerLocusMax_, gapsPerFragmentMax_));
+}
+
+const HaplotypeLocus &HaplotypeCache::get(const reference::ReferencePosition binStartPos, const GapsRange &gaps)
+{
+    ISAAC_ASSERT_MSG(gaps.size() <= gapsPerLocusMax_, "Too many gaps for a haplotype locus: " << gaps.size());
+    std::vector<HaplotypeLocus>::const_iterator it =
+        std::find_if(loci_.begin(), loci_.end(), boost::bind(&HaplotypeLocus::matches, _1, binStartPos, gaps));
+    if (loci_.end() != it)
+    {
+        return *it;
+    }
+
+    ISAAC_ASSERT_MSG(!loci_.empty(), "HaplotypeCache::reserve must be called before use");
+    HaplotypeLocus &ret = loci_.at(nextToEvict_);
+    nextToEvict_ = (nextToEvict_ + 1) % loci_.size();
+    ret.build(binStartPos, gaps, gapsPerFragmentMax_);
+    return ret;
+}
+
+} // namespace gapRealigner
+} // namespace build
+} // namespace isaac
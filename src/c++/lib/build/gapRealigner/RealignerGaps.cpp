@@ -30,12 +30,16 @@ void RealignerGaps::reserve(const std::size_t gaps)
 {
     deletionEndGroups_.reserve(gaps);
     gapGroups_.reserve(gaps);
+    gapStartsTree_.reserve(gaps);
+    deletionEndsTree_.reserve(gaps);
 }
 
 void RealignerGaps::unreserve()
 {
     gapRealigner::Gaps().swap(gapGroups_);
     gapRealigner::Gaps().swap(deletionEndGroups_);
+    gapStartsTree_.unreserve();
+    deletionEndsTree_.unreserve();
 }
 
 
@@ -79,6 +83,8 @@ void RealignerGaps::finalizeGaps()
 {
     if (gapGroups_.empty())
     {
+        gapStartsTree_.clear();
+        deletionEndsTree_.clear();
         return;
     }
     std::sort(gapGroups_.begin(), gapGroups_.end(), orderByGapStartAndTypeLength);
@@ -105,6 +111,11 @@ void RealignerGaps::finalizeGaps()
     std::remove_copy_if(gapGroups_.begin(), gapGroups_.end(), std::back_inserter(deletionEndGroups_),
                         !boost::bind(&gapRealigner::Gap::isDeletion, _1));
     std::sort(deletionEndGroups_.begin(), deletionEndGroups_.end(), orderByDeletionGapEnd);
+
+    gapStartsTree_.build(gapGroups_.begin(), gapGroups_.end(),
+                         [](const gapRealigner::Gap &gap){return gap.getBeginPos().getValue();});
+    deletionEndsTree_.build(deletionEndGroups_.begin(), deletionEndGroups_.end(),
+                            [](const gapRealigner::Gap &gap){return gap.getDeletionEndPos().getValue();});
 }
 
 gapRealigner::GapsRange RealignerGaps::allGaps() const
@@ -129,18 +140,19 @@ gapRealigner::GapsRange RealignerGaps::findGaps(
     gapRealigner::GapsRange gapStarts;
 //    ISAAC_THREAD_CERR_DEV_TRACE("findGaps all gaps: " << gapRealigner::GapsRange(sampleGaps.begin(), sampleGaps.end()));
     // the first one that begins on or after the rangeBegin
-    gapStarts.first = std::lower_bound(gapGroups_.begin(), gapGroups_.end(),
-                                 gapRealigner::Gap(rangeBegin, -1000000), orderByGapStartAndTypeLength);
-    // the first one that ends on or after the rangeEnd
-    gapStarts.second = std::lower_bound(gapStarts.first, gapGroups_.end(), gapRealigner::Gap(rangeEnd, 0), orderByGapStartAndTypeLength);
+    gapStarts.first = gapGroups_.begin() + gapStartsTree_.lowerBound(rangeBegin.getValue());
+    // the first one that begins after the rangeEnd or is a deletion that begins at rangeEnd.
+    // Insertions at rangeEnd are ordered before deletions at rangeEnd
+    gapStarts.second = std::max(gapStarts.first, gapGroups_.begin() + gapStartsTree_.lowerBound(rangeEnd.getValue()));
+    while (gapGroups_.end() != gapStarts.second && rangeEnd == gapStarts.second->getBeginPos() && gapStarts.second->isInsertion())
+    {
+        ++gapStarts.second;
+    }
 
     gapRealigner::GapsRange gapEnds;
-    gapEnds.first = std::lower_bound(deletionEndGroups_.begin(), deletionEndGroups_.end(),
-                                     // gap length 1 is simply to prevent orderByDeletionGapEnd for failing an assertion
-                                     gapRealigner::Gap(rangeBegin, 1), orderByDeletionGapEnd);
-    gapEnds.second = std::lower_bound(gapEnds.first, deletionEndGroups_.end(),
-                                      // gap length 1 is simply to prevent orderByDeletionGapEnd for failing an assertion
-                                      gapRealigner::Gap(rangeEnd, 1), orderByDeletionGapEnd);
+    // deletions that end after rangeBegin and up to rangeEnd inclusive
+    gapEnds.first = deletionEndGroups_.begin() + deletionEndsTree_.lowerBound((rangeBegin + 1).getValue());
+    gapEnds.second = std::max(gapEnds.first, deletionEndGroups_.begin() + deletionEndsTree_.lowerBound((rangeEnd + 1).getValue()));
 
     if (foundGaps.capacity() < gapStarts.size() + gapEnds.size())
     {
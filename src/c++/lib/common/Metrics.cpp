@@ -0,0 +1,205 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file Metrics.cpp
+ **
+ ** Per-thread work counters and per-stage timing of the workflow.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <boost/foreach.hpp>
+#include <boost/thread.hpp>
+
+#include "common/Debug.hh"
+#include "common/Exceptions.hh"
+#include "common/Metrics.hh"
+
+namespace isaac
+{
+namespace common
+{
+namespace metrics
+{
+
+// one cache line per thread so that the threads don't invalidate each other's counters
+static const std::size_t THREAD_COUNTERS_ALIGNMENT = 64;
+
+iSAAC_THREAD_LOCAL ThreadCounters *threadCounters_ = 0;
+
+// enough for the thread pools of all stages of a run. More threads are fine as long as they register
+// while the dynamic memory allocations are allowed
+static const std::size_t REGISTRY_RESERVE = 4096;
+
+static boost::mutex registryMutex_;
+// threads come and go, the counters they have accumulated stay
+static std::vector<ThreadCounters *> registry_;
+
+static uint64_t expected_[CountersCount];
+
+const char *getCounterName(const Counter counter)
+{
+    switch (counter)
+    {
+    case BytesLoaded:
+        return "bytesLoaded";
+    case TilesAligned:
+        return "tilesAligned";
+    case ClustersAligned:
+        return "clustersAligned";
+    case SeedsLookedUp:
+        return "seedsLookedUp";
+    case SmithWatermanCalls:
+        return "smithWatermanCalls";
+    case BinsSorted:
+        return "binsSorted";
+    case BgzfBytesCompressed:
+        return "bgzfBytesCompressed";
+    case TempBytesWritten:
+        return "tempBytesWritten";
+    default:
+        ISAAC_ASSERT_MSG(false, "Unknown counter " << counter);
+        return 0;
+    }
+}
+
+void registerThread()
+{
+    if (threadCounters_)
+    {
+        return;
+    }
+    void *memory = 0;
+    const int error = posix_memalign(&memory, THREAD_COUNTERS_ALIGNMENT, sizeof(ThreadCounters));
+    if (error)
+    {
+        BOOST_THROW_EXCEPTION(common::MemoryException("Failed to allocate thread counters"));
+    }
+    ThreadCounters *counters = static_cast<ThreadCounters *>(memory);
+    memset(counters, 0, sizeof(*counters));
+
+    boost::lock_guard<boost::mutex> lock(registryMutex_);
+    registry_.push_back(counters);
+    threadCounters_ = counters;
+}
+
+/**
+ * \brief Reserves the registry and registers the main thread before main() gets a chance to block
+ *        the allocations
+ */
+static struct MainThreadRegistration
+{
+    MainThreadRegistration()
+    {
+        registry_.reserve(REGISTRY_RESERVE);
+        registerThread();
+    }
+} mainThreadRegistration_;
+
+CounterValues snapshot()
+{
+    CounterValues ret;
+    ret.assign(0);
+    boost::lock_guard<boost::mutex> lock(registryMutex_);
+    BOOST_FOREACH(const ThreadCounters *counters, registry_)
+    {
+        for (unsigned counter = 0; CountersCount != counter; ++counter)
+        {
+            ret[counter] += __atomic_load_n(&counters->values_[counter], __ATOMIC_RELAXED);
+        }
+    }
+    return ret;
+}
+
+void addExpected(const Counter counter, const uint64_t value)
+{
+    __atomic_fetch_add(&expected_[counter], value, __ATOMIC_RELAXED);
+}
+
+CounterValues expected()
+{
+    CounterValues ret;
+    for (unsigned counter = 0; CountersCount != counter; ++counter)
+    {
+        ret[counter] = __atomic_load_n(&expected_[counter], __ATOMIC_RELAXED);
+    }
+    return ret;
+}
+
+void StageLog::begin(const std::string &stageName)
+{
+    ISAAC_ASSERT_MSG(currentName_.empty(), "Stage " << currentName_ << " has not ended before " << stageName);
+    currentName_ = stageName;
+    currentCounters_ = snapshot();
+    currentStart_ = std::chrono::steady_clock::now();
+}
+
+void StageLog::end()
+{
+    ISAAC_ASSERT_MSG(!currentName_.empty(), "No stage to end");
+    Stage stage;
+    stage.name_ = currentName_;
+    stage.seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - currentStart_).count();
+    stage.counters_ = snapshot();
+    for (unsigned counter = 0; CountersCount != counter; ++counter)
+    {
+        stage.counters_[counter] -= currentCounters_[counter];
+    }
+    stage.processPeakRssBytes_ = getPeakResidentSetSize();
+    stages_.push_back(stage);
+    currentName_.clear();
+}
+
+void StageLog::serialize(std::ostream &os) const
+{
+    os << "{\n  \"stages\": [";
+    bool firstStage = true;
+    BOOST_FOREACH(const Stage &stage, stages_)
+    {
+        os << (firstStage ? "" : ",") << "\n    {\n      \"name\": \"" << stage.name_ << "\",\n"
+            "      \"seconds\": " << stage.seconds_ << ",\n"
+            "      \"processPeakRssBytes\": " << stage.processPeakRssBytes_ << ",\n      \"counters\": {";
+        for (unsigned counter = 0; CountersCount != counter; ++counter)
+        {
+            os << (counter ? ", " : "") << "\"" << getCounterName(Counter(counter)) << "\": " << stage.counters_[counter];
+        }
+        os << "},\n      \"perSecond\": {";
+        for (unsigned counter = 0; CountersCount != counter; ++counter)
+        {
+            os << (counter ? ", " : "") << "\"" << getCounterName(Counter(counter)) << "\": " <<
+                (stage.seconds_ ? stage.counters_[counter] / stage.seconds_ : 0.0);
+        }
+        os << "}\n    }";
+        firstStage = false;
+    }
+    os << "\n  ]\n}\n";
+}
+
+void StageLog::dumpJson(const boost::filesystem::path &jsonPath) const
+{
+    std::ofstream os(jsonPath.string().c_str());
+    if (!os) {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "ERROR: Unable to open file for writing: " + jsonPath.string()));
+    }
+    serialize(os);
+    if (!os) {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "ERROR: Unable to write file: " + jsonPath.string()));
+    }
+}
+
+} // namespace metrics
+} // namespace common
+} // namespace isaac
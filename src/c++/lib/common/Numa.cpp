@@ -106,6 +106,18 @@ void numaDeallocate(void * p, std::size_t size, const int node)
     ::operator delete(p);
 }
 
+void numaInterleave(void *p, std::size_t size)
+{
+    if (!isNumaAvailable())
+    {
+        return;
+    }
+
+#ifdef HAVE_NUMA
+    numa_interleave_memory(p, size, numa_all_nodes_ptr);
+#endif //HAVE_NUMA
+}
+
 } // namespace numa
 
 
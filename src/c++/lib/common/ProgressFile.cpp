@@ -0,0 +1,213 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file ProgressFile.cpp
+ **
+ ** Periodically rewritten json summary of the workflow progress for the job schedulers to poll.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "common/Debug.hh"
+#include "common/ProgressFile.hh"
+#include "common/SystemCompatibility.hh"
+#include "common/Threads.hpp"
+
+namespace isaac
+{
+namespace common
+{
+namespace metrics
+{
+
+ProgressFile::ProgressFile(const boost::filesystem::path &path, const unsigned intervalSeconds) :
+    path_(path.string()),
+    tempPath_(path_ + ".tmp"),
+    interval_(intervalSeconds),
+    finished_(!intervalSeconds),
+    start_(std::chrono::steady_clock::now()),
+    stageName_(""),
+    stageStart_(start_),
+    stageCounters_(snapshot()),
+    lastUpdate_(start_),
+    lastCounters_(stageCounters_)
+{
+    if (!finished_)
+    {
+        thread_ = boost::thread(&ProgressFile::run, this);
+    }
+}
+
+ProgressFile::~ProgressFile()
+{
+    try
+    {
+        finish();
+    }
+    catch (...)
+    {
+        // progress reporting must not bring the process down
+    }
+}
+
+void ProgressFile::beginStage(const char *stageName)
+{
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    stageName_ = stageName;
+    stageStart_ = std::chrono::steady_clock::now();
+    stageCounters_ = snapshot();
+}
+
+void ProgressFile::finish()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        if (finished_)
+        {
+            return;
+        }
+        finished_ = true;
+    }
+    stateChangedCondition_.notify_all();
+    thread_.join();
+    char buffer[BUFFER_SIZE];
+    std::size_t length = 0;
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        length = update(std::chrono::steady_clock::now(), buffer);
+    }
+    write(buffer, length);
+}
+
+void ProgressFile::run()
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    while (!finished_)
+    {
+        if (!stateChangedCondition_.wait_for(
+            lock, boost::chrono::seconds(interval_.count()), [this]{return finished_;}))
+        {
+            char buffer[BUFFER_SIZE];
+            const std::size_t length = update(std::chrono::steady_clock::now(), buffer);
+            // beginStage must not wait for the file system
+            common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
+            // not worth failing the alignment over, nor logging as that allocates. Next interval will try again
+            write(buffer, length);
+        }
+    }
+}
+
+static double seconds(const std::chrono::steady_clock::duration &duration)
+{
+    return std::chrono::duration<double>(duration).count();
+}
+
+std::size_t ProgressFile::format(
+    const std::chrono::steady_clock::time_point now,
+    const CounterValues &counters,
+    char *buffer) const
+{
+    const CounterValues totals = expected();
+    const double sinceLastUpdate = seconds(now - lastUpdate_);
+    const double sinceStageStart = seconds(now - stageStart_);
+
+    // ETA is extrapolated from the stage rate of the first counter that has both work left and progress made
+    double eta = -1.0;
+    static const Counter etaCounters[] = {ClustersAligned, BinsSorted};
+    for (const Counter counter : etaCounters)
+    {
+        const uint64_t progressed = counters[counter] - stageCounters_[counter];
+        if (totals[counter] > counters[counter] && progressed && sinceStageStart)
+        {
+            eta = (totals[counter] - counters[counter]) * sinceStageStart / progressed;
+            break;
+        }
+    }
+
+    char etaText[32] = "null";
+    if (0.0 <= eta)
+    {
+        snprintf(etaText, sizeof(etaText), "%.0f", eta);
+    }
+
+    std::size_t length = snprintf(
+        buffer, BUFFER_SIZE,
+        "{\n"
+        "  \"stage\": \"%s\",\n"
+        "  \"finished\": %s,\n"
+        "  \"elapsedSeconds\": %.0f,\n"
+        "  \"stageElapsedSeconds\": %.0f,\n"
+        "  \"tiles\": {\"done\": %lu, \"total\": %lu},\n"
+        "  \"clusters\": {\"done\": %lu, \"total\": %lu},\n"
+        "  \"bins\": {\"done\": %lu, \"total\": %lu},\n"
+        "  \"etaSeconds\": %s,\n"
+        "  \"residentSetBytes\": %lu,\n"
+        "  \"peakResidentSetBytes\": %lu,\n"
+        "  \"tempBytesWritten\": %lu,\n"
+        "  \"perSecond\": {",
+        stageName_, finished_ ? "true" : "false",
+        seconds(now - start_), sinceStageStart,
+        (unsigned long)counters[TilesAligned], (unsigned long)totals[TilesAligned],
+        (unsigned long)counters[ClustersAligned], (unsigned long)totals[ClustersAligned],
+        (unsigned long)counters[BinsSorted], (unsigned long)totals[BinsSorted],
+        etaText,
+        (unsigned long)getResidentSetSize(), (unsigned long)getPeakResidentSetSize(),
+        (unsigned long)counters[TempBytesWritten]);
+
+    for (unsigned counter = 0; CountersCount != counter && BUFFER_SIZE > length; ++counter)
+    {
+        length += snprintf(
+            buffer + length, BUFFER_SIZE - length, "%s\"%s\": %.1f",
+            counter ? ", " : "", getCounterName(Counter(counter)),
+            sinceLastUpdate ? (counters[counter] - lastCounters_[counter]) / sinceLastUpdate : 0.0);
+    }
+    if (BUFFER_SIZE > length)
+    {
+        length += snprintf(buffer + length, BUFFER_SIZE - length, "}\n}\n");
+    }
+    ISAAC_ASSERT_MSG(BUFFER_SIZE > length, "Progress document does not fit the buffer: " << length);
+    return length;
+}
+
+std::size_t ProgressFile::update(const std::chrono::steady_clock::time_point now, char *buffer)
+{
+    const CounterValues counters = snapshot();
+    const std::size_t length = format(now, counters, buffer);
+    lastUpdate_ = now;
+    lastCounters_ = counters;
+    return length;
+}
+
+bool ProgressFile::write(const char *buffer, const std::size_t length) const
+{
+    // This runs while the dynamic memory allocations are blocked, so stack buffer and plain io only
+    const int fd = ::open(tempPath_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (-1 == fd)
+    {
+        return false;
+    }
+    const bool written = ssize_t(length) == ::write(fd, buffer, length);
+    if (::close(fd) || !written)
+    {
+        return false;
+    }
+    // readers see either the previous or the new document, never a partial one
+    return !::rename(tempPath_.c_str(), path_.c_str());
+}
+
+} // namespace metrics
+} // namespace common
+} // namespace isaac
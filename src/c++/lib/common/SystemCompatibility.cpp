@@ -130,6 +130,7 @@ int linuxFtruncate(int fd, std::size_t len)
 #ifdef _WIN32
 
 #include <windows.h>
+#include <psapi.h>
 
 namespace isaac
 {
@@ -198,6 +199,26 @@ uint64_t getFileSize(const PathCharType* filePath)
 	return buffer.st_size;
 }
 
+uint64_t getPeakResidentSetSize()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+	return counters.PeakWorkingSetSize;
+}
+
+uint64_t getResidentSetSize()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+	return counters.WorkingSetSize;
+}
+
 boost::filesystem::path getModuleFileName()
 {
 	const DWORD bufsize = 10240;
@@ -311,7 +332,9 @@ int shmdt(const void *shmaddr)
 
 #else
 
+#include <cstdlib>
 #include <sys/resource.h>
+#include <unistd.h>
 
 namespace isaac
 {
@@ -381,6 +404,39 @@ uint64_t getFileSize(const PathCharType *filePath)
 #endif
 }
 
+uint64_t getPeakResidentSetSize()
+{
+    struct rusage usage;
+    if (0 != getrusage(RUSAGE_SELF, &usage))
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to get resource usage"));
+    }
+    // linux reports kilobytes
+    return uint64_t(usage.ru_maxrss) * 1024;
+}
+
+uint64_t getResidentSetSize()
+{
+    // plain io as this gets called while dynamic memory allocations are blocked
+    const int fd = ::open("/proc/self/statm", O_RDONLY);
+    if (-1 == fd)
+    {
+        return 0;
+    }
+    char buffer[128];
+    const ssize_t bytes = ::read(fd, buffer, sizeof(buffer) - 1);
+    ::close(fd);
+    if (0 >= bytes)
+    {
+        return 0;
+    }
+    buffer[bytes] = 0;
+    // second field is the number of resident pages
+    char *end = 0;
+    strtoull(buffer, &end, 10);
+    return strtoull(end, 0, 10) * sysconf(_SC_PAGESIZE);
+}
+
 boost::filesystem::path getModuleFileName()
 {
     char szBuffer[10240];
@@ -0,0 +1,144 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+
+#include "common/Debug.hh"
+#include "common/Metrics.hh"
+#include "common/ProgressFile.hh"
+
+using namespace std;
+using namespace isaac::common;
+
+#include "RegistryName.hh"
+#include "testMetrics.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestMetrics, registryName("Metrics"));
+
+void TestMetrics::setUp()
+{
+}
+
+void TestMetrics::tearDown()
+{
+}
+
+static void countSeeds(const unsigned times)
+{
+    metrics::registerThread();
+    for (unsigned i = 0; times != i; ++i)
+    {
+        metrics::add(metrics::SeedsLookedUp, 1);
+    }
+}
+
+void TestMetrics::testThreadCounters()
+{
+    const metrics::CounterValues before = metrics::snapshot();
+    boost::thread_group threads;
+    for (unsigned i = 0; 4 != i; ++i)
+    {
+        threads.create_thread(boost::bind(&countSeeds, 1000));
+    }
+    threads.join_all();
+    metrics::add(metrics::BytesLoaded, 123);
+
+    const metrics::CounterValues after = metrics::snapshot();
+    CPPUNIT_ASSERT_EQUAL(4000UL, after[metrics::SeedsLookedUp] - before[metrics::SeedsLookedUp]);
+    CPPUNIT_ASSERT_EQUAL(123UL, after[metrics::BytesLoaded] - before[metrics::BytesLoaded]);
+    CPPUNIT_ASSERT_EQUAL(before[metrics::BinsSorted], after[metrics::BinsSorted]);
+}
+
+static void countSeedsWithMallocBlocked(const unsigned times)
+{
+    metrics::registerThread();
+    ScopedMallocBlock block(ScopedMallocBlock::Strict);
+    for (unsigned i = 0; times != i; ++i)
+    {
+        metrics::add(metrics::SeedsLookedUp, 1);
+    }
+}
+
+void TestMetrics::testMallocBlocked()
+{
+    const metrics::CounterValues before = metrics::snapshot();
+    boost::thread thread(boost::bind(&countSeedsWithMallocBlocked, 1000));
+    thread.join();
+    const metrics::CounterValues after = metrics::snapshot();
+    CPPUNIT_ASSERT_EQUAL(1000UL, after[metrics::SeedsLookedUp] - before[metrics::SeedsLookedUp]);
+}
+
+void TestMetrics::testStageLog()
+{
+    metrics::StageLog stageLog;
+    stageLog.begin("AlignDone");
+    metrics::add(metrics::ClustersAligned, 10);
+    stageLog.end();
+    stageLog.begin("BamDone");
+    metrics::add(metrics::BinsSorted, 2);
+    stageLog.end();
+
+    std::ostringstream os;
+    stageLog.serialize(os);
+    const std::string json = os.str();
+    CPPUNIT_ASSERT(std::string::npos != json.find("\"name\": \"AlignDone\""));
+    CPPUNIT_ASSERT(std::string::npos != json.find("\"clustersAligned\": 10, \"seedsLookedUp\": 0"));
+    CPPUNIT_ASSERT(std::string::npos != json.find("\"name\": \"BamDone\""));
+    CPPUNIT_ASSERT(std::string::npos != json.find("\"binsSorted\": 2"));
+    CPPUNIT_ASSERT(std::string::npos != json.find("\"processPeakRssBytes\": "));
+    CPPUNIT_ASSERT(json.find("\"clustersAligned\": 10") == json.rfind("\"clustersAligned\": 10"));
+}
+
+void TestMetrics::testProgressFile()
+{
+    const boost::filesystem::path path =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("testProgressFile-%%%%-%%%%.json");
+
+    const metrics::CounterValues expectedBefore = metrics::expected();
+    const metrics::CounterValues before = metrics::snapshot();
+    {
+        metrics::ProgressFile progressFile(path, 1);
+        progressFile.beginStage("BamDone");
+        metrics::addExpected(metrics::BinsSorted, 4);
+        metrics::add(metrics::BinsSorted, 1);
+        progressFile.finish();
+        CPPUNIT_ASSERT(!boost::filesystem::exists(path.string() + ".tmp"));
+    }
+
+    std::ifstream is(path.string().c_str());
+    const std::string json((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    boost::filesystem::remove(path);
+
+    std::ostringstream bins;
+    bins << "\"bins\": {\"done\": " << before[metrics::BinsSorted] + 1 <<
+        ", \"total\": " << expectedBefore[metrics::BinsSorted] + 4 << "}";
+    CPPUNIT_ASSERT(std::string::npos != json.find("\"stage\": \"BamDone\""));
+    CPPUNIT_ASSERT(std::string::npos != json.find("\"finished\": true"));
+    CPPUNIT_ASSERT(std::string::npos != json.find(bins.str()));
+    CPPUNIT_ASSERT(std::string::npos != json.find("\"residentSetBytes\": "));
+    CPPUNIT_ASSERT(std::string::npos != json.find("\"perSecond\": {\"bytesLoaded\": "));
+    CPPUNIT_ASSERT_EQUAL('\n', json.at(json.size() - 1));
+
+    // disabled progress file does not write anything
+    {
+        metrics::ProgressFile progressFile(path, 0);
+    }
+    CPPUNIT_ASSERT(!boost::filesystem::exists(path));
+}
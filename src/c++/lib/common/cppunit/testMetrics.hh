@@ -0,0 +1,37 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_COMMON_TEST_METRICS_HH
+#define iSAAC_COMMON_TEST_METRICS_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class TestMetrics : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestMetrics );
+    CPPUNIT_TEST( testThreadCounters );
+    CPPUNIT_TEST( testMallocBlocked );
+    CPPUNIT_TEST( testStageLog );
+    CPPUNIT_TEST( testProgressFile );
+    CPPUNIT_TEST_SUITE_END();
+private:
+public:
+    void setUp();
+    void tearDown();
+    void testThreadCounters();
+    void testMallocBlocked();
+    void testStageLog();
+    void testProgressFile();
+};
+
+#endif // #ifndef iSAAC_COMMON_TEST_METRICS_HH
@@ -58,12 +58,6 @@ bool isSequenceBarcodeEqual(const flowcell::BarcodeMetadataList &allBarcodeMetad
     return true;
 }
 
-
-bool orderBySequence(const Barcode &left, const Barcode &right)
-{
-    return left.getSequence() < right.getSequence();
-}
-
 /**
  * \return Number of single-mismatch variations for a kmer of kmerLength. Original kmer is included in the count.
  */
@@ -259,42 +253,118 @@ Barcodes BarcodeResolver::generateMismatches(
     return ret;
 }
 
+/**
+ * \brief Spreads barcode sequences over the table. Barcode kmers are short, so multiplicative
+ *        hashing is used to get the entropy into the higher bits
+ */
+inline std::size_t hashBarcodeSequence(const Kmer sequence, const std::size_t tableMask)
+{
+    return ((sequence * 0x9E3779B97F4A7C15UL) >> 32) & tableMask;
+}
+
+std::vector<unsigned> BarcodeResolver::buildMismatchIndex(const Barcodes &mismatchBarcodes)
+{
+    ISAAC_ASSERT_MSG(mismatchBarcodes.size() < std::numeric_limits<unsigned>::max(), "Too many mismatch barcodes: " << mismatchBarcodes.size());
+    // keep the load factor at or below 0.5
+    std::size_t tableSize = 2;
+    while (tableSize < mismatchBarcodes.size() * 2)
+    {
+        tableSize <<= 1;
+    }
+    std::vector<unsigned> ret(tableSize, 0);
+    const std::size_t tableMask = tableSize - 1;
+    for (Barcodes::const_iterator it = mismatchBarcodes.begin(); mismatchBarcodes.end() != it; ++it)
+    {
+        std::size_t slot = hashBarcodeSequence(it->getSequence(), tableMask);
+        while (ret[slot])
+        {
+            ISAAC_ASSERT_MSG(mismatchBarcodes.at(ret[slot] - 1).getSequence() != it->getSequence(),
+                             "Mismatch barcodes are expected to be unique: " << *it);
+            slot = (slot + 1) & tableMask;
+        }
+        ret[slot] = std::distance(mismatchBarcodes.begin(), it) + 1;
+    }
+    return ret;
+}
+
+std::size_t BarcodeResolver::findMismatchBarcode(
+    const Barcodes &mismatchBarcodes,
+    const std::vector<unsigned> &mismatchIndex,
+    const Kmer sequence)
+{
+    const std::size_t tableMask = mismatchIndex.size() - 1;
+    for (std::size_t slot = hashBarcodeSequence(sequence, tableMask); mismatchIndex[slot]; slot = (slot + 1) & tableMask)
+    {
+        const std::size_t offset = mismatchIndex[slot] - 1;
+        if (mismatchBarcodes[offset].getSequence() == sequence)
+        {
+            return offset;
+        }
+    }
+    return mismatchBarcodes.size();
+}
+
 BarcodeResolver::BarcodeResolver(
     const flowcell::BarcodeMetadataList &allBarcodeMetadata,
-    const flowcell::BarcodeMetadataList &barcodeGroup)
+    const flowcell::BarcodeMetadataList &barcodeGroup,
+    common::ThreadVector &threads,
+    const unsigned threadsMax)
     : allBarcodeMetadata_(allBarcodeMetadata)
     , mismatchBarcodes_(generateMismatches(allBarcodeMetadata_, barcodeGroup))
+    , mismatchIndex_(buildMismatchIndex(mismatchBarcodes_))
     , unknownBarcodeIndex_(barcodeGroup.at(0).getIndex())
     , barcodeHits_(allBarcodeMetadata_.size())
+    , threads_(threads)
+    , threadStates_(std::max(1U, std::min<unsigned>(threadsMax, threads.size())))
 {
+    BOOST_FOREACH(ThreadState &threadState, threadStates_)
+    {
+        threadState.barcodeStats_.resize(allBarcodeMetadata_.size());
+    }
 }
 
-inline std::ostream &operator << (std::ostream &os, const std::vector<unsigned> &mismatchesPerComponent)
+void BarcodeResolver::resolveThread(
+    const unsigned threadNumber,
+    const unsigned threadsTotal,
+    Barcodes &dataBarcodes)
 {
-    os << mismatchesPerComponent.at(0);
+    ThreadState &threadState = threadStates_.at(threadNumber);
+    const std::size_t chunkSize = (dataBarcodes.size() + threadsTotal - 1) / threadsTotal;
+    const Barcodes::iterator chunkBegin = dataBarcodes.begin() + std::min(dataBarcodes.size(), chunkSize * threadNumber);
+    const Barcodes::iterator chunkEnd = dataBarcodes.begin() + std::min(dataBarcodes.size(), chunkSize * (threadNumber + 1));
 
-    BOOST_FOREACH(const unsigned &thisCompMismatches,
-                  std::make_pair(mismatchesPerComponent.begin() + 1, mismatchesPerComponent.end()))
+    for (Barcodes::iterator dataBarcodeIterator = chunkBegin; chunkEnd != dataBarcodeIterator; ++dataBarcodeIterator)
     {
-        os << ":" << thisCompMismatches;
+        Barcode &dataBarcode = *dataBarcodeIterator;
+        const std::size_t offset = findMismatchBarcode(mismatchBarcodes_, mismatchIndex_, dataBarcode.getSequence());
+        if (mismatchBarcodes_.size() != offset)
+        {
+            const Barcode &mismatchBarcode = mismatchBarcodes_[offset];
+            // match!, set the index in data
+            BarcodeId barcodeId(dataBarcode.getTile(), mismatchBarcode.getBarcode(),
+                                dataBarcode.getCluster(), mismatchBarcode.getMismatches());
+            dataBarcode.setBarcodeId(barcodeId);
+            threadState.barcodeStats_[mismatchBarcode.getBarcode()].recordBarcode(barcodeId);
+        }
+        else
+        {
+            ISAAC_ASSERT_MSG(dataBarcode.getBarcode() == unknownBarcodeIndex_, "Data barcodes are expected to have the index preset to 'unknown'");
+            threadState.barcodeStats_[unknownBarcodeIndex_].recordUnknownBarcode();
+            threadState.unknownSequences_.push_back(dataBarcode.getSequence());
+        }
     }
-    return os;
-}
 
-Barcodes::iterator BarcodeResolver::recordSameBarcodeHits(
-    const Barcodes::iterator dataBarcodeIterator,
-    const Barcodes::const_iterator dataBarcodesEnd,
-    demultiplexing::DemultiplexingStats& demultiplexingStats)
-{
-    Barcodes::iterator sameBarcodeIterator = dataBarcodeIterator;
-    while (dataBarcodesEnd != sameBarcodeIterator
-        && sameBarcodeIterator->getSequence()  == dataBarcodeIterator->getSequence())
+    // collapse unknown sequences into hit counts while still running in parallel
+    std::sort(threadState.unknownSequences_.begin(), threadState.unknownSequences_.end());
+    for (std::vector<Kmer>::const_iterator it = threadState.unknownSequences_.begin();
+        threadState.unknownSequences_.end() != it;)
     {
-        demultiplexingStats.recordUnknownBarcode(unknownBarcodeIndex_, dataBarcodeIterator->getTile());
-        ++sameBarcodeIterator;
+        const std::vector<Kmer>::const_iterator sameEnd =
+            std::upper_bound(it, std::vector<Kmer>::const_iterator(threadState.unknownSequences_.end()), *it);
+        threadState.unknownHits_.push_back(std::make_pair(*it, std::distance(it, sameEnd)));
+        it = sameEnd;
     }
-    demultiplexingStats.recordUnknownBarcodeHits(dataBarcodeIterator->getSequence(), std::distance(dataBarcodeIterator, sameBarcodeIterator));
-    return sameBarcodeIterator - 1;
+    threadState.unknownSequences_.clear();
 }
 
 /**
@@ -308,38 +378,42 @@ void BarcodeResolver::resolve(
     ISAAC_THREAD_CERR << "Resolving barcodes for " << dataBarcodes.size() << " clusters against " <<
         mismatchBarcodes_.size() << " mismatch variants" << std::endl;
 
-    uint64_t totalBarcodeHits = 0;
-    std::sort(dataBarcodes.begin(), dataBarcodes.end(), orderBySequence);
-    Barcodes::const_iterator mismatchBarcodeIterator = mismatchBarcodes_.begin();
+    threads_.execute(boost::bind(&BarcodeResolver::resolveThread, this, _1, _2, boost::ref(dataBarcodes)),
+                     threadStates_.size());
 
-    for(Barcodes::iterator dataBarcodeIterator = dataBarcodes.begin();
-        dataBarcodes.end() != dataBarcodeIterator; ++dataBarcodeIterator)
+    uint64_t totalBarcodeHits = 0;
+    UnknownBarcodeHits unknownHits;
+    BOOST_FOREACH(ThreadState &threadState, threadStates_)
     {
-        Barcode &dataBarcode = *dataBarcodeIterator;
-        // rewind sample sheet to the first data match
-        while(mismatchBarcodes_.end() != mismatchBarcodeIterator &&
-            dataBarcode.getSequence() > mismatchBarcodeIterator->getSequence())
+        BOOST_FOREACH(const LaneBarcodeStats &stats, threadState.barcodeStats_)
         {
-            ISAAC_ASSERT_MSG(dataBarcode.getBarcode() == unknownBarcodeIndex_, "Data barcodes are expected to have the index preset to 'unknown'");
-            ++mismatchBarcodeIterator;
+            const unsigned barcodeIndex = &stats - &threadState.barcodeStats_.front();
+            if (stats.barcodeCount_)
+            {
+                demultiplexingStats.recordBarcodeStats(barcodeIndex, stats);
+                if (unknownBarcodeIndex_ != barcodeIndex)
+                {
+                    barcodeHits_.at(barcodeIndex) += stats.barcodeCount_;
+                    totalBarcodeHits += stats.barcodeCount_;
+                }
+            }
         }
+        std::fill(threadState.barcodeStats_.begin(), threadState.barcodeStats_.end(), LaneBarcodeStats());
+        unknownHits.insert(unknownHits.end(), threadState.unknownHits_.begin(), threadState.unknownHits_.end());
+        threadState.unknownHits_.clear();
+    }
 
-        if (mismatchBarcodes_.end() != mismatchBarcodeIterator && dataBarcode.getSequence() == mismatchBarcodeIterator->getSequence())
-        {
-            // match!, set the index in data
-            BarcodeId barcodeId(dataBarcode.getTile(), mismatchBarcodeIterator->getBarcode(),
-                                dataBarcode.getCluster(), mismatchBarcodeIterator->getMismatches());
-            dataBarcode.setBarcodeId(barcodeId);
-            ++barcodeHits_.at(mismatchBarcodeIterator->getBarcode());
-            ++totalBarcodeHits;
-            demultiplexingStats.recordBarcode(barcodeId);
-        }
-        else
+    // the same unknown sequence could have been seen by more than one thread
+    std::sort(unknownHits.begin(), unknownHits.end(), &DemultiplexingStats::orderBySequence);
+    for (UnknownBarcodeHits::const_iterator it = unknownHits.begin(); unknownHits.end() != it;)
+    {
+        uint64_t hits = it->second;
+        const Kmer sequence = it->first;
+        while (unknownHits.end() != ++it && sequence == it->first)
         {
-            dataBarcodeIterator = recordSameBarcodeHits(dataBarcodeIterator, dataBarcodes.end(), demultiplexingStats);
+            hits += it->second;
         }
-
-        // else dataBarcode.getSequence() < mismatchBarcodeIterator->getSequence(), no match, move on
+        demultiplexingStats.recordUnknownBarcodeHits(sequence, hits);
     }
 
     if (!dataBarcodes.empty())
@@ -165,3 +165,50 @@ void TestBarcodeResolver::testMismatchCollision()
 
 }
 
+void TestBarcodeResolver::testResolve()
+{
+    isaac::flowcell::BarcodeMetadataList barcodeMetadataList(3);
+    std::vector<unsigned> compMism(1, 1);
+    barcodeMetadataList.at(0).setUnknown();
+    barcodeMetadataList.at(0).setIndex(0);
+    barcodeMetadataList.at(0).setComponentMismatches(compMism);
+    barcodeMetadataList.at(1).setSequence("AAAA");
+    barcodeMetadataList.at(1).setIndex(1);
+    barcodeMetadataList.at(1).setComponentMismatches(compMism);
+    barcodeMetadataList.at(2).setSequence("CCCC");
+    barcodeMetadataList.at(2).setIndex(2);
+    barcodeMetadataList.at(2).setComponentMismatches(compMism);
+
+    isaac::common::ThreadVector threads(2);
+    BarcodeResolver resolver(barcodeMetadataList, barcodeMetadataList, threads, 2);
+
+    const Kmer sequences[] = {0x249/*CCCC*/, 0x0/*AAAA*/, 0x492/*GGGG*/, 0x1/*AAAC*/, 0x492/*GGGG*/};
+    const unsigned expectedBarcodes[] = {2, 1, 0, 1, 0};
+    Barcodes dataBarcodes;
+    for (unsigned cluster = 0; sizeof(sequences) / sizeof(sequences[0]) > cluster; ++cluster)
+    {
+        dataBarcodes.push_back(Barcode(sequences[cluster], BarcodeId(0, 0, cluster, 0)));
+    }
+
+    isaac::demultiplexing::DemultiplexingStats stats(isaac::flowcell::FlowcellLayoutList(), barcodeMetadataList);
+    resolver.resolve(dataBarcodes, stats);
+
+    BOOST_FOREACH(const Barcode &barcode, dataBarcodes)
+    {
+        const unsigned cluster = &barcode - &dataBarcodes.front();
+        // resolution must not reorder the data barcodes
+        CPPUNIT_ASSERT_EQUAL(uint64_t(cluster), barcode.getCluster());
+        CPPUNIT_ASSERT_EQUAL(uint64_t(expectedBarcodes[cluster]), barcode.getBarcode());
+    }
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), dataBarcodes.at(3).getMismatches());
+
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), stats.getLaneBarcodeStat(barcodeMetadataList.at(0)).barcodeCount_);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), stats.getLaneBarcodeStat(barcodeMetadataList.at(1)).barcodeCount_);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), stats.getLaneBarcodeStat(barcodeMetadataList.at(1)).perfectBarcodeCount_);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), stats.getLaneBarcodeStat(barcodeMetadataList.at(2)).barcodeCount_);
+
+    const isaac::demultiplexing::UnknownBarcodeHits &unknownHits = stats.getLaneUnknwonBarcodeStat(0).topUnknownBarcodes_;
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), unknownHits.size());
+    CPPUNIT_ASSERT_EQUAL(Kmer(0x492), unknownHits.at(0).first);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), unknownHits.at(0).second);
+}
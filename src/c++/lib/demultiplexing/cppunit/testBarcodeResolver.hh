@@ -31,6 +31,7 @@ class TestBarcodeResolver : public CppUnit::TestFixture
     CPPUNIT_TEST( testOneComponent );
     CPPUNIT_TEST( testTwoComponents );
     CPPUNIT_TEST( testMismatchCollision );
+    CPPUNIT_TEST( testResolve );
     CPPUNIT_TEST_SUITE_END();
 private:
 public:
@@ -40,6 +41,7 @@ public:
     void testOneComponent();
     void testTwoComponents();
     void testMismatchCollision();
+    void testResolve();
 };
 
 #endif // #ifndef iSAAC_OPTIONS_TEST_BARCODE_RESOLVER_HH
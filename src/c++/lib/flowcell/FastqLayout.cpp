@@ -55,6 +55,25 @@ void getFastqFilePath(
     result /= boost::filesystem::path(fastqFileName);
 }
 
+void getFastqIndexFilePath(
+    const boost::filesystem::path &baseCallsPath,
+    const unsigned lane,
+    const unsigned index,
+    const bool compressed,
+    boost::filesystem::path &result)
+{
+    ISAAC_ASSERT_MSG(index <= fastq::INDEX_NUMBER_MAX, "Index number " << index << " must not exceed " << fastq::INDEX_NUMBER_MAX);
+
+    // same as getFastqFilePath, avoid memory allocations if the result is pre-sized
+    char fastqFileName[100];
+    snprintf(fastqFileName, sizeof(fastqFileName),
+             (compressed ? "%clane%d_index%d.fastq.gz" : "%clane%d_index%d.fastq"),
+             common::getDirectorySeparatorChar(), lane, index);
+
+    result = baseCallsPath.c_str();
+    result /= boost::filesystem::path(fastqFileName);
+}
+
 } //namespace fastq
 
 template<>
@@ -70,6 +89,41 @@ const boost::filesystem::path &Layout::getLaneReadAttribute<Layout::Fastq, Fastq
     return result;
 }
 
+template<>
+const boost::filesystem::path &Layout::getLaneReadAttribute<Layout::Fastq, FastqIndexFilePathAttributeTag>(
+    const unsigned lane, const unsigned read, boost::filesystem::path &result) const
+{
+    ISAAC_ASSERT_MSG(Fastq == format_, FastqIndexFilePathAttributeTag() << " is only allowed for fastq flowcells");
+    ISAAC_ASSERT_MSG(lane <= laneNumberMax_, "Lane number " << lane << " must not exceed " << laneNumberMax_);
+
+    const FastqFlowcellData &data = boost::get<FastqFlowcellData>(formatSpecificData_);
+
+    fastq::getFastqIndexFilePath(getBaseCallsPath(), lane, read, data.compressed_, result);
+    return result;
+}
+
+template<>
+const FastqIndexLengths::value_type &Layout::getAttribute<Layout::Fastq, FastqIndexLengths>(
+    FastqIndexLengths::value_type &result) const
+{
+    ISAAC_ASSERT_MSG(Fastq == format_, FastqIndexLengths() << " is only allowed for fastq flowcells");
+
+    const FastqFlowcellData &data = boost::get<FastqFlowcellData>(formatSpecificData_);
+    result = data.indexLengths_;
+    return result;
+}
+
+template<>
+const FastqIndexInReadName::value_type &Layout::getAttribute<Layout::Fastq, FastqIndexInReadName>(
+    FastqIndexInReadName::value_type &result) const
+{
+    ISAAC_ASSERT_MSG(Fastq == format_, FastqIndexInReadName() << " is only allowed for fastq flowcells");
+
+    const FastqFlowcellData &data = boost::get<FastqFlowcellData>(formatSpecificData_);
+    result = data.indexInReadName_;
+    return result;
+}
+
 template<>
 const FastqBaseQ0::value_type &Layout::getAttribute<Layout::Fastq, FastqBaseQ0>(
     FastqBaseQ0::value_type &result) const
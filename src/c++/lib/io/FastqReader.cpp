@@ -16,11 +16,14 @@
  **
  ** \author Roman Petrovski
  **/
-//#include <xmmintrin.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include <boost/bind.hpp>
 
 #include "common/Debug.hh"
 #include "common/FileSystem.hh"
+#include "common/Threads.hpp"
 #include "io/FastqReader.hh"
 
 namespace isaac
@@ -46,13 +49,37 @@ FastqReader::FastqReader(const bool allowVariableLength, const unsigned threadsM
     bgzfCompressed_(false),
     reachedEof_(false),
     filePos_(0),
-    zeroLengthRead_(false)
+    zeroLengthRead_(false),
+    readAheadSize_(0),
+    readAheadOffset_(0),
+    readAheadEof_(false),
+    readAheadStream_(0),
+    readAheadRequested_(false),
+    readAheadTerminateRequested_(false)
 {
     ISAAC_THREAD_CERR << "FastqReader uncompressedBufferSize_=" << uncompressedBufferSize_ << std::endl;
     buffer_.reserve(uncompressedBufferSize_);
     resetBuffer();
 }
 
+FastqReader::~FastqReader()
+{
+    if (readAheadThread_.joinable())
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(readAheadMutex_);
+            // let the current inflate finish, its result is of no interest
+            while (readAheadRequested_)
+            {
+                readAheadStateChangedCondition_.wait(lock);
+            }
+            readAheadTerminateRequested_ = true;
+            readAheadStateChangedCondition_.notify_all();
+        }
+        readAheadThread_.join();
+    }
+}
+
 void FastqReader::resetBuffer()
 {
     buffer_.resize(uncompressedBufferSize_);
@@ -70,6 +97,16 @@ void FastqReader::open(
 {
     if (fastqPath.c_str() != fastqPath_)
     {
+        if (readAheadThread_.joinable())
+        {
+            // the read-ahead thread may still be inflating from fileBuffer_. Whatever the previous file
+            // had left to inflate is of no interest anymore, but the buffer must not be reopened under it
+            boost::unique_lock<boost::mutex> lock(readAheadMutex_);
+            while (readAheadRequested_)
+            {
+                readAheadStateChangedCondition_.wait(lock);
+            }
+        }
         resetBuffer();
         // ensure actual copying, prevent path buffer sharing
         fastqPath_ = fastqPath.c_str();
@@ -81,6 +118,10 @@ void FastqReader::open(
                 getPath() % strerror(errno)).str()));
         }
         buffer_.resize(uncompressedBufferSize_);
+        readAheadException_ = boost::exception_ptr();
+        readAheadSize_ = 0;
+        readAheadOffset_ = 0;
+        readAheadEof_ = false;
         gzReader_.reset();
         filePos_ = 0;
 
@@ -88,6 +129,11 @@ void FastqReader::open(
         {
             is_.rdbuf(&fileBuffer_);
             bgzfCompressed_ = compressed_ ? bgzf::BgzfReader::isBgzfCompressed(is_) : false;
+            if (compressed_ && !bgzfCompressed_ && !readAheadThread_.joinable())
+            {
+                readAheadBuffer_.resize(GZIP_READ_AHEAD_BYTES);
+                readAheadThread_ = boost::thread(boost::bind(&FastqReader::readAheadThreadFunc, this));
+            }
             reachedEof_ = false;
             next();
         }
@@ -121,9 +167,25 @@ IteratorT findNotNewLine(IteratorT itBegin, IteratorT itEnd)
          boost::bind(std::not_equal_to<char>(), '\n', _1));
 }
 
+/**
+ * \brief Finds the first newline or carriage return. Sequence and quality lines are long, so look at 16 bytes at a time where possible.
+ */
 template <typename IteratorT>
 IteratorT findNewLine(IteratorT itBegin, IteratorT itEnd)
 {
+#ifdef __SSE2__
+    const __m128i n = _mm_set1_epi8('\n');
+    const __m128i r = _mm_set1_epi8('\r');
+    for (; 16 <= std::distance(itBegin, itEnd); itBegin += 16)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&*itBegin));
+        const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, n), _mm_cmpeq_epi8(block, r)));
+        if (mask)
+        {
+            return itBegin + __builtin_ctz(mask);
+        }
+    }
+#endif
     static const char *rn = "\n\r";
     return std::find_first_of(itBegin, itEnd, rn, rn+2);
 }
@@ -305,12 +367,89 @@ void FastqReader::findQScoresEnd()
     }
 }
 
+void FastqReader::inflateAhead(std::istream &is)
+{
+    const std::streamsize decompressedBytes = gzReader_.read(is, 0, &readAheadBuffer_.front(), readAheadBuffer_.size());
+    readAheadEof_ = gzReader_.isEof(is);
+    ISAAC_ASSERT_MSG(-1 != decompressedBytes || readAheadEof_, "Did not reach eof while unable to uncompress anymore");
+    readAheadSize_ = -1 == decompressedBytes ? 0 : decompressedBytes;
+    readAheadOffset_ = 0;
+}
+
+void FastqReader::readAheadThreadFunc()
+{
+    boost::unique_lock<boost::mutex> lock(readAheadMutex_);
+    while (!readAheadTerminateRequested_)
+    {
+        if (!readAheadRequested_)
+        {
+            readAheadStateChangedCondition_.wait(lock);
+            continue;
+        }
+        {
+            common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
+            try
+            {
+                inflateAhead(*readAheadStream_);
+            }
+            catch (...)
+            {
+                readAheadException_ = boost::current_exception();
+            }
+        }
+        readAheadRequested_ = false;
+        readAheadStateChangedCondition_.notify_all();
+    }
+}
+
+void FastqReader::requestReadAhead(std::istream &is)
+{
+    boost::unique_lock<boost::mutex> lock(readAheadMutex_);
+    readAheadStream_ = &is;
+    readAheadRequested_ = true;
+    readAheadStateChangedCondition_.notify_all();
+}
+
+void FastqReader::waitForReadAhead()
+{
+    boost::unique_lock<boost::mutex> lock(readAheadMutex_);
+    while (readAheadRequested_)
+    {
+        readAheadStateChangedCondition_.wait(lock);
+    }
+    if (readAheadException_)
+    {
+        boost::rethrow_exception(readAheadException_);
+    }
+}
+
+/**
+ * \brief Plain gzip cannot be inflated in parallel. Instead, the next GZIP_READ_AHEAD_BYTES are inflated on
+ *        readAheadThread_ while the caller parses the ones returned.
+ */
 std::size_t FastqReader::readCompressedFastq(std::istream &is, char *buffer, std::size_t amount)
 {
-    const std::streamsize decompressedBytes = gzReader_.read(is, 0, buffer, amount);
-    reachedEof_ = gzReader_.isEof(is);
-    ISAAC_ASSERT_MSG(-1 != decompressedBytes || reachedEof_, "Did not reach eof while unable to uncompress anymore");
-    return -1 == decompressedBytes ? 0 : decompressedBytes;
+    waitForReadAhead();
+
+    if (readAheadSize_ == readAheadOffset_ && !readAheadEof_)
+    {
+        // nothing inflated ahead yet. This happens on the first read after open
+        inflateAhead(is);
+    }
+
+    const std::size_t ret = std::min(amount, readAheadSize_ - readAheadOffset_);
+    std::copy(readAheadBuffer_.begin() + readAheadOffset_, readAheadBuffer_.begin() + readAheadOffset_ + ret, buffer);
+    readAheadOffset_ += ret;
+
+    if (readAheadSize_ == readAheadOffset_)
+    {
+        reachedEof_ = readAheadEof_;
+        if (!reachedEof_)
+        {
+            requestReadAhead(is);
+        }
+    }
+    return ret;
 }
 
 std::size_t FastqReader::readBgzfFastq(std::istream &is, char *buffer, std::size_t amount)
@@ -365,8 +504,10 @@ bool FastqReader::fetchMore()
 
     try
     {
-        buffer_.resize(uncompressedBufferSize_);
-        const std::size_t availableSpace = buffer_.size() - moved;
+        // plain gzip comes in GZIP_READ_AHEAD_BYTES at a time. Don't zero-fill the rest of the buffer for nothing.
+        const std::size_t availableSpace = (compressed_ && !bgzfCompressed_) ?
+            std::min(uncompressedBufferSize_ - moved, GZIP_READ_AHEAD_BYTES) : uncompressedBufferSize_ - moved;
+        buffer_.resize(moved + availableSpace);
         const std::size_t readBytes = bgzfCompressed_ ?
             readBgzfFastq(is_, &*firstUnreadByte, availableSpace) :
             compressed_ ?
@@ -384,6 +525,63 @@ bool FastqReader::fetchMore()
     return true;
 }
 
+/**
+ * \brief Figures out the lengths of the index components in a CASAVA 1.8 header such as
+ *        '@name 1:N:0:ACGTACGT+TTGGCCAA'.
+ *
+ * \return false if the header does not have an index field made of bases
+ */
+bool FastqReader::parseNameIndex(IteratorPair header, std::vector<unsigned> &indexLengths)
+{
+    indexLengths.clear();
+    static const char whitespace[] = {' ', '\t'};
+    const BufferType::const_iterator commentBegin = std::find_first_of(
+        header.first, header.second, whitespace, whitespace + sizeof(whitespace));
+    if (header.second == commentBegin)
+    {
+        return false;
+    }
+    BufferType::const_iterator indexBegin = std::find(
+        std::reverse_iterator<BufferType::const_iterator>(header.second),
+        std::reverse_iterator<BufferType::const_iterator>(commentBegin), ':').base();
+    if (commentBegin == indexBegin)
+    {
+        return false;
+    }
+
+    unsigned length = 0;
+    for (; header.second != indexBegin; ++indexBegin)
+    {
+        if ('+' == *indexBegin)
+        {
+            if (!length)
+            {
+                indexLengths.clear();
+                return false;
+            }
+            indexLengths.push_back(length);
+            length = 0;
+        }
+        else if (INCORRECT_FASTQ_BASE == translator_[*indexBegin])
+        {
+            indexLengths.clear();
+            return false;
+        }
+        else
+        {
+            ++length;
+        }
+    }
+    if (!length)
+    {
+        // trailing '+'. Partially parsed components must not be mistaken for the index geometry
+        indexLengths.clear();
+        return false;
+    }
+    indexLengths.push_back(length);
+    return true;
+}
+
 void FastqReader::next()
 {
     findHeader();
@@ -0,0 +1,169 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <fstream>
+#include <iterator>
+
+#include <boost/assign.hpp>
+
+#include "io/FastqReader.hh"
+
+using namespace std;
+
+#include "RegistryName.hh"
+#include "testFastqReader.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestFastqReader, registryName("FastqReader"));
+
+void TestFastqReader::setUp()
+{
+    fastqPath_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("testFastqReader-%%%%-%%%%.fastq");
+}
+
+void TestFastqReader::tearDown()
+{
+    boost::filesystem::remove(fastqPath_);
+}
+
+void TestFastqReader::writeFastq(const std::vector<std::string> &headers)
+{
+    std::ofstream os(fastqPath_.c_str());
+    for (const std::string &header : headers)
+    {
+        os << header << "\nACGT\n+\nIIII\n";
+    }
+    CPPUNIT_ASSERT(os);
+}
+
+std::vector<std::vector<unsigned> > TestFastqReader::parseHeaders(
+    const std::vector<std::string> &headers, std::vector<bool> &parsed)
+{
+    writeFastq(headers);
+    isaac::io::FastqReader reader(false, 1, fastqPath_.string().length());
+    reader.open(fastqPath_, '!');
+    std::vector<std::vector<unsigned> > ret;
+    parsed.clear();
+    for (; reader.hasData(); reader.next())
+    {
+        ret.push_back(std::vector<unsigned>());
+        parsed.push_back(isaac::io::FastqReader::parseNameIndex(reader.getHeader(), ret.back()));
+    }
+    CPPUNIT_ASSERT_EQUAL(headers.size(), ret.size());
+    return ret;
+}
+
+std::vector<char> TestFastqReader::extractNameIndex(const std::string &header, const unsigned indexLength)
+{
+    writeFastq(std::vector<std::string>(1, header));
+    isaac::io::FastqReader reader(false, 1, fastqPath_.string().length());
+    reader.open(fastqPath_, '!');
+    CPPUNIT_ASSERT(reader.hasData());
+    std::vector<char> ret;
+    reader.extractNameIndex(indexLength, std::back_inserter(ret));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(indexLength), ret.size());
+    return ret;
+}
+
+// bcl byte of a name index base
+static char bcl(const unsigned base)
+{
+    return base | (isaac::io::FastqReader::NAME_INDEX_QUALITY << 2);
+}
+
+void TestFastqReader::testCasava18Names()
+{
+    std::vector<bool> parsed;
+    const std::vector<std::vector<unsigned> > lengths = parseHeaders(
+        boost::assign::list_of
+            (std::string("@M00123:12:000000000-A1B2C:1:1101:15589:1331 1:N:0:ACGTAC"))
+            (std::string("@M00123:12:000000000-A1B2C:1:1101:15589:1331 2:N:0:ACGTAC+TTGG"))
+            (std::string("@r3\t1:Y:18:NNGTAC")),
+        parsed);
+
+    CPPUNIT_ASSERT(parsed.at(0));
+    CPPUNIT_ASSERT(boost::assign::list_of(6U).convert_to_container<std::vector<unsigned> >() == lengths.at(0));
+    CPPUNIT_ASSERT(parsed.at(1));
+    CPPUNIT_ASSERT(boost::assign::list_of(6U)(4U).convert_to_container<std::vector<unsigned> >() == lengths.at(1));
+    // N is a valid index base, tab separates the comment too
+    CPPUNIT_ASSERT(parsed.at(2));
+    CPPUNIT_ASSERT(boost::assign::list_of(6U).convert_to_container<std::vector<unsigned> >() == lengths.at(2));
+
+    // components are concatenated, Ns become 0
+    const std::vector<char> dual = extractNameIndex("@r1 2:N:0:ACGTAC+TTGG", 10);
+    const std::vector<char> expectedDual = boost::assign::list_of
+        (bcl(0))(bcl(1))(bcl(2))(bcl(3))(bcl(0))(bcl(1))(bcl(3))(bcl(3))(bcl(2))(bcl(2));
+    CPPUNIT_ASSERT(expectedDual == dual);
+
+    const std::vector<char> withN = extractNameIndex("@r1 1:N:0:NCGT", 4);
+    CPPUNIT_ASSERT_EQUAL(char(0), withN.at(0));
+    CPPUNIT_ASSERT_EQUAL(bcl(1), withN.at(1));
+
+    // shorter index in the name gets padded with Ns, longer one truncated
+    const std::vector<char> padded = extractNameIndex("@r1 1:N:0:AC", 4);
+    CPPUNIT_ASSERT(boost::assign::list_of(bcl(0))(bcl(1))(char(0))(char(0)).convert_to_container<std::vector<char> >() == padded);
+    const std::vector<char> truncated = extractNameIndex("@r1 1:N:0:ACGTAC", 2);
+    CPPUNIT_ASSERT(boost::assign::list_of(bcl(0))(bcl(1)).convert_to_container<std::vector<char> >() == truncated);
+}
+
+void TestFastqReader::testOldStyleNames()
+{
+    std::vector<bool> parsed;
+    const std::vector<std::vector<unsigned> > lengths = parseHeaders(
+        boost::assign::list_of
+            (std::string("@HWI-ST1234:8:1101:1234:2000#0/1"))
+            (std::string("@HWI-ST1234:8:1101:1234:2000#ACGTAC/2"))
+            (std::string("@read1/1")),
+        parsed);
+
+    for (std::size_t i = 0; lengths.size() != i; ++i)
+    {
+        CPPUNIT_ASSERT(!parsed.at(i));
+        CPPUNIT_ASSERT(lengths.at(i).empty());
+    }
+
+    // nothing resembling an index yields all Ns
+    CPPUNIT_ASSERT(std::vector<char>(6, 0) == extractNameIndex("@read1/1", 6));
+    CPPUNIT_ASSERT(std::vector<char>(6, 0) == extractNameIndex("@HWI-ST1234:8:1101:1234:2000#0/1", 6));
+}
+
+void TestFastqReader::testMalformedNames()
+{
+    std::vector<bool> parsed;
+    const std::vector<std::vector<unsigned> > lengths = parseHeaders(
+        boost::assign::list_of
+            // no index after the last colon
+            (std::string("@r1 1:N:0:"))
+            // empty first component
+            (std::string("@r2 1:N:0:+ACGT"))
+            // empty last component
+            (std::string("@r3 1:N:0:ACGT+"))
+            // not a base
+            (std::string("@r4 1:N:0:AC1T"))
+            // colons only in the name
+            (std::string("@M00123:12:1:1101:15589:1331 comment")),
+        parsed);
+
+    for (std::size_t i = 0; parsed.size() != i; ++i)
+    {
+        CPPUNIT_ASSERT(!parsed.at(i));
+    }
+    CPPUNIT_ASSERT(lengths.at(0).empty());
+    CPPUNIT_ASSERT(lengths.at(1).empty());
+    CPPUNIT_ASSERT(lengths.at(2).empty());
+    CPPUNIT_ASSERT(lengths.at(3).empty());
+    CPPUNIT_ASSERT(lengths.at(4).empty());
+
+    // extraction does not validate, non-bases become Ns
+    const std::vector<char> index = extractNameIndex("@r4 1:N:0:AC1T", 4);
+    CPPUNIT_ASSERT(boost::assign::list_of(bcl(0))(bcl(1))(char(0))(bcl(3)).convert_to_container<std::vector<char> >() == index);
+}
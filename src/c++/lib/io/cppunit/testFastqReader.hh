@@ -0,0 +1,48 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_IO_TEST_FASTQ_READER_HH
+#define iSAAC_IO_TEST_FASTQ_READER_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+class TestFastqReader : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestFastqReader );
+    CPPUNIT_TEST( testCasava18Names );
+    CPPUNIT_TEST( testOldStyleNames );
+    CPPUNIT_TEST( testMalformedNames );
+    CPPUNIT_TEST_SUITE_END();
+private:
+    boost::filesystem::path fastqPath_;
+
+    /// writes a fastq with one record per header and returns the name index lengths parsed from each
+    std::vector<std::vector<unsigned> > parseHeaders(const std::vector<std::string> &headers, std::vector<bool> &parsed);
+    /// \return bcl bytes of the index taken from the name of the only record with the header
+    std::vector<char> extractNameIndex(const std::string &header, const unsigned indexLength);
+    void writeFastq(const std::vector<std::string> &headers);
+
+public:
+    void setUp();
+    void tearDown();
+    void testCasava18Names();
+    void testOldStyleNames();
+    void testMalformedNames();
+};
+
+#endif // #ifndef iSAAC_IO_TEST_FASTQ_READER_HH
@@ -36,6 +36,7 @@
 #include "common/Exceptions.hh"
 #include "demultiplexing/SampleSheetCsv.hh"
 #include "oligo/Mask.hh"
+#include "oligo/Minimizer.hh"
 #include "options/AlignOptions.hh"
 #include "package/InstallationPaths.hh"
 
@@ -196,6 +197,12 @@ AlignOptions::AlignOptions()
     , optionalFeatures(parseBamExcludeTags(bamExcludeTags))
     , pessimisticMapQ(false)
     , detectTemplateBlockSize(10000)
+    , seedMatchCacheSize(0)
+    , adaptiveSeeds(false)
+    , minimizerWindow(0)
+    , sharedReferenceHash(false)
+    , traceSlowestClusters(0)
+    , progressInterval(30)
     , disableResume(false)
 {
     static bool bufferBins = false;
@@ -272,7 +279,8 @@ AlignOptions::AlignOptions()
         ("realign-mapq-min"     , bpo::value<unsigned>(&realignMapqMin)->default_value(realignMapqMin),
                 "Gaps from alignments with lower MAPQ will not be used as candidates for gap realignment")
         ("known-indels"           , bpo::value<std::string>(&knownIndelsPathString),
-                "path to a VCF file containing known indels fore realignment.")
+                "path to a VCF file containing known indels fore realignment. The parsed indels are cached in "
+                "<path>.isaac-gaps if the location is writable so that subsequent runs don't need to parse the VCF.")
         ("bam-gzip-level"           , bpo::value<int>(&bamGzipLevel)->default_value(bamGzipLevel),
                 "Gzip level to use for BAM")
         ("bam-header-tag"           , bpo::value<std::vector<std::string> >(&bamHeaderTags)->multitoken(),
@@ -295,6 +303,13 @@ AlignOptions::AlignOptions()
                 "When set, the MAPQ is computed as MAPQ:=min(60, min(SM, AS)), otherwise MAPQ:=min(60, max(SM, AS))")
         ("detect-template-block-size" , bpo::value<unsigned>(&detectTemplateBlockSize)->default_value(detectTemplateBlockSize),
             "Number of pairs to use as a single block for template length statistics detection")
+        ("seed-match-cache-size"    , bpo::value<unsigned>(&seedMatchCacheSize)->default_value(seedMatchCacheSize),
+            "Number of entries in the per-thread cache of read seed matches. Allows duplicate reads within a tile to "
+            "reuse the candidate matches instead of querying the reference hash. Set to 0 to disable the cache.")
+        ("adaptive-seeds"           , bpo::value<bool>(&adaptiveSeeds)->default_value(adaptiveSeeds),
+            "When set, the match finder first queries a minimal set of non-overlapping seeds and only queries the "
+            "seeds shifted by half a seed length when the candidate support is ambiguous. Seeds having more than "
+            "--candidate-matches-max hits are only used to promote the candidates found by less repetitive seeds.")
         ("description"              , bpo::value<std::string>(&description), "Free form text to be stored in the Isaac @PG DS bam header tag")
         ("tiles"                    , bpo::value<std::vector<std::string> >(&tilesFilterList),
                 "Comma-separated list of regular expressions to select only a subset of the tiles available in the flow-cell."
@@ -315,6 +330,24 @@ AlignOptions::AlignOptions()
         ("seed-length"              , bpo::value<unsigned>(&seedLength)->default_value(seedLength),
             ("Length of the seed in bases. Only " + oligo::supportedKmersString() +
             " are allowed. Longer seeds reduce sensitivity on noisy data but improve repeat resolution and run time.").c_str())
+        ("minimizer-window"         , bpo::value<unsigned>(&minimizerWindow)->default_value(minimizerWindow),
+            ("When not 0, only the (minimizer-window,seed-length)-minimizers are stored in the reference hash and "
+            "queried from the reads. Reduces the hash size and makes seeding of long reads less sensitive to "
+            "mismatches. At most " + boost::lexical_cast<std::string>(oligo::MinimizerWindow<oligo::KmerType>::WINDOW_MAX) +
+            " is allowed. Set to 0 to hash all reference k-mers.").c_str())
+        ("shared-reference-hash"    , bpo::value<bool>(&sharedReferenceHash)->default_value(sharedReferenceHash),
+            "When set, the reference hash is kept in a POSIX shared memory segment named after the reference and "
+            "hashing parameters. Concurrent isaac-align processes that use the same reference attach to it read-only "
+            "instead of building their own. The segment is removed when the last process detaches. "
+            "If the segment cannot be created or validated, the hash is built privately.")
+        ("trace-slowest-clusters"   , bpo::value<unsigned>(&traceSlowestClusters)->default_value(traceSlowestClusters),
+            "Number of the most expensive clusters to report in Stats/SlowestClusters.tsv along with the cpu cycles "
+            "spent in match finding, ungapped, gapped, split read alignment and shadow rescue and the alignment "
+            "outcome of each read. Set to 0 to disable the tracing.")
+        ("progress-interval"        , bpo::value<unsigned>(&progressInterval)->default_value(progressInterval),
+            "Number of seconds between the updates of Stats/Progress.json. The file shows the current stage, tiles, "
+            "clusters and bins done out of the total, throughput, estimated time to the end of the stage, memory in use "
+            "and the amount of temporary data written. The file is replaced atomically. Set to 0 to disable.")
         ("expected-coverage"         , bpo::value<unsigned>(&expectedCoverage)->default_value(expectedCoverage),
                 "Expected coverage is required for Isaac to estimate the efficient binning of the aligned data.")
         ("target-bin-size"            , bpo::value<uint64_t>(&targetBinSizeMB)->default_value(targetBinSizeMB),
@@ -1267,6 +1300,17 @@ void AlignOptions::postProcess(bpo::variables_map &vm)
             " is not supported. ***\n"));
     }
 
+    if (oligo::MinimizerWindow<oligo::KmerType>::WINDOW_MAX < minimizerWindow)
+    {
+        BOOST_THROW_EXCEPTION(InvalidOptionException("\n   *** --minimizer-window must not exceed " +
+            boost::lexical_cast<std::string>(oligo::MinimizerWindow<oligo::KmerType>::WINDOW_MAX) + " ***\n"));
+    }
+
+    if (minimizerWindow && adaptiveSeeds)
+    {
+        BOOST_THROW_EXCEPTION(InvalidOptionException("\n   *** --adaptive-seeds is incompatible with --minimizer-window ***\n"));
+    }
+
     std::vector<boost::filesystem::path> sampleSheetPathList = parseSampleSheetPaths();
     for (std::size_t i = 0; baseCallsDirectoryList.size() > i; ++i)
     {
@@ -45,7 +45,8 @@ namespace bfs = boost::filesystem;
 using common::InvalidOptionException;
 using boost::format;
 
-ReorderReferenceOptions::ReorderReferenceOptions()
+ReorderReferenceOptions::ReorderReferenceOptions() :
+    contigImage_(true)
 {
     namedOptions_.add_options()
         ("reference-genome,r"       , bpo::value<bfs::path>(&sortedReferenceMetadata_),
@@ -59,6 +60,10 @@ ReorderReferenceOptions::ReorderReferenceOptions()
             )
         ("output-xml,x"       , bpo::value<bfs::path>(&newXmlPath_),
                 "Path for the new xml file."
+            )
+        ("contig-image"       , bpo::value<bool>(&contigImage_)->default_value(contigImage_),
+                "Store the translated contig bases in a binary image next to the new .fa file. isaac-align copies "
+                "contigs from the image instead of parsing the fasta."
             );
 }
 
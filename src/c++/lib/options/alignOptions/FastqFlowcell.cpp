@@ -17,11 +17,15 @@
  ** \author Roman Petrovski
  **/
 
+#include <numeric>
+
 #include <boost/foreach.hpp>
 
 #include <boost/algorithm/string/regex.hpp>
+#include <boost/iterator/counting_iterator.hpp>
 
 #include "alignOptions/UseBasesMaskOption.hh"
+#include "demultiplexing/Barcode.hh"
 #include "flowcell/FastqLayout.hh"
 #include "io/FastqReader.hh"
 
@@ -134,6 +138,17 @@ FastqFlowcell::FastqPathPairList FastqFlowcell::findFastqPathPairs(
             p.r2Path_ = r2Path;
         }
 
+        for (unsigned index = 1; flowcell::fastq::INDEX_NUMBER_MAX >= index; ++index)
+        {
+            boost::filesystem::path indexPath;
+            flowcell::fastq::getFastqIndexFilePath(baseCallsDirectory, lane, index, compressed, indexPath);
+            if (!boost::filesystem::exists(indexPath))
+            {
+                break;
+            }
+            p.indexPaths_.push_back(indexPath);
+        }
+
         if (!p.r1Path_.empty() || !p.r2Path_.empty())
         {
             p.lane_ = lane;
@@ -185,6 +200,22 @@ FastqFlowcellInfo FastqFlowcell::parseFastqFlowcellInfo(
         }
     }
 
+    BOOST_FOREACH(const boost::filesystem::path &indexPath, laneFilePaths.indexPaths_)
+    {
+        io::FastqReader reader(false, 1, 0);
+        reader.open(indexPath, fastqQ0);
+        CasavaFastqParser parser(reader);
+        ret.indexLengths_.push_back(parser.parseReadLength());
+    }
+
+    if (laneFilePaths.indexPaths_.empty())
+    {
+        // without the index files, use the index recorded in the read names, if any
+        io::FastqReader reader(false, 1, 0);
+        reader.open(laneFilePaths.r1Path_.empty() ? laneFilePaths.r2Path_ : laneFilePaths.r1Path_, fastqQ0);
+        ret.indexInReadName_ = reader.hasData() && io::FastqReader::parseNameIndex(reader.getHeader(), ret.indexLengths_);
+    }
+
     ret.lanes_.push_back(laneFilePaths.lane_);
 
     return ret;
@@ -230,6 +261,12 @@ FastqFlowcellInfo FastqFlowcell::parseFastqFlowcellInfo(
                         anotherLane % ret).str()));
                 }
 
+                if (anotherLane.indexLengths_ != ret.indexLengths_ || anotherLane.indexInReadName_ != ret.indexInReadName_)
+                {
+                    BOOST_THROW_EXCEPTION(common::IoException(errno, (boost::format("Index reads mismatch between lanes of the same flowcell %s vs %s") %
+                        anotherLane % ret).str()));
+                }
+
                 if (anotherLane.flowcellId_ != ret.flowcellId_)
                 {
                     ISAAC_THREAD_CERR << "WARNING: Flowcell id mismatch across the lanes of the same flowcell" <<
@@ -304,12 +341,35 @@ flowcell::Layout FastqFlowcell::createFilteredFlowcell(
         parsedUseBasesMask = parseUseBasesMask(readFirstCycles, readLengths, seedLength, useBasesMask, baseCallsDirectory);
     }
 
+    const unsigned barcodeLength = std::accumulate(flowcellInfo.indexLengths_.begin(), flowcellInfo.indexLengths_.end(), 0U);
+    if (demultiplexing::MAX_BARCODE_LENGTH < barcodeLength)
+    {
+        if (!flowcellInfo.indexInReadName_)
+        {
+            const boost::format message = boost::format("\n   *** Index reads in %s are too long: %d bases. At most %d supported ***\n") %
+                baseCallsDirectory.string() % barcodeLength % demultiplexing::MAX_BARCODE_LENGTH;
+            BOOST_THROW_EXCEPTION(common::InvalidOptionException(message.str()));
+        }
+        ISAAC_THREAD_CERR << "WARNING: Ignoring the index in read names of " << baseCallsDirectory << " as it is too long: " <<
+            barcodeLength << " bases. At most " << demultiplexing::MAX_BARCODE_LENGTH << " supported." << std::endl;
+        flowcellInfo.indexLengths_.clear();
+        flowcellInfo.indexInReadName_ = false;
+    }
+
+    // index cycles follow the data cycles
+    const unsigned firstBarcodeCycle = std::accumulate(readLengths.begin(), readLengths.end(), 1U);
+    const std::vector<unsigned> barcodeCycles(
+        boost::counting_iterator<unsigned>(firstBarcodeCycle),
+        boost::counting_iterator<unsigned>(firstBarcodeCycle +
+            std::accumulate(flowcellInfo.indexLengths_.begin(), flowcellInfo.indexLengths_.end(), 0U)));
+
     flowcell::Layout fc(baseCallsDirectory,
                         flowcell::Layout::Fastq,
-                        flowcell::FastqFlowcellData(compressed, fastqQ0, allowVariableFastqLength),
+                        flowcell::FastqFlowcellData(compressed, fastqQ0, allowVariableFastqLength,
+                                                    flowcellInfo.indexLengths_, flowcellInfo.indexInReadName_),
                         laneNumberMax,
                         flowcellInfo.readNameLength_,
-                        std::vector<unsigned>(),
+                        barcodeCycles,
                         parsedUseBasesMask.dataReads_,
                         flowcellInfo.flowcellId_);
 
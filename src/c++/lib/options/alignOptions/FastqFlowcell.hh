@@ -32,11 +32,13 @@ namespace alignOptions
 
 struct FastqFlowcellInfo
 {
-    FastqFlowcellInfo() : readNameLength_(0){}
+    FastqFlowcellInfo() : readNameLength_(0), indexInReadName_(false){}
     std::string flowcellId_;
     std::pair<unsigned, unsigned> readLengths_;
     std::vector<unsigned> lanes_;
     unsigned readNameLength_;
+    std::vector<unsigned> indexLengths_;
+    bool indexInReadName_;
 
     const std::vector<unsigned> &getLanes() const
     {
@@ -66,6 +68,7 @@ private:
         unsigned lane_;
         boost::filesystem::path r1Path_;
         boost::filesystem::path r2Path_;
+        std::vector<boost::filesystem::path> indexPaths_;
     };
     typedef std::vector<FastqPathPair> FastqPathPairList;
 
@@ -96,8 +99,15 @@ inline std::ostream &operator<< (std::ostream &os, const FastqFlowcellInfo &fcIn
     {
         os << lane << " ";
     }
+    os << "]," <<
+        fcInfo.readNameLength_ << "nl,[";
+
+    BOOST_FOREACH(const unsigned indexLength, fcInfo.indexLengths_)
+    {
+        os << indexLength << " ";
+    }
     return os << "]," <<
-        fcInfo.readNameLength_ << "nl,"
+        fcInfo.indexInReadName_ << "inr"
         ")";
 }
 
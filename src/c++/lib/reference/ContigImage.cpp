@@ -0,0 +1,180 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file ContigImage.cpp
+ **
+ ** Binary image of the translated contig bases stored next to the sorted reference fasta.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <cstring>
+#include <fstream>
+
+#include <boost/format.hpp>
+
+#include "common/Debug.hh"
+#include "common/Exceptions.hh"
+#include "reference/ContigImage.hh"
+
+namespace isaac
+{
+namespace reference
+{
+
+static std::size_t alignContigOffset(const std::size_t offset)
+{
+    return (offset + contigImage::CONTIG_ALIGNMENT - 1) / contigImage::CONTIG_ALIGNMENT * contigImage::CONTIG_ALIGNMENT;
+}
+
+void saveContigImage(
+    const boost::filesystem::path &fastaPath,
+    const SortedReferenceMetadata::Contigs &xmlContigs,
+    const ContigList &contigList)
+{
+    const boost::filesystem::path imagePath = getContigImagePath(fastaPath);
+    std::vector<const SortedReferenceMetadata::Contig *> fastaOrder;
+    fastaOrder.reserve(xmlContigs.size());
+    for (const SortedReferenceMetadata::Contig &xmlContig : xmlContigs)
+    {
+        fastaOrder.push_back(&xmlContig);
+    }
+    std::sort(fastaOrder.begin(), fastaOrder.end(),
+              [](const SortedReferenceMetadata::Contig *left, const SortedReferenceMetadata::Contig *right){return left->offset_ < right->offset_;});
+
+    std::vector<contigImage::Entry> entries;
+    entries.reserve(fastaOrder.size());
+    std::size_t imageOffset = sizeof(contigImage::Header) + sizeof(contigImage::Entry) * fastaOrder.size();
+    for (const SortedReferenceMetadata::Contig *xmlContig : fastaOrder)
+    {
+        imageOffset = alignContigOffset(imageOffset);
+        const contigImage::Entry entry = {xmlContig->offset_, xmlContig->totalBases_, xmlContig->acgtBases_, imageOffset};
+        entries.push_back(entry);
+        imageOffset += entry.totalBases_;
+    }
+
+    std::ofstream os(imagePath.c_str(), std::ios_base::binary);
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open contig image file for writing: " + imagePath.string()));
+    }
+
+    contigImage::Header header;
+    std::memcpy(header.magic_, contigImage::MAGIC, sizeof(header.magic_));
+    header.version_ = contigImage::VERSION;
+    header.contigs_ = entries.size();
+    header.fastaSize_ = boost::filesystem::file_size(fastaPath);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!entries.empty())
+    {
+        os.write(reinterpret_cast<const char*>(&entries.front()), sizeof(contigImage::Entry) * entries.size());
+    }
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to write contig image header into " + imagePath.string()));
+    }
+
+    const std::vector<char> padding(contigImage::CONTIG_ALIGNMENT, 0);
+    for (std::size_t i = 0; i < entries.size(); ++i)
+    {
+        const contigImage::Entry &entry = entries[i];
+        const ContigList::Contig &contig = contigList.at(fastaOrder[i]->index_);
+        ISAAC_ASSERT_MSG(contig.size() == entry.totalBases_, "Contig is not loaded: " << *fastaOrder[i] << " " << contig);
+        os.write(padding.data(), entry.imageOffset_ - std::size_t(os.tellp()));
+        os.write(&*contig.begin(), contig.size());
+        if (!os)
+        {
+            BOOST_THROW_EXCEPTION(common::IoException(errno, (boost::format("Failed to write %s into contig image file %s") %
+                contig % imagePath.string()).str()));
+        }
+    }
+    ISAAC_THREAD_CERR << "Saved " << entries.size() << " contigs into " << imagePath << std::endl;
+}
+
+bool ContigImages::open(const boost::filesystem::path &fastaPath, Image &image)
+{
+    const boost::filesystem::path imagePath = getContigImagePath(fastaPath);
+    if (!boost::filesystem::exists(imagePath))
+    {
+        return false;
+    }
+    if (boost::filesystem::last_write_time(imagePath) < boost::filesystem::last_write_time(fastaPath))
+    {
+        ISAAC_THREAD_CERR << "WARNING: ignoring contig image " << imagePath << " older than " << fastaPath << std::endl;
+        return false;
+    }
+
+    image.file_.map(imagePath, true);
+    const contigImage::Header *header = reinterpret_cast<const contigImage::Header *>(image.file_.data());
+    if (image.file_.size() < sizeof(contigImage::Header) ||
+        std::memcmp(header->magic_, contigImage::MAGIC, sizeof(header->magic_)) ||
+        contigImage::VERSION != header->version_ ||
+        image.file_.size() < sizeof(contigImage::Header) + sizeof(contigImage::Entry) * header->contigs_)
+    {
+        ISAAC_THREAD_CERR << "WARNING: ignoring contig image " << imagePath << " of unexpected format" << std::endl;
+        image.file_.unmap();
+        return false;
+    }
+    if (boost::filesystem::file_size(fastaPath) != header->fastaSize_)
+    {
+        ISAAC_THREAD_CERR << "WARNING: ignoring contig image " << imagePath << " made from a different " << fastaPath << std::endl;
+        image.file_.unmap();
+        return false;
+    }
+    image.entriesBegin_ = reinterpret_cast<const contigImage::Entry *>(header + 1);
+    image.entriesEnd_ = image.entriesBegin_ + header->contigs_;
+    ISAAC_THREAD_CERR << "Mapped contig image " << imagePath << " with " << header->contigs_ << " contigs" << std::endl;
+    return true;
+}
+
+ContigImages::ContigImages(const SortedReferenceMetadata::Contigs &xmlContigs)
+{
+    for (const SortedReferenceMetadata::Contig &xmlContig : xmlContigs)
+    {
+        if (images_.end() == images_.find(xmlContig.filePath_))
+        {
+            // a fasta without a usable image stays in the map unmapped, so that it is not checked again
+            Image *image = new Image;
+            boost::filesystem::path filePath = xmlContig.filePath_;
+            images_.insert(filePath, image);
+            open(xmlContig.filePath_, *image);
+        }
+    }
+}
+
+bool ContigImages::load(
+    const SortedReferenceMetadata::Contig &xmlContig,
+    ContigList::UpdateRange &contig) const
+{
+    const boost::ptr_map<boost::filesystem::path, Image>::const_iterator it = images_.find(xmlContig.filePath_);
+    if (images_.end() == it || !it->second->file_.isMapped())
+    {
+        return false;
+    }
+    const Image &image = *it->second;
+    const contigImage::Entry *entry = std::lower_bound(
+        image.entriesBegin_, image.entriesEnd_, xmlContig.offset_,
+        [](const contigImage::Entry &entry, const uint64_t offset){return entry.fastaOffset_ < offset;});
+    if (image.entriesEnd_ == entry || xmlContig.offset_ != entry->fastaOffset_ ||
+        xmlContig.totalBases_ != entry->totalBases_ || xmlContig.acgtBases_ != entry->acgtBases_ ||
+        image.file_.size() < entry->imageOffset_ + entry->totalBases_)
+    {
+        ISAAC_THREAD_CERR << "WARNING: contig image does not match " << xmlContig << std::endl;
+        return false;
+    }
+    ISAAC_ASSERT_MSG(contig.getLength() == entry->totalBases_, "Attempt to load wrong data into contig:" << xmlContig << " " << contig);
+    std::memcpy(&*contig.begin(), image.file_.data() + entry->imageOffset_, entry->totalBases_);
+    return true;
+}
+
+} // namespace reference
+} // namespace isaac
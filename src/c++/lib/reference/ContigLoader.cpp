@@ -16,9 +16,17 @@
  **
  ** \author Roman Petrovski
  **/
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
 
+#include "io/MappedFile.hh"
+#include "oligo/Nucleotides.hh"
 #include "reference/ContigLoader.hh"
 
 namespace isaac
@@ -26,46 +34,87 @@ namespace isaac
 namespace reference
 {
 
+bool translateBases(const char *begin, const char *end, char *out, std::size_t &acgtBases)
+{
+    static const oligo::Translator<true> translator = {};
+#ifdef __SSE2__
+    const __m128i caseMask = _mm_set1_epi8(char(0xDF));
+    const __m128i a = _mm_set1_epi8('A');
+    const __m128i c = _mm_set1_epi8('C');
+    const __m128i g = _mm_set1_epi8('G');
+    const __m128i t = _mm_set1_epi8('T');
+    const __m128i n = _mm_set1_epi8(oligo::REFERENCE_OLIGO_N);
+    const __m128i lettersMax = _mm_set1_epi8('Z' - 'A');
+    __m128i notLetter = _mm_setzero_si128();
+    for (; end - begin >= 16; begin += 16, out += 16)
+    {
+        const __m128i upper = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin)), caseMask);
+        const __m128i acgt = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(upper, a), _mm_cmpeq_epi8(upper, c)),
+            _mm_or_si128(_mm_cmpeq_epi8(upper, g), _mm_cmpeq_epi8(upper, t)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                         _mm_or_si128(_mm_and_si128(acgt, upper), _mm_andnot_si128(acgt, n)));
+        acgtBases += __builtin_popcount(_mm_movemask_epi8(acgt));
+        // unsigned (upper - 'A') > 25 means not a letter
+        const __m128i offset = _mm_sub_epi8(upper, a);
+        notLetter = _mm_or_si128(notLetter, _mm_xor_si128(_mm_max_epu8(offset, lettersMax), lettersMax));
+    }
+    bool ret = 0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi8(notLetter, _mm_setzero_si128()));
+#else
+    bool ret = true;
+#endif // __SSE2__
+    for (; end != begin; ++begin, ++out)
+    {
+        ret &= bool(std::isalpha(*begin));
+        *out = oligo::getBase(translator[*begin], true);
+        acgtBases += oligo::REFERENCE_OLIGO_N != *out;
+    }
+    return ret;
+}
+
 void loadContig(
     const reference::SortedReferenceMetadata::Contig &contigMetadata,
     ContigList::UpdateRange &contig)
 {
     ISAAC_ASSERT_MSG(contig.getLength() == contigMetadata.totalBases_, "Attempt to load wrong data into contig:" << contigMetadata << " " << contig)
-    std::ifstream is(contigMetadata.filePath_.string().c_str());
-    if (!is) {
-        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open reference file " + contigMetadata.filePath_.string()));
-    }
-    if (!is.seekg(contigMetadata.offset_))
-    {
-        using common::IoException;
-        using boost::format;
-        const format message = (boost::format("Failed to reach offset %d in reference file % s") % contigMetadata.offset_ % contigMetadata.filePath_);
-        BOOST_THROW_EXCEPTION(IoException(errno, message.str()));
-    }
+    io::MappedFile fasta;
+    fasta.mapRange(contigMetadata.filePath_, contigMetadata.offset_, contigMetadata.size_);
 //        ISAAC_THREAD_CERR << (boost::format("Contig seek %s (%3d:%8d): %s") % contigMetadata.name_ % contigMetadata.index_ % contigMetadata.totalBases_ % contigMetadata.filePath_).str() << std::endl;
-    static const oligo::Translator<true> translator = {};
-    char base = 0;
     std::size_t acgtBases = 0;
-    auto updateIterator = contig.begin();
-    while(is && (std::size_t(std::distance(contig.begin(), updateIterator)) < contigMetadata.totalBases_) && is.get(base))
+    char *const contigBegin = &*contig.begin();
+    char *out = contigBegin;
+    char *const outEnd = contigBegin + contig.getLength();
+    const char *in = fasta.data();
+    const char *const inEnd = in + fasta.size();
+    while (outEnd != out && inEnd != in)
     {
-        if ('\r' != base && '\n' != base)
+        const char *lineEnd = static_cast<const char*>(std::memchr(in, '\n', inEnd - in));
+        const char *const next = lineEnd ? lineEnd + 1 : inEnd;
+        lineEnd = lineEnd ? lineEnd : inEnd;
+        // '\r' is skipped wherever it is in the line, not just before the '\n'
+        while (outEnd != out && lineEnd != in)
         {
-            ISAAC_ASSERT_MSG(std::isalpha(base), "Invalid base read from " << contigMetadata << " : " << base);
+            const char *runEnd = static_cast<const char*>(std::memchr(in, '\r', lineEnd - in));
+            runEnd = in + std::min<std::size_t>((runEnd ? runEnd : lineEnd) - in, outEnd - out);
+            if (!translateBases(in, runEnd, out, acgtBases))
             {
-                ISAAC_ASSERT_MSG(updateIterator < contig.end(), "Trying to update contig past its range " << contig << " " << contigMetadata);
-                *updateIterator = oligo::getBase(translator[base], true);
-                acgtBases += oligo::REFERENCE_OLIGO_N != *updateIterator;
-                ++updateIterator;
+                using common::IoException;
+                using boost::format;
+                const format message = (format("Invalid base read from reference file %s at offset %d for %s") %
+                    contigMetadata.filePath_.string() % (contigMetadata.offset_ + (in - fasta.data())) % contigMetadata);
+                BOOST_THROW_EXCEPTION(IoException(EINVAL, message.str()));
             }
+            out += runEnd - in;
+            in = (lineEnd != runEnd && '\r' == *runEnd) ? runEnd + 1 : runEnd;
         }
+        in = next;
     }
-    if (contigMetadata.totalBases_ != std::size_t(std::distance(contig.begin(), updateIterator)))
+    if (outEnd != out)
     {
         using common::IoException;
         using boost::format;
-        const format message = (format("Failed to read %d bases from reference file % s: %d") % contigMetadata.totalBases_ % contigMetadata.filePath_.string() % contig.getLength());
-        BOOST_THROW_EXCEPTION(IoException(errno, message.str()));
+        const format message = (format("Failed to read %d bases from reference file % s: %d") % contigMetadata.totalBases_ % contigMetadata.filePath_.string() % (out - contigBegin));
+        BOOST_THROW_EXCEPTION(IoException(EINVAL, message.str()));
     }
 
     if (contigMetadata.acgtBases_ != acgtBases)
@@ -74,7 +123,7 @@ void loadContig(
         using boost::format;
         const format message = (format("Failed to read %d ACGT bases from reference file % s: %d") %
             contigMetadata.acgtBases_ % contigMetadata.filePath_.string() % acgtBases);
-        BOOST_THROW_EXCEPTION(IoException(errno, message.str()));
+        BOOST_THROW_EXCEPTION(IoException(EINVAL, message.str()));
     }
 
     //ISAAC_TRACE_STAT("Loaded contig " << contigMetadata << " ");
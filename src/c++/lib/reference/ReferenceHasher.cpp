@@ -35,11 +35,13 @@ template <typename ReferenceHashT>
 ReferenceHasher<ReferenceHashT>::ReferenceHasher (
     const ContigList &contigList,
     common::ThreadVector &threads,
-    const unsigned threadsMax)
+    const unsigned threadsMax,
+    const unsigned minimizerWindow)
     : BaseT(contigList)
     , contigList_(contigList)
     , threads_(threads)
     , threadsMax_(threadsMax)
+    , minimizerWindow_(minimizerWindow)
     , mutexes_(threadsMax_ * 2) // reduce collision probability somewhat
     , threadBuffers_(threadsMax_, ThreadBuffer(mutexes_.capacity()))
 
@@ -58,6 +60,23 @@ ReferenceHasher<ReferenceHashT>::ReferenceHasher (
     }
 }
 
+template <typename ReferenceHashT>
+template <typename CallbackT>
+void ReferenceHasher<ReferenceHashT>::generateKmers(
+    const unsigned threadNumber,
+    const std::size_t threads,
+    const CallbackT &callback) const
+{
+    if (minimizerWindow_)
+    {
+        BaseT::minimizerThread(threadNumber, threads, minimizerWindow_, callback);
+    }
+    else
+    {
+        BaseT::thread(threadNumber, threads, callback);
+    }
+}
+
 template<typename ReferenceHashT>
 void ReferenceHasher<ReferenceHashT>::dumpCounts(
     boost::mutex& mutex, MutexBuffer& buffer, ReferenceHashT& referenceHash)
@@ -102,7 +121,7 @@ void ReferenceHasher<ReferenceHashT>::countKmers(
     const unsigned threadNumber,
     const std::size_t threads)
 {
-    BaseT::thread(
+    generateKmers(
         threadNumber, threads,
         [this, &referenceHash](
             const unsigned threadNumber, const KmerT &kmer, const unsigned contigIndex, const uint64_t kmerPosition, bool reverse)
@@ -160,7 +179,7 @@ void ReferenceHasher<ReferenceHashT>::storePositions(
     const std::size_t threads,
     const ContigList &contigList)
 {
-    BaseT::thread(
+    generateKmers(
         threadNumber, threads,
         [this, &referenceHash, &contigList](
             const unsigned threadNumber, const KmerT &kmer, const unsigned contigIndex, const uint64_t kmerPosition, bool reverse)
@@ -191,6 +210,11 @@ void ReferenceHasher<ReferenceHashT>::sortPositions(
     if (blockBegin < referenceHash.offsets_.size())
     {
         const std::size_t blockEnd = std::min(referenceHash.offsets_.size(), blockBegin + blockLength + 1);
+        if (!threadNumber)
+        {
+            // the loop below starts from the second key. Positions of the first one begin at 0
+            std::sort(referenceHash.positions_.begin(), referenceHash.positions_.begin() + referenceHash.offsets_.front());
+        }
         for (typename Offsets::iterator it = referenceHash.offsets_.begin() + blockBegin + 1;
             referenceHash.offsets_.begin() + blockEnd != it; ++it)
         {
@@ -334,6 +358,7 @@ void ReferenceHasher<ReferenceHashT>::generate(ReferenceHashT &ret)
 {
     ISAAC_TRACE_STAT(
         "Constructing ReferenceHasher: for " << oligo::KmerTraits<KmerT>::KMER_BASES << "-mers ");
+    ret.minimizerWindow_ = minimizerWindow_;
 
     threads_.execute(boost::bind(&ReferenceHasher::countKmers, this, boost::ref(ret), _1, _2), threadsMax_);
 
@@ -351,7 +376,8 @@ void ReferenceHasher<ReferenceHashT>::generate(ReferenceHashT &ret)
         " buckets:" << ret.getBucketCount() <<
         " and " << total <<
         " genome " << oligo::KmerTraits<KmerT>::KMER_BASES <<
-        "-mers "
+        "-mers " <<
+        (minimizerWindow_ ? "(minimizers) " : "") <<
 //        " and " << uniqueKmers <<
         " unique k-mers found " << uniqueKeys << " unique keys. maxUniqueKeys:" << maxUniqueKeys << std::endl;
 
@@ -376,6 +402,7 @@ void ReferenceHasher<ReferenceHashT>::generate(ReferenceHashT &ret)
         }, threadsMax_);
 
     ISAAC_THREAD_CERR << " sorted " << ret.offsets_.back() << " positions" << std::endl;
+    ret.updateView();
 }
 //
 template class ReferenceHasher<ReferenceHash<oligo::VeryShortKmerType> >;
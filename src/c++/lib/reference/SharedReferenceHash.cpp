@@ -0,0 +1,321 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file SharedReferenceHash.cpp
+ **
+ ** Reference hash kept in a POSIX shared memory segment.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <ctime>
+
+#include <boost/format.hpp>
+
+#include "common/Debug.hh"
+#include "common/Numa.hh"
+#include "reference/SharedReferenceHash.hh"
+
+namespace isaac
+{
+namespace reference
+{
+
+namespace sharedReferenceHash
+{
+
+// an incomplete segment changed more recently than this may belong to a builder that has not locked it yet
+static const time_t STALE_SECONDS_MIN = 10;
+static const unsigned OPEN_ATTEMPTS_MAX = 5;
+
+static uint64_t fnv1a(uint64_t hash, const void *data, const std::size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 0x100000001b3UL;
+    }
+    return hash;
+}
+
+template <typename T>
+static uint64_t fnv1a(const uint64_t hash, const T &value)
+{
+    return fnv1a(hash, &value, sizeof(value));
+}
+
+static uint64_t fnv1a(const uint64_t hash, const std::string &value)
+{
+    return fnv1a(fnv1a(hash, value.size()), value.data(), value.size());
+}
+
+} // namespace sharedReferenceHash
+
+sharedReferenceHash::Header SharedReferenceHashSegment::makeHeader(
+    const ContigList &contigList,
+    const SortedReferenceMetadata::Contigs &xmlContigs,
+    const unsigned seedLength,
+    const std::size_t offsetSize,
+    const uint64_t bucketCount,
+    const unsigned minimizerWindow)
+{
+    using sharedReferenceHash::fnv1a;
+    // The bases are identified by the M5 of each contig, see isIdentifiable. Hash positions are offsets
+    // in the linear genome, so the layout of contigList matters as well as the metadata
+    uint64_t checksum = 0xcbf29ce484222325UL;
+    for (const SortedReferenceMetadata::Contig &xmlContig : xmlContigs)
+    {
+        checksum = fnv1a(checksum, xmlContig.name_);
+        checksum = fnv1a(checksum, xmlContig.bamM5_);
+        checksum = fnv1a(checksum, uint64_t(xmlContig.totalBases_));
+        checksum = fnv1a(checksum, uint64_t(xmlContig.acgtBases_));
+    }
+    checksum = fnv1a(checksum, uint64_t(contigList.endOffset()));
+    for (std::size_t contigId = 0; contigId < contigList.size(); ++contigId)
+    {
+        const ContigList::Contig &contig = contigList[contigId];
+        checksum = fnv1a(checksum, uint64_t(contigList.beginOffset(contigId)));
+        checksum = fnv1a(checksum, uint64_t(contig.size()));
+    }
+
+    sharedReferenceHash::Header ret;
+    std::memset(&ret, 0, sizeof(ret));
+    std::memcpy(ret.magic_, sharedReferenceHash::MAGIC, sizeof(ret.magic_));
+    ret.version_ = sharedReferenceHash::VERSION;
+    ret.checksum_ = checksum;
+    ret.seedLength_ = seedLength;
+    ret.offsetSize_ = offsetSize;
+    ret.minimizerWindow_ = minimizerWindow;
+    ret.bucketCount_ = bucketCount;
+    return ret;
+}
+
+bool SharedReferenceHashSegment::isIdentifiable(const SortedReferenceMetadata::Contigs &xmlContigs)
+{
+    return xmlContigs.end() == std::find_if(
+        xmlContigs.begin(), xmlContigs.end(),
+        [](const SortedReferenceMetadata::Contig &xmlContig){return xmlContig.bamM5_.empty();});
+}
+
+SharedReferenceHashSegment::SharedReferenceHashSegment(
+    const ContigList &contigList,
+    const SortedReferenceMetadata::Contigs &xmlContigs,
+    const unsigned seedLength,
+    const std::size_t offsetSize,
+    const uint64_t bucketCount,
+    const unsigned minimizerWindow) :
+        expected_(makeHeader(contigList, xmlContigs, seedLength, offsetSize, bucketCount, minimizerWindow)),
+        // parameters that change the layout are in the name so that different jobs don't contend for one segment
+        name_((boost::format("/isaac-hash-%d-%016x-%d-%d-%d") %
+            ::getuid() % expected_.checksum_ % seedLength % bucketCount % minimizerWindow).str()),
+        fd_(-1), mapping_(0), mappingSize_(0), creator_(false), attached_(false)
+{
+    if (!isIdentifiable(xmlContigs))
+    {
+        ISAAC_THREAD_CERR << "WARNING: reference has contigs without M5. Building private hash" << std::endl;
+    }
+    else if (!open())
+    {
+        ISAAC_THREAD_CERR << "WARNING: shared reference hash " << name_ << " is unavailable. Building private hash" << std::endl;
+    }
+}
+
+SharedReferenceHashSegment::~SharedReferenceHashSegment()
+{
+    unmap();
+    if (-1 != fd_)
+    {
+        if ((creator_ && !attached_) || !::flock(fd_, LOCK_EX | LOCK_NB))
+        {
+            // either the build has not completed or nobody else holds the segment
+            unlink();
+            ISAAC_THREAD_CERR << "Removed shared reference hash " << name_ << std::endl;
+        }
+        ::close(fd_);
+    }
+}
+
+/**
+ * \brief removes the name unless it has already been reused for a different segment
+ */
+void SharedReferenceHashSegment::unlink()
+{
+    const int fd = ::shm_open(name_.c_str(), O_RDONLY, 0);
+    if (-1 != fd)
+    {
+        struct stat named, ours;
+        if (!::fstat(fd, &named) && !::fstat(fd_, &ours) && named.st_ino == ours.st_ino)
+        {
+            ::shm_unlink(name_.c_str());
+        }
+        ::close(fd);
+    }
+}
+
+void SharedReferenceHashSegment::unmap()
+{
+    if (mapping_)
+    {
+        ::munmap(mapping_, mappingSize_);
+        mapping_ = 0;
+        mappingSize_ = 0;
+    }
+}
+
+bool SharedReferenceHashSegment::open()
+{
+    // repeated attempts happen after a stale segment has been removed or a fresh one was found unlocked
+    for (unsigned attempt = 0; attempt < sharedReferenceHash::OPEN_ATTEMPTS_MAX; ++attempt)
+    {
+        fd_ = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+        if (-1 != fd_)
+        {
+            if (-1 == ::flock(fd_, LOCK_EX))
+            {
+                ISAAC_THREAD_CERR << "WARNING: failed to lock " << name_ << ": " << strerror(errno) << std::endl;
+                unlink();
+                ::close(fd_);
+                fd_ = -1;
+                return false;
+            }
+            creator_ = true;
+            ISAAC_THREAD_CERR << "Created shared reference hash " << name_ << std::endl;
+            return true;
+        }
+        if (EEXIST != errno)
+        {
+            ISAAC_THREAD_CERR << "WARNING: failed to create " << name_ << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        fd_ = ::shm_open(name_.c_str(), O_RDONLY, 0);
+        if (-1 == fd_)
+        {
+            if (ENOENT == errno)
+            {
+                // the last user has just removed it
+                continue;
+            }
+            ISAAC_THREAD_CERR << "WARNING: failed to open " << name_ << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        ISAAC_THREAD_CERR << "Waiting for shared reference hash " << name_ << std::endl;
+        struct stat st;
+        if (-1 == ::flock(fd_, LOCK_SH) || -1 == ::fstat(fd_, &st))
+        {
+            ISAAC_THREAD_CERR << "WARNING: failed to lock " << name_ << ": " << strerror(errno) << std::endl;
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+
+        bool ready = false;
+        if (std::size_t(st.st_size) >= sharedReferenceHash::HEADER_SIZE)
+        {
+            void *mapping = ::mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd_, 0);
+            if (MAP_FAILED != mapping)
+            {
+                mapping_ = mapping;
+                mappingSize_ = st.st_size;
+                ready = header().ready_;
+                if (ready && header().sameHash(expected_) &&
+                    mappingSize_ >= sharedReferenceHash::HEADER_SIZE +
+                        (header().bucketCount_ + header().positionsCount_) * header().offsetSize_)
+                {
+                    attached_ = true;
+                    ISAAC_THREAD_CERR << "Attached to shared reference hash " << name_ << " with " <<
+                        header().positionsCount_ << " positions" << std::endl;
+                    return true;
+                }
+                unmap();
+            }
+        }
+
+        if (!ready)
+        {
+            const bool fresh = ::time(0) - st.st_mtime < sharedReferenceHash::STALE_SECONDS_MIN;
+            if (fresh)
+            {
+                ::close(fd_);
+                fd_ = -1;
+                ::sleep(1);
+                continue;
+            }
+            if (!::flock(fd_, LOCK_EX | LOCK_NB))
+            {
+                // the builder is gone and nobody uses the segment
+                unlink();
+                ::close(fd_);
+                fd_ = -1;
+                ISAAC_THREAD_CERR << "Removed stale shared reference hash " << name_ << std::endl;
+                continue;
+            }
+        }
+
+        ISAAC_THREAD_CERR << "WARNING: shared reference hash " << name_ << " does not match the reference" << std::endl;
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    return false;
+}
+
+char *SharedReferenceHashSegment::allocate(const std::size_t dataBytes)
+{
+    ISAAC_ASSERT_MSG(creator_ && !mapping_, "Only the creator can allocate the segment once: " << name_);
+    const std::size_t size = sharedReferenceHash::HEADER_SIZE + dataBytes;
+    // unlike ftruncate, fallocate reports shortage of shared memory now rather than with SIGBUS later
+    const int error = ::posix_fallocate(fd_, 0, size);
+    void *mapping = error ? MAP_FAILED : ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (MAP_FAILED == mapping)
+    {
+        ISAAC_THREAD_CERR << "WARNING: failed to allocate " << size << " bytes for " << name_ << ": " <<
+            strerror(error ? error : errno) << std::endl;
+        unlink();
+        ::close(fd_);
+        fd_ = -1;
+        creator_ = false;
+        return 0;
+    }
+    mapping_ = mapping;
+    mappingSize_ = size;
+    common::numa::numaInterleave(static_cast<char*>(mapping_) + sharedReferenceHash::HEADER_SIZE, dataBytes);
+    return static_cast<char*>(mapping_) + sharedReferenceHash::HEADER_SIZE;
+}
+
+void SharedReferenceHashSegment::seal(
+    const uint64_t a, const uint64_t b, const uint64_t largePrime, const uint64_t positionsCount)
+{
+    sharedReferenceHash::Header &header = *static_cast<sharedReferenceHash::Header*>(mapping_);
+    header = expected_;
+    header.a_ = a;
+    header.b_ = b;
+    header.largePrime_ = largePrime;
+    header.positionsCount_ = positionsCount;
+    header.ready_ = 1;
+    ::mprotect(mapping_, mappingSize_, PROT_READ);
+    // waiting processes get their shared locks once the exclusive one is downgraded
+    ISAAC_VERIFY_MSG(!::flock(fd_, LOCK_SH), "Failed to downgrade lock on " << name_ << ": " << strerror(errno));
+    attached_ = true;
+    ISAAC_THREAD_CERR << "Published shared reference hash " << name_ << " with " << positionsCount << " positions" << std::endl;
+}
+
+} // namespace reference
+} // namespace isaac
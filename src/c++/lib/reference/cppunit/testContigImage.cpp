@@ -0,0 +1,124 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <fstream>
+#include <string>
+
+#include "reference/ContigImage.hh"
+#include "reference/ContigLoader.hh"
+
+using namespace std;
+
+#include "RegistryName.hh"
+#include "testContigImage.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestContigImage, registryName("ContigImage"));
+
+static const std::string CHR1(">chr1\n");
+static const std::string CHR1_BASES("ACGTACGTNNNN\nACGTAC\n");
+static const std::string CHR2(">chr2\n");
+static const std::string CHR2_BASES("GGGGCCCCAAAATTTT\nGG\n");
+
+void TestContigImage::setUp()
+{
+    fastaPath_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("testContigImage-%%%%-%%%%.fa");
+    // karyotype order differs from the fasta order
+    xmlContigs_.clear();
+    xmlContigs_.push_back(isaac::reference::SortedReferenceMetadata::Contig(
+        0, "chr2", false, fastaPath_, CHR1.length() + CHR1_BASES.length() + CHR2.length(), CHR2_BASES.length(), 0, 18, 18, "", "", ""));
+    xmlContigs_.push_back(isaac::reference::SortedReferenceMetadata::Contig(
+        1, "chr1", false, fastaPath_, CHR1.length(), CHR1_BASES.length(), 0, 18, 14, "", "", ""));
+    writeFasta(CHR1 + CHR1_BASES + CHR2 + CHR2_BASES);
+}
+
+void TestContigImage::tearDown()
+{
+    boost::filesystem::remove(isaac::reference::getContigImagePath(fastaPath_));
+    boost::filesystem::remove(fastaPath_);
+}
+
+void TestContigImage::writeFasta(const std::string &fasta)
+{
+    std::ofstream os(fastaPath_.c_str(), std::ios_base::binary);
+    os << fasta;
+    CPPUNIT_ASSERT(os);
+}
+
+std::vector<std::string> TestContigImage::loadFromImage() const
+{
+    const isaac::reference::ContigImages images(xmlContigs_);
+    isaac::reference::ContigList contigList(xmlContigs_, 0);
+    std::vector<std::string> ret;
+    for (const isaac::reference::SortedReferenceMetadata::Contig &xmlContig : xmlContigs_)
+    {
+        isaac::reference::ContigList::UpdateRange range = contigList.getUpdateRange(xmlContig.index_);
+        if (!images.load(xmlContig, range))
+        {
+            return std::vector<std::string>();
+        }
+        ret.push_back(std::string(range.begin(), range.end()));
+    }
+    return ret;
+}
+
+void TestContigImage::testRoundTrip()
+{
+    isaac::reference::ContigList contigList(xmlContigs_, 0);
+    for (const isaac::reference::SortedReferenceMetadata::Contig &xmlContig : xmlContigs_)
+    {
+        isaac::reference::ContigList::UpdateRange range = contigList.getUpdateRange(xmlContig.index_);
+        isaac::reference::loadContig(xmlContig, range);
+    }
+    // no image yet
+    CPPUNIT_ASSERT(loadFromImage().empty());
+
+    isaac::reference::saveContigImage(fastaPath_, xmlContigs_, contigList);
+    const std::vector<std::string> loaded = loadFromImage();
+    CPPUNIT_ASSERT_EQUAL(2UL, loaded.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("GGGGCCCCAAAATTTTGG"), loaded.at(0));
+    CPPUNIT_ASSERT_EQUAL(std::string("ACGTACGTNNNNACGTAC"), loaded.at(1));
+
+    // contig not in the image falls back to fasta
+    isaac::reference::SortedReferenceMetadata::Contig moved = xmlContigs_.at(1);
+    ++moved.offset_;
+    const isaac::reference::ContigImages images(xmlContigs_);
+    isaac::reference::ContigList::UpdateRange range = contigList.getUpdateRange(1);
+    CPPUNIT_ASSERT(!images.load(moved, range));
+}
+
+void TestContigImage::testNoContigs()
+{
+    const isaac::reference::SortedReferenceMetadata::Contigs none;
+    isaac::reference::saveContigImage(fastaPath_, none, isaac::reference::ContigList(none, 0));
+    CPPUNIT_ASSERT(boost::filesystem::exists(isaac::reference::getContigImagePath(fastaPath_)));
+    // the image is valid but has none of the contigs
+    CPPUNIT_ASSERT(loadFromImage().empty());
+}
+
+void TestContigImage::testStale()
+{
+    isaac::reference::ContigList contigList(xmlContigs_, 0);
+    for (const isaac::reference::SortedReferenceMetadata::Contig &xmlContig : xmlContigs_)
+    {
+        isaac::reference::ContigList::UpdateRange range = contigList.getUpdateRange(xmlContig.index_);
+        isaac::reference::loadContig(xmlContig, range);
+    }
+    isaac::reference::saveContigImage(fastaPath_, xmlContigs_, contigList);
+    CPPUNIT_ASSERT(!loadFromImage().empty());
+
+    // fasta replaced after the image got written, but the timestamps don't tell it apart
+    const std::time_t imageTime = boost::filesystem::last_write_time(isaac::reference::getContigImagePath(fastaPath_));
+    writeFasta(CHR1 + CHR1_BASES + CHR2 + CHR2_BASES + CHR2_BASES);
+    boost::filesystem::last_write_time(fastaPath_, imageTime);
+    CPPUNIT_ASSERT(loadFromImage().empty());
+}
@@ -0,0 +1,48 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_REFERENCE_TEST_CONTIG_IMAGE_HH
+#define iSAAC_REFERENCE_TEST_CONTIG_IMAGE_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "reference/SortedReferenceMetadata.hh"
+
+class TestContigImage : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestContigImage );
+    CPPUNIT_TEST( testRoundTrip );
+    CPPUNIT_TEST( testNoContigs );
+    CPPUNIT_TEST( testStale );
+    CPPUNIT_TEST_SUITE_END();
+private:
+    boost::filesystem::path fastaPath_;
+    isaac::reference::SortedReferenceMetadata::Contigs xmlContigs_;
+
+    void writeFasta(const std::string &fasta);
+    /// loads all contigs through ContigImages. Empty list if any of the contigs is not in the image
+    std::vector<std::string> loadFromImage() const;
+
+public:
+    void setUp();
+    void tearDown();
+    void testRoundTrip();
+    void testNoContigs();
+    void testStale();
+};
+
+#endif // #ifndef iSAAC_REFERENCE_TEST_CONTIG_IMAGE_HH
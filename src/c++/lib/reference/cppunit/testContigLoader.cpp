@@ -0,0 +1,151 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <fstream>
+#include <string>
+
+#include "common/Exceptions.hh"
+#include "reference/ContigLoader.hh"
+
+using namespace std;
+
+#include "RegistryName.hh"
+#include "testContigLoader.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestContigLoader, registryName("ContigLoader"));
+
+static const std::string FASTA_HEADER(">chr1 test\n");
+
+void TestContigLoader::setUp()
+{
+    fastaPath_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("testContigLoader-%%%%-%%%%.fa");
+}
+
+void TestContigLoader::tearDown()
+{
+    boost::filesystem::remove(fastaPath_);
+}
+
+std::string TestContigLoader::load(const std::string &fasta, const std::size_t totalBases, const std::size_t acgtBases)
+{
+    {
+        std::ofstream os(fastaPath_.c_str(), std::ios_base::binary);
+        os << FASTA_HEADER << fasta;
+        CPPUNIT_ASSERT(os);
+    }
+
+    const isaac::reference::SortedReferenceMetadata::Contigs xmlContigs(
+        1, isaac::reference::SortedReferenceMetadata::Contig(
+            0, "chr1", false, fastaPath_, FASTA_HEADER.length(), fasta.length(), 0, totalBases, acgtBases, "", "", ""));
+    isaac::reference::ContigList contigList(xmlContigs, 0);
+    isaac::reference::ContigList::UpdateRange range = contigList.getUpdateRange(0);
+    isaac::reference::loadContig(xmlContigs.front(), range);
+    return std::string(range.begin(), range.end());
+}
+
+void TestContigLoader::testTranslateBases()
+{
+    // long enough for the vectorized part and a scalar tail
+    const std::string in ("ACGTacgtNnRYKMswbdhv-ACGTACGTacgtACGTAC");
+    const std::string out("ACGTACGTNNNNNNNNNNNN-ACGTACGTACGTACGTAC");
+    std::size_t acgtBases = 0;
+    std::string translated(in.length(), 0);
+
+    CPPUNIT_ASSERT(isaac::reference::translateBases(&in[0], &in[20], &translated[0], acgtBases));
+    CPPUNIT_ASSERT_EQUAL(out.substr(0, 20), translated.substr(0, 20));
+    CPPUNIT_ASSERT_EQUAL(8UL, acgtBases);
+
+    acgtBases = 0;
+    CPPUNIT_ASSERT(isaac::reference::translateBases(&in[21], &in[0] + in.length(), &translated[21], acgtBases));
+    CPPUNIT_ASSERT_EQUAL(out.substr(21), translated.substr(21));
+    CPPUNIT_ASSERT_EQUAL(in.length() - 21, acgtBases);
+
+    // non-letters are reported both in the vectorized part and in the tail
+    CPPUNIT_ASSERT(!isaac::reference::translateBases(&in[0], &in[0] + in.length(), &translated[0], acgtBases));
+    CPPUNIT_ASSERT(!isaac::reference::translateBases(&in[5], &in[0] + 22, &translated[0], acgtBases));
+    const std::string digit("ACGT1");
+    CPPUNIT_ASSERT(!isaac::reference::translateBases(&digit[0], &digit[0] + digit.length(), &translated[0], acgtBases));
+    const std::string bracket("ACGTACGTACGTACG[");
+    CPPUNIT_ASSERT(!isaac::reference::translateBases(&bracket[0], &bracket[0] + bracket.length(), &translated[0], acgtBases));
+
+    acgtBases = 0;
+    CPPUNIT_ASSERT(isaac::reference::translateBases(&in[0], &in[0], &translated[0], acgtBases));
+    CPPUNIT_ASSERT_EQUAL(0UL, acgtBases);
+}
+
+void TestContigLoader::testLoadContig()
+{
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("ACGTNACGTACGTACGTACGTACGTNNNNACGTACGTACGTACGTACGTACGTACGT"),
+        load("ACGTnacgtACGTACGTACGTACGTNNNN\n"
+             "ACGTACGTACGTACGTACGTACGTACGT\n", 57, 52));
+
+    // loading stops at the contig length and ignores what follows, last line without a newline
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("ACGTACGTAC"),
+        load("ACGTA\nCGTAC\n>chr2\nGGGG", 10, 10));
+    CPPUNIT_ASSERT_EQUAL(std::string("ACGTACGTAC"), load("ACGTA\nCGTAC", 10, 10));
+}
+
+void TestContigLoader::testLoadContigCrLf()
+{
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("ACGTACGTACGTACGTACGTACGTAAAAAAAAAAAAAAAAAAAAAAAAAAAA"),
+        load("ACGTACGTACGTACGTACGTACGT\r\n"
+             "AAAAAAAAAAAAAAAAAAAAAAAAAAAA\r\n", 52, 52));
+
+    // stray carriage returns in the middle of a line and blank lines are skipped too
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("ACGTACGTACGTACGTACGTACGTACGTACGT"),
+        load("ACGTACGT\rACGTACGTACGTACGT\r\r\n"
+             "\r\n"
+             "\n"
+             "ACGT\rACGT\r\n", 32, 32));
+}
+
+void TestContigLoader::testLoadContigErrors()
+{
+    // not a base
+    CPPUNIT_ASSERT_THROW(load("ACGTACGT ACGT\n", 12, 12), isaac::common::IoException);
+    // file ends before the contig does
+    CPPUNIT_ASSERT_THROW(load("ACGTACGT\n", 12, 8), isaac::common::IoException);
+    // acgt count does not match the metadata
+    CPPUNIT_ASSERT_THROW(load("ACGTNCGT\n", 8, 8), isaac::common::IoException);
+}
+
+void TestContigLoader::testLoadContigRange()
+{
+    // the second contig starts past the first page, so its mapping has to start at the page boundary below it
+    const std::string header(">chr1 " + std::string(5000, 'x') + "\n");
+    const std::string chr1("ACGTACGTAC\nGTAC\n");
+    const std::string chr2Header(">chr2\n");
+    const std::string chr2("GGGGCCCC\nTTTT\n");
+    {
+        std::ofstream os(fastaPath_.c_str(), std::ios_base::binary);
+        os << header << chr1 << chr2Header << chr2 << ">chr3\nAAAA\n";
+        CPPUNIT_ASSERT(os);
+    }
+
+    const std::size_t chr2Offset = header.length() + chr1.length() + chr2Header.length();
+    isaac::reference::SortedReferenceMetadata::Contigs xmlContigs(
+        1, isaac::reference::SortedReferenceMetadata::Contig(
+            0, "chr2", false, fastaPath_, chr2Offset, chr2.length(), 0, 12, 12, "", "", ""));
+    isaac::reference::ContigList contigList(xmlContigs, 0);
+    isaac::reference::ContigList::UpdateRange range = contigList.getUpdateRange(0);
+    isaac::reference::loadContig(xmlContigs.front(), range);
+    CPPUNIT_ASSERT_EQUAL(std::string("GGGGCCCCTTTT"), std::string(range.begin(), range.end()));
+
+    // the bases past the contig size are not there for the loader to find
+    xmlContigs.front().size_ = chr2.length() - 4;
+    CPPUNIT_ASSERT_THROW(isaac::reference::loadContig(xmlContigs.front(), range), isaac::common::IoException);
+}
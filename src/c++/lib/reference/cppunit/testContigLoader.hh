@@ -0,0 +1,48 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_REFERENCE_TEST_CONTIG_LOADER_HH
+#define iSAAC_REFERENCE_TEST_CONTIG_LOADER_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+class TestContigLoader : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestContigLoader );
+    CPPUNIT_TEST( testTranslateBases );
+    CPPUNIT_TEST( testLoadContig );
+    CPPUNIT_TEST( testLoadContigCrLf );
+    CPPUNIT_TEST( testLoadContigErrors );
+    CPPUNIT_TEST( testLoadContigRange );
+    CPPUNIT_TEST_SUITE_END();
+private:
+    boost::filesystem::path fastaPath_;
+
+    /// writes the fasta and loads its only contig expecting totalBases and acgtBases
+    std::string load(const std::string &fasta, const std::size_t totalBases, const std::size_t acgtBases);
+
+public:
+    void setUp();
+    void tearDown();
+    void testTranslateBases();
+    void testLoadContig();
+    void testLoadContigCrLf();
+    void testLoadContigErrors();
+    void testLoadContigRange();
+};
+
+#endif // #ifndef iSAAC_REFERENCE_TEST_CONTIG_LOADER_HH
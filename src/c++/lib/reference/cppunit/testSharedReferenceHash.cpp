@@ -0,0 +1,146 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "common/Exceptions.hh"
+#include "oligo/Kmer.hh"
+#include "reference/SharedReferenceHash.hh"
+
+using namespace std;
+
+#include "RegistryName.hh"
+#include "testSharedReferenceHash.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestSharedReferenceHash, registryName("SharedReferenceHash"));
+
+typedef isaac::reference::ReferenceHash<isaac::oligo::ShortKmerType> ReferenceHash;
+
+static const unsigned SEED_LENGTH = 16;
+static const unsigned MINIMIZER_WINDOW = 0;
+
+// 4 buckets over 6 positions
+static const ReferenceHash::Offset OFFSETS[] = {1, 1, 4, 6};
+static const ReferenceHash::Offset POSITIONS[] = {7, 0, 2, 9, 3, 5};
+
+static ReferenceHash makeHash(const unsigned bucketCount)
+{
+    ReferenceHash view(11, 13, 17, bucketCount, MINIMIZER_WINDOW, OFFSETS, POSITIONS, sizeof(POSITIONS) / sizeof(POSITIONS[0]));
+    // the copy owns its data the way a freshly built hash does
+    return ReferenceHash(view, std::allocator<void>());
+}
+
+static void checkHash(const ReferenceHash &hash)
+{
+    CPPUNIT_ASSERT_EQUAL(11UL, hash.getA());
+    CPPUNIT_ASSERT_EQUAL(13UL, hash.getB());
+    CPPUNIT_ASSERT_EQUAL(17UL, hash.getLargePrime());
+    CPPUNIT_ASSERT_EQUAL(sizeof(POSITIONS) / sizeof(POSITIONS[0]), hash.getPositionsCount());
+    CPPUNIT_ASSERT(std::equal(OFFSETS, OFFSETS + hash.getBucketCount(), hash.offsetsData()));
+    CPPUNIT_ASSERT(std::equal(POSITIONS, POSITIONS + hash.getPositionsCount(), hash.positionsData()));
+}
+
+void TestSharedReferenceHash::setUp()
+{
+    xmlContigs_.clear();
+    xmlContigs_.push_back(isaac::reference::SortedReferenceMetadata::Contig(
+        0, "chr1", false, "chr1.fa", 6, 10, 0, 10, 10, "", "", "0123456789abcdef0123456789abcdef"));
+    // segment names are per user. Keep concurrent runs of the test apart
+    xmlContigs_.front().name_ += std::to_string(::getpid());
+    bucketCount_ = sizeof(OFFSETS) / sizeof(OFFSETS[0]);
+}
+
+void TestSharedReferenceHash::tearDown()
+{
+}
+
+void TestSharedReferenceHash::testAttach()
+{
+    const isaac::reference::ContigList contigList(xmlContigs_, 0);
+    isaac::reference::SharedReferenceHashSegment creator(
+        contigList, xmlContigs_, SEED_LENGTH, sizeof(ReferenceHash::Offset), bucketCount_, MINIMIZER_WINDOW);
+    CPPUNIT_ASSERT(creator.isCreator());
+    CPPUNIT_ASSERT(!creator.isAttached());
+
+    unsigned builds = 0;
+    const ReferenceHash created = isaac::reference::getSharedReferenceHash<ReferenceHash>(
+        creator, [&builds, this](){++builds; return makeHash(bucketCount_);});
+    CPPUNIT_ASSERT_EQUAL(1U, builds);
+    CPPUNIT_ASSERT(creator.isAttached());
+    // the hash reads the segment rather than a private copy
+    CPPUNIT_ASSERT(creator.data() == reinterpret_cast<const char*>(created.offsetsData()));
+    checkHash(created);
+
+    // second user attaches without building
+    isaac::reference::SharedReferenceHashSegment user(
+        contigList, xmlContigs_, SEED_LENGTH, sizeof(ReferenceHash::Offset), bucketCount_, MINIMIZER_WINDOW);
+    CPPUNIT_ASSERT(user.isAttached());
+    CPPUNIT_ASSERT(!user.isCreator());
+    const ReferenceHash attached = isaac::reference::getSharedReferenceHash<ReferenceHash>(
+        user, [&builds, this](){++builds; return makeHash(bucketCount_);});
+    CPPUNIT_ASSERT_EQUAL(1U, builds);
+    checkHash(attached);
+}
+
+void TestSharedReferenceHash::testValidate()
+{
+    const isaac::reference::ContigList contigList(xmlContigs_, 0);
+    isaac::reference::SharedReferenceHashSegment creator(
+        contigList, xmlContigs_, SEED_LENGTH, sizeof(ReferenceHash::Offset), bucketCount_, MINIMIZER_WINDOW);
+    CPPUNIT_ASSERT(creator.isCreator());
+    isaac::reference::getSharedReferenceHash<ReferenceHash>(creator, [this](){return makeHash(bucketCount_);});
+
+    // offset size is not in the segment name, so the segment is found but does not match the header
+    isaac::reference::SharedReferenceHashSegment narrow(
+        contigList, xmlContigs_, SEED_LENGTH, sizeof(ReferenceHash::Offset) * 2, bucketCount_, MINIMIZER_WINDOW);
+    CPPUNIT_ASSERT(!narrow.isAttached());
+    CPPUNIT_ASSERT(!narrow.isCreator());
+}
+
+void TestSharedReferenceHash::testFallback()
+{
+    xmlContigs_.front().bamM5_.clear();
+    const isaac::reference::ContigList contigList(xmlContigs_, 0);
+    isaac::reference::SharedReferenceHashSegment segment(
+        contigList, xmlContigs_, SEED_LENGTH, sizeof(ReferenceHash::Offset), bucketCount_, MINIMIZER_WINDOW);
+    CPPUNIT_ASSERT(!segment.isAttached());
+    CPPUNIT_ASSERT(!segment.isCreator());
+
+    unsigned builds = 0;
+    const ReferenceHash hash = isaac::reference::getSharedReferenceHash<ReferenceHash>(
+        segment, [&builds, this](){++builds; return makeHash(bucketCount_);});
+    CPPUNIT_ASSERT_EQUAL(1U, builds);
+    checkHash(hash);
+}
+
+void TestSharedReferenceHash::testAbandoned()
+{
+    const isaac::reference::ContigList contigList(xmlContigs_, 0);
+    {
+        // creator that never publishes removes the segment
+        isaac::reference::SharedReferenceHashSegment creator(
+            contigList, xmlContigs_, SEED_LENGTH, sizeof(ReferenceHash::Offset), bucketCount_, MINIMIZER_WINDOW);
+        CPPUNIT_ASSERT(creator.isCreator());
+    }
+    isaac::reference::SharedReferenceHashSegment next(
+        contigList, xmlContigs_, SEED_LENGTH, sizeof(ReferenceHash::Offset), bucketCount_, MINIMIZER_WINDOW);
+    CPPUNIT_ASSERT(next.isCreator());
+}
+
+void TestSharedReferenceHash::testNoBuckets()
+{
+    CPPUNIT_ASSERT_THROW(ReferenceHash(0), isaac::common::InvalidParameterException);
+}
@@ -0,0 +1,44 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_REFERENCE_TEST_SHARED_REFERENCE_HASH_HH
+#define iSAAC_REFERENCE_TEST_SHARED_REFERENCE_HASH_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "reference/SortedReferenceMetadata.hh"
+
+class TestSharedReferenceHash : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestSharedReferenceHash );
+    CPPUNIT_TEST( testAttach );
+    CPPUNIT_TEST( testValidate );
+    CPPUNIT_TEST( testFallback );
+    CPPUNIT_TEST( testAbandoned );
+    CPPUNIT_TEST( testNoBuckets );
+    CPPUNIT_TEST_SUITE_END();
+private:
+    isaac::reference::SortedReferenceMetadata::Contigs xmlContigs_;
+    unsigned bucketCount_;
+
+public:
+    void setUp();
+    void tearDown();
+    void testAttach();
+    void testValidate();
+    void testFallback();
+    void testAbandoned();
+    void testNoBuckets();
+};
+
+#endif // #ifndef iSAAC_REFERENCE_TEST_SHARED_REFERENCE_HASH_HH
@@ -0,0 +1,189 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#include <boost/assign/list_of.hpp>
+
+#include "flowcell/Layout.hh"
+#include "rta/BclMapper.hh"
+
+using namespace std;
+
+#include "RegistryName.hh"
+#include "testBclMapper.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestBclMapper, registryName("BclMapper"));
+
+namespace
+{
+
+class TestableBclMapper : public isaac::rta::BclMapper
+{
+public:
+    TestableBclMapper(const unsigned cycles, const unsigned clusters) : BclMapper(cycles, clusters)
+    {
+        setGeometry(cycles, clusters);
+    }
+
+    using BclMapper::getCycleBufferStart;
+    using BclMapper::getClusterOffset;
+    using BclMapper::transposeClusters;
+};
+
+// distinct for every cycle and cluster within the tile sizes used here
+char bclByte(const unsigned cycle, const unsigned cluster)
+{
+    return char(cycle * 31 + cluster * 7 + cluster / 256);
+}
+
+/// generates the tile data instead of reading it from the cycle files
+class GeneratedTileReader
+{
+public:
+    bool mapTileCycle(
+        const isaac::flowcell::Layout &, const isaac::flowcell::TileMetadata &, const unsigned,
+        isaac::io::MappedFile &) const
+    {
+        return false;
+    }
+
+    unsigned readTileCycle(
+        const isaac::flowcell::Layout &, const isaac::flowcell::TileMetadata &tile, const unsigned cycle,
+        char *cycleBuffer, const std::size_t)
+    {
+        const unsigned clusters = tile.getClusterCount();
+        std::memcpy(cycleBuffer, &clusters, sizeof(clusters));
+        for (unsigned cluster = 0; clusters != cluster; ++cluster)
+        {
+            cycleBuffer[sizeof(clusters) + cluster] = bclByte(cycle, cluster);
+        }
+        return clusters;
+    }
+};
+
+} // namespace
+
+void TestBclMapper::setUp()
+{
+}
+
+void TestBclMapper::tearDown()
+{
+}
+
+void TestBclMapper::testTranspose16x16()
+{
+#ifdef __SSE2__
+    static const unsigned CLUSTERS = 40;
+    static const unsigned OFFSET = 5;
+    static const unsigned OUT_STRIDE = 19;
+    std::vector<std::vector<char> > cycleData(16, std::vector<char>(CLUSTERS));
+    std::vector<const char *> cycles;
+    for (unsigned cycle = 0; cycleData.size() != cycle; ++cycle)
+    {
+        for (unsigned cluster = 0; CLUSTERS != cluster; ++cluster)
+        {
+            cycleData[cycle][cluster] = bclByte(cycle, cluster);
+        }
+        cycles.push_back(&cycleData[cycle].front());
+    }
+
+    std::vector<char> out(16 * OUT_STRIDE, '#');
+    isaac::rta::BclMapperDetails::transpose16x16(&cycles.front(), OFFSET, &out.front(), OUT_STRIDE);
+
+    for (unsigned cluster = 0; 16 != cluster; ++cluster)
+    {
+        for (unsigned cycle = 0; 16 != cycle; ++cycle)
+        {
+            CPPUNIT_ASSERT_EQUAL(cycleData[cycle][OFFSET + cluster], out[cluster * OUT_STRIDE + cycle]);
+        }
+        // bytes between the output records are not touched
+        for (unsigned gap = 16; OUT_STRIDE != gap; ++gap)
+        {
+            CPPUNIT_ASSERT_EQUAL('#', out[cluster * OUT_STRIDE + gap]);
+        }
+    }
+#endif // __SSE2__
+}
+
+void TestBclMapper::checkTransposeClusters(const unsigned cycles, const unsigned clusters)
+{
+    TestableBclMapper mapper(cycles, clusters);
+    for (unsigned cycle = 0; cycles != cycle; ++cycle)
+    {
+        char *bcl = mapper.getCycleBufferStart(cycle);
+        for (unsigned cluster = 0; clusters != cluster; ++cluster)
+        {
+            bcl[mapper.getClusterOffset(cluster)] = bclByte(cycle, cluster);
+        }
+    }
+
+    std::vector<char> expected;
+    for (unsigned cluster = 0; clusters != cluster; ++cluster)
+    {
+        mapper.get(cluster, std::back_inserter(expected));
+    }
+
+    std::vector<char> transposed(std::size_t(cycles) * clusters);
+    mapper.transposeClusters(0, clusters, &transposed.front());
+    CPPUNIT_ASSERT(expected == transposed);
+
+    // a chunk starting in the middle of the tile, the way threads split it
+    const unsigned chunkBegin = clusters / 3;
+    std::vector<char> chunk(std::size_t(cycles) * (clusters - chunkBegin));
+    mapper.transposeClusters(chunkBegin, clusters, &chunk.front());
+    CPPUNIT_ASSERT(std::equal(chunk.begin(), chunk.end(), expected.begin() + std::size_t(cycles) * chunkBegin));
+}
+
+void TestBclMapper::testTransposeClusters()
+{
+    // full 16x16 tiles only
+    checkTransposeClusters(32, 2048);
+    // partial cycle group, partial cluster tile and partial transposition block
+    checkTransposeClusters(37, 2100);
+    // fewer cycles and clusters than a single tile
+    checkTransposeClusters(5, 11);
+}
+
+void TestBclMapper::testMapTransposeTile()
+{
+    // 37 cycles leave a partial cycle group, 40000 clusters a partial transposition chunk
+    static const unsigned CLUSTERS = 40000;
+    const isaac::flowcell::ReadMetadataList readMetadataList = boost::assign::list_of
+        (isaac::flowcell::ReadMetadata(1, 20, 0, 0))
+        (isaac::flowcell::ReadMetadata(21, 37, 1, 20));
+    const isaac::flowcell::Layout flowcell(
+        "", isaac::flowcell::Layout::Fastq, isaac::flowcell::FastqFlowcellData(false, '!', false), 8, 0,
+        std::vector<unsigned>(), readMetadataList, "blah");
+    const isaac::flowcell::TileMetadata tile("blah", 0, 1, 1, CLUSTERS, 0);
+
+    // fewer loaders than threads, so that some threads only transpose
+    isaac::common::ThreadVector threads(4);
+    std::vector<GeneratedTileReader> readers(threads.size());
+    isaac::rta::ParallelBclMapper<GeneratedTileReader> mapper(37, threads, readers, 2, CLUSTERS);
+
+    std::vector<char> transposed(std::size_t(37) * CLUSTERS, '#');
+    mapper.mapTransposeTile(flowcell, tile, transposed.begin());
+
+    for (unsigned cluster = 0; CLUSTERS != cluster; ++cluster)
+    {
+        for (unsigned cycleIndex = 0; 37 != cycleIndex; ++cycleIndex)
+        {
+            // cycle numbers are 1-based
+            CPPUNIT_ASSERT_EQUAL(bclByte(cycleIndex + 1, cluster), transposed[std::size_t(cluster) * 37 + cycleIndex]);
+        }
+    }
+}
@@ -0,0 +1,37 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_RTA_TEST_BCL_MAPPER_HH
+#define iSAAC_RTA_TEST_BCL_MAPPER_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class TestBclMapper : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestBclMapper );
+    CPPUNIT_TEST( testTranspose16x16 );
+    CPPUNIT_TEST( testTransposeClusters );
+    CPPUNIT_TEST( testMapTransposeTile );
+    CPPUNIT_TEST_SUITE_END();
+private:
+    /// compares the blocked transposition against per-cluster extraction for the tile geometry
+    void checkTransposeClusters(const unsigned cycles, const unsigned clusters);
+public:
+    void setUp();
+    void tearDown();
+    void testTranspose16x16();
+    void testTransposeClusters();
+    void testMapTransposeTile();
+};
+
+#endif // #ifndef iSAAC_RTA_TEST_BCL_MAPPER_HH
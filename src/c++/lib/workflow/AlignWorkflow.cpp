@@ -151,7 +151,13 @@ AlignWorkflow::AlignWorkflow(
     const boost::array<char, 256> &fullBclQScoreTable,
     const OptionalFeatures optionalFeatures,
     const bool pessimisticMapQ,
-    const unsigned detectTemplateBlockSize)
+    const unsigned detectTemplateBlockSize,
+    const unsigned seedMatchCacheSize,
+    const bool adaptiveSeeds,
+    const unsigned minimizerWindow,
+    const bool sharedReferenceHash,
+    const unsigned traceSlowestClusters,
+    const unsigned progressInterval)
     : argv_(argv)
     , description_(description)
     , hashTableBucketCount_(hashTableBucketCount)
@@ -249,6 +255,11 @@ AlignWorkflow::AlignWorkflow(
     , foundMatchesMetadata_(tempDirectory_, barcodeMetadataList_, 0, sortedReferenceMetadataList_)
     , barcodeTemplateLengthStatistics_(barcodeMetadataList_.size())
     , detectTemplateBlockSize_(detectTemplateBlockSize)
+    , seedMatchCacheSize_(seedMatchCacheSize)
+    , adaptiveSeeds_(adaptiveSeeds)
+    , minimizerWindow_(minimizerWindow)
+    , sharedReferenceHash_(sharedReferenceHash)
+    , traceSlowestClusters_(traceSlowestClusters)
 {
     ISAAC_THREAD_CERR << "Aligner: expectedCoverage_ " << expectedCoverage_ << std::endl;
     ISAAC_THREAD_CERR << "Aligner: estimatedFragmentSize_ " << estimatedFragmentSize_ << std::endl;
@@ -259,6 +270,7 @@ AlignWorkflow::AlignWorkflow(
     const std::vector<bfs::path> createList = boost::assign::list_of
         (tempDirectory_)(outputDirectory)(statsDirectory_)(reportsDirectory_)(projectsDirectory_);
     common::createDirectories(createList);
+    progressFile_.reset(new common::metrics::ProgressFile(statsDirectory_ / "Progress.json", progressInterval));
 
     BOOST_FOREACH(const flowcell::Layout &layout, flowcellLayoutList)
     {
@@ -337,7 +349,12 @@ void AlignWorkflow::findMatches(
         preSortBins_,
         preAllocateBins_,
         binRegexString_,
-        detectTemplateBlockSize_);
+        detectTemplateBlockSize_,
+        seedMatchCacheSize_,
+        adaptiveSeeds_,
+        minimizerWindow_,
+        sharedReferenceHash_,
+        traceSlowestClusters_);
 
     findMatchesTransition.perform(seedLength_, foundMatches, binMetadataList, barcodeTemplateLengthStatistics, matchSelectorStatsXmlPath_);
 }
@@ -447,9 +464,33 @@ AlignWorkflow::State AlignWorkflow::getNextState() const
     }
 }
 
+static const char *getStateName(const AlignWorkflow::State state)
+{
+    switch (state)
+    {
+    case AlignWorkflow::Start:
+        return "Start";
+    case AlignWorkflow::AlignDone:
+        return "AlignDone";
+    case AlignWorkflow::AlignmentReportsDone:
+        return "AlignmentReportsDone";
+    case AlignWorkflow::BamDone:
+        return "BamDone";
+    default:
+        ISAAC_ASSERT_MSG(false, "Invalid state value " << state);
+        return 0;
+    }
+}
+
 AlignWorkflow::State AlignWorkflow::step()
 {
     using std::swap;
+    const bool measured = Finish != state_;
+    if (measured)
+    {
+        stageLog_.begin(getStateName(getNextState()));
+        progressFile_->beginStage(getStateName(getNextState()));
+    }
     switch (state_)
     {
     case Start:
@@ -481,6 +522,11 @@ AlignWorkflow::State AlignWorkflow::step()
         break;
     }
     }
+    if (measured)
+    {
+        stageLog_.end();
+        stageLog_.dumpJson(statsDirectory_ / "WorkflowMetrics.json");
+    }
     return state_;
 }
 
@@ -35,11 +35,13 @@ ReorderReferenceWorkflow::ReorderReferenceWorkflow(
     const bfs::path &sortedReferenceMetadata,
     const bfs::path &newXmlPath,
     const bfs::path &newDataFileDirectory,
-    const std::vector<std::string> &newOrder
+    const std::vector<std::string> &newOrder,
+    const bool contigImage
     )
     : sortedReferenceMetadata_(sortedReferenceMetadata),
       newXmlPath_(newXmlPath),
       newDataFileDirectory_(newDataFileDirectory),
+      contigImage_(contigImage),
       xml_(reference::loadReferenceMetadataFromXml(sortedReferenceMetadata_))
 {
     const reference::SortedReferenceMetadata::Contigs &contigs = xml_.getContigs();
@@ -160,8 +162,31 @@ void ReorderReferenceWorkflow::run()
             [](const reference::SortedReferenceMetadata::Contig &left,
                     const reference::SortedReferenceMetadata::Contig &right){return left.index_ < right.index_;});
 
+    ofs.close();
+    if (!ofs)
+    {
+        BOOST_THROW_EXCEPTION(isaac::common::IoException(errno, "Failed to close output file: " + targetPath.string()));
+    }
+
+    if (contigImage_)
+    {
+        saveContigImage(targetPath);
+    }
+
     saveSortedReferenceXml(xmlOs, xml_);
 }
 
+void ReorderReferenceWorkflow::saveContigImage(const bfs::path &targetPath) const
+{
+    const reference::SortedReferenceMetadata::Contigs &contigs = xml_.getContigs();
+    // make sure the bases come from the new fasta and not from a stale image
+    bfs::remove(reference::getContigImagePath(targetPath));
+    // translation is cpu-bound, use all cores
+    common::ThreadVector threads(boost::thread::hardware_concurrency());
+    const reference::ContigList contigList = reference::loadContigs(
+        contigs, 0, [](const reference::SortedReferenceMetadata::Contig &){return true;}, threads);
+    reference::saveContigImage(targetPath, contigs, contigList);
+}
+
 } // namespace workflow
 } // namespace isaac
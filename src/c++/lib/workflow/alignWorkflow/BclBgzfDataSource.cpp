@@ -234,7 +234,8 @@ void BclBgzfBaseCallsSource::loadClusters(
         currentLaneNumber_ = tileMetadata.getLane();
     }
 
-    bclMapper_.mapTile(flowcell_, tileMetadata);
+    // the cycles are decompressed on the whole pool and transposed straight into bclData as they complete
+    bclMapper_.mapTransposeTile(flowcell_, tileMetadata, bclData.addMoreClusters(tileMetadata.getClusterCount()));
     ISAAC_THREAD_CERR << "Loading Bcl data done for " << tileMetadata << std::endl;
 
     ISAAC_THREAD_CERR << "Loading Filter data for " << tileMetadata << std::endl;
@@ -263,10 +264,7 @@ void BclBgzfBaseCallsSource::loadClusters(
         ISAAC_THREAD_CERR << "Loading Positions data done for " << tileMetadata << std::endl;
     }
 
-    // bclToClusters mainly does transposition of bcl cycles to clusters which is a non-io operation.
-    // However, the amount of CPU required is relatively low, and occurs on a single thread.
-    // Avoid locking all the cores for the duration of this...
-    // Also, bclMapper_ and filtersMapper_ are shared between the threads at the moment.
+    // filtersMapper_ and the positions mappers are shared between the threads at the moment.
     bclToClusters(tileMetadata, bclData, boolUseLocsPositions);
 }
 
@@ -285,11 +283,6 @@ void BclBgzfBaseCallsSource::bclToClusters(
     const bool useLocsPositions) const
 {
 
-    ISAAC_THREAD_CERR << "Transposing Bcl data for " << tileMetadata.getClusterCount() << " bcl clusters" << std::endl;
-    const clock_t startTranspose = clock();
-    bclMapper_.transpose(bclData.addMoreClusters(tileMetadata.getClusterCount()));
-    ISAAC_THREAD_CERR << "Transposing Bcl data done for " << bclData.getClusterCount() << " bcl clusters in " << (clock() - startTranspose) / 1000 << "ms" << std::endl;
-
     ISAAC_THREAD_CERR << "Extracting Pf values for " << tileMetadata.getClusterCount() << " bcl clusters" << std::endl;
     // gcc 4.4 has trouble figuring out which assignment implementation to use with back insert iterators
     filtersMapper_.getPf(std::back_inserter(bclData.pf()));
@@ -17,6 +17,7 @@
  ** \author Roman Petrovski
  **/
 
+#include "demultiplexing/BarcodeLoader.hh"
 #include "workflow/alignWorkflow/FastqDataSource.hh"
 
 namespace isaac
@@ -44,7 +45,29 @@ void FastqBaseCallsSource::generateAllFilePaths()
                 flowcell::FastqFilePathAttributeTag>(lane, fastqFlowcellLayout_.getReadMetadataList().at(1).getNumber());
             lanePaths_.at(lane) = std::make_pair(read1Path, read2Path);
         }
+
+        laneIndexPaths_.resize(lanePaths_.size());
+        for (unsigned index = 1; indexMetadataList_.size() >= index; ++index)
+        {
+            laneIndexPaths_.at(lane).push_back(fastqFlowcellLayout_.getLaneReadAttribute<flowcell::Layout::Fastq,
+                flowcell::FastqIndexFilePathAttributeTag>(lane, index));
+        }
+    }
+}
+
+static flowcell::ReadMetadataList makeIndexMetadataList(const flowcell::Layout &fastqFlowcellLayout)
+{
+    flowcell::ReadMetadataList ret;
+    if (!fastqFlowcellLayout.getAttribute<flowcell::Layout::Fastq, flowcell::FastqIndexInReadName>())
+    {
+        unsigned offset = 0;
+        for (const unsigned indexLength : fastqFlowcellLayout.getAttribute<flowcell::Layout::Fastq, flowcell::FastqIndexLengths>())
+        {
+            ret.push_back(flowcell::ReadMetadata(1, indexLength, ret.size(), offset));
+            offset += indexLength;
+        }
     }
+    return ret;
 }
 
 FastqBaseCallsSource::FastqBaseCallsSource(
@@ -61,7 +84,10 @@ FastqBaseCallsSource::FastqBaseCallsSource(
         loadingClusters_(clusterLength_),
         lanes_(fastqFlowcellLayout.getLaneIds()),
         loadingLaneIterator_(lanes_.begin()),
-        fastqLoader_(fastqFlowcellLayout_.getAttribute<flowcell::Layout::Fastq, flowcell::FastqVariableLengthOk>(), 0, threads, coresMax_)
+        indexMetadataList_(makeIndexMetadataList(fastqFlowcellLayout_)),
+        nameIndexLength_(indexMetadataList_.empty() ? fastqFlowcellLayout_.getBarcodeLength() : 0),
+        fastqLoader_(fastqFlowcellLayout_.getAttribute<flowcell::Layout::Fastq, flowcell::FastqVariableLengthOk>(), 0, threads, coresMax_,
+                     1 != fastqFlowcellLayout_.getReadMetadataList().size(), indexMetadataList_.size())
 {
     loadedClusters_.reset(clusterLength_, tileClustersMax_);
     // reserve space.
@@ -96,6 +122,11 @@ void FastqBaseCallsSource::reopenFastq(
         // this will keep the current files open if the paths don't change
         fastqLoader.open(lanePaths_.at(lane).first, lanePaths_.at(lane).second, fastqFlowcellLayout.getAttribute<flowcell::Layout::Fastq, flowcell::FastqBaseQ0>());
     }
+
+    for (unsigned index = 0; laneIndexPaths_.at(lane).size() > index; ++index)
+    {
+        fastqLoader.openIndex(index, laneIndexPaths_.at(lane).at(index), fastqFlowcellLayout.getAttribute<flowcell::Layout::Fastq, flowcell::FastqBaseQ0>());
+    }
 }
 
 void FastqBaseCallsSource::loadNextTile()
@@ -112,7 +143,8 @@ void FastqBaseCallsSource::loadNextTile()
         ISAAC_THREAD_CERR<< "Resetting Fastq data done for " << loadingClusters_.getClusterCount() << " clusters" << std::endl;
         // load clusters, return tile breakdown based on tileClustersMax_
         clustersLoaded = fastqLoader_.loadClusters(tileClustersMax_, fastqFlowcellLayout_.getReadNameLength(),
-                                                   fastqFlowcellLayout_.getReadMetadataList(), loadingClusters_.cluster(0));
+                                                   fastqFlowcellLayout_.getReadMetadataList(),
+                                                   indexMetadataList_, nameIndexLength_, loadingClusters_.cluster(0));
         ISAAC_THREAD_CERR<< "Loaded  " << clustersLoaded << " clusters of length " << clusterLength_ << std::endl;
         if (!clustersLoaded)
         {
@@ -196,6 +228,40 @@ flowcell::TileMetadataList FastqBaseCallsSource::discoverTiles()
     return ret;
 }
 
+/**
+ * \brief The barcodes of the loaded tile are already in loadedClusters_. They were read in the same pass as the
+ *        data reads, either from the index files or from the read names.
+ */
+void FastqBaseCallsSource::loadBarcodes(
+    const flowcell::Layout &flowcell,
+    const unsigned unknownBarcodeIndex,
+    const flowcell::TileMetadataList &tiles,
+    demultiplexing::Barcodes &barcodes)
+{
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    ISAAC_ASSERT_MSG(flowcell.getBarcodeLength(), "Fastq flowcell has no index reads to resolve barcodes from: " << flowcell);
+    ISAAC_ASSERT_MSG(1 == tiles.size(), "Fastq data is loaded one tile at a time");
+    const flowcell::TileMetadata &tile = tiles.front();
+    ISAAC_ASSERT_MSG(tile.getLane() == loadedLane_ && tile.getTile() == loadedTile_, "Unexpected tile requested: " << tile);
+    ISAAC_ASSERT_MSG(tile.getClusterCount() == loadedClusters_.getClusterCount(), "Unexpected cluster count for: " << tile);
+
+    demultiplexing::BarcodeMemoryManager::allocate(tiles, barcodes);
+    const alignment::BclClusterFields<alignment::BclClusters::const_iterator> fields(
+        flowcell.getReadMetadataList(), flowcell.getBarcodeLength());
+    for (unsigned clusterId = 0; tile.getClusterCount() > clusterId; ++clusterId)
+    {
+        demultiplexing::Barcode &barcode = barcodes.at(clusterId);
+        barcode = demultiplexing::Barcode::constructFromTileBarcodeCluster(tile.getIndex(), unknownBarcodeIndex, clusterId);
+        const alignment::BclClusterFields<alignment::BclClusters::const_iterator>::IteratorPair bcl =
+            fields.getBarcode(loadedClusters_.cluster(clusterId));
+        BOOST_FOREACH(const char base, bcl)
+        {
+            const demultiplexing::Kmer barcodeBase = (0 == base) ? 4 : (base & 3);
+            barcode.setSequence((barcode.getSequence() << demultiplexing::BITS_PER_BASE) | barcodeBase);
+        }
+    }
+}
+
 void FastqBaseCallsSource::loadClusters(
     const flowcell::TileMetadata &tileMetadata,
     alignment::BclClusters &bclData)
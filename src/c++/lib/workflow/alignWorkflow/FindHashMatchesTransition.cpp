@@ -17,7 +17,10 @@
  ** \author Roman Petrovski
  **/
 
+#include <numeric>
+
 #include <boost/ref.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "alignment/HashMatchFinder.hh"
 #include "alignment/matchSelector/BinningFragmentStorage.hh"
@@ -25,10 +28,12 @@
 #include "build/Build.hh"
 #include "common/Debug.hh"
 #include "common/Exceptions.hh"
+#include "common/Metrics.hh"
 #include "common/Numa.hh"
 #include "demultiplexing/DemultiplexingStatsXml.hh"
 #include "flowcell/Layout.hh"
 #include "flowcell/ReadMetadata.hh"
+#include "reference/SharedReferenceHash.hh"
 #include "workflow/alignWorkflow/BamDataSource.hh"
 #include "workflow/alignWorkflow/BclBgzfDataSource.hh"
 #include "workflow/alignWorkflow/BclDataSource.hh"
@@ -131,6 +136,8 @@ void IoOverlapThreadWorker::run(
 
                 dataSource.resetBclData(tileMetadata, tileClusters_);
                 dataSource.loadClusters(tileMetadata, tileClusters_);
+                common::metrics::add(common::metrics::BytesLoaded,
+                                     tileClusters_.getClusterCount() * tileClusters_.getClusterLength());
                 if(qScoreBin_)
                 {
                     binQscores(tileClusters_);
@@ -160,7 +167,9 @@ void IoOverlapThreadWorker::run(
             {
                 common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
                 matchSelector_.parallelSelect(tileClusterInfo, barcodeTemplateLengthStatistics, tileMetadata, matchFinder, tileClusters_, fragmentStorage_);
+                common::metrics::add(common::metrics::ClustersAligned, tileClusters_.getClusterCount());
             }
+            common::metrics::add(common::metrics::TilesAligned, 1);
 
             // swap the flush buffers while we still have compute lock
             wait(flushing_, stateChangedCondition_, lock, forceTermination_);
@@ -248,7 +257,12 @@ FindHashMatchesTransition::FindHashMatchesTransition(
     const bool preSortBins,
     const bool preAllocateBins,
     const std::string &binRegexString,
-    const unsigned detectTemplateBlockSize
+    const unsigned detectTemplateBlockSize,
+    const unsigned seedMatchCacheSize,
+    const bool adaptiveSeeds,
+    const unsigned minimizerWindow,
+    const bool sharedReferenceHash,
+    const unsigned traceSlowestClusters
     )
     : hashTableBucketCount_(hashTableBucketCount)
     , flowcellLayoutList_(flowcellLayoutList)
@@ -257,6 +271,9 @@ FindHashMatchesTransition::FindHashMatchesTransition(
     , coresMax_(maxThreadCount)
     , candidateMatchesMax_(candidateMatchesMax)
     , matchFinderMaxRepeats_(std::max(matchFinderTooManyRepeats, std::max(matchFinderWayTooManyRepeats, matchFinderShadowSplitRepeats)))
+    , adaptiveSeeds_(adaptiveSeeds)
+    , minimizerWindow_(minimizerWindow)
+    , sharedReferenceHash_(sharedReferenceHash)
     , seedBaseQualityMin_(seedBaseQualityMin)
     , seedLength_(seedLength)
     , repeatThreshold_(repeatThreshold)
@@ -328,7 +345,9 @@ FindHashMatchesTransition::FindHashMatchesTransition(
         dodgyAlignmentScore,
         anomalousPairHandicap,
         common::ScopedMallocBlock::Strict == memoryControl_,
-        detectTemplateBlockSize),
+        detectTemplateBlockSize,
+        seedMatchCacheSize,
+        traceSlowestClusters),
         qScoreBin_(qScoreBin),
         fullBclQScoreTable_(fullBclQScoreTable)
 {
@@ -422,7 +441,7 @@ void FindHashMatchesTransition::resolveBarcodes(
     }
     else
     {
-        demultiplexing::BarcodeResolver barcodeResolver(barcodeMetadataList_, barcodeGroup);
+        demultiplexing::BarcodeResolver barcodeResolver(barcodeMetadataList_, barcodeGroup, threads_, coresMax_);
 
         flowcell::TileMetadataList currentTiles; currentTiles.reserve(unprocessedTiles.size());
 
@@ -496,9 +515,10 @@ ReferenceHashT buildReferenceHash(
     const reference::ContigList &contigList,
     const std::size_t hashTableBucketCount,
     common::ThreadVector &threads,
-    const unsigned coresMax)
+    const unsigned coresMax,
+    const unsigned minimizerWindow)
 {
-    reference::ReferenceHasher<ReferenceHashT> hasher(contigList, threads, coresMax);
+    reference::ReferenceHasher<ReferenceHashT> hasher(contigList, threads, coresMax, minimizerWindow);
 
     ReferenceHashT ret = hasher.generate(hashTableBucketCount);
 
@@ -534,10 +554,17 @@ void FindHashMatchesTransition::findLaneMatches(
         ISAAC_THREAD_CERR << "Finding hash matches with repeat threshold: " << repeatThreshold_ << std::endl;
 
         alignment::ClusterHashMatchFinder<ReferenceHashT, SEEDS_PER_MATCH_MAX> matchFinder(
-            referenceHash, candidateMatchesMax_, seedBaseQualityMin_, matchFinderMaxRepeats_);
+            referenceHash, candidateMatchesMax_, seedBaseQualityMin_, matchFinderMaxRepeats_, adaptiveSeeds_);
 
         matchSelector_.reserveMemory(unprocessedTiles);
 
+        // streamed inputs discover tiles as they go, so the totals grow from lane to lane
+        common::metrics::addExpected(common::metrics::TilesAligned, unprocessedTiles.size());
+        common::metrics::addExpected(
+            common::metrics::ClustersAligned,
+            std::accumulate(unprocessedTiles.begin(), unprocessedTiles.end(), uint64_t(0),
+                            [](const uint64_t sum, const flowcell::TileMetadata &tile){return sum + tile.getClusterCount();}));
+
         {
             unsigned current = 0;
             unsigned nextUnprocessed = 0;
@@ -786,8 +813,19 @@ void FindHashMatchesTransition::align(
 //    const NumaReferenceHash referenceHash(buildReferenceHash<ReferenceHash>(contigLists_.node0Container().front(), threads_, coresMax_));
 
     typedef reference::ReferenceHash<KmerT, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > ReferenceHash;
-    const ReferenceHash referenceHash(buildReferenceHash<ReferenceHash>(
-        contigLists_.node0Container().front(), hashTableBucketCount_, threads_, coresMax_));
+    const reference::ContigList &contigList = contigLists_.node0Container().front();
+    const auto build = [this, &contigList]()
+    {
+        return buildReferenceHash<ReferenceHash>(contigList, hashTableBucketCount_, threads_, coresMax_, minimizerWindow_);
+    };
+    // must outlive referenceHash
+    boost::scoped_ptr<reference::SharedReferenceHashSegment> sharedSegment(
+        sharedReferenceHash_ ?
+            new reference::SharedReferenceHashSegment(
+                contigList, sortedReferenceMetadataList_.front().getContigs(),
+                ReferenceHash::SEED_LENGTH, sizeof(typename ReferenceHash::Offset), hashTableBucketCount_, minimizerWindow_) : 0);
+    const ReferenceHash referenceHash(
+        sharedSegment ? reference::getSharedReferenceHash<ReferenceHash>(*sharedSegment, build) : build());
 
     FoundMatchesMetadata ret(tempDirectory_, barcodeMetadataList_, 1, sortedReferenceMetadataList_);
     demultiplexing::DemultiplexingStats demultiplexingStats(flowcellLayoutList_, barcodeMetadataList_);
@@ -802,6 +840,7 @@ void FindHashMatchesTransition::align(
     matchSelector_.unreserve();
 
     matchSelector_.dumpStats(matchSelectorStatsXmlPath);
+    matchSelector_.dumpSlowestClusters(matchSelectorStatsXmlPath.parent_path() / "SlowestClusters.tsv");
 }
 
 void FindHashMatchesTransition::dumpStats(
@@ -17,6 +17,8 @@
  ** \author Roman Petrovski
  **/
 
+#include <numeric>
+
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
 #include <boost/integer/static_min_max.hpp>
@@ -34,6 +36,9 @@ namespace alignWorkflow
 namespace bamDataSource
 {
 
+const unsigned TempFileClusterExtractor::NO_RECORD;
+const unsigned TempFileClusterExtractor::REMOVED_RECORD;
+
 void TempFileClusterExtractor::open(const boost::filesystem::path &tempFilePath, std::streamsize expectedFileSize)
 {
     if (tempFilePath_ != tempFilePath.c_str())
@@ -65,19 +70,124 @@ void TempFileClusterExtractor::open(const boost::filesystem::path &tempFilePath,
             {
                 recordIndex_.push_back(it);
             }
-
-            std::sort(recordIndex_.begin(), recordIndex_.end(), compareNameAndRead);
             ISAAC_THREAD_CERR << "TempFileClusterExtractor::open: " << recordIndex_.size() << " " << tempFilePath << std::endl;
         }
         else
         {
             ISAAC_THREAD_CERR << "TempFileClusterExtractor::open: empty " << tempFilePath << std::endl;
         }
+        joinRecords();
     }
-    firstUnextracted_ = recordIndex_.begin();
+    extractPartition_ = 0;
+    extractPair_ = 0;
+    skipExtractedPartitions();
     tempFilePath_ = tempFilePath.c_str();
 }
 
+/**
+ * \brief Pairs the records of recordIndex_ into partitionPairs_
+ */
+void TempFileClusterExtractor::joinRecords()
+{
+    ISAAC_ASSERT_MSG(recordIndex_.size() < REMOVED_RECORD, "Too many records in " << common::pathStringToStdString(tempFilePath_));
+    recordHashes_.resize(recordIndex_.size());
+    threads_.execute(
+        [this](const unsigned threadNumber, const unsigned threadsTotal)
+        {
+            const std::size_t chunkSize = (recordIndex_.size() + threadsTotal - 1) / threadsTotal;
+            const std::size_t chunkEnd = std::min(recordIndex_.size(), chunkSize * (threadNumber + 1));
+            for (std::size_t i = std::min(recordIndex_.size(), chunkSize * threadNumber); chunkEnd != i; ++i)
+            {
+                recordHashes_[i] = getReadNameHash(getReadNameCString(recordIndex_[i]));
+            }
+        },
+        threadsMax_);
+
+    // counting sort of record offsets by join partition
+    partitionOffsets_.assign(JOIN_PARTITIONS + 1, 0);
+    BOOST_FOREACH(const uint64_t nameHash, recordHashes_)
+    {
+        ++partitionOffsets_[getJoinPartition(nameHash) + 1];
+    }
+    std::partial_sum(partitionOffsets_.begin(), partitionOffsets_.end(), partitionOffsets_.begin());
+    partitionedRecords_.resize(recordIndex_.size());
+    {
+        std::vector<std::size_t> next(partitionOffsets_.begin(), partitionOffsets_.end() - 1);
+        for (unsigned i = 0; recordHashes_.size() != i; ++i)
+        {
+            partitionedRecords_[next[getJoinPartition(recordHashes_[i])]++] = i;
+        }
+    }
+
+    threads_.execute(
+        [this](const unsigned threadNumber, const unsigned threadsTotal)
+        {
+            for (unsigned partition = threadNumber; JOIN_PARTITIONS > partition; partition += threadsTotal)
+            {
+                joinPartition(partition, threadJoinTables_.at(threadNumber));
+            }
+        },
+        threadsMax_);
+}
+
+/**
+ * \brief Hash join of read 1 and read 2 records of a single join partition. Records are processed in the
+ *        order in which they were stored, so that the result does not depend on the thread that does it.
+ */
+void TempFileClusterExtractor::joinPartition(const unsigned partition, std::vector<unsigned> &joinTable)
+{
+    const std::vector<unsigned>::const_iterator recordsBegin = partitionedRecords_.begin() + partitionOffsets_[partition];
+    const std::vector<unsigned>::const_iterator recordsEnd = partitionedRecords_.begin() + partitionOffsets_[partition + 1];
+    // keep the load factor at or below 0.5 so that there is always an empty slot to terminate the probing
+    std::size_t tableSize = 2;
+    while (tableSize < std::size_t(std::distance(recordsBegin, recordsEnd)) * 2)
+    {
+        tableSize <<= 1;
+    }
+    const std::size_t tableMask = tableSize - 1;
+    joinTable.assign(tableSize, NO_RECORD);
+
+    std::vector<RecordPair> &pairs = partitionPairs_[partition];
+    pairs.clear();
+    for (std::vector<unsigned>::const_iterator recordIt = recordsBegin; recordsEnd != recordIt; ++recordIt)
+    {
+        const unsigned record = *recordIt;
+        const uint64_t nameHash = recordHashes_[record];
+        const bool readOne = isReadOne(recordIndex_[record]);
+        std::size_t freeSlot = tableSize;
+        std::size_t slot = nameHash & tableMask;
+        for (; NO_RECORD != joinTable[slot]; slot = (slot + 1) & tableMask)
+        {
+            const unsigned candidate = joinTable[slot];
+            if (REMOVED_RECORD == candidate)
+            {
+                freeSlot = std::min(freeSlot, slot);
+            }
+            else if (recordHashes_[candidate] == nameHash &&
+                isReadOne(recordIndex_[candidate]) != readOne &&
+                !strcmp(getReadNameCString(recordIndex_[candidate]), getReadNameCString(recordIndex_[record])))
+            {
+                pairs.push_back(readOne ? RecordPair(record, candidate) : RecordPair(candidate, record));
+                joinTable[slot] = REMOVED_RECORD;
+                break;
+            }
+        }
+        if (NO_RECORD == joinTable[slot])
+        {
+            // no mate, wait for it
+            joinTable[tableSize == freeSlot ? slot : freeSlot] = record;
+        }
+    }
+
+    BOOST_FOREACH(const unsigned record, joinTable)
+    {
+        if (REMOVED_RECORD > record)
+        {
+            pairs.push_back(isReadOne(recordIndex_[record]) ? RecordPair(record, NO_RECORD) : RecordPair(NO_RECORD, record));
+        }
+    }
+}
+
 template <typename IteratorT>
 void UnpairedReadsCache::storeUnpaired(
     IteratorT unpairedBegin,
@@ -99,8 +209,8 @@ void UnpairedReadsCache::storeUnpaired(
         extractReadName(block, maxReadNameLength_, readMetadata, std::back_inserter(byteBuff));
         ISAAC_ASSERT_MSG(byteBuff.size() == maxReadNameLength_, "Invalid number of name bytes extracted");
         byteBuff.push_back(0);// 0 terminator is needed for name comparison during extraction
-        const unsigned nameCrc = getNameCrc<7>(crcWidth_, byteBuff.begin(), maxReadNameLength_);
-        std::ostream os(tempFiles_[nameCrc].get());
+        const unsigned partition = getPartition(getReadNameHash(byteBuff.begin()));
+        std::ostream os(tempFiles_[partition].get());
 
         const TempFileClusterExtractor::FlagsType flags =
             (block.isReadOne() ? TempFileClusterExtractor::READ_ONE_FLAG : 0) |
@@ -109,23 +219,23 @@ void UnpairedReadsCache::storeUnpaired(
         if (!os.write(reinterpret_cast<const char*>(&recordLength), sizeof(unsigned)))
         {
             BOOST_THROW_EXCEPTION(isaac::common::IoException(
-                errno, (boost::format("Failed to write: %d bytes into %s") % sizeof(unsigned) % common::pathStringToStdString(tempFilePaths_[nameCrc])).str()));
+                errno, (boost::format("Failed to write: %d bytes into %s") % sizeof(unsigned) % common::pathStringToStdString(tempFilePaths_[partition])).str()));
         }
-        tempFileSizes_[nameCrc] += sizeof(unsigned);
+        tempFileSizes_[partition] += sizeof(unsigned);
 
         if (!os.write(reinterpret_cast<const char*>(&flags), sizeof(flags)))
         {
             BOOST_THROW_EXCEPTION(isaac::common::IoException(
-                errno, (boost::format("Failed to write: %d bytes into %s") % sizeof(flags) % common::pathStringToStdString(tempFilePaths_[nameCrc])).str()));
+                errno, (boost::format("Failed to write: %d bytes into %s") % sizeof(flags) % common::pathStringToStdString(tempFilePaths_[partition])).str()));
         }
-        tempFileSizes_[nameCrc] += sizeof(flags);
+        tempFileSizes_[partition] += sizeof(flags);
 
         if (!os.write(byteBuff.begin(), byteBuff.size()))
         {
             BOOST_THROW_EXCEPTION(isaac::common::IoException(
-                errno, (boost::format("Failed to write: %d bytes into %s") % byteBuff.size() % common::pathStringToStdString(tempFilePaths_[nameCrc])).str()));
+                errno, (boost::format("Failed to write: %d bytes into %s") % byteBuff.size() % common::pathStringToStdString(tempFilePaths_[partition])).str()));
         }
-        tempFileSizes_[nameCrc] += byteBuff.size();
+        tempFileSizes_[partition] += byteBuff.size();
 
         byteBuff.resize(readMetadata.getLength());
         bam::extractBcl(idx.getBlock(), byteBuff.begin(), readMetadata);
@@ -133,9 +243,9 @@ void UnpairedReadsCache::storeUnpaired(
         if (!os.write(&byteBuff.front(), byteBuff.size()))
         {
             BOOST_THROW_EXCEPTION(isaac::common::IoException(
-                errno, (boost::format("Failed to write: %d bytes into %s") % byteBuff.size() % common::pathStringToStdString(tempFilePaths_[nameCrc])).str()));
+                errno, (boost::format("Failed to write: %d bytes into %s") % byteBuff.size() % common::pathStringToStdString(tempFilePaths_[partition])).str()));
         }
-        tempFileSizes_[nameCrc] += byteBuff.size();
+        tempFileSizes_[partition] += byteBuff.size();
     }
 }
 
@@ -0,0 +1,183 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <fstream>
+#include <iterator>
+#include <map>
+
+#include "workflow/alignWorkflow/bamDataSource/PairedEndClusterExtractor.hh"
+
+using namespace std;
+using isaac::workflow::alignWorkflow::bamDataSource::TempFileClusterExtractor;
+using isaac::workflow::alignWorkflow::bamDataSource::getReadNameHash;
+
+#include "RegistryName.hh"
+#include "testTempFileClusterExtractor.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestTempFileClusterExtractor, registryName("TempFileClusterExtractor"));
+
+static const unsigned NAME_LENGTH_MAX = 8;
+static const unsigned R1_LENGTH = 3;
+static const unsigned R2_LENGTH = 4;
+static const unsigned CLUSTER_LENGTH = R1_LENGTH + R2_LENGTH + NAME_LENGTH_MAX;
+static const unsigned PAIRS = 500;
+
+static unsigned getJoinPartition(const std::string &name)
+{
+    // TempFileClusterExtractor splits the records into 64 partitions by the top bits of the name hash
+    return getReadNameHash(name.c_str()) >> 58;
+}
+
+static std::string paddedName(const std::string &name)
+{
+    return name + std::string(NAME_LENGTH_MAX - name.length(), '\0');
+}
+
+void TestTempFileClusterExtractor::setUp()
+{
+    tempFilePath_ = boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path("testTempFileClusterExtractor-%%%%-%%%%.tmp");
+
+    // mates stored in either order and far apart, a few reads without a mate
+    reads_.clear();
+    for (unsigned pair = 0; PAIRS != pair; ++pair)
+    {
+        const std::string name = "r" + std::to_string(pair);
+        const Read r1 = {name, true, 0 != pair % 7, std::string(R1_LENGTH, char(pair))};
+        const Read r2 = {name, false, 0 != pair % 5, std::string(R2_LENGTH, char(pair + 1))};
+        reads_.push_back(pair % 2 ? r1 : r2);
+        if (pair % 50)
+        {
+            reads_.insert(reads_.begin() + (pair * 7919) % reads_.size(), pair % 2 ? r2 : r1);
+        }
+    }
+    writeTempFile();
+}
+
+void TestTempFileClusterExtractor::tearDown()
+{
+    boost::filesystem::remove(tempFilePath_);
+}
+
+void TestTempFileClusterExtractor::writeTempFile()
+{
+    std::ofstream os(tempFilePath_.c_str(), std::ios_base::binary);
+    for (const Read &read : reads_)
+    {
+        const TempFileClusterExtractor::FlagsType flags =
+            (read.readOne_ ? TempFileClusterExtractor::READ_ONE_FLAG : 0) |
+            (read.pf_ ? TempFileClusterExtractor::PASS_FILTER_FLAG : 0);
+        const unsigned recordLength = sizeof(recordLength) + sizeof(flags) + NAME_LENGTH_MAX + 1 + read.bcl_.length();
+        os.write(reinterpret_cast<const char*>(&recordLength), sizeof(recordLength));
+        os.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+        const std::string name = paddedName(read.name_);
+        os.write(name.c_str(), name.length() + 1);
+        os.write(read.bcl_.data(), read.bcl_.length());
+    }
+    CPPUNIT_ASSERT(os);
+}
+
+std::vector<std::string> TestTempFileClusterExtractor::extract(const unsigned threads)
+{
+    isaac::common::ThreadVector threadVector(threads);
+    TempFileClusterExtractor extractor(
+        tempFilePath_.string().length(), boost::filesystem::file_size(tempFilePath_), R1_LENGTH, threadVector, threads);
+    extractor.open(tempFilePath_, boost::filesystem::file_size(tempFilePath_));
+
+    std::vector<char> clusters;
+    std::vector<bool> pfs;
+    std::back_insert_iterator<std::vector<char> > clusterIt(clusters);
+    std::back_insert_iterator<std::vector<bool> > pfIt(pfs);
+    // in several calls to check that extraction resumes where it stopped
+    while (!extractor.isEmpty())
+    {
+        const unsigned notExtracted = extractor.extractClusters(R1_LENGTH, R2_LENGTH, NAME_LENGTH_MAX, 77, clusterIt, pfIt);
+        CPPUNIT_ASSERT(extractor.isEmpty() || !notExtracted);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(clusters.size(), pfs.size() * CLUSTER_LENGTH);
+    std::vector<std::string> ret;
+    for (std::size_t i = 0; pfs.size() != i; ++i)
+    {
+        ret.push_back(std::string(clusters.begin() + i * CLUSTER_LENGTH, clusters.begin() + (i + 1) * CLUSTER_LENGTH) +
+                      (pfs[i] ? '1' : '0'));
+    }
+    return ret;
+}
+
+void TestTempFileClusterExtractor::testJoin()
+{
+    const std::vector<std::string> clusters = extract(3);
+
+    // each read appears in exactly one cluster, next to its mate
+    std::map<std::string, std::pair<const Read*, const Read*> > mates;
+    for (const Read &read : reads_)
+    {
+        (read.readOne_ ? mates[read.name_].first : mates[read.name_].second) = &read;
+    }
+    CPPUNIT_ASSERT_EQUAL(mates.size(), clusters.size());
+
+    // file order of the record that completes each pair. Within a partition, pairs come out in this order
+    std::map<std::string, std::size_t> pairedAt;
+    std::map<std::string, bool> seen;
+    for (std::size_t i = 0; reads_.size() != i; ++i)
+    {
+        if (seen[reads_[i].name_])
+        {
+            pairedAt[reads_[i].name_] = i;
+        }
+        seen[reads_[i].name_] = true;
+    }
+
+    unsigned lastPartition = 0;
+    bool lastPaired = true;
+    std::size_t lastPairedAt = 0;
+    for (const std::string &cluster : clusters)
+    {
+        const std::string name = cluster.substr(R1_LENGTH + R2_LENGTH, NAME_LENGTH_MAX).c_str();
+        CPPUNIT_ASSERT(mates.end() != mates.find(name));
+        const Read *r1 = mates[name].first;
+        const Read *r2 = mates[name].second;
+        const bool paired = r1 && r2;
+
+        CPPUNIT_ASSERT_EQUAL(r1 ? r1->bcl_ : std::string(R1_LENGTH, '\0'), cluster.substr(0, R1_LENGTH));
+        CPPUNIT_ASSERT_EQUAL(r2 ? r2->bcl_ : std::string(R2_LENGTH, '\0'), cluster.substr(R1_LENGTH, R2_LENGTH));
+        CPPUNIT_ASSERT_EQUAL(paddedName(name), cluster.substr(R1_LENGTH + R2_LENGTH, NAME_LENGTH_MAX));
+        const bool pf = paired ? r1->pf_ && r2->pf_ : (r1 ? r1 : r2)->pf_;
+        CPPUNIT_ASSERT_EQUAL(pf ? '1' : '0', cluster[CLUSTER_LENGTH]);
+
+        // partitions come out in order, pairs before the unpaired reads of the partition
+        const unsigned partition = getJoinPartition(name);
+        CPPUNIT_ASSERT(lastPartition <= partition);
+        if (lastPartition == partition)
+        {
+            CPPUNIT_ASSERT(lastPaired || !paired);
+            if (lastPaired && paired)
+            {
+                CPPUNIT_ASSERT(lastPairedAt < pairedAt[name]);
+            }
+        }
+        lastPartition = partition;
+        lastPaired = paired;
+        lastPairedAt = paired ? pairedAt[name] : 0;
+        mates.erase(name);
+    }
+    CPPUNIT_ASSERT(mates.empty());
+}
+
+void TestTempFileClusterExtractor::testJoinThreadsIndependent()
+{
+    const std::vector<std::string> clusters = extract(1);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(PAIRS), clusters.size());
+    CPPUNIT_ASSERT(clusters == extract(4));
+}
@@ -0,0 +1,53 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_WORKFLOW_TEST_TEMP_FILE_CLUSTER_EXTRACTOR_HH
+#define iSAAC_WORKFLOW_TEST_TEMP_FILE_CLUSTER_EXTRACTOR_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+class TestTempFileClusterExtractor : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestTempFileClusterExtractor );
+    CPPUNIT_TEST( testJoin );
+    CPPUNIT_TEST( testJoinThreadsIndependent );
+    CPPUNIT_TEST_SUITE_END();
+private:
+    struct Read
+    {
+        std::string name_;
+        bool readOne_;
+        bool pf_;
+        std::string bcl_;
+    };
+
+    boost::filesystem::path tempFilePath_;
+    std::vector<Read> reads_;
+
+    void writeTempFile();
+    /// \return extracted clusters, each r1 bcl, r2 bcl and the padded name followed by the pf flag
+    std::vector<std::string> extract(const unsigned threads);
+
+public:
+    void setUp();
+    void tearDown();
+    void testJoin();
+    void testJoinThreadsIndependent();
+};
+
+#endif // #ifndef iSAAC_WORKFLOW_TEST_TEMP_FILE_CLUSTER_EXTRACTOR_HH
@@ -56,7 +56,7 @@ GENOME_FASTA:=$(TEMP_DIR)/$(ORIGINAL_GENOME_FASTA)
 CONSOLIDATED_REFERENCE_XML:=$(TEMP_DIR)/sorted-reference.xml
 
 $(CONSOLIDATED_REFERENCE_XML): $(REFERENCE_GENOME) $(TEMP_DIR)/.sentinel
-	$(CMDPREFIX) $(REORDER_REFERENCE) --reference-genome $< --output-directory $(TEMP_DIR) --output-xml $(SAFEPIPETARGET) 
+	$(CMDPREFIX) $(REORDER_REFERENCE) --reference-genome $< --output-directory $(TEMP_DIR) --output-xml $(SAFEPIPETARGET) --contig-image 0
 
 $(OUTPUT_FILE): $(CONSOLIDATED_REFERENCE_XML)
 	$(CMDPREFIX) $(TAR) -czvO \